@@ -172,6 +172,82 @@ class AdminAgentImpl : public AdminAgent {
     return 0;
   }
 
+  int attach_segments(const proto::AttachSegmentsRequest &request,
+                      proto::AttachSegmentsResponse *response) override {
+    auto collection = meta_agent_->get_collection(request.collection_name());
+    if (!collection) {
+      LOG_ERROR("Failed to attach segments. collection[%s]",
+                request.collection_name().c_str());
+      return PROXIMA_BE_ERROR_CODE(InexistentCollection);
+    }
+
+    size_t segment_count = 0U;
+    int code = index_agent_->attach_segments(
+        request.collection_name(), request.source_path(), &segment_count);
+    if (code != 0) {
+      LOG_ERROR(
+          "Failed to attach segments, collection[%s] source_path[%s] "
+          "code[%d], what[%s].",
+          request.collection_name().c_str(), request.source_path().c_str(),
+          code, ErrorCode::What(code));
+      return code;
+    }
+    response->set_segment_count(segment_count);
+    return 0;
+  }
+
+  int checkpoint_collection(
+      const proto::CheckpointCollectionRequest &request,
+      proto::CheckpointCollectionResponse *response) override {
+    auto collection = meta_agent_->get_collection(request.collection_name());
+    if (!collection) {
+      LOG_ERROR("Failed to checkpoint collection. collection[%s]",
+                request.collection_name().c_str());
+      return PROXIMA_BE_ERROR_CODE(InexistentCollection);
+    }
+
+    uint64_t lsn = 0U;
+    int code = index_agent_->checkpoint_collection(
+        request.collection_name(), request.checkpoint_path(), &lsn);
+    if (code != 0) {
+      LOG_ERROR(
+          "Failed to checkpoint collection, collection[%s] "
+          "checkpoint_path[%s] code[%d], what[%s].",
+          request.collection_name().c_str(),
+          request.checkpoint_path().c_str(), code, ErrorCode::What(code));
+      return code;
+    }
+    response->set_lsn(lsn);
+    return 0;
+  }
+
+  int trace_write(const proto::TraceWriteRequest &request,
+                  proto::TraceWriteResponse *response) override {
+    auto collection = meta_agent_->get_collection(request.collection_name());
+    if (!collection) {
+      LOG_ERROR("Failed to trace write. collection[%s]",
+                request.collection_name().c_str());
+      return PROXIMA_BE_ERROR_CODE(InexistentCollection);
+    }
+
+    std::vector<uint64_t> traced_keys;
+    int code = index_agent_->trace_write(request.collection_name(),
+                                         request.primary_key(),
+                                         request.enable(), &traced_keys);
+    if (code != 0) {
+      LOG_ERROR(
+          "Failed to trace write, collection[%s] primary_key[%zu] "
+          "code[%d], what[%s].",
+          request.collection_name().c_str(), (size_t)request.primary_key(),
+          code, ErrorCode::What(code));
+      return code;
+    }
+    for (auto key : traced_keys) {
+      response->add_traced_keys(key);
+    }
+    return 0;
+  }
+
   int reload_meta() override {
     return meta_agent_->reload();
   }
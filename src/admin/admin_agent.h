@@ -79,6 +79,19 @@ class AdminAgent {
   virtual int stats_collection(const std::string &collection_name,
                                proto::StatsCollectionResponse *stats) = 0;
 
+  //! Attach segments built outside to collection
+  virtual int attach_segments(const proto::AttachSegmentsRequest &request,
+                              proto::AttachSegmentsResponse *response) = 0;
+
+  //! Create a point-in-time checkpoint of collection
+  virtual int checkpoint_collection(
+      const proto::CheckpointCollectionRequest &request,
+      proto::CheckpointCollectionResponse *response) = 0;
+
+  //! Start or stop tracing writes of a primary key
+  virtual int trace_write(const proto::TraceWriteRequest &request,
+                          proto::TraceWriteResponse *response) = 0;
+
   //! Reload meta from meta store
   virtual int reload_meta() = 0;
 
@@ -111,6 +111,8 @@ int AdminProtoConverter::PBToCollectionBase(
   }
   // Should we recommend some of default value for users
   param->set_max_docs_per_segment(request.max_docs_per_segment());
+  param->set_ttl_seconds(request.ttl_seconds());
+  param->set_load_mode(static_cast<LoadModes>(request.load_mode()));
   // Serialize forward_columns
   param->mutable_forward_columns()->insert(
       param->forward_columns().begin(), request.forward_column_names().begin(),
@@ -176,6 +178,9 @@ void AdminProtoConverter::CollectionMetaToPB(
   auto *config = info->mutable_config();
   config->set_collection_name(collection.name());
   config->set_max_docs_per_segment(collection.max_docs_per_segment());
+  config->set_ttl_seconds(collection.ttl_seconds());
+  config->set_load_mode(
+      static_cast<proto::CollectionConfig_LoadMode>(collection.load_mode()));
 
   for (auto &forward : collection.forward_columns()) {
     config->add_forward_column_names(forward);
@@ -203,6 +208,7 @@ void AdminProtoConverter::SegmentStatsToPB(
   SET_STATS_FIELD(max_timestamp);
   SET_STATS_FIELD(min_lsn);
   SET_STATS_FIELD(max_lsn);
+  SET_STATS_FIELD(resident_size);
   pb_stats->set_state(
       static_cast<proto::CollectionStats_SegmentStats_SegmentState>(
           stats.state));
@@ -216,9 +222,35 @@ void AdminProtoConverter::CollectionStatsToPB(
   SET_STATS_FIELD(total_segment_count);
   SET_STATS_FIELD(total_index_file_count);
   SET_STATS_FIELD(total_index_file_size);
+  SET_STATS_FIELD(total_resident_size);
   for (const auto &segment : stats.segment_stats) {
     SegmentStatsToPB(segment, pb_stats->add_segment_stats());
   }
+  for (const auto &column : stats.column_build_stats) {
+    auto *pb_column = pb_stats->add_column_build_stats();
+    pb_column->set_column_name(column.column_name);
+    pb_column->set_insert_count(column.insert_count);
+    pb_column->set_total_build_us(column.total_build_us);
+    pb_column->set_max_batch_build_us(column.max_batch_build_us);
+  }
+  for (const auto &backfill : stats.backfill_stats) {
+    auto *pb_backfill = pb_stats->add_backfill_stats();
+    pb_backfill->set_column_name(backfill.column_name);
+    pb_backfill->set_schema_revision(backfill.schema_revision);
+    pb_backfill->set_total_segment_count(backfill.total_segment_count);
+    pb_backfill->set_done_segment_count(backfill.done_segment_count);
+    pb_backfill->set_failed_segment_count(backfill.failed_segment_count);
+    pb_backfill->set_backfilled_doc_count(backfill.backfilled_doc_count);
+  }
+  auto &rebuild = stats.rebuild_stats;
+  auto *pb_rebuild = pb_stats->mutable_rebuild_stats();
+  pb_rebuild->set_total_segment_count(rebuild.total_segment_count);
+  pb_rebuild->set_done_segment_count(rebuild.done_segment_count);
+  pb_rebuild->set_failed_segment_count(rebuild.failed_segment_count);
+  pb_rebuild->set_rejected_column_count(rebuild.rejected_column_count);
+  pb_rebuild->set_rebuilt_doc_count(rebuild.rebuilt_doc_count);
+  pb_rebuild->set_dropped_doc_count(rebuild.dropped_doc_count);
+  pb_rebuild->set_last_recall(rebuild.last_recall);
 }
 #undef SET_STATS_FIELD
 
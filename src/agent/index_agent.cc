@@ -19,7 +19,9 @@
  */
 
 #include "index_agent.h"
+#include <ailego/hash/jump_hash.h>
 #include "common/config.h"
+#include "metrics/metrics_collector.h"
 
 namespace proxima {
 namespace be {
@@ -68,13 +70,8 @@ int IndexAgent::update_collection(const std::string &collection_name,
     return ErrorCode_RuntimeError;
   }
 
-  // wait collection's all records to be processed
-  while (true) {
-    if (counter->active_count() == 0) {
-      break;
-    }
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-  }
+  // Records in flight are not drained, collection switches columns
+  // while writing, and backfills columns rows of older revision miss
 
   // get specified revision's collection meta
   auto collection = meta_service_->get_collection(collection_name, revision);
@@ -123,6 +120,48 @@ int IndexAgent::get_collection_stats(
   return 0;
 }
 
+int IndexAgent::attach_segments(const std::string &collection_name,
+                                const std::string &source_path,
+                                size_t *segment_count) {
+  int ret = index_service_->attach_segments(collection_name, source_path,
+                                            segment_count);
+  if (ret != 0) {
+    LOG_ERROR("Index service attach segments failed. collection[%s]",
+              collection_name.c_str());
+    return ret;
+  }
+
+  return 0;
+}
+
+int IndexAgent::checkpoint_collection(const std::string &collection_name,
+                                      const std::string &checkpoint_path,
+                                      uint64_t *lsn) {
+  int ret = index_service_->checkpoint_collection(collection_name,
+                                                  checkpoint_path, lsn);
+  if (ret != 0) {
+    LOG_ERROR("Index service checkpoint collection failed. collection[%s]",
+              collection_name.c_str());
+    return ret;
+  }
+
+  return 0;
+}
+
+int IndexAgent::trace_write(const std::string &collection_name,
+                            uint64_t primary_key, bool enable,
+                            std::vector<uint64_t> *traced_keys) {
+  int ret = index_service_->trace_write(collection_name, primary_key, enable,
+                                        traced_keys);
+  if (ret != 0) {
+    LOG_ERROR("Index service trace write failed. collection[%s]",
+              collection_name.c_str());
+    return ret;
+  }
+
+  return 0;
+}
+
 bool IndexAgent::is_collection_suspend(const std::string &collection) {
   meta::CollectionMetaPtr meta =
       meta_service_->get_current_collection(collection);
@@ -278,12 +317,31 @@ int IndexAgent::stop() {
 int IndexAgent::proxy_write(const WriteRequest &request,
                             CollectionCounter *counter) {
   auto &collection = request.collection_name();
-  int dataset_count = (int)request.collection_dataset_count();
-  for (int i = 0; i < dataset_count; ++i) {
-    auto &dataset = request.get_collection_dataset(i);
-    thread_pool_->execute(dataset->get(0).primary_key, this,
-                          &IndexAgent::write_dataset, collection, dataset,
-                          counter);
+
+  // Rows are split into a sub batch per worker. A key is always handled
+  // by the same worker in arrival order, so rows of a key keep ordered.
+  int32_t shard_count = static_cast<int32_t>(thread_pool_->count());
+  std::vector<index::CollectionDatasetPtr> shards(shard_count);
+  std::vector<uint64_t> shard_keys(shard_count);
+  for (auto &dataset : request.get_collection_dataset()) {
+    for (size_t i = 0; i < dataset->size(); ++i) {
+      auto *row = dataset->mutable_row_data(i);
+      int32_t shard = ailego::JumpHash(row->primary_key, shard_count);
+      if (!shards[shard]) {
+        shards[shard] = std::make_shared<index::CollectionDataset>(
+            dataset->get_schema_revision());
+        shards[shard]->reserve(request.row_count() / shard_count + 1);
+        shard_keys[shard] = row->primary_key;
+      }
+      shards[shard]->add_row_data(std::move(*row));
+    }
+  }
+
+  for (int32_t i = 0; i < shard_count; ++i) {
+    if (shards[i]) {
+      thread_pool_->execute(shard_keys[i], this, &IndexAgent::write_dataset,
+                            collection, shards[i], counter);
+    }
   }
 
   return 0;
@@ -294,14 +352,24 @@ int IndexAgent::direct_write(const WriteRequest &request,
   auto &collection = request.collection_name();
   int row_count = request.row_count();
   auto &dataset = request.get_collection_dataset(0);
-  int ret = index_service_->write_records(collection, dataset);
+  index::WriteSummary summary;
+  int ret = index_service_->write_records(collection, dataset, &summary);
+  report_write_summary(summary);
   if (ret != 0) {
     counter->sub_active_count(row_count);
     LOG_ERROR("Index service write records failed. collection[%s]",
               collection.c_str());
     return ret;
   }
+
+  // Request is acked after its rows are synced in group commit mode
+  ret = index_service_->commit_records(collection);
   counter->sub_active_count(row_count);
+  if (ret != 0) {
+    LOG_ERROR("Index service commit records failed. collection[%s]",
+              collection.c_str());
+    return ret;
+  }
 
   return 0;
 }
@@ -309,14 +377,27 @@ int IndexAgent::direct_write(const WriteRequest &request,
 void IndexAgent::write_dataset(const std::string &collection_name,
                                const index::CollectionDatasetPtr &record,
                                CollectionCounter *counter) {
-  int ret = index_service_->write_records(collection_name, record);
+  index::WriteSummary summary;
+  int ret = index_service_->write_records(collection_name, record, &summary);
+  report_write_summary(summary);
   if (ret != 0) {
     LOG_ERROR(
         "Index service write record failed. "
         "code[%d] reason[%s] collection[%s]",
         ret, ErrorCode::What(ret), collection_name.c_str());
   }
-  counter->dec_active_count();
+  counter->sub_active_count(record->size());
+}
+
+void IndexAgent::report_write_summary(const index::WriteSummary &summary) {
+  if (summary.folded_count > 0) {
+    metrics::MetricsCollector::GetInstance().report_write_folded_count(
+        summary.folded_count);
+  }
+  if (summary.failed_count > 0) {
+    metrics::MetricsCollector::GetInstance().report_write_rejected_count(
+        summary.failed_count);
+  }
 }
 
 int IndexAgent::load_index_service() {
@@ -64,6 +64,18 @@ class IndexAgent {
   //! Write records
   int write(const WriteRequest &request);
 
+  //! Attach segments built outside
+  int attach_segments(const std::string &collection_name,
+                      const std::string &source_path, size_t *segment_count);
+
+  //! Create a point-in-time checkpoint of collection
+  int checkpoint_collection(const std::string &collection_name,
+                            const std::string &checkpoint_path, uint64_t *lsn);
+
+  //! Start or stop tracing writes of a primary key
+  int trace_write(const std::string &collection_name, uint64_t primary_key,
+                  bool enable, std::vector<uint64_t> *traced_keys);
+
   // Get latest lsn
   int get_latest_lsn(const std::string &collection_name, uint64_t *lsn,
                      std::string *lsn_context);
@@ -120,6 +132,9 @@ class IndexAgent {
                      const index::CollectionDatasetPtr &records,
                      CollectionCounter *counter);
 
+  //! Report how a write batch is applied to metrics
+  void report_write_summary(const index::WriteSummary &summary);
+
  private:
   IndexAgent(const IndexAgent &) = delete;
   IndexAgent &operator=(const IndexAgent &) = delete;
@@ -19,6 +19,7 @@
  */
 
 #include "config.h"
+#include <algorithm>
 #include <thread>
 #include <ailego/io/file.h>
 #include <ailego/utility/string_helper.h>
@@ -61,15 +62,40 @@ int Config::load_config(const std::string &file_name) {
       "http_listen_port[%u] log_directory[%s] log_file[%s] log_level[%u] "
       "build_thread_count[%u] dump_thread_count[%u] "
       "max_build_qps[%u] index_directory[%s] "
-      "flush_internal[%u] optimize_internal[%u] meta_uri[%s] "
-      "query_thread_count[%u]",
+      "flush_internal[%u] optimize_internal[%u] read_only[%d] "
+      "refresh_internal[%u] huge_page[%d] segment_load_mode[%s] "
+      "forward_on_disk[%d] forward_fetch_thread_count[%u] "
+      "forward_cache_size[%uMB] forward_compression[%s] "
+      "forward_block_size[%uKB] forward_block_cache_size[%uMB] "
+      "write_trace_sample_rate[%u] group_commit[%d] "
+      "group_commit_window[%uus] max_flush_speed[%uMB/s] "
+      "rebuild_deleted_ratio[%u%%] rebuild_cpu_ratio[%u%%] "
+      "rebuild_min_recall[%u%%] meta_uri[%s] "
+      "query_thread_count[%u] numa_aware[%d] numa_simulated_node_count[%u]",
       this->get_protocol().c_str(), this->get_grpc_listen_port(),
       this->get_http_listen_port(), this->get_log_dir().c_str(),
       this->get_log_file().c_str(), this->get_log_level() + 1,
       this->get_index_build_thread_count(), this->get_index_dump_thread_count(),
       this->get_index_max_build_qps(), this->get_index_directory().c_str(),
       this->get_index_flush_internal(), this->get_index_optimize_internal(),
-      this->get_meta_uri().c_str(), this->get_query_thread_count());
+      this->get_index_read_only(), this->get_index_refresh_internal(),
+      this->get_index_huge_page(),
+      this->get_index_segment_load_mode().c_str(),
+      this->get_index_forward_on_disk(),
+      this->get_index_forward_fetch_thread_count(),
+      this->get_index_forward_cache_size(),
+      this->get_index_forward_compression().c_str(),
+      this->get_index_forward_block_size(),
+      this->get_index_forward_block_cache_size(),
+      this->get_index_write_trace_sample_rate(),
+      this->get_index_group_commit(), this->get_index_group_commit_window(),
+      this->get_index_max_flush_speed(),
+      this->get_index_rebuild_deleted_ratio(),
+      this->get_index_rebuild_cpu_ratio(),
+      this->get_index_rebuild_min_recall(), this->get_meta_uri().c_str(),
+      this->get_query_thread_count(),
+      this->get_query_numa_aware(),
+      this->get_query_numa_simulated_node_count());
 
   return 0;
 }
@@ -131,6 +157,41 @@ bool Config::validate_config() const {
     return false;
   }
 
+  std::string load_mode = this->get_index_segment_load_mode();
+  if (load_mode != "mmap" && load_mode != "mmap_locked" &&
+      load_mode != "heap") {
+    LOG_ERROR(
+        "Config error, segment_load_mode must be mmap, mmap_locked or heap. "
+        "mode[%s]",
+        load_mode.c_str());
+    return false;
+  }
+
+  if (this->get_index_forward_fetch_thread_count() > 500) {
+    LOG_ERROR(
+        "Config error, forward_fetch_thread_count must be [1, 500]. "
+        "thread_count[%u]",
+        this->get_index_forward_fetch_thread_count());
+    return false;
+  }
+
+  std::string compression = this->get_index_forward_compression();
+  if (compression != "none" && compression != "snappy") {
+    LOG_ERROR(
+        "Config error, forward_compression must be none or snappy. "
+        "compression[%s]",
+        compression.c_str());
+    return false;
+  }
+
+  if (this->get_index_forward_block_size() > 4096) {
+    LOG_ERROR(
+        "Config error, forward_block_size must be [1, 4096] KB. "
+        "block_size[%u]",
+        this->get_index_forward_block_size());
+    return false;
+  }
+
   /** ========== valid Query Config========= **/
   if (this->get_query_thread_count() > 500) {
     LOG_ERROR(
@@ -266,6 +327,134 @@ uint32_t Config::get_index_optimize_internal(void) const {
   return optimize_internal;
 }
 
+bool Config::get_index_read_only(void) const {
+  return config_.has_index_config() && config_.index_config().read_only();
+}
+
+uint32_t Config::get_index_refresh_internal(void) const {
+  uint32_t refresh_internal = 10U;
+  if (config_.has_index_config() &&
+      config_.index_config().refresh_internal() != 0) {
+    refresh_internal = config_.index_config().refresh_internal();
+  }
+  return refresh_internal;
+}
+
+bool Config::get_index_huge_page(void) const {
+  return config_.has_index_config() && config_.index_config().huge_page();
+}
+
+std::string Config::get_index_segment_load_mode(void) const {
+  if (config_.has_index_config() &&
+      !config_.index_config().segment_load_mode().empty()) {
+    return config_.index_config().segment_load_mode();
+  }
+  return "mmap";
+}
+
+bool Config::get_index_forward_on_disk(void) const {
+  return config_.has_index_config() &&
+         config_.index_config().forward_on_disk();
+}
+
+uint32_t Config::get_index_forward_fetch_thread_count(void) const {
+  uint32_t thread_count = 8U;
+  if (config_.has_index_config() &&
+      config_.index_config().forward_fetch_thread_count() != 0) {
+    thread_count = config_.index_config().forward_fetch_thread_count();
+  }
+  return thread_count;
+}
+
+uint32_t Config::get_index_forward_cache_size(void) const {
+  uint32_t cache_size = 64U;
+  if (config_.has_index_config() &&
+      config_.index_config().forward_cache_size() != 0) {
+    cache_size = config_.index_config().forward_cache_size();
+  }
+  return cache_size;
+}
+
+std::string Config::get_index_forward_compression(void) const {
+  if (config_.has_index_config() &&
+      !config_.index_config().forward_compression().empty()) {
+    return config_.index_config().forward_compression();
+  }
+  return "none";
+}
+
+uint32_t Config::get_index_forward_block_size(void) const {
+  uint32_t block_size = 16U;
+  if (config_.has_index_config() &&
+      config_.index_config().forward_block_size() != 0) {
+    block_size = config_.index_config().forward_block_size();
+  }
+  return block_size;
+}
+
+uint32_t Config::get_index_forward_block_cache_size(void) const {
+  uint32_t cache_size = 256U;
+  if (config_.has_index_config() &&
+      config_.index_config().forward_block_cache_size() != 0) {
+    cache_size = config_.index_config().forward_block_cache_size();
+  }
+  return cache_size;
+}
+
+uint32_t Config::get_index_write_trace_sample_rate(void) const {
+  uint32_t sample_rate = 10U;
+  if (config_.has_index_config() &&
+      config_.index_config().write_trace_sample_rate() != 0) {
+    sample_rate = config_.index_config().write_trace_sample_rate();
+  }
+  return sample_rate;
+}
+
+bool Config::get_index_group_commit(void) const {
+  return config_.has_index_config() && config_.index_config().group_commit();
+}
+
+uint32_t Config::get_index_group_commit_window(void) const {
+  uint32_t commit_window = 1000U;
+  if (config_.has_index_config() &&
+      config_.index_config().group_commit_window() != 0) {
+    commit_window = config_.index_config().group_commit_window();
+  }
+  return commit_window;
+}
+
+uint32_t Config::get_index_max_flush_speed(void) const {
+  if (config_.has_index_config()) {
+    return config_.index_config().max_flush_speed();
+  }
+  return 0U;
+}
+
+uint32_t Config::get_index_rebuild_deleted_ratio(void) const {
+  if (config_.has_index_config()) {
+    return std::min(config_.index_config().rebuild_deleted_ratio(), 100U);
+  }
+  return 0U;
+}
+
+uint32_t Config::get_index_rebuild_cpu_ratio(void) const {
+  uint32_t cpu_ratio = 25U;
+  if (config_.has_index_config() &&
+      config_.index_config().rebuild_cpu_ratio() != 0) {
+    cpu_ratio = std::min(config_.index_config().rebuild_cpu_ratio(), 100U);
+  }
+  return cpu_ratio;
+}
+
+uint32_t Config::get_index_rebuild_min_recall(void) const {
+  uint32_t min_recall = 90U;
+  if (config_.has_index_config() &&
+      config_.index_config().rebuild_min_recall() != 0) {
+    min_recall = std::min(config_.index_config().rebuild_min_recall(), 100U);
+  }
+  return min_recall;
+}
+
 std::string Config::get_meta_uri(void) const {
   if (config_.has_meta_config() && !config_.meta_config().meta_uri().empty()) {
     return config_.meta_config().meta_uri();
@@ -288,5 +477,17 @@ uint32_t Config::get_query_thread_count(void) const {
   return thread_count;
 }
 
+bool Config::get_query_numa_aware(void) const {
+  return config_.has_query_config() && config_.query_config().numa_aware();
+}
+
+uint32_t Config::get_query_numa_simulated_node_count(void) const {
+  uint32_t node_count = 0U;
+  if (config_.has_query_config()) {
+    node_count = config_.query_config().numa_simulated_node_count();
+  }
+  return node_count;
+}
+
 }  // namespace be
 }  // end namespace proxima
@@ -81,6 +81,58 @@ class Config : public ailego::Singleton<Config> {
   //! Get optimize internal seconds
   uint32_t get_index_optimize_internal(void) const;
 
+  //! Check if index service serves as read only follower
+  bool get_index_read_only(void) const;
+
+  //! Get refresh internal seconds of read only follower
+  uint32_t get_index_refresh_internal(void) const;
+
+  //! Check if index memory backed by transparent huge pages
+  bool get_index_huge_page(void) const;
+
+  //! Get load mode of persist segments
+  std::string get_index_segment_load_mode(void) const;
+
+  //! Check if forwards of persist segments kept on disk
+  bool get_index_forward_on_disk(void) const;
+
+  //! Get io thread count of forward fetching
+  uint32_t get_index_forward_fetch_thread_count(void) const;
+
+  //! Get cache size of fetched forwards in MB
+  uint32_t get_index_forward_cache_size(void) const;
+
+  //! Get compression of persist forward blocks
+  std::string get_index_forward_compression(void) const;
+
+  //! Get raw size of compressed forward block in KB
+  uint32_t get_index_forward_block_size(void) const;
+
+  //! Get cache size of decompressed forward blocks in MB
+  uint32_t get_index_forward_block_cache_size(void) const;
+
+  //! Get sampled write trace events per second
+  uint32_t get_index_write_trace_sample_rate(void) const;
+
+  //! Check if direct writes are acked after a shared sync
+  bool get_index_group_commit(void) const;
+
+  //! Get microseconds to gather writes of a group commit
+  uint32_t get_index_group_commit_window(void) const;
+
+  //! Get MB per second of routine flush, 0 means unlimited
+  uint32_t get_index_max_flush_speed(void) const;
+
+  //! Get percent of deleted documents in graphs of persist segment to
+  //! rebuild it, 0 means never
+  uint32_t get_index_rebuild_deleted_ratio(void) const;
+
+  //! Get percent of a cpu core rebuilding segments may use
+  uint32_t get_index_rebuild_cpu_ratio(void) const;
+
+  //! Get percent of recall a rebuilt graph must keep
+  uint32_t get_index_rebuild_min_recall(void) const;
+
   /** ============Meta Config============= **/
   std::string get_meta_uri(void) const;
 
@@ -88,6 +140,12 @@ class Config : public ailego::Singleton<Config> {
   //! Get query thread count
   uint32_t get_query_thread_count(void) const;
 
+  //! Check if query workers and segments are placed by numa nodes
+  bool get_query_numa_aware(void) const;
+
+  //! Get simulated numa node count, 0 means detecting real topology
+  uint32_t get_query_numa_simulated_node_count(void) const;
+
   //! Get metrics config
   const proto::MetricsConfig &metrics_config() const {
     return config_.common_config().metrics_config();
@@ -114,6 +114,8 @@ PROXIMA_BE_ERROR_CODE_DEFINE(SuspendedCollection, 4005,
 PROXIMA_BE_ERROR_CODE_DEFINE(LostSegment, 4006, "Lost Segment");
 PROXIMA_BE_ERROR_CODE_DEFINE(EmptyLsnContext, 4007, "Empty Lsn Context");
 PROXIMA_BE_ERROR_CODE_DEFINE(ExceedRateLimit, 4008, "Exceed Rate Limit");
+PROXIMA_BE_ERROR_CODE_DEFINE(ReadOnlyCollection, 4009,
+                             "Collection Is Read Only");
 
 // 5000~5999 [Query]
 PROXIMA_BE_ERROR_CODE_DEFINE(UnavailableSegment, 5000,
@@ -181,6 +181,7 @@ PROXIMA_BE_ERROR_CODE_DECLARE(SuspendedCollection);
 PROXIMA_BE_ERROR_CODE_DECLARE(LostSegment);
 PROXIMA_BE_ERROR_CODE_DECLARE(EmptyLsnContext);
 PROXIMA_BE_ERROR_CODE_DECLARE(ExceedRateLimit);
+PROXIMA_BE_ERROR_CODE_DECLARE(ReadOnlyCollection);
 
 // 5000~5999 [Query]
 PROXIMA_BE_ERROR_CODE_DECLARE(UnavailableSegment);
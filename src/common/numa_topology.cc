@@ -0,0 +1,147 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of numa topology
+ */
+
+#include "numa_topology.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <ailego/utility/string_helper.h>
+#include "error_code.h"
+#include "logger.h"
+
+namespace proxima {
+namespace be {
+
+int NumaTopology::init(uint32_t simulated_node_count) {
+  this->cleanup();
+
+  int ret = simulated_node_count > 0 ? this->simulate(simulated_node_count)
+                                     : this->detect();
+  if (ret != 0) {
+    this->cleanup();
+    return ret;
+  }
+
+  for (uint32_t i = 0; i < node_cpus_.size(); i++) {
+    LOG_INFO("Numa node initialized. node[%u] cpu_count[%zu] simulated[%d]",
+             i, node_cpus_[i].size(), simulated_);
+  }
+  return 0;
+}
+
+void NumaTopology::cleanup() {
+  node_cpus_.clear();
+  simulated_ = false;
+}
+
+int NumaTopology::bind_thread(uint32_t node) const {
+  if (!this->enabled()) {
+    return 0;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : this->cpus(node)) {
+    CPU_SET(cpu, &cpu_set);
+  }
+
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (ret != 0) {
+    LOG_ERROR("Bind thread to numa node failed. node[%u] ret[%d]", node, ret);
+    return ErrorCode_RuntimeError;
+  }
+  return 0;
+}
+
+int NumaTopology::detect() {
+  for (uint32_t node = 0;; node++) {
+    std::string path = ailego::StringHelper::Concat(
+        "/sys/devices/system/node/node", node, "/cpulist");
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      break;
+    }
+
+    std::string cpu_list;
+    std::getline(file, cpu_list);
+    std::vector<uint32_t> cpus;
+    if (!ParseCpuList(cpu_list, &cpus)) {
+      LOG_ERROR("Parse cpu list failed. path[%s] cpu_list[%s]", path.c_str(),
+                cpu_list.c_str());
+      return ErrorCode_RuntimeError;
+    }
+
+    // Memory only node has no cpu to run workers
+    if (!cpus.empty()) {
+      node_cpus_.emplace_back(std::move(cpus));
+    }
+  }
+
+  if (node_cpus_.empty()) {
+    LOG_ERROR("Detect numa topology failed, no node found.");
+    return ErrorCode_RuntimeError;
+  }
+  return 0;
+}
+
+int NumaTopology::simulate(uint32_t node_count) {
+  uint32_t cpu_count = std::max(std::thread::hardware_concurrency(), 1U);
+  node_cpus_.resize(node_count);
+
+  // Interleave cpus, nodes share cpus if there are more nodes than cpus
+  for (uint32_t i = 0; i < std::max(cpu_count, node_count); i++) {
+    node_cpus_[i % node_count].emplace_back(i % cpu_count);
+  }
+  simulated_ = true;
+  return 0;
+}
+
+bool NumaTopology::ParseCpuList(const std::string &cpu_list,
+                                std::vector<uint32_t> *cpus) {
+  // Format like "0-23,48-71"
+  std::vector<std::string> ranges;
+  ailego::StringHelper::Split<std::string>(cpu_list, ',', &ranges);
+  for (auto &range : ranges) {
+    if (range.empty()) {
+      continue;
+    }
+    std::vector<std::string> bounds;
+    ailego::StringHelper::Split<std::string>(range, '-', &bounds);
+    uint32_t first = std::strtoul(bounds[0].c_str(), nullptr, 10);
+    uint32_t last = bounds.size() > 1
+                        ? std::strtoul(bounds[1].c_str(), nullptr, 10)
+                        : first;
+    if (bounds.size() <= 2 && first <= last) {
+      for (uint32_t cpu = first; cpu <= last; cpu++) {
+        cpus->emplace_back(cpu);
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace be
+}  // end namespace proxima
@@ -0,0 +1,106 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    NUMA topology of host, used to place segments and query
+ *             workers on the same node
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace proxima {
+namespace be {
+
+/*
+ * NumaTopology describes the numa nodes and their cpus. Segments are
+ * partitioned across nodes by segment id, memory of a segment is first
+ * touched by a thread bound to the owning node, and knn tasks of the
+ * segment are routed to the query workers of that node.
+ * A simulated topology splits host cpus into several fake nodes, so the
+ * placement and routing logic can be tested on single node machines.
+ */
+class NumaTopology {
+ public:
+  //! Constructor
+  NumaTopology() = default;
+
+  //! Destructor
+  ~NumaTopology() = default;
+
+  //! Return global instance, disabled until initialized
+  static NumaTopology &Instance() {
+    static NumaTopology instance;
+    return instance;
+  }
+
+ public:
+  //! Detect topology from sysfs, or simulate simulated_node_count nodes
+  //! if it's not zero
+  int init(uint32_t simulated_node_count);
+
+  //! Disable numa awareness
+  void cleanup();
+
+  //! Bind current thread to cpus of node
+  int bind_thread(uint32_t node) const;
+
+ public:
+  //! Return if numa awareness enabled
+  bool enabled() const {
+    return !node_cpus_.empty();
+  }
+
+  //! Return if topology is simulated
+  bool simulated() const {
+    return simulated_;
+  }
+
+  //! Return node count
+  uint32_t node_count() const {
+    return static_cast<uint32_t>(node_cpus_.size());
+  }
+
+  //! Return cpus of node
+  const std::vector<uint32_t> &cpus(uint32_t node) const {
+    return node_cpus_[node % node_cpus_.size()];
+  }
+
+  //! Return owning node of a segment
+  uint32_t node_of(uint64_t segment_id) const {
+    return enabled() ? static_cast<uint32_t>(segment_id % node_cpus_.size())
+                     : 0U;
+  }
+
+ private:
+  int detect();
+
+  int simulate(uint32_t node_count);
+
+  static bool ParseCpuList(const std::string &cpu_list,
+                           std::vector<uint32_t> *cpus);
+
+ private:
+  std::vector<std::vector<uint32_t>> node_cpus_{};
+  bool simulated_{false};
+};
+
+
+}  // namespace be
+}  // end namespace proxima
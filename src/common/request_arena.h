@@ -0,0 +1,94 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Request scoped arena of protobuf messages
+ */
+
+#pragma once
+
+#include <google/protobuf/arena.h>
+
+namespace proxima {
+namespace be {
+
+/*
+ * RequestArena owns all protobuf messages of a request. Messages and
+ * their sub messages are carved out of a few large blocks, which are
+ * released in one shot when the arena destructs at the end of request.
+ */
+class RequestArena {
+ public:
+  //! Initial block bytes, enough for a small request
+  static constexpr size_t DEFAULT_START_BLOCK_SIZE = 8UL * 1024UL;
+
+  //! Max block bytes
+  static constexpr size_t DEFAULT_MAX_BLOCK_SIZE = 1024UL * 1024UL;
+
+  //! Constructor
+  RequestArena() : arena_(MakeOptions()) {}
+
+  //! Destructor
+  ~RequestArena() = default;
+
+  //! Disable copy and move
+  RequestArena(const RequestArena &) = delete;
+  RequestArena &operator=(const RequestArena &) = delete;
+
+ public:
+  //! Create a message owned by arena
+  template <typename T>
+  T *create_message() {
+    ++message_count_;
+    return google::protobuf::Arena::CreateMessage<T>(&arena_);
+  }
+
+  //! Retrieve the underlying protobuf arena
+  google::protobuf::Arena *arena() {
+    return &arena_;
+  }
+
+  //! Return bytes of blocks allocated from heap
+  uint64_t space_allocated() const {
+    return arena_.SpaceAllocated();
+  }
+
+  //! Return bytes handed out to messages
+  uint64_t space_used() const {
+    return arena_.SpaceUsed();
+  }
+
+  //! Return count of top level messages created
+  uint64_t message_count() const {
+    return message_count_;
+  }
+
+ private:
+  static google::protobuf::ArenaOptions MakeOptions() {
+    google::protobuf::ArenaOptions options;
+    options.start_block_size = DEFAULT_START_BLOCK_SIZE;
+    options.max_block_size = DEFAULT_MAX_BLOCK_SIZE;
+    return options;
+  }
+
+ private:
+  google::protobuf::Arena arena_;
+  uint64_t message_count_{0U};
+};
+
+
+}  // namespace be
+}  // end namespace proxima
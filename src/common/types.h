@@ -72,5 +72,24 @@ enum class DataTypes : uint32_t {
  */
 enum class QueryTypes : uint32_t { UNDEFINED = 0, KNN_QUERY, EQUAL_QUERY };
 
+/*
+ * Load modes of persist segments
+ * DEFAULT: follow load mode of index service
+ * MMAP: map segment files, pages are loaded from page cache on demand
+ * MMAP_LOCKED: map segment files, and lock their pages in memory
+ * HEAP: copy segment files into anonymous memory
+ */
+enum class LoadModes : uint32_t {
+  DEFAULT = 0,
+  MMAP = 1,
+  MMAP_LOCKED = 2,
+  HEAP = 3
+};
+
+/*
+ * Compression types of persist forward blocks
+ */
+enum class CompressionTypes : uint32_t { NONE = 0, SNAPPY = 1 };
+
 }  // namespace be
 }  // end namespace proxima
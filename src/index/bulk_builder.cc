@@ -0,0 +1,323 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of bulk builder
+ */
+
+#include "bulk_builder.h"
+#include "common/error_code.h"
+#include "file_helper.h"
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+BulkBuilderPtr BulkBuilder::Create(const std::string &collection_name,
+                                   const std::string &prefix_path,
+                                   meta::CollectionMetaPtr schema,
+                                   uint32_t concurrency,
+                                   ThreadPool *thread_pool) {
+  return std::make_shared<BulkBuilder>(collection_name, prefix_path, schema,
+                                       concurrency, thread_pool);
+}
+
+BulkBuilder::BulkBuilder(const std::string &coll_name,
+                         const std::string &path,
+                         meta::CollectionMetaPtr coll_meta, uint32_t concur,
+                         ThreadPool *pool)
+    : collection_name_(coll_name),
+      prefix_path_(path),
+      schema_(std::move(coll_meta)),
+      concurrency_(concur),
+      thread_pool_(pool) {}
+
+BulkBuilder::~BulkBuilder() {
+  if (opened_) {
+    this->finish();
+  }
+}
+
+int BulkBuilder::open() {
+  CHECK_STATUS(opened_, false);
+
+  dir_path_ = prefix_path_ + "/" + collection_name_;
+  if (FileHelper::DirectoryExists(dir_path_)) {
+    CLOG_ERROR("Index directory already exist, build failed. dir_path[%s]",
+               dir_path_.c_str());
+    return ErrorCode_DuplicateCollection;
+  }
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = VersionManager::CreateAndOpen(collection_name_, dir_path_,
+                                          read_options, &version_manager_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open version manager failed.");
+
+  ret =
+      IDMap::CreateAndOpen(collection_name_, dir_path_, read_options, &id_map_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open id map failed.");
+
+  ret = DeleteStore::CreateAndOpen(collection_name_, dir_path_, read_options,
+                                   &delete_store_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open delete store failed.");
+
+  ret = LsnStore::CreateAndOpen(collection_name_, dir_path_, read_options,
+                                &lsn_store_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open lsn store failed.");
+
+  // First shard takes the initial writing segment of manifest
+  std::vector<SegmentMeta> writing_segment_metas;
+  ret = version_manager_->get_segment_metas(SegmentState::WRITING,
+                                            &writing_segment_metas);
+  if (ret != 0 || writing_segment_metas.empty()) {
+    CLOG_ERROR("Get writing segment meta failed.");
+    return ErrorCode_RuntimeError;
+  }
+
+  ret = this->open_shard(writing_segment_metas[0], &building_shard_);
+  CHECK_RETURN(ret, 0);
+
+  building_group_ = thread_pool_->make_group();
+  timer_.reset();
+  opened_ = true;
+  CLOG_INFO("Opened bulk builder. dir_path[%s] max_docs_per_segment[%zu]",
+            dir_path_.c_str(), (size_t)schema_->max_docs_per_segment());
+  return 0;
+}
+
+int BulkBuilder::add(Record record) {
+  CHECK_STATUS(opened_, true);
+
+  int ret = index_error_.load();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Build index columns failed before.");
+
+  if (id_map_->has(record.primary_key)) {
+    CLOG_ERROR("Insert duplicate record. key[%zu]", (size_t)record.primary_key);
+    return ErrorCode_DuplicateKey;
+  }
+
+  // Forward and key mappings are written in input order by the caller
+  // thread, so doc ids of a shard are contiguous
+  ailego::ElapsedTime timer;
+  idx_t doc_id = INVALID_DOC_ID;
+  ret = building_shard_->insert_forward(std::move(record), &doc_id);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert forward failed. key[%zu]",
+                         (size_t)record.primary_key);
+
+  ret = id_map_->insert(record.primary_key, doc_id);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert into id map failed. key[%zu]",
+                         (size_t)record.primary_key);
+  stats_.forward_cost_us += timer.micro_seconds();
+  stats_.doc_count++;
+
+  last_lsn_ = record.lsn;
+  last_lsn_context_ = record.lsn_context;
+
+  // Index columns are built by thread pool in parallel, a task per batch
+  // of rows which are moved in without copying vectors
+  if (!pending_rows_) {
+    pending_rows_ = std::make_shared<RowBatch>();
+    pending_rows_->reserve(BATCH_ROWS);
+  }
+  pending_rows_->emplace_back(doc_id, std::move(record));
+  if (pending_rows_->size() >= BATCH_ROWS) {
+    this->submit_rows();
+  }
+
+  uint64_t max_docs_per_segment = schema_->max_docs_per_segment();
+  if (max_docs_per_segment > 0 &&
+      building_shard_->doc_count() >= max_docs_per_segment) {
+    ret = this->seal_shard();
+    CHECK_RETURN(ret, 0);
+  }
+  return 0;
+}
+
+int BulkBuilder::finish() {
+  CHECK_STATUS(opened_, true);
+
+  int ret = 0;
+  if (building_shard_->doc_count() > 0) {
+    ret = this->seal_shard();
+  }
+
+  // Sealed shards are published in order, the first error is kept
+  while (!sealed_shards_.empty()) {
+    int publish_ret = this->publish_shard();
+    if (ret == 0) {
+      ret = publish_ret;
+    }
+  }
+
+  // The empty shard left is the writing segment of collection
+  building_group_->wait_finish();
+  building_shard_->flush();
+  version_manager_->update_segment_meta(building_shard_->segment_meta());
+  building_shard_->close();
+  building_shard_.reset();
+
+  if (stats_.doc_count > 0) {
+    lsn_store_->append(last_lsn_, last_lsn_context_);
+  }
+
+  id_map_->flush();
+  delete_store_->flush();
+  lsn_store_->flush();
+  version_manager_->flush();
+
+  id_map_->close();
+  delete_store_->close();
+  lsn_store_->close();
+  version_manager_->close();
+
+  stats_.total_cost_us = timer_.micro_seconds();
+  opened_ = false;
+  CLOG_INFO(
+      "Finished bulk build. ret[%d] doc_count[%zu] segment_count[%zu] "
+      "forward_cost[%zums] index_cost[%zums] dump_cost[%zums] "
+      "total_cost[%zums] qps[%.1f]",
+      ret, (size_t)stats_.doc_count, (size_t)stats_.segment_count,
+      (size_t)stats_.forward_cost_us / 1000,
+      (size_t)stats_.index_cost_us / 1000, (size_t)stats_.dump_cost_us / 1000,
+      (size_t)stats_.total_cost_us / 1000, stats_.docs_per_second());
+  return ret;
+}
+
+int BulkBuilder::open_shard(const SegmentMeta &segment_meta,
+                            MemorySegmentPtr *shard) {
+  SegmentMeta shard_meta = segment_meta;
+  shard_meta.state = SegmentState::WRITING;
+  int ret = version_manager_->update_segment_meta(shard_meta);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Update segment meta failed.");
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  ret = MemorySegment::CreateAndOpen(
+      collection_name_, dir_path_, shard_meta, schema_,
+      delete_store_.get(), id_map_.get(), concurrency_, read_options, shard);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open shard failed. segment_id[%zu]",
+                         (size_t)shard_meta.segment_id);
+
+  shard_timer_.reset();
+  return 0;
+}
+
+void BulkBuilder::submit_rows() {
+  if (!pending_rows_ || pending_rows_->empty()) {
+    return;
+  }
+  building_group_->submit(ailego::Closure::New(
+      this, &BulkBuilder::do_insert_columns, building_shard_.get(),
+      std::move(pending_rows_)));
+  pending_rows_.reset();
+}
+
+int BulkBuilder::seal_shard() {
+  this->submit_rows();
+
+  // Oldest shard is published before sealing another one
+  if (sealed_shards_.size() >= MAX_SEALED_SHARDS) {
+    int ret = this->publish_shard();
+    CHECK_RETURN(ret, 0);
+  }
+
+  SegmentMeta next_meta;
+  int ret = version_manager_->alloc_segment_meta(&next_meta);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Alloc segment meta failed.");
+  next_meta.min_doc_id = building_shard_->segment_meta().max_doc_id + 1;
+
+  // Columns of sealed shard are still building in its task group, while
+  // next shard starts building in a group of its own
+  std::unique_ptr<SealedShard> sealed(new SealedShard);
+  sealed->shard = std::move(building_shard_);
+  TaskGroupPtr sealed_group = std::move(building_group_);
+  uint64_t building_us = shard_timer_.micro_seconds();
+  ret = this->open_shard(next_meta, &building_shard_);
+  CHECK_RETURN(ret, 0);
+  building_group_ = thread_pool_->make_group();
+
+  sealed->future =
+      std::async(std::launch::async, &BulkBuilder::build_shard, this,
+                 sealed.get(), std::move(sealed_group), building_us);
+  sealed_shards_.emplace_back(std::move(sealed));
+  return 0;
+}
+
+int BulkBuilder::build_shard(SealedShard *sealed, TaskGroupPtr group,
+                             uint64_t building_us) {
+  ailego::ElapsedTime timer;
+  group->wait_finish();
+  sealed->index_cost_us = building_us + timer.micro_seconds();
+
+  int ret = index_error_.load();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Build index columns failed.");
+
+  timer.reset();
+  ret = sealed->shard->dump();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Dump shard failed. segment_id[%zu]",
+                         (size_t)sealed->shard->segment_id());
+  sealed->dump_cost_us = timer.micro_seconds();
+  return 0;
+}
+
+int BulkBuilder::publish_shard() {
+  std::unique_ptr<SealedShard> sealed = std::move(sealed_shards_.front());
+  sealed_shards_.pop_front();
+  int ret = sealed->future.get();
+  stats_.index_cost_us += sealed->index_cost_us;
+  CHECK_RETURN(ret, 0);
+
+  // Published by the caller thread in sealing order, so manifest lists
+  // segments by doc id
+  MemorySegmentPtr &shard = sealed->shard;
+  SegmentID segment_id = shard->segment_id();
+  shard->update_state(SegmentState::PERSIST);
+  ret = version_manager_->update_segment_meta(shard->segment_meta());
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Update segment meta failed.");
+
+  VersionEdit edit;
+  edit.add_segments.emplace_back(segment_id);
+  ret = version_manager_->apply(edit);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Apply version edit failed.");
+
+  size_t doc_count = shard->doc_count();
+  shard->close_and_remove_files();
+  stats_.dump_cost_us += sealed->dump_cost_us;
+  stats_.segment_count++;
+
+  CLOG_INFO("Dumped shard. segment_id[%zu] doc_count[%zu] cost[%zums]",
+            (size_t)segment_id, doc_count,
+            (size_t)sealed->dump_cost_us / 1000);
+  return 0;
+}
+
+void BulkBuilder::do_insert_columns(MemorySegment *shard, RowBatchPtr rows) {
+  for (auto &row : *rows) {
+    int ret = shard->insert_columns(row.second, row.first);
+    if (ret != 0) {
+      index_error_ = ret;
+      return;
+    }
+  }
+}
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
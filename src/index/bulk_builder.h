@@ -0,0 +1,170 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Offline bulk builder which creates collection index files
+ *             directly, bypassing the online write path
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include "meta/meta.h"
+#include "segment/memory_segment.h"
+#include "delete_store.h"
+#include "id_map.h"
+#include "lsn_store.h"
+#include "version_manager.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+class BulkBuilder;
+using BulkBuilderPtr = std::shared_ptr<BulkBuilder>;
+
+/*
+ * Throughput metrics of a bulk build
+ */
+struct BulkBuildStats {
+  uint64_t doc_count{0U};
+  uint64_t segment_count{0U};
+  uint64_t forward_cost_us{0U};
+  uint64_t index_cost_us{0U};
+  uint64_t dump_cost_us{0U};
+  uint64_t total_cost_us{0U};
+
+  //! Return documents built per second
+  double docs_per_second() const {
+    return total_cost_us > 0 ? doc_count * 1000000.0 / total_cost_us : 0.0;
+  }
+};
+
+/*
+ * BulkBuilder creates a brand new collection directory offline. Input
+ * records are partitioned into segment-sized shards, forward data is
+ * written sequentially while index columns of a shard are built by the
+ * thread pool in parallel, a task per batch of rows. A full shard is
+ * sealed at once, it finishes building and is dumped as a persist segment
+ * in background while next shard is building. Sealed shards are published
+ * in order. The output contains segment files, id map and manifest, which
+ * can be opened by Collection directly.
+ */
+class BulkBuilder {
+ public:
+  PROXIMA_DISALLOW_COPY_AND_ASSIGN(BulkBuilder);
+
+  //! Constructor
+  BulkBuilder(const std::string &collection_name,
+              const std::string &prefix_path, meta::CollectionMetaPtr schema,
+              uint32_t concurrency, ThreadPool *thread_pool);
+
+  //! Destructor
+  ~BulkBuilder();
+
+  //! Create an instance
+  static BulkBuilderPtr Create(const std::string &collection_name,
+                               const std::string &prefix_path,
+                               meta::CollectionMetaPtr schema,
+                               uint32_t concurrency, ThreadPool *thread_pool);
+
+ public:
+  //! Create collection directory and stores
+  int open();
+
+  //! Add a record, records must be added by one thread
+  int add(Record record);
+
+  //! Dump remaining shard, flush and close stores
+  int finish();
+
+ public:
+  //! Return build stats
+  const BulkBuildStats &stats() const {
+    return stats_;
+  }
+
+  //! Return collection name
+  const std::string &collection_name() const {
+    return collection_name_;
+  }
+
+ private:
+  //! Rows whose index columns are built by one task
+  static constexpr size_t BATCH_ROWS = 256U;
+
+  //! Sealed shards building or dumping at the same time, it bounds
+  //! memory usage
+  static constexpr size_t MAX_SEALED_SHARDS = 2U;
+
+  using TaskGroupPtr = aitheta2::IndexThreads::TaskGroup::Pointer;
+  using RowBatch = std::vector<std::pair<idx_t, Record>>;
+  using RowBatchPtr = std::shared_ptr<RowBatch>;
+
+  //! Shard sealed, which is building or dumping in background
+  struct SealedShard {
+    MemorySegmentPtr shard{};
+    std::future<int> future{};
+    uint64_t index_cost_us{0U};
+    uint64_t dump_cost_us{0U};
+  };
+
+  int open_shard(const SegmentMeta &segment_meta, MemorySegmentPtr *shard);
+
+  void submit_rows();
+
+  int seal_shard();
+
+  int build_shard(SealedShard *sealed, TaskGroupPtr group,
+                  uint64_t building_us);
+
+  int publish_shard();
+
+  void do_insert_columns(MemorySegment *shard, RowBatchPtr rows);
+
+ private:
+  std::string collection_name_{};
+  std::string prefix_path_{};
+  std::string dir_path_{};
+  meta::CollectionMetaPtr schema_{};
+  uint32_t concurrency_{0U};
+  ThreadPool *thread_pool_{nullptr};
+
+  IDMapPtr id_map_{};
+  DeleteStorePtr delete_store_{};
+  LsnStorePtr lsn_store_{};
+  VersionManagerPtr version_manager_{};
+
+  MemorySegmentPtr building_shard_{};
+  TaskGroupPtr building_group_{};
+  RowBatchPtr pending_rows_{};
+  std::deque<std::unique_ptr<SealedShard>> sealed_shards_{};
+  std::atomic<int> index_error_{0};
+
+  uint64_t last_lsn_{0U};
+  std::string last_lsn_context_{};
+  ailego::ElapsedTime timer_{};
+  ailego::ElapsedTime shard_timer_{};
+  BulkBuildStats stats_{};
+  bool opened_{false};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -19,13 +19,18 @@
  */
 
 #include "collection.h"
+#include <algorithm>
 #include <chrono>
+#include <thread>
+#include <unordered_map>
 #include <ailego/container/heap.h>
 #include <ailego/utility/time_helper.h>
 #include "common/defer.h"
 #include "common/error_code.h"
 #include "common/logger.h"
+#include "common/numa_topology.h"
 #include "constants.h"
+#include "dirty_range_storage.h"
 #include "file_helper.h"
 #include "typedef.h"
 
@@ -61,7 +66,8 @@ Collection::Collection(const std::string &coll_name, const std::string &path,
       prefix_path_(path),
       schema_(std::move(coll_meta)),
       concurrency_(concur),
-      thread_pool_(pool) {}
+      thread_pool_(pool),
+      write_tracer_(coll_name) {}
 
 Collection::~Collection() {
   if (opened_) {
@@ -77,6 +83,11 @@ int Collection::open(const ReadOptions &read_options) {
       FileHelper::MakeFilePath(dir_path_, FileID::MANIFEST_FILE);
 
   // check index data
+  if (read_options.create_new && read_options.read_only) {
+    CLOG_ERROR("Can't create new collection in read only mode.");
+    return ErrorCode_InvalidArgument;
+  }
+
   if (read_options.create_new) {
     if (FileHelper::DirectoryExists(dir_path_)) {
       CLOG_ERROR("Index directory already exist, create failed. dir_path[%s]",
@@ -93,6 +104,8 @@ int Collection::open(const ReadOptions &read_options) {
     }
   }
 
+  read_options_ = read_options;
+  backfill_stopped_ = false;
   int ret = recover_from_snapshot(read_options);
   if (ret != 0) {
     CLOG_ERROR("Recover from snapshot failed.");
@@ -139,8 +152,24 @@ int Collection::close() {
     std::this_thread::sleep_for(std::chrono::seconds(1));
   }
 
-  // Close writing segment
-  writing_segment_->close();
+  // Wait until expire ended
+  while (is_expiring_) {
+    LOG_INFO("Collection is expiring segments, wait until expired...");
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+
+  // Wait until running backfills and rebuilds ended, queued ones quit
+  // at once
+  backfill_stopped_ = true;
+  while (this->backfill_count() > 0 || is_rebuilding_) {
+    LOG_INFO("Collection is backfilling columns, wait until ended...");
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+
+  // Close writing segment, read only collection has no memory segments
+  if (writing_segment_ != nullptr) {
+    writing_segment_->close();
+  }
 
   // maybe dumping segment process exist error
   // so we still close dumping segment safely
@@ -173,43 +202,99 @@ int Collection::close_and_cleanup() {
 int Collection::flush() {
   CHECK_STATUS(opened_, true);
 
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, flush failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
   CLOG_INFO("Start flushing collection.");
   ailego::ElapsedTime timer;
   is_flushing_ = true;
 
   Defer defer([this] { is_flushing_ = false; });
 
-  int ret = 0;
-  ret = writing_segment_->flush();
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush writing segment failed.");
+  // Wait for tokens before taking sync mutex, so group commits are never
+  // blocked by throttled routine flush
+  DirtyRangeStorage::Throttle(this->dirty_bytes());
 
-  ret = id_map_->flush();
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush id map failed.");
+  int ret = this->sync_stores();
+  if (ret != 0) {
+    return ret;
+  }
 
-  ret = delete_store_->flush();
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush delete store failed.");
+  CLOG_INFO("Ended flushing collection. cost[%zums]",
+            (size_t)timer.milli_seconds());
+  return 0;
+}
 
-  ret = lsn_store_->flush();
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush lsn store failed.");
+int Collection::commit(uint32_t commit_window_us) {
+  CHECK_STATUS(opened_, true);
 
-  version_manager_->update_segment_meta(writing_segment_->segment_meta());
-  ret = version_manager_->flush();
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush version manager failed.");
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, commit failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  // Batches written before are all counted in sequence already
+  uint64_t seq = written_seq_.load();
+
+  std::unique_lock<std::mutex> lock(commit_mutex_);
+  while (committed_seq_ < seq) {
+    if (committing_) {
+      // Follow the round in progress, which may not cover this waiter
+      uint64_t round = commit_round_;
+      commit_cond_.wait(lock, [&] { return commit_round_ != round; });
+      if (round_code_ != 0 && round_target_seq_ >= seq) {
+        return round_code_;
+      }
+      continue;
+    }
+
+    // Lead a round, waiters arriving within the window share its sync
+    committing_ = true;
+    lock.unlock();
+    if (commit_window_us > 0U) {
+      std::this_thread::sleep_for(std::chrono::microseconds(commit_window_us));
+    }
+    uint64_t target_seq = written_seq_.load();
+    int ret = this->sync_stores();
+    lock.lock();
+
+    committing_ = false;
+    commit_round_++;
+    round_target_seq_ = target_seq;
+    round_code_ = ret;
+    if (ret == 0 && target_seq > committed_seq_) {
+      committed_seq_ = target_seq;
+    }
+    commit_cond_.notify_all();
+    if (ret != 0) {
+      return ret;
+    }
+  }
 
-  CLOG_INFO("Ended flushing collection. cost[%zums]",
-            (size_t)timer.milli_seconds());
   return 0;
 }
 
 int Collection::dump() {
   CHECK_STATUS(opened_, true);
 
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, dump failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
   return this->drive_dump_segment();
 }
 
 int Collection::optimize(ThreadPoolPtr pool) {
   CHECK_STATUS(opened_, true);
 
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, optimize failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
   CLOG_INFO("Start optimizing collection.");
   ailego::ElapsedTime timer;
   is_optimizing_ = true;
@@ -224,92 +309,883 @@ int Collection::optimize(ThreadPoolPtr pool) {
   return 0;
 }
 
+int Collection::expire() {
+  CHECK_STATUS(opened_, true);
+
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, expire failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  uint64_t expire_timestamp = Segment::ExpireTimestamp(schema_->ttl_seconds());
+  if (expire_timestamp == 0U || is_expiring_.exchange(true)) {
+    return 0;
+  }
+
+  Defer defer([this] { is_expiring_ = false; });
+
+  // Schema lock keeps dump and attach from applying version edits
+  // meanwhile
+  std::lock_guard<std::mutex> schema_lock(schema_mutex_);
+
+  // Only whole persist segments are dropped here, documents in boundary
+  // segments are filtered at query time until their segment expires
+  std::vector<SegmentMeta> expired_metas;
+  for (auto &segment_meta : version_manager_->current_version()) {
+    if (Segment::IsExpired(segment_meta.max_timestamp, expire_timestamp)) {
+      expired_metas.emplace_back(segment_meta);
+    }
+  }
+  if (expired_metas.empty()) {
+    return 0;
+  }
+
+  ailego::ElapsedTime timer;
+  VersionEdit edit;
+  size_t purged_count = 0U;
+
+  // Writers are held, so a key upserted meanwhile never has its fresh
+  // mapping purged
+  int ret = 0;
+  {
+    write_mutex_.lock();
+    Defer write_defer([this] { write_mutex_.unlock(); });
+    for (auto &segment_meta : expired_metas) {
+      // Purge key mappings first, so that a crash before applying edit
+      // only leaves documents which are filtered by expiry anyway
+      size_t removed_count = 0U;
+      ret = id_map_->remove_range(segment_meta.min_doc_id,
+                                  segment_meta.max_doc_id, &removed_count);
+      CHECK_RETURN_WITH_CLOG(ret, 0, "Purge id map failed. segment_id[%zu]",
+                             (size_t)segment_meta.segment_id);
+      purged_count += removed_count;
+      edit.delete_segments.emplace_back(segment_meta.segment_id);
+    }
+
+    ret = version_manager_->apply(edit);
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Apply expire version edit failed.");
+  }
+
+  ret = version_manager_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush version manager failed.");
+
+  // Searching requests may still hold the segments, mapped files
+  // keep valid until they released
+  for (auto &segment_meta : expired_metas) {
+    persist_segment_mgr_->remove_segment(segment_meta.segment_id);
+    std::vector<std::string> file_paths;
+    file_paths.emplace_back(FileHelper::MakeFilePath(
+        dir_path_, FileID::SEGMENT_FILE, segment_meta.segment_id));
+    ColumnBackfill::ListFiles(dir_path_, segment_meta.segment_id, *schema_,
+                              &file_paths);
+    for (auto &file_path : file_paths) {
+      FileHelper::RemoveFile(file_path);
+    }
+  }
+
+  CLOG_INFO(
+      "Expired segments success. segment_count[%zu] purged_key_count[%zu] "
+      "expire_timestamp[%zu] cost[%zums]",
+      expired_metas.size(), purged_count, (size_t)expire_timestamp,
+      (size_t)timer.milli_seconds());
+  return 0;
+}
+
+int Collection::attach_segments(const std::string &source_path,
+                                size_t *segment_count) {
+  CHECK_STATUS(opened_, true);
+
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, attach failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  // Hold schema lock, so attached segments are validated with the schema
+  // they serve with
+  std::lock_guard<std::mutex> lock(schema_mutex_);
+  if (is_dumping_.exchange(true)) {
+    CLOG_ERROR("Can't attach segments while dumping segment.");
+    return ErrorCode_StatusError;
+  }
+
+  // Released by dumping process once writing segment switched
+  bool switched = false;
+  Defer defer([this, &switched] {
+    if (!switched) {
+      is_dumping_ = false;
+    }
+  });
+
+  ailego::ElapsedTime timer;
+  if (!FileHelper::FileExists(
+          FileHelper::MakeFilePath(source_path, FileID::MANIFEST_FILE))) {
+    CLOG_ERROR("Manifest not exist in source directory. source_path[%s]",
+               source_path.c_str());
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  ReadOptions source_options;
+  source_options.use_mmap = true;
+  source_options.create_new = false;
+
+  // Stores of source are only read, never touch its files
+  ReadOptions source_store_options = source_options;
+  source_store_options.read_only = true;
+  VersionManagerPtr source_version_manager;
+  int ret = VersionManager::CreateAndOpen(collection_name_, source_path,
+                                          source_store_options,
+                                          &source_version_manager);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Open source version manager failed.");
+
+  IDMapPtr source_id_map;
+  ret = IDMap::CreateAndOpen(collection_name_, source_path,
+                             source_store_options, &source_id_map);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Open source id map failed.");
+
+  DeleteStorePtr source_delete_store;
+  ret = DeleteStore::CreateAndOpen(collection_name_, source_path,
+                                   source_store_options, &source_delete_store);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Open source delete store failed.");
+
+  std::vector<SegmentMeta> source_metas =
+      source_version_manager->current_version();
+  *segment_count = source_metas.size();
+  if (source_metas.empty()) {
+    CLOG_WARN("No persist segment in source directory. source_path[%s]",
+              source_path.c_str());
+    return 0;
+  }
+
+  // Attached documents take a doc id range right behind writing segment,
+  // and later writes continue behind the attached range
+  std::sort(source_metas.begin(), source_metas.end(),
+            [](const SegmentMeta &a, const SegmentMeta &b) {
+              return a.min_doc_id < b.min_doc_id;
+            });
+  idx_t source_min_doc_id = source_metas[0].min_doc_id;
+  idx_t source_max_doc_id = source_min_doc_id;
+  for (auto &source_meta : source_metas) {
+    source_max_doc_id =
+        std::max<idx_t>(source_max_doc_id, source_meta.max_doc_id);
+  }
+
+  // Reserve the range before linking segments, so that concurrent writes
+  // never run into it. A failed attach only leaves a gap of doc ids.
+  idx_t base_doc_id = 0U;
+  idx_t attached_max_doc_id = 0U;
+  {
+    write_mutex_.lock();
+    Defer write_defer([this] { write_mutex_.unlock(); });
+
+    base_doc_id =
+        writing_segment_->segment_meta().max_doc_id + DOC_ID_INCREASE_COUNT;
+    attached_max_doc_id = base_doc_id + (source_max_doc_id - source_min_doc_id);
+
+    // Switch writing segment behind attached range, old writing segment
+    // starts dumping
+    ret = this->switch_writing_segment(attached_max_doc_id +
+                                       DOC_ID_INCREASE_COUNT);
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Reserve attached doc id range failed.");
+    switched = true;
+  }
+  int64_t doc_id_delta = (int64_t)(base_doc_id - source_min_doc_id);
+
+  std::vector<PersistSegmentPtr> attached_segments;
+  std::vector<SegmentMeta> attached_metas;
+  auto rollback = [this, &attached_segments, &attached_metas] {
+    attached_segments.clear();
+    for (auto &segment_meta : attached_metas) {
+      FileHelper::RemoveFile(FileHelper::MakeFilePath(
+          dir_path_, FileID::SEGMENT_FILE, segment_meta.segment_id));
+      segment_meta.state = SegmentState::CREATED;
+      version_manager_->update_segment_meta(segment_meta);
+    }
+  };
+
+  for (auto &source_meta : source_metas) {
+    SegmentMeta segment_meta;
+    ret = version_manager_->alloc_segment_meta(&segment_meta);
+    if (ret != 0) {
+      CLOG_ERROR("Alloc segment meta failed.");
+      rollback();
+      return ret;
+    }
+
+    SegmentID segment_id = segment_meta.segment_id;
+    segment_meta = source_meta;
+    segment_meta.segment_id = segment_id;
+    segment_meta.state = SegmentState::PERSIST;
+    segment_meta.min_doc_id = source_meta.min_doc_id + doc_id_delta;
+    segment_meta.max_doc_id = source_meta.max_doc_id + doc_id_delta;
+    segment_meta.set_doc_id_delta(source_meta.doc_id_delta() + doc_id_delta);
+
+    // Occupy the segment meta before allocating next one
+    version_manager_->update_segment_meta(segment_meta);
+    attached_metas.emplace_back(segment_meta);
+
+    std::string src_file = FileHelper::MakeFilePath(
+        source_path, FileID::SEGMENT_FILE, source_meta.segment_id);
+    std::string dst_file =
+        FileHelper::MakeFilePath(dir_path_, FileID::SEGMENT_FILE, segment_id);
+    FileHelper::RemoveFile(dst_file);
+    if (!FileHelper::LinkFile(src_file, dst_file) &&
+        !FileHelper::CopyFile(src_file, dst_file)) {
+      CLOG_ERROR("Link segment file failed. src[%s] dst[%s]", src_file.c_str(),
+                 dst_file.c_str());
+      rollback();
+      return ErrorCode_OpenFile;
+    }
+
+    // Loading validates columns of segment with schema
+    PersistSegmentPtr persist_segment;
+    ret = this->load_persist_segment(segment_meta, source_options,
+                                     &persist_segment);
+    if (ret != 0) {
+      CLOG_ERROR("Validate source segment failed. source_segment_id[%zu]",
+                 (size_t)source_meta.segment_id);
+      rollback();
+      return ret;
+    }
+    if (!persist_segment->pending_columns().empty()) {
+      CLOG_ERROR(
+          "Source segment misses index columns of schema. "
+          "source_segment_id[%zu]",
+          (size_t)source_meta.segment_id);
+      rollback();
+      return ErrorCode_MismatchedSchema;
+    }
+    attached_segments.emplace_back(persist_segment);
+  }
+
+  size_t merged_count = 0U;
+  size_t shadowed_count = 0U;
+  {
+    // Writers are held until attached segments are published, so writes
+    // of overlapping keys never interleave with the merge
+    write_mutex_.lock();
+    Defer write_defer([this] { write_mutex_.unlock(); });
+
+    // Documents deleted in source stay deleted
+    if (source_delete_store->count() > 0) {
+      for (size_t i = 0; i < source_metas.size(); i++) {
+        size_t deleted_count = 0U;
+        for (idx_t doc_id = source_metas[i].min_doc_id;
+             doc_id <= source_metas[i].max_doc_id; doc_id++) {
+          if (source_delete_store->has(doc_id)) {
+            delete_store_->insert(doc_id + doc_id_delta);
+            deleted_count++;
+          }
+        }
+        attached_segments[i]->add_deleted_count(deleted_count);
+      }
+    }
+
+    // Merge key mappings before publishing, so readers switch from live
+    // documents to attached ones in one step. Attached doc ids sort above
+    // writing segment, so attached documents always win over live ones.
+    ret = source_id_map->for_each([&](uint64_t key, idx_t source_doc_id) {
+      // Skip documents in source memory segments, which are not attached
+      auto it = std::upper_bound(
+          source_metas.begin(), source_metas.end(), source_doc_id,
+          [](idx_t val, const SegmentMeta &meta) {
+            return val < meta.min_doc_id;
+          });
+      if (it == source_metas.begin() || source_doc_id > (it - 1)->max_doc_id) {
+        return;
+      }
+
+      idx_t doc_id = source_doc_id + doc_id_delta;
+      idx_t current_doc_id = id_map_->get_mapping_id(key);
+      if (current_doc_id != INVALID_DOC_ID) {
+        delete_store_->insert(current_doc_id);
+        this->count_deleted(current_doc_id);
+        id_map_->remove(key);
+        shadowed_count++;
+      }
+      id_map_->insert(key, doc_id);
+      merged_count++;
+    });
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Merge source id map failed.");
+
+    // Publish attached segments in one version edit. Current version in
+    // memory takes the edit even if persisting it fails, so key mappings
+    // merged are kept, and it is persisted by next edit.
+    VersionEdit edit;
+    for (size_t i = 0; i < attached_segments.size(); i++) {
+      persist_segment_mgr_->add_segment(attached_segments[i]);
+      edit.add_segments.emplace_back(attached_metas[i].segment_id);
+    }
+    ret = version_manager_->apply(edit);
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Apply attach version edit failed.");
+  }
+
+  ret = id_map_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush id map failed.");
+
+  ret = delete_store_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush delete store failed.");
+
+  ret = version_manager_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush version manager failed.");
+
+  source_id_map->close();
+  source_delete_store->close();
+  source_version_manager->close();
+
+  CLOG_INFO(
+      "Attach segments success. source_path[%s] segment_count[%zu] "
+      "doc_id_range[%zu, %zu] merged_key_count[%zu] shadowed_key_count[%zu] "
+      "cost[%zums]",
+      source_path.c_str(), attached_metas.size(), (size_t)base_doc_id,
+      (size_t)attached_max_doc_id, merged_count, shadowed_count,
+      (size_t)timer.milli_seconds());
+  return 0;
+}
+
+int Collection::checkpoint(const std::string &checkpoint_path,
+                           uint64_t *lsn) {
+  CHECK_STATUS(opened_, true);
+
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, checkpoint failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  std::string target_path = checkpoint_path + "/" + collection_name_;
+  if (FileHelper::DirectoryExists(target_path)) {
+    CLOG_ERROR("Checkpoint directory already exists. path[%s]",
+               target_path.c_str());
+    return ErrorCode_InvalidArgument;
+  }
+
+  // Hold dumping and expiring flags, so that segment files and manifest
+  // stay unchanged until checkpoint finished
+  while (is_dumping_.exchange(true)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  Defer dumping_defer([this] { is_dumping_ = false; });
+  while (is_expiring_.exchange(true)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  Defer expiring_defer([this] { is_expiring_ = false; });
+
+  // Hold schema lock, so backfilled columns are not published meanwhile
+  std::lock_guard<std::mutex> schema_lock(schema_mutex_);
+
+  // Block writers, so all mutable stores are flushed at the same lsn
+  write_mutex_.lock();
+  Defer write_defer([this] { write_mutex_.unlock(); });
+
+  ailego::ElapsedTime timer;
+  int ret = this->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush collection failed.");
+
+  std::string lsn_context;
+  ret = lsn_store_->get_latest_lsn(lsn, &lsn_context);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Get latest lsn failed.");
+
+  if (!FileHelper::CreateDirectory(target_path)) {
+    CLOG_ERROR("Create checkpoint directory failed. path[%s]",
+               target_path.c_str());
+    return ErrorCode_WriteData;
+  }
+
+  bool succeeded = false;
+  Defer cleanup_defer([&target_path, &succeeded] {
+    if (!succeeded) {
+      FileHelper::RemoveDirectory(target_path);
+    }
+  });
+
+  auto make_target = [&target_path](const std::string &file_path) {
+    return target_path + file_path.substr(file_path.rfind('/'));
+  };
+
+  // Persist segment files and backfilled columns are immutable, just
+  // link them
+  auto &segment_metas = version_manager_->current_version();
+  std::vector<std::string> segment_files;
+  for (auto &segment_meta : segment_metas) {
+    segment_files.emplace_back(FileHelper::MakeFilePath(
+        dir_path_, FileID::SEGMENT_FILE, segment_meta.segment_id));
+    ColumnBackfill::ListFiles(dir_path_, segment_meta.segment_id, *schema_,
+                              &segment_files);
+  }
+  for (auto &file_path : segment_files) {
+    std::string target_file = make_target(file_path);
+    if (!FileHelper::LinkFile(file_path, target_file) &&
+        !FileHelper::CopyFile(file_path, target_file)) {
+      CLOG_ERROR("Link segment file failed. file[%s]", file_path.c_str());
+      return ErrorCode_WriteData;
+    }
+  }
+
+  // Mutable stores and writing segment files are small, copy them
+  std::vector<std::string> mutable_files;
+  mutable_files.emplace_back(
+      FileHelper::MakeFilePath(dir_path_, FileID::ID_FILE));
+  mutable_files.emplace_back(
+      FileHelper::MakeFilePath(dir_path_, FileID::DELETE_FILE));
+  mutable_files.emplace_back(
+      FileHelper::MakeFilePath(dir_path_, FileID::LSN_FILE));
+  mutable_files.emplace_back(
+      FileHelper::MakeFilePath(dir_path_, FileID::MANIFEST_FILE));
+  writing_segment_->get_index_files(&mutable_files);
+  ColumnBackfill::ListFiles(dir_path_, writing_segment_->segment_id(),
+                            *schema_, &mutable_files);
+  for (auto &file_path : mutable_files) {
+    if (!FileHelper::CopyFile(file_path, make_target(file_path))) {
+      CLOG_ERROR("Copy file failed. file[%s]", file_path.c_str());
+      return ErrorCode_WriteData;
+    }
+  }
+
+  succeeded = true;
+  CLOG_INFO(
+      "Checkpoint collection success. path[%s] lsn[%zu] "
+      "linked_file_count[%zu] copied_file_count[%zu] cost[%zums]",
+      target_path.c_str(), (size_t)*lsn, segment_files.size(),
+      mutable_files.size(), (size_t)timer.milli_seconds());
+  return 0;
+}
+
+int Collection::refresh() {
+  CHECK_STATUS(opened_, true);
+
+  if (!read_options_.read_only) {
+    return 0;
+  }
+
+  ailego::ElapsedTime timer;
+  int ret = version_manager_->reload(read_options_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Reload version manager failed.");
+
+  // Map in new segments before syncing deletions and key mappings, so
+  // that updated documents never disappear from queries
+  std::vector<SegmentMeta> segment_metas = version_manager_->current_version();
+  size_t added_count = 0U;
+  for (auto &segment_meta : segment_metas) {
+    if (persist_segment_mgr_->has_segment(segment_meta.segment_id)) {
+      continue;
+    }
+    PersistSegmentPtr persist_segment;
+    ReadOptions load_options = this->persist_read_options();
+    ret = this->load_persist_segment(segment_meta, load_options,
+                                     &persist_segment);
+    CHECK_RETURN(ret, 0);
+    persist_segment_mgr_->add_segment(persist_segment);
+    added_count++;
+  }
+
+  ret = delete_store_->reload(read_options_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Reload delete store failed.");
+
+  ret = id_map_->reload(read_options_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Reload id map failed.");
+
+  // Segments dropped by writer are unloaded after last reference released
+  std::vector<SegmentID> loaded_segment_ids;
+  persist_segment_mgr_->get_segment_ids(&loaded_segment_ids);
+  size_t removed_count = 0U;
+  for (auto segment_id : loaded_segment_ids) {
+    auto it = std::find_if(segment_metas.begin(), segment_metas.end(),
+                           [segment_id](const SegmentMeta &segment_meta) {
+                             return segment_meta.segment_id == segment_id;
+                           });
+    if (it == segment_metas.end()) {
+      persist_segment_mgr_->remove_segment(segment_id);
+      removed_count++;
+    }
+  }
+
+  if (added_count > 0 || removed_count > 0) {
+    CLOG_INFO(
+        "Refresh collection success. added_segment_count[%zu] "
+        "removed_segment_count[%zu] cost[%zums]",
+        added_count, removed_count, (size_t)timer.milli_seconds());
+  }
+  return 0;
+}
+
+size_t Collection::dirty_bytes() const {
+  return id_map_->dirty_bytes() + delete_store_->dirty_bytes() +
+         lsn_store_->dirty_bytes() + version_manager_->dirty_bytes();
+}
+
+int Collection::sync_stores() {
+  // Routine flush and group commit may sync at the same time
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+
+  // Batches counted in sequence are all written before the flush
+  uint64_t seq = written_seq_.load();
+  int ret = writing_segment_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush writing segment failed.");
+
+  // Records of the segment being dumped are not persisted until the dump
+  // ends, so they must be synced before acknowledged as well
+  if (dumping_segment_ != nullptr &&
+      dumping_segment_->state() == SegmentState::DUMPING) {
+    ret = dumping_segment_->flush();
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Flush dumping segment failed.");
+  }
+
+  ret = id_map_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush id map failed.");
+
+  ret = delete_store_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush delete store failed.");
+
+  ret = lsn_store_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush lsn store failed.");
+
+  version_manager_->update_segment_meta(writing_segment_->segment_meta());
+  ret = version_manager_->flush();
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Flush version manager failed.");
+
+  synced_seq_ = seq;
+  return 0;
+}
+
 int Collection::remove_files() {
   return FileHelper::RemoveDirectory(dir_path_);
 }
 
 int Collection::write_records(const CollectionDataset &records) {
+  return this->write_records(records, nullptr);
+}
+
+int Collection::write_records(const CollectionDataset &records,
+                              WriteSummary *summary) {
   CHECK_STATUS(opened_, true);
 
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, write failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  // Shared with other writers, exclusive with checkpoint
+  write_mutex_.lock_shared();
+  Defer defer([this] { write_mutex_.unlock_shared(); });
+
   ailego::ElapsedTime timer;
   int ret = 0;
+
+  // Operations of a key are folded to the net effect first
+  std::vector<FoldedRecord> folded_records;
+  std::vector<const Record *> folded_lsns;
+  size_t folded_count = 0U;
+  int error_code =
+      this->fold_records(records, &folded_records, &folded_lsns, &folded_count);
+  WriteSummary batch_summary;
+  batch_summary.row_count = records.size();
+  batch_summary.folded_count = folded_count;
+
+  // Consecutive inserts or deletes are handled as one batch, inserts never
+  // grow beyond room left in writing segment
+  std::vector<const Record *> batch;
+  OperationTypes batch_type = OperationTypes::UNDEFINED;
+  uint64_t max_docs_per_segment = schema_->max_docs_per_segment();
+  auto flush_batch = [&]() {
+    if (batch.empty()) {
+      return;
+    }
+    if (batch_type == OperationTypes::INSERT) {
+      ret = this->insert_records(batch, &batch_summary);
+    } else {
+      ret = this->delete_records(batch, &batch_summary);
+    }
+    if (ret != 0) {
+      error_code = ret;
+    }
+    batch.clear();
+  };
+
+  for (auto &it : folded_records) {
+    auto &record = *it.record;
+    if (it.operation_type == OperationTypes::INSERT ||
+        it.operation_type == OperationTypes::DELETE) {
+      if (it.operation_type != batch_type) {
+        flush_batch();
+      }
+      batch_type = it.operation_type;
+      batch.emplace_back(&record);
+      if (batch_type == OperationTypes::INSERT && max_docs_per_segment > 0 &&
+          writing_segment_->doc_count() + batch.size() >=
+              max_docs_per_segment) {
+        flush_batch();
+      }
+      continue;
+    }
+    flush_batch();
+
+    ret = update_record(record);
+    if (ret != 0) {
+      error_code = ret;
+      CLOG_ERROR("Update record failed. key[%zu] lsn[%zu] rt[%zuus]",
+                 (size_t)record.primary_key, (size_t)record.lsn,
+                 (size_t)timer.micro_seconds());
+    } else {
+      batch_summary.update_count++;
+    }
+    write_tracer_.trace("update", record, ret, timer.micro_seconds());
+  }
+  flush_batch();
+
+  // Lsns of folded rows are still recorded, latest lsn is found by
+  // continuity of stored lsns
+  if (!folded_lsns.empty()) {
+    std::vector<uint64_t> lsns;
+    std::vector<const std::string *> lsn_contexts;
+    lsns.reserve(folded_lsns.size());
+    lsn_contexts.reserve(folded_lsns.size());
+    for (auto *record : folded_lsns) {
+      lsns.emplace_back(record->lsn);
+      lsn_contexts.emplace_back(&record->lsn_context);
+    }
+    ret = lsn_store_->append(lsns, lsn_contexts);
+    if (ret != 0) {
+      CLOG_WARN("Lsn store append failed. count[%zu]", lsns.size());
+    }
+  }
+
+  batch_summary.failed_count =
+      batch_summary.row_count - batch_summary.folded_count -
+      batch_summary.insert_count - batch_summary.update_count -
+      batch_summary.delete_count;
+  batch_summary.cost_us = timer.micro_seconds();
+  write_tracer_.trace_summary(batch_summary);
+
+  // Commits read sequence after this are sure to cover the batch
+  written_seq_.fetch_add(1U);
+  if (summary) {
+    *summary = batch_summary;
+  }
+
+  return error_code;
+}
+
+int Collection::fold_records(const CollectionDataset &records,
+                             std::vector<FoldedRecord> *folded_records,
+                             std::vector<const Record *> *folded_lsns,
+                             size_t *folded_count) {
+  // State of a key while operations of batch are applied in order
+  struct KeyState {
+    bool existed{false};
+    bool exists{false};
+    bool stored_lsn_loaded{false};
+    uint64_t stored_lsn{0U};
+    const Record *content{nullptr};
+    const Record *last_record{nullptr};
+    size_t last_pos{0U};
+  };
+
   int error_code = 0;
+  size_t applied_count = 0U;
+  std::unordered_map<uint64_t, KeyState> states;
+  states.reserve(records.size());
   for (size_t i = 0; i < records.size(); i++) {
     auto &record = records.get(i);
     uint64_t primary_key = record.primary_key;
-    uint64_t lsn = record.lsn;
+    auto it = states.find(primary_key);
+    if (it == states.end()) {
+      it = states.emplace(primary_key, KeyState()).first;
+      it->second.existed = this->has_record(primary_key);
+      it->second.exists = it->second.existed;
+    }
+    auto &state = it->second;
 
+    int ret = 0;
     switch (record.operation_type) {
       case OperationTypes::INSERT:
-        ret = insert_record(record);
-        if (ret != 0) {
-          error_code = ret;
-          CLOG_ERROR("Insert record failed. key[%zu] lsn[%zu] rt[%zuus]",
-                     (size_t)primary_key, (size_t)lsn,
-                     (size_t)timer.micro_seconds());
-        } else {
-          CLOG_INFO("Insert record success. key[%zu] lsn[%zu] rt[%zuus]",
-                    (size_t)primary_key, (size_t)lsn,
-                    (size_t)timer.micro_seconds());
+        if (state.exists) {
+          CLOG_ERROR("Insert duplicate record. key[%zu]", (size_t)primary_key);
+          ret = ErrorCode_DuplicateKey;
         }
         break;
       case OperationTypes::UPDATE:
-        ret = update_record(record);
-        if (ret != 0) {
-          error_code = ret;
-          CLOG_ERROR("Update record failed. key[%zu] lsn[%zu] rt[%zuus]",
-                     (size_t)primary_key, (size_t)lsn,
-                     (size_t)timer.micro_seconds());
-        } else {
-          CLOG_INFO("Update record success. key[%zu] lsn[%zu] rt[%zuus]",
-                    (size_t)primary_key, (size_t)lsn,
-                    (size_t)timer.micro_seconds());
+        if (!state.exists) {
+          CLOG_ERROR("Record not exist in collection. key[%zu]",
+                     (size_t)primary_key);
+          ret = ErrorCode_InexistentKey;
+          break;
+        }
+        if (!record.lsn_check) {
+          break;
+        }
+        if (!state.content && !state.stored_lsn_loaded) {
+          ret = this->search_lsn(primary_key, &state.stored_lsn);
+          if (ret != 0) {
+            break;
+          }
+          state.stored_lsn_loaded = true;
+        }
+        {
+          uint64_t last_lsn =
+              state.content ? state.content->lsn : state.stored_lsn;
+          if (record.lsn <= last_lsn) {
+            CLOG_ERROR("Invalid record lsn. key[%zu] lsn[%zu] last_lsn[%zu]",
+                       (size_t)primary_key, (size_t)record.lsn,
+                       (size_t)last_lsn);
+            ret = ErrorCode_InvalidRecord;
+          }
         }
         break;
       case OperationTypes::DELETE:
-        ret = delete_record(primary_key);
-        if (ret != 0) {
-          error_code = ret;
-          CLOG_ERROR("Delete record failed. key[%zu] lsn[%zu] rt[%zuus]",
-                     (size_t)primary_key, (size_t)lsn,
-                     (size_t)timer.micro_seconds());
-        } else {
-          CLOG_INFO("Delete record success. key[%zu] lsn[%zu] rt[%zuus]",
-                    (size_t)primary_key, (size_t)lsn,
-                    (size_t)timer.micro_seconds());
+        if (!state.exists) {
+          CLOG_ERROR("Record not exist in colletion. key[%zu]",
+                     (size_t)primary_key);
+          ret = ErrorCode_InexistentKey;
         }
         break;
       default:
         CLOG_ERROR("Unknown operation type. type[%d]", record.operation_type);
+        continue;
+    }
+    if (ret != 0) {
+      error_code = ret;
+      continue;
     }
+
+    // Content of key written earlier in batch is superseded
+    if (state.content) {
+      folded_lsns->emplace_back(state.content);
+      write_tracer_.trace("fold", *state.content, 0, 0U);
+    }
+    if (record.operation_type == OperationTypes::DELETE) {
+      state.exists = false;
+      state.content = nullptr;
+    } else {
+      state.exists = true;
+      state.content = &record;
+    }
+    state.last_record = &record;
+    state.last_pos = i;
+    applied_count++;
   }
 
+  // Net effect of a key, in order of its last operation
+  folded_records->clear();
+  folded_records->reserve(states.size());
+  for (auto &it : states) {
+    auto &state = it.second;
+    if (!state.last_record) {
+      continue;
+    }
+    FoldedRecord folded;
+    folded.position = state.last_pos;
+    if (state.existed && !state.exists) {
+      folded.record = state.last_record;
+      folded.operation_type = OperationTypes::DELETE;
+    } else if (state.content) {
+      folded.record = state.content;
+      folded.operation_type = state.existed ? OperationTypes::UPDATE
+                                            : OperationTypes::INSERT;
+    } else {
+      continue;
+    }
+    folded_records->emplace_back(folded);
+  }
+  std::sort(folded_records->begin(), folded_records->end(),
+            [](const FoldedRecord &lhs, const FoldedRecord &rhs) {
+              return lhs.position < rhs.position;
+            });
+  *folded_count = applied_count - folded_records->size();
   return error_code;
 }
 
 int Collection::insert_record(const Record &record) {
-  // 1. check if record already exists
-  if (this->has_record(record.primary_key)) {
-    CLOG_ERROR("Insert duplicate record. key[%zu]", (size_t)record.primary_key);
-    return ErrorCode_DuplicateKey;
+  WriteSummary summary;
+  return this->insert_records({&record}, &summary);
+}
+
+int Collection::insert_records(const std::vector<const Record *> &records,
+                               WriteSummary *summary) {
+  ailego::ElapsedTime timer;
+  int error_code = 0;
+  MemorySegmentPtr segment = writing_segment_;
+
+  // 1. check if records already exist, and insert forwards in order
+  std::vector<const Record *> rows;
+  std::vector<idx_t> doc_ids;
+  rows.reserve(records.size());
+  doc_ids.reserve(records.size());
+  for (auto *record : records) {
+    if (this->has_record(record->primary_key)) {
+      CLOG_ERROR("Insert duplicate record. key[%zu]",
+                 (size_t)record->primary_key);
+      error_code = ErrorCode_DuplicateKey;
+      continue;
+    }
+
+    idx_t doc_id = INVALID_DOC_ID;
+    int ret = segment->insert_forward(*record, &doc_id);
+    if (ret != 0) {
+      CLOG_ERROR("Insert into memory segment failed. key[%zu]",
+                 (size_t)record->primary_key);
+      error_code = ret;
+      continue;
+    }
+    rows.emplace_back(record);
+    doc_ids.emplace_back(doc_id);
   }
 
-  // 2. insert into memory segment
-  idx_t doc_id = INVALID_DOC_ID;
-  int ret = writing_segment_->insert(record, &doc_id);
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert into memory segment failed. key[%zu]",
-                         (size_t)record.primary_key);
+  // 2. insert index columns, each column is built in parallel
+  std::vector<int> codes;
+  std::vector<ColumnBuildStats> column_stats;
+  int ret = segment->insert_columns(rows, doc_ids, build_pool_, &codes,
+                                    &column_stats);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert columns into memory segment failed.");
+  this->update_column_stats(column_stats);
+
+  // 3. record key/doc_id mappings of indexed rows in id map at once
+  std::vector<uint64_t> keys;
+  std::vector<idx_t> indexed_ids;
+  std::vector<uint64_t> indexed_lsns;
+  std::vector<const Record *> indexed;
+  keys.reserve(rows.size());
+  indexed_ids.reserve(rows.size());
+  indexed_lsns.reserve(rows.size());
+  indexed.reserve(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (codes[i] != 0) {
+      CLOG_ERROR("Insert record failed. key[%zu] lsn[%zu] rt[%zuus]",
+                 (size_t)rows[i]->primary_key, (size_t)rows[i]->lsn,
+                 (size_t)timer.micro_seconds());
+      error_code = codes[i];
+      continue;
+    }
+    keys.emplace_back(rows[i]->primary_key);
+    indexed_ids.emplace_back(doc_ids[i]);
+    indexed_lsns.emplace_back(rows[i]->lsn);
+    indexed.emplace_back(rows[i]);
+  }
 
-  // 3. record key/doc_id mapping in id map
-  ret = id_map_->insert(record.primary_key, doc_id);
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert into id map failed. key[%zu]",
-                         (size_t)record.primary_key);
+  std::vector<int> map_codes;
+  ret = id_map_->insert(keys, indexed_ids, indexed_lsns, &map_codes);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert into id map failed.");
+
+  // 4. record lsns of mapped rows in lsn store at once
+  std::vector<uint64_t> lsns;
+  std::vector<const std::string *> lsn_contexts;
+  lsns.reserve(indexed.size());
+  lsn_contexts.reserve(indexed.size());
+  for (size_t i = 0; i < indexed.size(); i++) {
+    if (map_codes[i] != 0) {
+      CLOG_ERROR("Insert into id map failed. key[%zu]",
+                 (size_t)indexed[i]->primary_key);
+      error_code = map_codes[i];
+      continue;
+    }
+    lsns.emplace_back(indexed[i]->lsn);
+    lsn_contexts.emplace_back(&indexed[i]->lsn_context);
+    write_tracer_.trace("insert", *indexed[i], 0, timer.micro_seconds());
+  }
+  summary->insert_count += lsns.size();
 
-  // 4. record in lsn store
-  ret = lsn_store_->append(record.lsn, record.lsn_context);
+  ret = lsn_store_->append(lsns, lsn_contexts);
   if (ret != 0) {
     // do not need to terminate insert process
-    CLOG_WARN("Lsn store append failed. key[%zu]", (size_t)record.primary_key);
+    CLOG_WARN("Lsn store append failed. count[%zu]", lsns.size());
   }
 
   // try to drive dump writing segment
@@ -319,7 +1195,72 @@ int Collection::insert_record(const Record &record) {
     drive_dump_segment();
   }
 
-  return 0;
+  return error_code;
+}
+
+int Collection::delete_records(const std::vector<const Record *> &records,
+                               WriteSummary *summary) {
+  ailego::ElapsedTime timer;
+  int error_code = 0;
+
+  // 1. resolve doc ids of existing records
+  std::vector<const Record *> rows;
+  std::vector<idx_t> doc_ids;
+  rows.reserve(records.size());
+  doc_ids.reserve(records.size());
+  for (auto *record : records) {
+    uint64_t primary_key = record->primary_key;
+    if (!this->has_record(primary_key)) {
+      CLOG_ERROR("Delete record failed. key[%zu] lsn[%zu] rt[%zuus]",
+                 (size_t)primary_key, (size_t)record->lsn,
+                 (size_t)timer.micro_seconds());
+      error_code = ErrorCode_InexistentKey;
+      continue;
+    }
+
+    idx_t doc_id = id_map_->get_mapping_id(primary_key);
+    if (doc_id == INVALID_DOC_ID) {
+      CLOG_ERROR("Get mapping doc-id failed. key[%zu]", (size_t)primary_key);
+      error_code = ErrorCode_RuntimeError;
+      continue;
+    }
+    rows.emplace_back(record);
+    doc_ids.emplace_back(doc_id);
+  }
+
+  // 2. insert into delete map at once
+  int ret = delete_store_->insert(doc_ids);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Insert into delete map failed.");
+
+  // 3. remove mappings in id_map, and try to inplace remove in writing
+  // segment
+  MemorySegmentPtr segment = writing_segment_;
+  for (size_t i = 0; i < rows.size(); i++) {
+    id_map_->remove(rows[i]->primary_key);
+    if (segment->is_in_range(doc_ids[i])) {
+      ret = segment->remove(doc_ids[i]);
+      CHECK_RETURN_WITH_CLOG(ret, 0, "Remove from writing segment failed.");
+    } else {
+      this->count_deleted(doc_ids[i]);
+    }
+    summary->delete_count++;
+    write_tracer_.trace("delete", *rows[i], 0, timer.micro_seconds());
+  }
+
+  return error_code;
+}
+
+void Collection::update_column_stats(
+    const std::vector<ColumnBuildStats> &column_stats) {
+  std::lock_guard<std::mutex> lock(column_stats_mutex_);
+  for (auto &it : column_stats) {
+    auto &stats = column_build_stats_[it.column_name];
+    stats.column_name = it.column_name;
+    stats.insert_count += it.insert_count;
+    stats.total_build_us += it.total_build_us;
+    stats.max_batch_build_us =
+        std::max(stats.max_batch_build_us, it.max_batch_build_us);
+  }
 }
 
 int Collection::delete_record(uint64_t primary_key) {
@@ -347,41 +1288,33 @@ int Collection::delete_record(uint64_t primary_key) {
   if (writing_segment_->is_in_range(doc_id)) {
     ret = writing_segment_->remove(doc_id);
     CHECK_RETURN_WITH_CLOG(ret, 0, "Remove from writing segment failed.");
+  } else {
+    this->count_deleted(doc_id);
   }
   return 0;
 }
 
-int Collection::update_record(const Record &record) {
-  // 1. check if record exist
-  if (!this->has_record(record.primary_key)) {
-    CLOG_ERROR("Record not exist in collection. key[%zu]",
-               (size_t)record.primary_key);
-    return ErrorCode_InexistentKey;
-  }
-
-  // 2. check record lsn
-  int ret = 0;
-  if (record.lsn_check) {
-    Record old_record;
-    ret = this->search_record(record.primary_key, &old_record);
-    if (ret != 0 || old_record.primary_key == INVALID_KEY) {
-      CLOG_ERROR("Search record failed. key[%zu]", (size_t)record.primary_key);
-      return ret;
-    }
-
-    if (record.lsn <= old_record.lsn) {
-      CLOG_ERROR("Invalid record lsn. key[%zu] lsn[%zu] last_lsn[%zu]",
-                 (size_t)record.primary_key, (size_t)record.lsn,
-                 (size_t)old_record.lsn);
-      return ErrorCode_InvalidRecord;
+void Collection::count_deleted(idx_t doc_id) {
+  // Documents deleted in dumping segment are counted when it's loaded
+  auto &segment_metas = version_manager_->current_version();
+  for (auto it = segment_metas.crbegin(); it != segment_metas.crend(); ++it) {
+    if (doc_id >= it->min_doc_id && doc_id <= it->max_doc_id) {
+      if (persist_segment_mgr_->has_segment(it->segment_id)) {
+        persist_segment_mgr_->get_segment(it->segment_id)
+            ->add_deleted_count(1U);
+      }
+      return;
     }
   }
+}
 
-  // 3. delete old record
-  ret = this->delete_record(record.primary_key);
+int Collection::update_record(const Record &record) {
+  // Existence and lsn of record are checked while folding
+  // 1. delete old record
+  int ret = this->delete_record(record.primary_key);
   CHECK_RETURN(ret, 0);
 
-  // 4. insert new record
+  // 2. insert new record
   ret = this->insert_record(record);
 
   return ret;
@@ -391,6 +1324,23 @@ bool Collection::has_record(uint64_t primary_key) {
   return id_map_->has(primary_key);
 }
 
+int Collection::search_lsn(uint64_t primary_key, uint64_t *lsn) {
+  if (id_map_->get_lsn(primary_key, lsn)) {
+    return 0;
+  }
+
+  // Lsn is unknown for documents attached or bulk built, read it from
+  // forward of record
+  Record record;
+  int ret = this->search_record(primary_key, &record);
+  if (ret != 0 || record.primary_key == INVALID_KEY) {
+    CLOG_ERROR("Search record failed. key[%zu]", (size_t)primary_key);
+    return ret != 0 ? ret : ErrorCode_InexistentKey;
+  }
+  *lsn = record.lsn;
+  return 0;
+}
+
 int Collection::search_record(uint64_t primary_key, Record *record) {
   if (!this->has_record(primary_key)) {
     return 0;
@@ -410,8 +1360,7 @@ int Collection::search_record(uint64_t primary_key, Record *record) {
   }
 
   if (!found_segment && dumping_segment_ != nullptr) {
-    if (doc_id >= dumping_segment_->segment_meta().min_doc_id &&
-        doc_id <= dumping_segment_->segment_meta().max_doc_id) {
+    if (dumping_segment_->is_in_range(doc_id)) {
       found_segment = dumping_segment_;
     }
   }
@@ -448,9 +1397,7 @@ int Collection::get_segments(std::vector<SegmentPtr> *segments) {
     } else {
       // Maybe it's pre-loaded fail, and it will be loaded again.
       PersistSegmentPtr persist_segment;
-      ReadOptions read_options;
-      read_options.use_mmap = true;
-      read_options.create_new = false;
+      ReadOptions read_options = this->persist_read_options();
       int ret = this->load_persist_segment(segment_metas[i], read_options,
                                            &persist_segment);
       CHECK_RETURN(ret, 0);
@@ -484,12 +1431,21 @@ int Collection::get_stats(CollectionStats *stats) {
     stats->total_index_file_size += segment_metas[i].index_file_size;
     stats->total_segment_count++;
     stats->segment_stats.emplace_back(segment_metas[i]);
+
+    // Only persist segments follow load mode, count their resident bytes
+    SegmentID segment_id = segment_metas[i].segment_id;
+    if (persist_segment_mgr_->has_segment(segment_id)) {
+      PersistSegmentPtr segment = persist_segment_mgr_->get_segment(segment_id);
+      auto &segment_stats = stats->segment_stats.back();
+      segment_stats.resident_size = segment->resident_size();
+      stats->total_resident_size += segment_stats.resident_size;
+    }
   }
 
   // collect stats of memory segment
   if (dumping_segment_ != nullptr &&
       !persist_segment_mgr_->has_segment(dumping_segment_->segment_id())) {
-    auto &segment_meta = dumping_segment_->segment_meta();
+    auto segment_meta = dumping_segment_->segment_meta();
     stats->total_doc_count += segment_meta.doc_count;
     stats->total_index_file_count += segment_meta.index_file_count;
     stats->total_index_file_size += segment_meta.index_file_size;
@@ -498,7 +1454,7 @@ int Collection::get_stats(CollectionStats *stats) {
   }
 
   if (writing_segment_ != nullptr) {
-    auto &segment_meta = writing_segment_->segment_meta();
+    auto segment_meta = writing_segment_->segment_meta();
     stats->total_doc_count += segment_meta.doc_count;
     stats->total_index_file_count += segment_meta.index_file_count;
     stats->total_index_file_size += segment_meta.index_file_size;
@@ -506,6 +1462,21 @@ int Collection::get_stats(CollectionStats *stats) {
     stats->segment_stats.emplace_back(segment_meta);
   }
 
+  {
+    std::lock_guard<std::mutex> lock(column_stats_mutex_);
+    for (auto &it : column_build_stats_) {
+      stats->column_build_stats.emplace_back(it.second);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    for (auto &it : backfill_stats_) {
+      stats->backfill_stats.emplace_back(it.second);
+    }
+    stats->rebuild_stats = rebuild_stats_;
+  }
+
   stats->total_index_file_count += 4;
   stats->total_index_file_size += FileHelper::FileSize(id_map_->file_path());
   stats->total_index_file_size +=
@@ -521,11 +1492,6 @@ int Collection::update_schema(meta::CollectionMetaPtr new_schema) {
   CHECK_STATUS(opened_, true);
 
   std::lock_guard<std::mutex> lock(schema_mutex_);
-  if (is_dumping_) {
-    CLOG_ERROR("Can't update schema while dumping segment.");
-    return ErrorCode_StatusError;
-  }
-
   uint32_t new_revision = new_schema->revision();
   uint32_t current_revision = schema_->revision();
   if (new_revision <= current_revision) {
@@ -540,35 +1506,455 @@ int Collection::update_schema(meta::CollectionMetaPtr new_schema) {
   std::vector<meta::ColumnMetaPtr> delete_columns;
   this->diff_schema(*new_schema, *schema_, &add_columns, &delete_columns);
 
+  // Writers are held only while columns of writing segment switch.
+  // Dumping segment keeps columns it opened with, columns of its
+  // persist segment are settled by the schema when loaded.
   int ret = 0;
-  std::vector<SegmentPtr> all_segments;
-  ret = this->get_segments(&all_segments);
-  CHECK_RETURN_WITH_CLOG(ret, 0, "Get segments failed.");
+  {
+    write_mutex_.lock();
+    Defer write_defer([this] { write_mutex_.unlock(); });
+
+    if (writing_segment_ != nullptr) {
+      SegmentID segment_id = writing_segment_->segment_id();
+      bool has_docs = writing_segment_->doc_count() > 0U;
+      for (auto &column_meta : add_columns) {
+        ret = writing_segment_->add_column(column_meta);
+        CHECK_RETURN_WITH_CLOG(ret, 0, "Add new column failed. column[%s]",
+                               column_meta->name().c_str());
+        if (has_docs) {
+          this->mark_partial_column(segment_id, column_meta->name());
+        }
+      }
+      for (auto &column_meta : delete_columns) {
+        ret = writing_segment_->remove_column(column_meta->name());
+        CHECK_RETURN_WITH_CLOG(ret, 0, "Remove column failed. column[%s]",
+                               column_meta->name().c_str());
+      }
+    }
 
-  for (size_t i = 0; i < add_columns.size(); i++) {
-    for (size_t j = 0; j < all_segments.size(); j++) {
-      ret = all_segments[j]->add_column(add_columns[i]);
-      CHECK_RETURN_WITH_CLOG(
-          ret, 0, "Add new column failed. column[%s] segment_id[%zu]",
-          add_columns[i]->name().c_str(),
-          (size_t)all_segments[j]->segment_id());
+    // Backfill stats report the revision each column is added at
+    for (auto &column_meta : add_columns) {
+      column_revisions_[column_meta->name()] = new_revision;
     }
+    for (auto &column_meta : delete_columns) {
+      column_revisions_.erase(column_meta->name());
+    }
+    schema_ = new_schema;
   }
 
-  for (size_t i = 0; i < delete_columns.size(); i++) {
-    for (size_t j = 0; j < all_segments.size(); j++) {
-      ret = all_segments[j]->remove_column(delete_columns[i]->name());
+  // Persist segments serve added columns empty until backfilled
+  std::vector<SegmentID> segment_ids;
+  persist_segment_mgr_->get_segment_ids(&segment_ids);
+  for (auto segment_id : segment_ids) {
+    if (!persist_segment_mgr_->has_segment(segment_id)) {
+      continue;
+    }
+    PersistSegmentPtr segment = persist_segment_mgr_->get_segment(segment_id);
+    for (auto &column_meta : add_columns) {
+      ret = segment->add_column(column_meta);
+      CHECK_RETURN_WITH_CLOG(
+          ret, 0, "Add new column failed. column[%s] segment_id[%zu]",
+          column_meta->name().c_str(), (size_t)segment_id);
+    }
+    for (auto &column_meta : delete_columns) {
+      ret = segment->remove_column(column_meta->name());
       CHECK_RETURN_WITH_CLOG(ret, 0,
                              "Remove column failed. column[%s] segment_id[%zu]",
-                             delete_columns[i]->name().c_str(),
-                             (size_t)all_segments[j]->segment_id());
+                             column_meta->name().c_str(), (size_t)segment_id);
+    }
+    if (!read_options_.read_only) {
+      this->schedule_backfill(segment);
+    }
+  }
+
+  CLOG_INFO(
+      "Update schema success. current_schema[%u] new_schema[%u] "
+      "add_column_count[%zu] delete_column_count[%zu]",
+      current_revision, new_revision, add_columns.size(),
+      delete_columns.size());
+
+  return 0;
+}
+
+int Collection::backfill_column(const std::string &column_name,
+                                BackfillSourcePtr source) {
+  CHECK_STATUS(opened_, true);
+
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, backfill failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  std::lock_guard<std::mutex> lock(schema_mutex_);
+  if (schema_->column_by_name(column_name) == nullptr) {
+    CLOG_ERROR("Column not exist, backfill failed. column[%s]",
+               column_name.c_str());
+    return ErrorCode_InexistentColumn;
+  }
+
+  {
+    std::lock_guard<std::mutex> backfill_lock(backfill_mutex_);
+    backfill_sources_[column_name] = std::move(source);
+  }
+
+  std::vector<SegmentID> segment_ids;
+  persist_segment_mgr_->get_segment_ids(&segment_ids);
+  for (auto segment_id : segment_ids) {
+    if (persist_segment_mgr_->has_segment(segment_id)) {
+      this->schedule_backfill(persist_segment_mgr_->get_segment(segment_id),
+                              column_name);
+    }
+  }
+
+  CLOG_INFO("Backfill column from source. column[%s]", column_name.c_str());
+  return 0;
+}
+
+void Collection::mark_partial_column(SegmentID segment_id,
+                                     const std::string &column_name) {
+  std::lock_guard<std::mutex> lock(backfill_mutex_);
+  if (marked_columns_.emplace(segment_id, column_name).second &&
+      ColumnBackfill::Mark(dir_path_, segment_id, column_name) != 0) {
+    marked_columns_.erase(std::make_pair(segment_id, column_name));
+  }
+}
+
+void Collection::schedule_backfill(const PersistSegmentPtr &segment) {
+  for (auto &column_name : segment->pending_columns()) {
+    this->schedule_backfill(segment, column_name);
+  }
+}
+
+void Collection::schedule_backfill(const PersistSegmentPtr &segment,
+                                   const std::string &column_name) {
+  // Caller holds schema lock
+  auto column_meta = schema_->column_by_name(column_name);
+  if (!column_meta) {
+    return;
+  }
+  auto pending_columns = segment->pending_columns();
+  if (std::find(pending_columns.begin(), pending_columns.end(),
+                column_name) == pending_columns.end()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(backfill_mutex_);
+  auto &stats = backfill_stats_[column_name];
+  if (stats.column_name.empty()) {
+    auto it = column_revisions_.find(column_name);
+    stats.column_name = column_name;
+    stats.schema_revision =
+        it != column_revisions_.end() ? it->second : schema_->revision();
+  }
+
+  // Column neither forwarded nor given a source waits for one
+  if (backfill_sources_.find(column_name) == backfill_sources_.end() &&
+      !ForwardBackfillSource::Create(*schema_, *column_meta)) {
+    CLOG_WARN("No source to backfill column, wait for one. column[%s]",
+              column_name.c_str());
+    return;
+  }
+
+  SegmentID segment_id = segment->segment_id();
+  if (!backfilling_columns_.emplace(segment_id, column_name).second) {
+    return;
+  }
+  stats.total_segment_count++;
+  thread_pool_->submit(ailego::Closure::New(
+      this, &Collection::do_backfill_segment, segment_id, column_name));
+}
+
+size_t Collection::backfill_count() {
+  std::lock_guard<std::mutex> lock(backfill_mutex_);
+  return backfilling_columns_.size();
+}
+
+int Collection::do_backfill_segment(SegmentID segment_id,
+                                    std::string column_name) {
+  size_t doc_count = 0U;
+  int ret = 0;
+  Defer defer([&, this] {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    backfilling_columns_.erase(std::make_pair(segment_id, column_name));
+    auto &stats = backfill_stats_[column_name];
+    if (ret == 0) {
+      stats.done_segment_count++;
+      stats.backfilled_doc_count += doc_count;
+    } else {
+      stats.failed_segment_count++;
+    }
+  });
+
+  // Segment may be expired, or column removed since scheduled
+  if (backfill_stopped_ || !persist_segment_mgr_->has_segment(segment_id)) {
+    return 0;
+  }
+  PersistSegmentPtr segment = persist_segment_mgr_->get_segment(segment_id);
+
+  meta::ColumnMetaPtr column_meta;
+  meta::CollectionMetaPtr schema;
+  {
+    std::lock_guard<std::mutex> lock(schema_mutex_);
+    schema = schema_;
+    column_meta = schema->column_by_name(column_name);
+  }
+  if (!column_meta) {
+    return 0;
+  }
+
+  BackfillSourcePtr source;
+  {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    auto it = backfill_sources_.find(column_name);
+    if (it != backfill_sources_.end()) {
+      source = it->second;
+    }
+  }
+  if (!source) {
+    source = ForwardBackfillSource::Create(*schema, *column_meta);
+  }
+
+  ailego::ElapsedTime timer;
+  BuildResult result;
+  ret = ColumnBackfill::Build(
+      collection_name_, dir_path_, segment->segment_meta(), *column_meta,
+      segment->get_forward_reader(), delete_store_.get(), source.get(),
+      BuildOptions(), &result);
+  doc_count = result.doc_count;
+  CHECK_RETURN_WITH_CLOG(ret, 0,
+                         "Backfill column failed. segment_id[%zu] column[%s]",
+                         (size_t)segment_id, column_name.c_str());
+
+  // Published under schema lock, so column removed meanwhile is dropped
+  std::lock_guard<std::mutex> lock(schema_mutex_);
+  if (schema_->column_by_name(column_name) == nullptr) {
+    FileHelper::RemoveFile(
+        ColumnBackfill::FilePath(dir_path_, segment_id, column_name));
+    return 0;
+  }
+  ret = segment->publish_column(*column_meta, this->persist_read_options());
+  CHECK_RETURN_WITH_CLOG(
+      ret, 0, "Publish backfilled column failed. segment_id[%zu] column[%s]",
+      (size_t)segment_id, column_name.c_str());
+  {
+    std::lock_guard<std::mutex> backfill_lock(backfill_mutex_);
+    marked_columns_.erase(std::make_pair(segment_id, column_name));
+  }
+
+  CLOG_INFO(
+      "Backfill segment success. segment_id[%zu] column[%s] doc_count[%zu] "
+      "cost[%zums]",
+      (size_t)segment_id, column_name.c_str(), doc_count,
+      (size_t)timer.milli_seconds());
+  return 0;
+}
+
+int Collection::rebuild_segments(const std::vector<SegmentID> &segment_ids,
+                                 const BuildOptions &options) {
+  CHECK_STATUS(opened_, true);
+
+  if (read_options_.read_only) {
+    CLOG_ERROR("Collection is read only, rebuild failed.");
+    return ErrorCode_ReadOnlyCollection;
+  }
+
+  if (segment_ids.empty()) {
+    return 0;
+  }
+
+  // Segments are rebuilt one by one in a single task, so the cpu share
+  // of rebuild stays bounded
+  if (is_rebuilding_.exchange(true)) {
+    CLOG_WARN("Collection is rebuilding segments, try later.");
+    return ErrorCode_TaskIsRunning;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    rebuild_stats_.total_segment_count += segment_ids.size();
+  }
+  thread_pool_->submit(ailego::Closure::New(
+      this, &Collection::do_rebuild_segments, segment_ids, options));
+
+  CLOG_INFO("Rebuild segments in background. segment_count[%zu]",
+            segment_ids.size());
+  return 0;
+}
+
+void Collection::select_rebuild_segments(float deleted_ratio,
+                                         std::vector<SegmentID> *segment_ids) {
+  std::vector<meta::ColumnMetaPtr> columns;
+  {
+    std::lock_guard<std::mutex> lock(schema_mutex_);
+    columns = schema_->index_columns();
+  }
+
+  std::vector<SegmentID> persist_segment_ids;
+  persist_segment_mgr_->get_segment_ids(&persist_segment_ids);
+  for (auto persist_segment_id : persist_segment_ids) {
+    if (!persist_segment_mgr_->has_segment(persist_segment_id)) {
+      continue;
+    }
+    PersistSegmentPtr segment =
+        persist_segment_mgr_->get_segment(persist_segment_id);
+    size_t doc_count = segment->segment_meta().doc_count;
+    size_t alive_count =
+        doc_count - std::min(segment->deleted_count(), doc_count);
+
+    // Documents deleted after segment built stay in its graphs, until
+    // columns are rebuilt
+    for (auto &column_meta : columns) {
+      ColumnReaderPtr column_reader =
+          segment->get_column_reader(column_meta->name());
+      if (!column_reader) {
+        continue;
+      }
+      size_t index_count = column_reader->doc_count();
+      if (index_count > alive_count &&
+          index_count - alive_count >= deleted_ratio * index_count) {
+        segment_ids->emplace_back(persist_segment_id);
+        break;
+      }
+    }
+  }
+}
+
+void Collection::do_rebuild_segments(std::vector<SegmentID> segment_ids,
+                                     BuildOptions options) {
+  Defer defer([this] { is_rebuilding_ = false; });
+
+  for (auto segment_id : segment_ids) {
+    // Segment may be expired since scheduled
+    if (backfill_stopped_ || !persist_segment_mgr_->has_segment(segment_id)) {
+      std::lock_guard<std::mutex> lock(backfill_mutex_);
+      rebuild_stats_.failed_segment_count++;
+      continue;
+    }
+    PersistSegmentPtr segment = persist_segment_mgr_->get_segment(segment_id);
+
+    meta::CollectionMetaPtr schema;
+    {
+      std::lock_guard<std::mutex> lock(schema_mutex_);
+      schema = schema_;
+    }
+
+    ailego::ElapsedTime timer;
+    int ret = 0;
+    size_t doc_count = 0U;
+    for (auto &column_meta : schema->index_columns()) {
+      BuildResult result;
+      ret = this->rebuild_column(segment, *schema, *column_meta, options,
+                                 &result);
+      if (ret != 0) {
+        break;
+      }
+      doc_count = std::max(doc_count, result.doc_count);
+    }
+
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    if (ret != 0) {
+      rebuild_stats_.failed_segment_count++;
+      continue;
+    }
+    size_t total_count = segment->segment_meta().doc_count;
+    rebuild_stats_.done_segment_count++;
+    rebuild_stats_.rebuilt_doc_count += doc_count;
+    rebuild_stats_.dropped_doc_count +=
+        total_count > doc_count ? total_count - doc_count : 0U;
+    CLOG_INFO(
+        "Rebuild segment success. segment_id[%zu] doc_count[%zu] "
+        "total_count[%zu] cost[%zums]",
+        (size_t)segment_id, doc_count, total_count,
+        (size_t)timer.milli_seconds());
+  }
+}
+
+int Collection::rebuild_column(const PersistSegmentPtr &segment,
+                               const meta::CollectionMeta &schema,
+                               const meta::ColumnMeta &column_meta,
+                               const BuildOptions &options,
+                               BuildResult *result) {
+  SegmentID segment_id = segment->segment_id();
+  const std::string &column_name = column_meta.name();
+
+  // Column pending for backfill is built by backfill, and never built
+  // by both at once
+  auto pending_columns = segment->pending_columns();
+  if (std::find(pending_columns.begin(), pending_columns.end(),
+                column_name) != pending_columns.end()) {
+    return 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    if (!backfilling_columns_.emplace(segment_id, column_name).second) {
+      return 0;
     }
   }
+  Defer defer([&, this] {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    backfilling_columns_.erase(std::make_pair(segment_id, column_name));
+  });
 
-  schema_ = new_schema;
-  CLOG_INFO("Update schema success. current_schema[%u] new_schema[%u]",
-            current_revision, new_revision);
+  ColumnReaderPtr column_reader = segment->get_column_reader(column_name);
+  if (!column_reader) {
+    return 0;
+  }
+
+  // Vectors are read back from graph of segment. Quantized graph keeps
+  // no raw vectors, which falls back to source of backfill.
+  BackfillSourcePtr source = std::make_shared<StoredVectorSource>(
+      column_reader);
+  ColumnData column_data;
+  auto segment_meta = segment->segment_meta();
+  idx_t first_key = segment_meta.min_doc_id - segment_meta.doc_id_delta();
+  if (column_reader->fetch_vector(first_key, &column_data) ==
+      ErrorCode_InvalidIndexDataFormat) {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    auto it = backfill_sources_.find(column_name);
+    if (it != backfill_sources_.end()) {
+      source = it->second;
+    } else {
+      source = ForwardBackfillSource::Create(schema, column_meta);
+    }
+  }
+  if (!source) {
+    CLOG_ERROR("No raw vectors to rebuild column. segment_id[%zu] column[%s]",
+               (size_t)segment_id, column_name.c_str());
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  int ret = ColumnBackfill::Build(
+      collection_name_, dir_path_, segment_meta, column_meta,
+      segment->get_forward_reader(), delete_store_.get(), source.get(),
+      options, result);
+  if (ret != 0) {
+    std::lock_guard<std::mutex> lock(backfill_mutex_);
+    if (result->verified && result->recall < options.min_recall) {
+      rebuild_stats_.rejected_column_count++;
+      rebuild_stats_.last_recall = result->recall;
+    }
+  }
+  CHECK_RETURN_WITH_CLOG(ret, 0,
+                         "Rebuild column failed. segment_id[%zu] column[%s]",
+                         (size_t)segment_id, column_name.c_str());
 
+  // Swapped in under schema lock, file of segment expired or column
+  // removed meanwhile is dropped
+  std::lock_guard<std::mutex> lock(schema_mutex_);
+  auto current_meta = schema_->column_by_name(column_name);
+  if (!current_meta || !persist_segment_mgr_->has_segment(segment_id)) {
+    FileHelper::RemoveFile(
+        ColumnBackfill::FilePath(dir_path_, segment_id, column_name));
+    return 0;
+  }
+  ret = segment->publish_column(*current_meta, this->persist_read_options());
+  CHECK_RETURN_WITH_CLOG(
+      ret, 0, "Publish rebuilt column failed. segment_id[%zu] column[%s]",
+      (size_t)segment_id, column_name.c_str());
+  if (result->verified) {
+    std::lock_guard<std::mutex> backfill_lock(backfill_mutex_);
+    rebuild_stats_.last_recall = result->recall;
+  }
   return 0;
 }
 
@@ -577,6 +1963,11 @@ int Collection::drive_dump_segment() {
     return 0;
   }
 
+  return this->switch_writing_segment(
+      writing_segment_->segment_meta().max_doc_id + DOC_ID_INCREASE_COUNT);
+}
+
+int Collection::switch_writing_segment(idx_t min_doc_id) {
   // 1. create a new segment for writing
   SegmentMeta new_segment_meta;
   int ret = version_manager_->alloc_segment_meta(&new_segment_meta);
@@ -585,12 +1976,14 @@ int Collection::drive_dump_segment() {
     is_dumping_ = false;
     return ret;
   }
-  new_segment_meta.min_doc_id =
-      writing_segment_->segment_meta().max_doc_id + DOC_ID_INCREASE_COUNT;
+  new_segment_meta.min_doc_id = min_doc_id;
 
   MemorySegmentPtr new_segment;
   ReadOptions read_options;
   read_options.use_mmap = true;
+  read_options.huge_page = read_options_.huge_page;
+  read_options.forward_compression = read_options_.forward_compression;
+  read_options.forward_block_size = read_options_.forward_block_size;
   read_options.create_new = true;
   ret = open_memory_segment(new_segment_meta, read_options, &new_segment);
   if (ret != 0) {
@@ -598,10 +1991,14 @@ int Collection::drive_dump_segment() {
     return ret;
   }
 
-  // 2. swap writing segment -> flushing segment
-  MemorySegmentPtr tmp_segment = writing_segment_;
-  writing_segment_ = new_segment;
-  dumping_segment_ = std::move(tmp_segment);
+  // 2. swap writing segment -> flushing segment, under sync mutex which
+  // keeps sync stores seeing both segments consistently
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    MemorySegmentPtr tmp_segment = writing_segment_;
+    writing_segment_ = new_segment;
+    dumping_segment_ = std::move(tmp_segment);
+  }
 
   // 3. record segment state change
   writing_segment_->update_state(SegmentState::WRITING);
@@ -622,7 +2019,7 @@ int Collection::open_memory_segment(const SegmentMeta &segment_meta,
                                     const ReadOptions &read_options,
                                     MemorySegmentPtr *new_segment) {
   int ret = MemorySegment::CreateAndOpen(
-      collection_name_, dir_path_, segment_meta, schema_.get(),
+      collection_name_, dir_path_, segment_meta, schema_,
       delete_store_.get(), id_map_.get(), concurrency_, read_options,
       new_segment);
 
@@ -636,10 +2033,29 @@ int Collection::open_memory_segment(const SegmentMeta &segment_meta,
 int Collection::load_persist_segment(const SegmentMeta &segment_meta,
                                      const ReadOptions &read_options,
                                      PersistSegmentPtr *new_segment) {
-  int ret = PersistSegment::CreateAndLoad(
-      collection_name_, dir_path_, segment_meta, schema_.get(),
-      delete_store_.get(), id_map_.get(), concurrency_, read_options,
-      new_segment);
+  auto load_segment = [&, this]() {
+    return PersistSegment::CreateAndLoad(
+        collection_name_, dir_path_, segment_meta, schema_,
+        delete_store_.get(), id_map_.get(), concurrency_, read_options,
+        new_segment);
+  };
+
+  int ret = 0;
+  auto &topology = NumaTopology::Instance();
+  if (topology.enabled()) {
+    // Load on a thread bound to the owning node, so that pages warmed up
+    // are first touched and allocated on that node
+    uint32_t node = topology.node_of(segment_meta.segment_id);
+    std::thread loader([&]() {
+      topology.bind_thread(node);
+      ret = load_segment();
+    });
+    loader.join();
+    CLOG_DEBUG("Load persist segment on numa node. segment_id[%zu] node[%u]",
+               (size_t)segment_meta.segment_id, node);
+  } else {
+    ret = load_segment();
+  }
 
   CHECK_RETURN_WITH_CLOG(
       ret, 0, "Create and load persist segment failed. segment_id[%zu]",
@@ -648,6 +2064,20 @@ int Collection::load_persist_segment(const SegmentMeta &segment_meta,
   return 0;
 }
 
+ReadOptions Collection::persist_read_options() const {
+  ReadOptions read_options;
+  read_options.huge_page = read_options_.huge_page;
+  read_options.forward_on_disk = read_options_.forward_on_disk;
+  read_options.create_new = false;
+
+  // Load mode of collection overrides the one of index service
+  read_options.load_mode = schema_->load_mode() != LoadModes::DEFAULT
+                               ? schema_->load_mode()
+                               : read_options_.load_mode;
+  read_options.use_mmap = read_options.load_mode != LoadModes::HEAP;
+  return read_options;
+}
+
 int Collection::do_dump_segment() {
   SegmentID segment_id = dumping_segment_->segment_id();
   CLOG_INFO("Start dumping segment. segment_id[%zu]", (size_t)segment_id);
@@ -672,7 +2102,9 @@ int Collection::do_dump_segment() {
   dumping_segment_->update_state(SegmentState::PERSIST);
   version_manager_->update_segment_meta(dumping_segment_->segment_meta());
 
-  // record in version manager with retry
+  // record in version manager with retry, under schema lock which
+  // keeps expire and attach from applying edits meanwhile
+  std::unique_lock<std::mutex> schema_lock(schema_mutex_);
   VersionEdit edit;
   edit.add_segments.emplace_back(segment_id);
   retry = 0;
@@ -689,21 +2121,27 @@ int Collection::do_dump_segment() {
     return ret;
   }
 
-  // try to pre load new persist segment into memory
-  PersistSegmentPtr persist_segment;
-  ReadOptions read_options;
-  read_options.use_mmap = true;
-  read_options.create_new = false;
-  ret = this->load_persist_segment(dumping_segment_->segment_meta(),
-                                   read_options, &persist_segment);
-  if (ret == 0) {
-    persist_segment_mgr_->add_segment(persist_segment);
+  // try to pre load new persist segment into memory, columns added
+  // while dumping are backfilled
+  {
+    PersistSegmentPtr persist_segment;
+    ReadOptions read_options = this->persist_read_options();
+    ret = this->load_persist_segment(dumping_segment_->segment_meta(),
+                                     read_options, &persist_segment);
+    if (ret == 0) {
+      persist_segment_mgr_->add_segment(persist_segment);
+      this->schedule_backfill(persist_segment);
+    }
   }
+  schema_lock.unlock();
 
   // reduce dumping segment ref
   // if search thread release all the refs
   // it will trigger dumping segment auto destruct
-  dumping_segment_.reset();
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    dumping_segment_.reset();
+  }
 
   // shift lsn store
   ret = lsn_store_->shift();
@@ -737,6 +2175,31 @@ int Collection::recover_from_snapshot(const ReadOptions &read_options) {
                                 &lsn_store_);
   CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open lsn store failed.");
 
+  // init persist segment manager
+  persist_segment_mgr_ =
+      PersistSegmentManager::Create(collection_name_, dir_path_);
+  if (!persist_segment_mgr_) {
+    CLOG_ERROR("Create persist segment manager failed.");
+    return ErrorCode_RuntimeError;
+  }
+
+  // load persist segment & add into psm
+  auto &segment_metas = version_manager_->current_version();
+  for (size_t i = 0; i < segment_metas.size(); i++) {
+    PersistSegmentPtr persist_segment;
+    ReadOptions load_options = this->persist_read_options();
+    ret = this->load_persist_segment(segment_metas[i], load_options,
+                                     &persist_segment);
+    CHECK_RETURN(ret, 0);
+    persist_segment_mgr_->add_segment(persist_segment);
+  }
+
+  // memory segments are owned by writer process, which are invisible
+  // to read only collection
+  if (read_options.read_only) {
+    return 0;
+  }
+
   // init writing segment
   std::vector<SegmentMeta> writing_segment_metas;
   ret = version_manager_->get_segment_metas(SegmentState::WRITING,
@@ -757,30 +2220,42 @@ int Collection::recover_from_snapshot(const ReadOptions &read_options) {
     ret = this->open_memory_segment(dumping_segment_metas[0], read_options,
                                     &dumping_segment_);
     CHECK_RETURN(ret, 0);
-    // continue to drive dumping segment
-    thread_pool_->submit(
-        ailego::Closure::New(this, &Collection::do_dump_segment));
   }
 
-  // init persist segment manager
-  persist_segment_mgr_ =
-      PersistSegmentManager::Create(collection_name_, dir_path_);
-  if (!persist_segment_mgr_) {
-    CLOG_ERROR("Create persist segment manager failed.");
-    return ErrorCode_RuntimeError;
+  // lsns of keys written by an older version are read from forwards once
+  if (id_map_->lsn_migration_needed()) {
+    ailego::ElapsedTime timer;
+    size_t migrated_count = 0U;
+    ret = id_map_->migrate_lsns(
+        [this](uint64_t key, uint64_t *lsn) {
+          Record record;
+          int code = this->search_record(key, &record);
+          if (code != 0 || record.primary_key == INVALID_KEY) {
+            return false;
+          }
+          *lsn = record.lsn;
+          return true;
+        },
+        &migrated_count);
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Migrate lsns of id map failed.");
+    CLOG_INFO("Migrated lsns of id map. key_count[%zu] cost[%zums]",
+              migrated_count, (size_t)timer.milli_seconds());
   }
 
-  // load persist segment & add into psm
-  auto &segment_metas = version_manager_->current_version();
-  for (size_t i = 0; i < segment_metas.size(); i++) {
-    PersistSegmentPtr persist_segment;
-    ReadOptions load_options;
-    load_options.use_mmap = true;
-    load_options.create_new = false;
-    ret = this->load_persist_segment(segment_metas[i], load_options,
-                                     &persist_segment);
-    CHECK_RETURN(ret, 0);
-    persist_segment_mgr_->add_segment(persist_segment);
+  // continue to backfill columns added after segments dumped
+  {
+    std::lock_guard<std::mutex> lock(schema_mutex_);
+    std::vector<SegmentID> segment_ids;
+    persist_segment_mgr_->get_segment_ids(&segment_ids);
+    for (auto segment_id : segment_ids) {
+      this->schedule_backfill(persist_segment_mgr_->get_segment(segment_id));
+    }
+  }
+
+  // continue to drive dumping segment
+  if (dumping_segment_) {
+    thread_pool_->submit(
+        ailego::Closure::New(this, &Collection::do_dump_segment));
   }
 
   return 0;
@@ -21,16 +21,22 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <map>
+#include <set>
+#include <ailego/parallel/lock.h>
 #include "common/macro_define.h"
 #include "meta/meta.h"
 #include "segment/memory_segment.h"
 #include "segment/persist_segment_manager.h"
 #include "collection_dataset.h"
 #include "collection_stats.h"
+#include "column_backfill.h"
 #include "delete_store.h"
 #include "id_map.h"
 #include "lsn_store.h"
 #include "version_manager.h"
+#include "write_tracer.h"
 
 namespace proxima {
 namespace be {
@@ -84,16 +90,37 @@ class Collection {
   //! Flush collection's memory to persist storage
   int flush();
 
+  //! Wait until records written before are synced to persist storage,
+  //! concurrent waiters within commit window share one sync
+  int commit(uint32_t commit_window_us);
+
   //! Dump collection's memory segment to persist segment
   int dump();
 
   //! Optimize collection memory usage
   int optimize(ThreadPoolPtr pool);
 
+  //! Drop persist segments whose documents all expired
+  int expire();
+
+  //! Attach persist segments of a collection directory built outside
+  int attach_segments(const std::string &source_path, size_t *segment_count);
+
+  //! Create a point-in-time checkpoint under checkpoint_path, which can
+  //! be opened as a collection directly
+  int checkpoint(const std::string &checkpoint_path, uint64_t *lsn);
+
+  //! Map in segments published by the writer process, only for read-only
+  //! collection
+  int refresh();
+
  public:
   //! Batch write records
   int write_records(const CollectionDataset &records);
 
+  //! Batch write records, and summarize how they are applied
+  int write_records(const CollectionDataset &records, WriteSummary *summary);
+
   //! Get latest lsn context of record
   int get_latest_lsn(uint64_t *lsn, std::string *lsn_context);
 
@@ -104,9 +131,26 @@ class Collection {
   int get_stats(CollectionStats *stats);
 
  public:
-  //! Update schema
+  //! Update schema, writes go on while columns switch, and index columns
+  //! added are backfilled for persist segments in background
   int update_schema(meta::CollectionMetaPtr new_schema);
 
+  //! Backfill an added index column of persist segments from source,
+  //! for columns which are not forwarded
+  int backfill_column(const std::string &column_name,
+                      BackfillSourcePtr source);
+
+  //! Rebuild index columns of persist segments with current column params
+  //! in background, dropping deleted documents. A column is swapped in
+  //! only if its recall on sampled documents is verified.
+  int rebuild_segments(const std::vector<SegmentID> &segment_ids,
+                       const BuildOptions &options);
+
+  //! Select persist segments whose index columns keep deleted documents
+  //! no less than ratio of their documents
+  void select_rebuild_segments(float deleted_ratio,
+                               std::vector<SegmentID> *segment_ids);
+
  public:
   //! Get collection name
   const std::string &collection_name() const {
@@ -123,11 +167,36 @@ class Collection {
     return schema_;
   }
 
+  //! Return if collection opened read only
+  bool read_only() const {
+    return read_options_.read_only;
+  }
+
+  //! Set pool in which index columns of a batch are built in parallel,
+  //! columns are built one by one if not set
+  void set_build_pool(ThreadPool *pool) {
+    build_pool_ = pool;
+  }
+
+  //! Start or stop tracing every write of a primary key
+  void trace_key(uint64_t primary_key, bool enable) {
+    write_tracer_.trace_key(primary_key, enable);
+  }
+
+  //! Return primary keys traced now
+  std::vector<uint64_t> traced_keys() const {
+    return write_tracer_.traced_keys();
+  }
+
  private:
   int recover_from_snapshot(const ReadOptions &read_options);
 
   int remove_files();
 
+  int sync_stores();
+
+  size_t dirty_bytes() const;
+
   int open_memory_segment(const SegmentMeta &segment_meta,
                           const ReadOptions &read_options,
                           MemorySegmentPtr *new_segment);
@@ -136,23 +205,71 @@ class Collection {
                            const ReadOptions &read_options,
                            PersistSegmentPtr *new_segment);
 
+  ReadOptions persist_read_options() const;
+
   int drive_dump_segment();
 
+  int switch_writing_segment(idx_t min_doc_id);
+
   int do_dump_segment();
 
+  void mark_partial_column(SegmentID segment_id,
+                           const std::string &column_name);
+
+  void schedule_backfill(const PersistSegmentPtr &segment);
+
+  void schedule_backfill(const PersistSegmentPtr &segment,
+                         const std::string &column_name);
+
+  int do_backfill_segment(SegmentID segment_id, std::string column_name);
+
+  size_t backfill_count();
+
+  void do_rebuild_segments(std::vector<SegmentID> segment_ids,
+                           BuildOptions options);
+
+  int rebuild_column(const PersistSegmentPtr &segment,
+                     const meta::CollectionMeta &schema,
+                     const meta::ColumnMeta &column_meta,
+                     const BuildOptions &options, BuildResult *result);
+
   void diff_schema(const meta::CollectionMeta &new_schema,
                    const meta::CollectionMeta &current_schema,
                    std::vector<meta::ColumnMetaPtr> *add_columns,
                    std::vector<meta::ColumnMetaPtr> *delete_columns);
 
+  //! Net operation of a key in a write batch
+  struct FoldedRecord {
+    const Record *record{nullptr};
+    OperationTypes operation_type{OperationTypes::UNDEFINED};
+    size_t position{0U};
+  };
+
+  int fold_records(const CollectionDataset &records,
+                   std::vector<FoldedRecord> *folded_records,
+                   std::vector<const Record *> *folded_lsns,
+                   size_t *folded_count);
+
   int insert_record(const Record &record);
 
+  int insert_records(const std::vector<const Record *> &records,
+                     WriteSummary *summary);
+
+  int delete_records(const std::vector<const Record *> &records,
+                     WriteSummary *summary);
+
+  void update_column_stats(const std::vector<ColumnBuildStats> &column_stats);
+
   int delete_record(uint64_t primary_key);
 
+  void count_deleted(idx_t doc_id);
+
   int update_record(const Record &record);
 
   bool has_record(uint64_t primary_key);
 
+  int search_lsn(uint64_t primary_key, uint64_t *lsn);
+
   int search_record(uint64_t primary_key, Record *record);
 
  private:
@@ -165,6 +282,8 @@ class Collection {
   meta::CollectionMetaPtr schema_{};
   uint32_t concurrency_{0U};
   ThreadPool *thread_pool_{nullptr};
+  ThreadPool *build_pool_{nullptr};
+  ReadOptions read_options_{};
 
   IDMapPtr id_map_{};
   DeleteStorePtr delete_store_{};
@@ -175,9 +294,35 @@ class Collection {
   PersistSegmentManagerPtr persist_segment_mgr_{};
 
   std::mutex schema_mutex_{};
+  ailego::SharedMutex write_mutex_{};
+  std::map<std::string, uint32_t> column_revisions_{};
+  std::mutex column_stats_mutex_{};
+  std::map<std::string, ColumnBuildStats> column_build_stats_{};
   std::atomic<bool> is_dumping_{false};
   std::atomic<bool> is_flushing_{false};
   std::atomic<bool> is_optimizing_{false};
+  std::atomic<bool> is_expiring_{false};
+  WriteTracer write_tracer_;
+
+  std::mutex backfill_mutex_{};
+  std::map<std::string, BackfillStats> backfill_stats_{};
+  std::map<std::string, BackfillSourcePtr> backfill_sources_{};
+  std::set<std::pair<SegmentID, std::string>> backfilling_columns_{};
+  std::set<std::pair<SegmentID, std::string>> marked_columns_{};
+  std::atomic<bool> backfill_stopped_{false};
+  RebuildStats rebuild_stats_{};
+  std::atomic<bool> is_rebuilding_{false};
+
+  std::mutex sync_mutex_{};
+  std::mutex commit_mutex_{};
+  std::condition_variable commit_cond_{};
+  std::atomic<uint64_t> written_seq_{0U};
+  std::atomic<uint64_t> synced_seq_{0U};
+  uint64_t committed_seq_{0U};
+  uint64_t commit_round_{0U};
+  uint64_t round_target_seq_{0U};
+  int round_code_{0};
+  bool committing_{false};
 
   bool opened_{false};
 };
@@ -29,10 +29,18 @@ CollectionDataset::RowData *CollectionDataset::add_row_data() {
   return &records_[records_.size() - 1];
 }
 
+void CollectionDataset::add_row_data(RowData &&row) {
+  records_.emplace_back(std::move(row));
+}
+
 const CollectionDataset::RowData &CollectionDataset::get(size_t i) const {
   return records_[i];
 }
 
+CollectionDataset::RowData *CollectionDataset::mutable_row_data(size_t i) {
+  return &records_[i];
+}
+
 
 }  // end namespace index
 }  // namespace be
@@ -76,6 +76,12 @@ class CollectionDataset {
   //! Add a row data
   RowData *add_row_data();
 
+  //! Add a row data moved from another dataset
+  void add_row_data(RowData &&row);
+
+  //! Return a mutable row, so that it can be moved to another dataset
+  RowData *mutable_row_data(size_t i);
+
   //! Return a row
   const RowData &get(size_t i) const;
 
@@ -89,6 +95,11 @@ class CollectionDataset {
     return records_.empty();
   }
 
+  //! Reserve rows, so that rows are not moved while adding
+  void reserve(size_t size) {
+    records_.reserve(size);
+  }
+
   //! Clear rows
   void clear() {
     records_.clear();
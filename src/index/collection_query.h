@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <aitheta2/index_params.h>
 #include "common/types.h"
@@ -33,6 +34,25 @@ struct QueryResult;
 using QueryResultList = std::vector<QueryResult>;
 using QueryResultListConstIter = std::vector<QueryResult>::const_iterator;
 
+/*
+ * ForwardCopyStats counts copies and allocations of forward bytes made
+ * while serving a query. It's shared by segments searched concurrently.
+ */
+struct ForwardCopyStats {
+  std::atomic<uint64_t> copy_count{0U};
+  std::atomic<uint64_t> copy_bytes{0U};
+  std::atomic<uint64_t> alloc_count{0U};
+
+  //! Count a copy of forward bytes, with or without a new buffer
+  void add_copy(size_t bytes, bool alloc) {
+    copy_count++;
+    copy_bytes += bytes;
+    if (alloc) {
+      alloc_count++;
+    }
+  }
+};
+
 /*
  * QueryParams represents knn query params.
  */
@@ -44,6 +64,7 @@ struct QueryParams {
   uint64_t query_id{0U};
   bool is_linear{false};
   aitheta2::IndexParams extra_params{};
+  ForwardCopyStats *forward_stats{nullptr};
 };
 
 /*
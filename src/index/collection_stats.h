@@ -45,6 +45,7 @@ struct SegmentStats {
   uint64_t max_timestamp{0U};
   uint64_t min_lsn{0U};
   uint64_t max_lsn{0U};
+  uint64_t resident_size{0U};
 
   SegmentStats(const SegmentMeta &segment_meta) {
     segment_id = segment_meta.segment_id;
@@ -63,6 +64,55 @@ struct SegmentStats {
   }
 };
 
+/*
+ * ColumnBuildStats records time spent on building an index column.
+ */
+struct ColumnBuildStats {
+  std::string column_name{};
+  uint64_t insert_count{0U};
+  uint64_t total_build_us{0U};
+  uint64_t max_batch_build_us{0U};
+};
+
+/*
+ * BackfillStats tracks building an index column added by schema update
+ * for persist segments dumped before.
+ */
+struct BackfillStats {
+  std::string column_name{};
+  uint32_t schema_revision{0U};
+  uint64_t total_segment_count{0U};
+  uint64_t done_segment_count{0U};
+  uint64_t failed_segment_count{0U};
+  uint64_t backfilled_doc_count{0U};
+};
+
+/*
+ * RebuildStats tracks rebuilding index columns of persist segments.
+ */
+struct RebuildStats {
+  uint64_t total_segment_count{0U};
+  uint64_t done_segment_count{0U};
+  uint64_t failed_segment_count{0U};
+  uint64_t rejected_column_count{0U};
+  uint64_t rebuilt_doc_count{0U};
+  uint64_t dropped_doc_count{0U};
+  float last_recall{0.0f};
+};
+
+/*
+ * WriteSummary describes how a write batch is applied.
+ */
+struct WriteSummary {
+  uint64_t row_count{0U};
+  uint64_t folded_count{0U};
+  uint64_t insert_count{0U};
+  uint64_t update_count{0U};
+  uint64_t delete_count{0U};
+  uint64_t failed_count{0U};
+  uint64_t cost_us{0U};
+};
+
 /*
  * CollectionStats contains some important metrics of collection.
  * It contains serveral segments, at least one.
@@ -75,7 +125,11 @@ struct CollectionStats {
   uint64_t total_segment_count{0U};
   uint64_t total_index_file_count{0U};
   uint64_t total_index_file_size{0U};
+  uint64_t total_resident_size{0U};
   std::vector<SegmentStats> segment_stats{};
+  std::vector<ColumnBuildStats> column_build_stats{};
+  std::vector<BackfillStats> backfill_stats{};
+  RebuildStats rebuild_stats{};
 };
 
 }  // end namespace index
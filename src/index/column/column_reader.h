@@ -21,6 +21,7 @@
 #pragma once
 
 #include <thread>
+#include "common/error_code.h"
 #include "index_provider.h"
 #include "../collection_dataset.h"
 #include "../collection_query.h"
@@ -73,6 +74,11 @@ class ColumnReader : public IndexProvider {
                      uint32_t batch_count, FilterFunction filter,
                      std::vector<IndexDocumentList> *batch_result_list) = 0;
 
+  //! Fetch stored vector of key, fails if index keeps no raw vectors
+  virtual int fetch_vector(idx_t /*key*/, ColumnData * /*column_data*/) {
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
  public:
   //! Set concurrency
   void set_concurrency(uint32_t val) {
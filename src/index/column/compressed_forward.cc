@@ -0,0 +1,287 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of block compressed forward index
+ */
+
+#include "compressed_forward.h"
+#include <algorithm>
+#include <ailego/hash/crc32c.h>
+#include <snappy.h>
+#include "common/error_code.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+std::atomic<uint32_t> CompressedForwardCloset::next_owner_id_{1U};
+
+//! Write a whole block with its meta, pad it to 8 bytes
+static int WriteBlock(const IndexDumperPtr &dumper, const std::string &id,
+                      const void *data, size_t size) {
+  if (dumper->write(data, size) != size) {
+    LOG_ERROR("Write block failed. id[%s] size[%zu]", id.c_str(), size);
+    return ErrorCode_WriteData;
+  }
+
+  size_t padding_size = ((size + 7U) & ~7UL) - size;
+  std::string padding(padding_size, '\0');
+  if (dumper->write(padding.data(), padding_size) != padding_size) {
+    LOG_ERROR("Write padding failed. id[%s] size[%zu]", id.c_str(),
+              padding_size);
+    return ErrorCode_WriteData;
+  }
+
+  uint32_t crc = ailego::Crc32c::Hash(data, size, 0U);
+  return dumper->append(id, size, padding_size, crc);
+}
+
+//! Compress a raw block
+static int Compress(CompressionTypes compression, const std::string &raw,
+                    std::string *out) {
+  switch (compression) {
+    case CompressionTypes::NONE:
+      *out = raw;
+      return 0;
+    case CompressionTypes::SNAPPY:
+      snappy::Compress(raw.data(), raw.size(), out);
+      return 0;
+  }
+  return ErrorCode_InvalidArgument;
+}
+
+int CompressedForwardDumper::Dump(const IndexClosetPtr &closet,
+                                  CompressionTypes compression,
+                                  uint32_t block_size,
+                                  const IndexDumperPtr &dumper) {
+  if (block_size == 0U) {
+    block_size = DEFAULT_BLOCK_SIZE;
+  }
+
+  CompressedForwardMeta meta;
+  meta.version = CompressedForwardCloset::FORMAT_VERSION;
+  meta.compression = static_cast<uint32_t>(compression);
+  meta.doc_count = closet->count();
+
+  std::vector<CompressedForwardBlockMeta> blocks;
+  std::vector<std::string> records;
+  size_t records_size = 0U;
+  uint64_t data_offset = 0U;
+  uint32_t data_crc = 0U;
+
+  auto flush_block = [&](uint64_t next_index) -> int {
+    uint32_t record_count = static_cast<uint32_t>(records.size());
+    std::string raw;
+    raw.reserve(sizeof(uint32_t) * (record_count + 2) + records_size);
+    raw.append((const char *)&record_count, sizeof(record_count));
+    uint32_t offset = 0U;
+    for (auto &record : records) {
+      raw.append((const char *)&offset, sizeof(offset));
+      offset += static_cast<uint32_t>(record.size());
+    }
+    raw.append((const char *)&offset, sizeof(offset));
+    for (auto &record : records) {
+      raw.append(record);
+    }
+
+    std::string compressed;
+    int ret = Compress(compression, raw, &compressed);
+    if (ret != 0) {
+      LOG_ERROR("Compress forward block failed. compression[%u]",
+                meta.compression);
+      return ret;
+    }
+    if (dumper->write(compressed.data(), compressed.size()) !=
+        compressed.size()) {
+      LOG_ERROR("Write forward block failed. size[%zu]", compressed.size());
+      return ErrorCode_WriteData;
+    }
+
+    CompressedForwardBlockMeta block;
+    block.first_index = next_index - record_count;
+    block.data_offset = data_offset;
+    block.data_size = static_cast<uint32_t>(compressed.size());
+    block.raw_size = static_cast<uint32_t>(raw.size());
+    blocks.emplace_back(block);
+
+    data_offset += compressed.size();
+    data_crc =
+        ailego::Crc32c::Hash(compressed.data(), compressed.size(), data_crc);
+    meta.raw_size += raw.size();
+    records.clear();
+    records_size = 0U;
+    return 0;
+  };
+
+  for (uint64_t i = 0; i < meta.doc_count; i++) {
+    // Erased records are kept as empty ones
+    std::string record;
+    if (closet->fetch(i, &record) != 0) {
+      record.clear();
+    }
+    records_size += record.size();
+    records.emplace_back(std::move(record));
+    if (records_size >= block_size) {
+      int ret = flush_block(i + 1);
+      CHECK_RETURN(ret, 0);
+    }
+  }
+  if (!records.empty()) {
+    int ret = flush_block(meta.doc_count);
+    CHECK_RETURN(ret, 0);
+  }
+
+  size_t padding_size = ((data_offset + 7U) & ~7UL) - data_offset;
+  std::string padding(padding_size, '\0');
+  if (dumper->write(padding.data(), padding_size) != padding_size) {
+    LOG_ERROR("Write padding failed. size[%zu]", padding_size);
+    return ErrorCode_WriteData;
+  }
+  int ret = dumper->append(COMPRESSED_FORWARD_DATA_BLOCK, data_offset,
+                           padding_size, data_crc);
+  CHECK_RETURN(ret, 0);
+
+  meta.block_count = blocks.size();
+  ret = WriteBlock(dumper, COMPRESSED_FORWARD_INDEX_BLOCK, blocks.data(),
+                   blocks.size() * sizeof(CompressedForwardBlockMeta));
+  CHECK_RETURN(ret, 0);
+
+  ret = WriteBlock(dumper, COMPRESSED_FORWARD_META_BLOCK, &meta, sizeof(meta));
+  CHECK_RETURN(ret, 0);
+
+  LOG_DEBUG(
+      "Dumped compressed forward. doc_count[%zu] block_count[%zu] "
+      "raw_size[%zu] compressed_size[%zu]",
+      (size_t)meta.doc_count, (size_t)meta.block_count, (size_t)meta.raw_size,
+      (size_t)data_offset);
+  return 0;
+}
+
+int CompressedForwardCloset::load(IndexContainerPtr container) {
+  auto meta_block = container->get(COMPRESSED_FORWARD_META_BLOCK);
+  auto index_block = container->get(COMPRESSED_FORWARD_INDEX_BLOCK);
+  auto data_block = container->get(COMPRESSED_FORWARD_DATA_BLOCK);
+  if (!meta_block || !index_block || !data_block) {
+    LOG_ERROR("Compressed forward blocks missing.");
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  if (meta_block->fetch(0, &meta_, sizeof(meta_)) != sizeof(meta_)) {
+    LOG_ERROR("Read compressed forward meta failed.");
+    return ErrorCode_ReadData;
+  }
+  if (meta_.version != FORMAT_VERSION) {
+    LOG_ERROR("Unsupported compressed forward version. version[%u]",
+              meta_.version);
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  // Block metas are small, copy them out so they are always aligned
+  size_t index_size = meta_.block_count * sizeof(CompressedForwardBlockMeta);
+  blocks_.resize(meta_.block_count);
+  if (index_block->fetch(0, blocks_.data(), index_size) != index_size) {
+    LOG_ERROR("Read compressed forward index failed. size[%zu]", index_size);
+    return ErrorCode_ReadData;
+  }
+
+  data_block_ = data_block;
+  owner_id_ = next_owner_id_.fetch_add(1U);
+  return 0;
+}
+
+int CompressedForwardCloset::unload(void) {
+  blocks_.clear();
+  data_block_.reset();
+  meta_ = CompressedForwardMeta();
+  return 0;
+}
+
+int CompressedForwardCloset::fetch(uint64_t index, std::string *out) const {
+  if (index >= meta_.doc_count || blocks_.empty()) {
+    return ErrorCode_InexistentKey;
+  }
+
+  auto it = std::upper_bound(
+      blocks_.begin(), blocks_.end(), index,
+      [](uint64_t value, const CompressedForwardBlockMeta &block) {
+        return value < block.first_index;
+      });
+  size_t block_no = static_cast<size_t>(it - blocks_.begin()) - 1U;
+
+  auto &cache = BlockCache();
+  uint64_t key = ((uint64_t)owner_id_ << 32) | block_no;
+  auto raw_block = cache.get(key);
+  if (!raw_block) {
+    auto block = std::make_shared<std::string>();
+    int ret = this->load_block(block_no, block.get());
+    CHECK_RETURN(ret, 0);
+    cache.put(key, block);
+    raw_block = std::move(block);
+  }
+
+  const char *raw = raw_block->data();
+  uint32_t record_count = *reinterpret_cast<const uint32_t *>(raw);
+  uint64_t pos = index - blocks_[block_no].first_index;
+  if (pos >= record_count) {
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  const uint32_t *offsets = reinterpret_cast<const uint32_t *>(raw) + 1;
+  size_t records_offset = sizeof(uint32_t) * (record_count + 2);
+  size_t record_size = offsets[pos + 1] - offsets[pos];
+  if (record_size == 0U) {
+    return ErrorCode_InexistentKey;
+  }
+  out->assign(raw + records_offset + offsets[pos], record_size);
+  return 0;
+}
+
+int CompressedForwardCloset::load_block(size_t block_no,
+                                        std::string *raw_block) const {
+  auto &block = blocks_[block_no];
+  const void *data = nullptr;
+  if (data_block_->read(block.data_offset, &data, block.data_size) !=
+      block.data_size) {
+    LOG_ERROR("Read compressed forward block failed. block[%zu]", block_no);
+    return ErrorCode_ReadData;
+  }
+
+  bool succ = true;
+  switch (static_cast<CompressionTypes>(meta_.compression)) {
+    case CompressionTypes::NONE:
+      raw_block->assign((const char *)data, block.data_size);
+      break;
+    case CompressionTypes::SNAPPY:
+      succ = snappy::Uncompress((const char *)data, block.data_size,
+                                raw_block);
+      break;
+    default:
+      succ = false;
+      break;
+  }
+  if (!succ || raw_block->size() != block.raw_size) {
+    LOG_ERROR("Decompress forward block failed. block[%zu] compression[%u]",
+              block_no, meta_.compression);
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+  return 0;
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -0,0 +1,144 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Block compressed format of persist forward index
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "forward_fetcher.h"
+#include "../constants.h"
+#include "../typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * Compressed forward index consists of three blocks:
+ * CompressedForwardMeta:  meta header
+ * CompressedForwardIndex: meta of each compressed block, ordered by the
+ *                         index of first record
+ * CompressedForwardData:  compressed blocks
+ *
+ * A raw block is laid out as
+ * [record count][record offsets, count + 1][records]
+ * Erased records are kept as empty records.
+ */
+struct CompressedForwardMeta {
+  uint32_t version{0U};
+  uint32_t compression{0U};
+  uint64_t doc_count{0U};
+  uint64_t block_count{0U};
+  uint64_t raw_size{0U};
+  uint64_t reserved[4]{};
+};
+
+struct CompressedForwardBlockMeta {
+  uint64_t first_index{0U};
+  uint64_t data_offset{0U};
+  uint32_t data_size{0U};
+  uint32_t raw_size{0U};
+};
+
+/*
+ * CompressedForwardDumper packs records of a closet into compressed
+ * blocks at dump time.
+ */
+class CompressedForwardDumper {
+ public:
+  //! Default raw bytes of a block
+  static constexpr uint32_t DEFAULT_BLOCK_SIZE = 16U * 1024U;
+
+  //! Dump records of closet into dumper
+  static int Dump(const IndexClosetPtr &closet, CompressionTypes compression,
+                  uint32_t block_size, const IndexDumperPtr &dumper);
+};
+
+/*
+ * CompressedForwardCloset loads a compressed forward index. Decompressed
+ * blocks are kept in a process wide cache shared by all segments.
+ */
+class CompressedForwardCloset : public aitheta2::IndexImmutableCloset {
+ public:
+  //! Current format version
+  static constexpr uint32_t FORMAT_VERSION = 1U;
+
+  //! Default capacity bytes of decompressed block cache
+  static constexpr size_t DEFAULT_CACHE_SIZE = 256UL * 1024UL * 1024UL;
+
+  //! Constructor
+  CompressedForwardCloset() = default;
+
+  //! Destructor
+  ~CompressedForwardCloset() override = default;
+
+  //! Return the process wide cache of decompressed blocks
+  static ForwardCache &BlockCache() {
+    static ForwardCache cache(DEFAULT_CACHE_SIZE);
+    return cache;
+  }
+
+ public:
+  //! Initialize the closet
+  int init(const IndexParams &) override {
+    return 0;
+  }
+
+  //! Cleanup the closet
+  int cleanup(void) override {
+    return 0;
+  }
+
+  //! Load compressed forward index from container
+  int load(IndexContainerPtr container) override;
+
+  //! Unload index
+  int unload(void) override;
+
+  //! Fetch a record via local index
+  int fetch(uint64_t index, std::string *out) const override;
+
+  //! Retrieve count of records
+  uint64_t count(void) const override {
+    return meta_.doc_count;
+  }
+
+ public:
+  //! Return count of compressed blocks
+  size_t block_count() const {
+    return blocks_.size();
+  }
+
+ private:
+  int load_block(size_t block_no, std::string *raw_block) const;
+
+ private:
+  static std::atomic<uint32_t> next_owner_id_;
+
+  CompressedForwardMeta meta_{};
+  std::vector<CompressedForwardBlockMeta> blocks_{};
+  IndexContainerBlockPtr data_block_{};
+  uint32_t owner_id_{0U};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include "../constants.h"
 
 namespace proxima {
@@ -62,6 +63,14 @@ struct ForwardData {
                 buf.size() - sizeof(ForwardHeader));
   }
 
+  //! Deserialize from a fetched buffer, the header is decoded in place
+  //! and the buffer is taken over as data, so no new buffer is allocated
+  void deserialize(std::string &&buf) {
+    header = *((ForwardHeader *)buf.data());
+    data = std::move(buf);
+    data.erase(0, sizeof(ForwardHeader));
+  }
+
   ForwardHeader header{};
   std::string data{};
 };
@@ -0,0 +1,169 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of batched forward fetcher
+ */
+
+#include "forward_fetcher.h"
+#include "common/error_code.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+std::shared_ptr<const std::string> ForwardCache::get(uint64_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+  return it->second->second;
+}
+
+void ForwardCache::put(uint64_t key,
+                       std::shared_ptr<const std::string> record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t record_size = record->size();
+  if (record_size > capacity_ || entries_.find(key) != entries_.end()) {
+    return;
+  }
+
+  lru_list_.emplace_front(key, std::move(record));
+  entries_.emplace(key, lru_list_.begin());
+  size_ += record_size;
+  this->evict();
+}
+
+void ForwardCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_list_.clear();
+  entries_.clear();
+  size_ = 0U;
+}
+
+void ForwardCache::set_capacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  this->evict();
+}
+
+void ForwardCache::evict() {
+  while (size_ > capacity_ && !lru_list_.empty()) {
+    auto &entry = lru_list_.back();
+    size_ -= entry.second->size();
+    entries_.erase(entry.first);
+    lru_list_.pop_back();
+  }
+}
+
+ForwardFetcher::~ForwardFetcher() {
+  this->cleanup();
+}
+
+int ForwardFetcher::init(uint32_t thread_count, size_t cache_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_pool_) {
+    thread_pool_->stop();
+  }
+  thread_pool_ = std::make_shared<ThreadPool>(
+      thread_count > 0U ? thread_count : DEFAULT_THREAD_COUNT, false);
+  cache_.set_capacity(cache_size);
+
+  LOG_INFO("ForwardFetcher init complete. thread_count[%zu] cache_size[%zu]",
+           thread_pool_->count(), cache_size);
+  return 0;
+}
+
+void ForwardFetcher::cleanup() {
+  ThreadPoolPtr thread_pool;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_pool.swap(thread_pool_);
+  }
+  if (thread_pool) {
+    thread_pool->stop();
+  }
+  cache_.clear();
+}
+
+void ForwardFetcher::fetch(const IndexImmutableClosetPtr &closet,
+                           uint32_t owner_id,
+                           const std::vector<uint64_t> &indexes,
+                           std::vector<std::string> *records,
+                           std::vector<int> *codes) {
+  records->clear();
+  records->resize(indexes.size());
+  codes->assign(indexes.size(), 0);
+
+  // Records stay in the cache are served at once
+  std::vector<size_t> missed;
+  for (size_t i = 0; i < indexes.size(); i++) {
+    uint64_t key = ((uint64_t)owner_id << 32) | (indexes[i] & 0xFFFFFFFFUL);
+    auto record = cache_.get(key);
+    if (record) {
+      (*records)[i] = *record;
+      hit_count_++;
+    } else {
+      missed.emplace_back(i);
+    }
+  }
+  if (missed.empty()) {
+    return;
+  }
+  miss_count_ += missed.size();
+
+  ThreadPoolPtr thread_pool;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_pool = thread_pool_;
+  }
+
+  // Issue all missed reads at once, a single read is not worth a thread
+  // switch
+  if (thread_pool && missed.size() > 1U) {
+    auto group = thread_pool->make_group();
+    for (auto i : missed) {
+      group->submit(ailego::Closure::New(this, &ForwardFetcher::do_fetch,
+                                         closet, indexes[i], &(*records)[i],
+                                         &(*codes)[i]));
+    }
+    group->wait_finish();
+  } else {
+    for (auto i : missed) {
+      this->do_fetch(closet, indexes[i], &(*records)[i], &(*codes)[i]);
+    }
+  }
+
+  for (auto i : missed) {
+    if ((*codes)[i] == 0) {
+      uint64_t key = ((uint64_t)owner_id << 32) | (indexes[i] & 0xFFFFFFFFUL);
+      cache_.put(key, std::make_shared<std::string>((*records)[i]));
+    }
+  }
+}
+
+void ForwardFetcher::do_fetch(IndexImmutableClosetPtr closet, uint64_t index,
+                              std::string *record, int *code) {
+  *code = closet->fetch(index, record);
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
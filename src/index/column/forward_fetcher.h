@@ -0,0 +1,163 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Batched fetcher and record cache of disk resident forwards
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * ForwardCache is a small LRU cache of forward records fetched from
+ * disk, it's bounded by total bytes of cached records. Records are
+ * shared, so that hits do not copy them under lock.
+ */
+class ForwardCache {
+ public:
+  //! Constructor
+  explicit ForwardCache(size_t capacity) : capacity_(capacity) {}
+
+  //! Destructor
+  ~ForwardCache() = default;
+
+ public:
+  //! Get a record, return nullptr if missed
+  std::shared_ptr<const std::string> get(uint64_t key);
+
+  //! Put a record, least recently used records are evicted
+  void put(uint64_t key, std::shared_ptr<const std::string> record);
+
+  //! Drop all records
+  void clear();
+
+  //! Change capacity bytes
+  void set_capacity(size_t capacity);
+
+ public:
+  //! Return bytes of cached records
+  size_t size() const {
+    return size_;
+  }
+
+  //! Return count of cached records
+  size_t count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+ private:
+  void evict();
+
+ private:
+  using Entry = std::pair<uint64_t, std::shared_ptr<const std::string>>;
+
+  size_t capacity_{0U};
+  std::atomic<size_t> size_{0U};
+  std::list<Entry> lru_list_{};
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> entries_{};
+  mutable std::mutex mutex_{};
+};
+
+/*
+ * ForwardFetcher issues reads of disk resident forward records. All
+ * missed records of a batch are submitted to io threads at once, so page
+ * faults of a query overlap with each other instead of being serialized.
+ * Fetched records are kept in a process wide cache.
+ */
+class ForwardFetcher {
+ public:
+  //! Default io threads count
+  static constexpr uint32_t DEFAULT_THREAD_COUNT = 8U;
+
+  //! Default cache capacity bytes
+  static constexpr size_t DEFAULT_CACHE_SIZE = 64UL * 1024UL * 1024UL;
+
+  //! Constructor
+  ForwardFetcher() : cache_(DEFAULT_CACHE_SIZE) {}
+
+  //! Destructor
+  ~ForwardFetcher();
+
+  //! Return global instance
+  static ForwardFetcher &Instance() {
+    static ForwardFetcher instance;
+    return instance;
+  }
+
+ public:
+  //! Start io threads and set cache capacity
+  int init(uint32_t thread_count, size_t cache_size);
+
+  //! Stop io threads and drop cached records
+  void cleanup();
+
+  //! Fetch records of indexes from closet, cache entries are keyed by
+  //! owner id. Codes are set per record
+  void fetch(const IndexImmutableClosetPtr &closet, uint32_t owner_id,
+             const std::vector<uint64_t> &indexes,
+             std::vector<std::string> *records, std::vector<int> *codes);
+
+  //! Allocate an owner id of cache entries
+  uint32_t alloc_owner_id() {
+    return next_owner_id_.fetch_add(1U);
+  }
+
+ public:
+  //! Return the record cache
+  const ForwardCache &cache() const {
+    return cache_;
+  }
+
+  //! Return count of cache hits
+  uint64_t hit_count() const {
+    return hit_count_.load();
+  }
+
+  //! Return count of records read from closet
+  uint64_t miss_count() const {
+    return miss_count_.load();
+  }
+
+ private:
+  void do_fetch(IndexImmutableClosetPtr closet, uint64_t index,
+                std::string *record, int *code);
+
+ private:
+  std::mutex mutex_{};
+  ThreadPoolPtr thread_pool_{};
+  ForwardCache cache_;
+  std::atomic<uint32_t> next_owner_id_{1U};
+  std::atomic<uint64_t> hit_count_{0U};
+  std::atomic<uint64_t> miss_count_{0U};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
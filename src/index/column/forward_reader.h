@@ -21,6 +21,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "forward_data.h"
 #include "index_provider.h"
 #include "../snapshot.h"
@@ -58,6 +59,19 @@ class ForwardReader : public IndexProvider {
   //! Seek a specific doc id
   virtual int seek(idx_t doc_id, ForwardData *forward_data) = 0;
 
+  //! Seek a batch of doc ids, codes are set per doc id
+  virtual int batch_seek(const std::vector<idx_t> &doc_ids,
+                         std::vector<ForwardData> *forwards,
+                         std::vector<int> *codes) {
+    forwards->clear();
+    forwards->resize(doc_ids.size());
+    codes->resize(doc_ids.size());
+    for (size_t i = 0; i < doc_ids.size(); i++) {
+      (*codes)[i] = this->seek(doc_ids[i], &(*forwards)[i]);
+    }
+    return 0;
+  }
+
  public:
   //! Set min doc id
   void set_start_doc_id(uint32_t val) {
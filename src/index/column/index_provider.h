@@ -65,6 +65,11 @@ class IndexProvider {
   //! Return index file path
   virtual std::string index_file_path() const = 0;
 
+  //! Return bytes of index resident in memory
+  virtual size_t resident_size() const {
+    return 0U;
+  }
+
  protected:
   void set_collection_name(const std::string &val) {
     collection_name_ = val;
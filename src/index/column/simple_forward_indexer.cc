@@ -20,6 +20,7 @@
 
 #include "simple_forward_indexer.h"
 #include "common/error_code.h"
+#include "compressed_forward.h"
 #include "forward_indexer.h"
 #include "../file_helper.h"
 
@@ -44,6 +45,8 @@ int SimpleForwardIndexer::open(const ReadOptions &read_options) {
   ret = open_proxima_forward();
   CHECK_RETURN_WITH_SLOG(ret, 0, "Open proxima forward failed.");
 
+  compression_ = read_options.forward_compression;
+  block_size_ = read_options.forward_block_size;
   opened_ = true;
   return 0;
 }
@@ -70,6 +73,12 @@ int SimpleForwardIndexer::flush() {
 int SimpleForwardIndexer::dump(IndexDumperPtr dumper) {
   CHECK_STATUS(opened_, true);
 
+  // Writing segment keeps the closet uncompressed, records are packed
+  // into compressed blocks only when dumped
+  if (compression_ != CompressionTypes::NONE) {
+    return CompressedForwardDumper::Dump(proxima_forward_, compression_,
+                                         block_size_, dumper);
+  }
   return proxima_forward_->dump(dumper);
 }
 
@@ -130,7 +139,7 @@ int SimpleForwardIndexer::seek(idx_t doc_id, ForwardData *forward_data) {
       ret, 0, "Forward store fetch failed. doc_id[%zu] index[%zu] ret[%d]",
       (size_t)doc_id, (size_t)index, ret);
 
-  forward_data->deserialize(buffer);
+  forward_data->deserialize(std::move(buffer));
   return 0;
 }
 
@@ -108,6 +108,8 @@ class SimpleForwardIndexer : public ForwardIndexer {
   SnapshotPtr snapshot_{};
   IndexClosetPtr proxima_forward_{};
 
+  CompressionTypes compression_{CompressionTypes::NONE};
+  uint32_t block_size_{0U};
   bool opened_{false};
 };
 
@@ -20,6 +20,9 @@
 
 #include "simple_forward_reader.h"
 #include "common/error_code.h"
+#include "compressed_forward.h"
+#include "forward_fetcher.h"
+#include "../huge_page_helper.h"
 
 namespace proxima {
 namespace be {
@@ -49,6 +52,7 @@ int SimpleForwardReader::close() {
   CHECK_STATUS(opened_, true);
 
   forward_searcher_->unload();
+  resident_block_.reset();
   opened_ = false;
   return 0;
 }
@@ -56,12 +60,52 @@ int SimpleForwardReader::close() {
 int SimpleForwardReader::seek(idx_t doc_id, ForwardData *forward) {
   CHECK_STATUS(opened_, true);
 
+  if (on_disk_) {
+    std::vector<ForwardData> forwards;
+    std::vector<int> codes;
+    int ret = this->batch_seek({doc_id}, &forwards, &codes);
+    CHECK_RETURN(ret, 0);
+    CHECK_RETURN_WITH_SLOG(codes[0], 0, "Forward searcher fetch failed.");
+
+    *forward = std::move(forwards[0]);
+    return 0;
+  }
+
   uint64_t index = doc_id - this->start_doc_id();
   std::string buffer;
   int ret = forward_searcher_->fetch(index, &buffer);
   CHECK_RETURN_WITH_SLOG(ret, 0, "Forward searcher fetch failed.");
 
-  forward->deserialize(buffer);
+  forward->deserialize(std::move(buffer));
+  return 0;
+}
+
+int SimpleForwardReader::batch_seek(const std::vector<idx_t> &doc_ids,
+                                    std::vector<ForwardData> *forwards,
+                                    std::vector<int> *codes) {
+  CHECK_STATUS(opened_, true);
+
+  if (!on_disk_) {
+    return ForwardReader::batch_seek(doc_ids, forwards, codes);
+  }
+
+  std::vector<uint64_t> indexes;
+  indexes.reserve(doc_ids.size());
+  for (auto doc_id : doc_ids) {
+    indexes.emplace_back(doc_id - this->start_doc_id());
+  }
+
+  std::vector<std::string> records;
+  ForwardFetcher::Instance().fetch(forward_searcher_, cache_owner_id_,
+                                   indexes, &records, codes);
+
+  forwards->clear();
+  forwards->resize(doc_ids.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    if ((*codes)[i] == 0) {
+      (*forwards)[i].deserialize(std::move(records[i]));
+    }
+  }
   return 0;
 }
 
@@ -70,7 +114,10 @@ int SimpleForwardReader::open_proxima_container(
   index_file_path_ = FileHelper::MakeFilePath(
       this->collection_path(), FileID::SEGMENT_FILE, this->segment_id());
 
-  if (read_options.use_mmap) {
+  // Disk resident forwards are always mapped and never warmed up
+  on_disk_ = read_options.forward_on_disk;
+  use_mmap_ = read_options.use_mmap || on_disk_;
+  if (use_mmap_) {
     container_ = aitheta2::IndexFactory::CreateContainer("MMapFileContainer");
   } else {
     container_ = aitheta2::IndexFactory::CreateContainer("MemoryContainer");
@@ -78,7 +125,7 @@ int SimpleForwardReader::open_proxima_container(
 
   // Default set warmup flag
   IndexParams container_params;
-  container_params.set("proxima.mmap_file.container.memory_warmup", true);
+  container_params.set("proxima.mmap_file.container.memory_warmup", !on_disk_);
 
   int ret = container_->init(container_params);
   CHECK_RETURN_WITH_LLOG(ret, 0, "Container init failed. ret[%d]", ret);
@@ -87,17 +134,34 @@ int SimpleForwardReader::open_proxima_container(
   CHECK_RETURN_WITH_LLOG(ret, 0, "Container load failed. ret[%d] file[%s]", ret,
                          index_file_path_.c_str());
 
+  // Collapse heap copy at once, mapped file pages are collapsed by
+  // khugepaged in background
+  if (read_options.huge_page && !on_disk_) {
+    size_t advised_size =
+        HugePageHelper::AdviseContainer(container_, !use_mmap_);
+    LLOG_DEBUG("Advised huge pages for container. advised_size[%zu]",
+               advised_size);
+  }
+
+  // Residency is accounted on the block owned by reader
+  resident_block_ = container_->get(FORWARD_DUMP_BLOCK);
+  if (on_disk_) {
+    // Records are read at random, read ahead only pollutes page cache
+    if (resident_block_) {
+      MemoryHelper::AdviseRandomBlock(resident_block_);
+    }
+    cache_owner_id_ = ForwardFetcher::Instance().alloc_owner_id();
+  } else if (read_options.load_mode == LoadModes::MMAP_LOCKED &&
+             resident_block_) {
+    ret = MemoryHelper::LockBlock(resident_block_);
+    CHECK_RETURN_WITH_LLOG(ret, 0, "Lock block in memory failed. ret[%d]",
+                           ret);
+  }
+
   return 0;
 }
 
 int SimpleForwardReader::open_forward_searcher() {
-  forward_searcher_ =
-      aitheta2::IndexFactory::CreateImmutableCloset("ChainImmutableCloset");
-  if (!forward_searcher_) {
-    SLOG_ERROR("Create proxima forward searcher failed.");
-    return ErrorCode_RuntimeError;
-  }
-
   auto forward_block = container_->get(FORWARD_DUMP_BLOCK);
   if (!forward_block) {
     LLOG_ERROR("Can't find forward block in index file");
@@ -109,6 +173,17 @@ int SimpleForwardReader::open_forward_searcher() {
   int ret = block_container->load();
   CHECK_RETURN_WITH_SLOG(ret, 0, "Load forward container failed.");
 
+  // Format of forward block is detected by its inner blocks
+  if (block_container->has(COMPRESSED_FORWARD_META_BLOCK)) {
+    forward_searcher_ = std::make_shared<CompressedForwardCloset>();
+  } else {
+    forward_searcher_ =
+        aitheta2::IndexFactory::CreateImmutableCloset("ChainImmutableCloset");
+  }
+  if (!forward_searcher_) {
+    SLOG_ERROR("Create proxima forward searcher failed.");
+    return ErrorCode_RuntimeError;
+  }
 
   ret = forward_searcher_->load(block_container);
   CHECK_RETURN_WITH_SLOG(ret, 0,
@@ -25,6 +25,7 @@
 #include "common/types.h"
 #include "forward_reader.h"
 #include "../collection_dataset.h"
+#include "../memory_helper.h"
 #include "../typedef.h"
 
 namespace proxima {
@@ -63,6 +64,12 @@ class SimpleForwardReader : public ForwardReader {
   //! Get forward by doc id
   int seek(idx_t doc_id, ForwardData *forward) override;
 
+  //! Get forwards of a batch of doc ids, disk resident forwards are
+  //! fetched concurrently
+  int batch_seek(const std::vector<idx_t> &doc_ids,
+                 std::vector<ForwardData> *forwards,
+                 std::vector<int> *codes) override;
+
  public:
   //! Return index path
   std::string index_file_path() const override {
@@ -78,6 +85,12 @@ class SimpleForwardReader : public ForwardReader {
     }
   }
 
+  //! Return bytes of forward block resident in memory
+  size_t resident_size() const override {
+    return opened_ ? MemoryHelper::BlockResidentSize(resident_block_, use_mmap_)
+                   : 0U;
+  }
+
  private:
   int open_proxima_container(const ReadOptions &read_options);
 
@@ -86,8 +99,12 @@ class SimpleForwardReader : public ForwardReader {
  private:
   IndexContainerPtr container_{};
   IndexImmutableClosetPtr forward_searcher_{};
+  IndexContainerBlockPtr resident_block_{};
 
   std::string index_file_path_{};
+  bool use_mmap_{false};
+  bool on_disk_{false};
+  uint32_t cache_owner_id_{0U};
   bool opened_{false};
 };
 
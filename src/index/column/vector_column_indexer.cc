@@ -19,6 +19,9 @@
  */
 
 #include "vector_column_indexer.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
 #include "common/defer.h"
 #include "common/logger.h"
 #include "../file_helper.h"
@@ -82,6 +85,9 @@ int VectorColumnIndexer::flush() {
 int VectorColumnIndexer::dump(IndexDumperPtr dumper) {
   CHECK_STATUS(opened_, true);
 
+  if (reorder_on_dump_) {
+    return this->dump_reordered(dumper);
+  }
   return proxima_streamer_->dump(dumper);
 }
 
@@ -354,6 +360,151 @@ int VectorColumnIndexer::search(
   return 0;
 }
 
+int VectorColumnIndexer::dump_reordered(IndexDumperPtr dumper) {
+  ailego::ElapsedTime timer;
+  IndexProviderPtr provider = proxima_streamer_->create_provider();
+  if (!provider) {
+    LLOG_WARN("Streamer not support provider, dump without reorder.");
+    return proxima_streamer_->dump(dumper);
+  }
+
+  std::vector<uint64_t> ordered_keys;
+  int ret = this->compute_locality_order(provider, &ordered_keys);
+  CHECK_RETURN_WITH_LLOG(ret, 0, "Compute locality order failed. ret[%d]",
+                         ret);
+
+  // Streamer assigns node ids in insertion order, so rebuilding it in
+  // locality order lays out vectors and neighbor lists accordingly. The
+  // node -> doc_id table is persisted by streamer itself as node keys.
+  SnapshotPtr snapshot;
+  ReadOptions read_options;
+  read_options.use_mmap = false;
+  read_options.create_new = true;
+  ret = Snapshot::CreateAndOpen(
+      this->collection_path(), FileID::PROXIMA_FILE, this->segment_id(),
+      this->column_name() + ".reorder", read_options, &snapshot);
+  CHECK_RETURN_WITH_LLOG(ret, 0, "Create and open reorder snapshot failed.");
+  Defer defer([&snapshot] {
+    snapshot->close();
+    FileHelper::RemoveFile(snapshot->file_path());
+  });
+
+  IndexStreamerPtr streamer =
+      aitheta2::IndexFactory::CreateStreamer(this->get_engine_name());
+  if (!streamer) {
+    LLOG_ERROR("Create reorder streamer failed.");
+    return ErrorCode_RuntimeError;
+  }
+  Defer cleanup([&streamer] { streamer->cleanup(); });
+
+  ret = streamer->init(proxima_streamer_->meta(), proxima_params_);
+  CHECK_RETURN_WITH_LLOG(ret, 0, "Init reorder streamer failed. ret[%d]", ret);
+
+  ret = streamer->open(snapshot->data());
+  CHECK_RETURN_WITH_LLOG(ret, 0, "Open reorder streamer failed. ret[%d]", ret);
+
+  IndexQueryMeta query_meta(provider->vector_type(), provider->dimension());
+  auto ctx = streamer->create_context();
+  for (auto key : ordered_keys) {
+    ret = streamer->add_impl(key, provider->get_vector(key), query_meta, ctx);
+    CHECK_RETURN_WITH_LLOG(ret, 0,
+                           "Insert reorder streamer failed. ret[%d] key[%zu]",
+                           ret, (size_t)key);
+  }
+
+  ret = streamer->dump(dumper);
+  CHECK_RETURN_WITH_LLOG(ret, 0, "Dump reorder streamer failed. ret[%d]", ret);
+
+  LLOG_INFO("Dumped reordered column index. doc_count[%zu] cost[%zums]",
+            ordered_keys.size(), (size_t)timer.milli_seconds());
+  return 0;
+}
+
+int VectorColumnIndexer::compute_locality_order(
+    const IndexProviderPtr &provider, std::vector<uint64_t> *ordered_keys) {
+  std::vector<uint64_t> keys;
+  std::unordered_map<uint64_t, uint32_t> positions;
+  keys.reserve(provider->count());
+  positions.reserve(provider->count());
+  for (auto it = provider->create_iterator(); it->is_valid(); it->next()) {
+    positions.emplace(it->key(), keys.size());
+    keys.emplace_back(it->key());
+  }
+
+  // Graph adjacency is private to streamer, so neighbors are collected by
+  // searching each node's own vector, then nodes are numbered in BFS order
+  // with nearer neighbors first, as Cuthill-McKee does on a uniform degree
+  // graph.
+  auto ctx = context_pool_.acquire();
+  ctx->set_topk(reorder_neighbor_count_ + 1);
+  Defer defer([&ctx, this] { context_pool_.release(std::move(ctx)); });
+
+  size_t node_count = keys.size();
+  IndexQueryMeta query_meta(provider->vector_type(), provider->dimension());
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> new_positions(node_count, 0U);
+  std::vector<bool> visited(node_count, false);
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  static constexpr size_t kMaxSampleEdgeCount = 1024UL * 1024UL;
+  std::queue<uint32_t> queue;
+  order.reserve(node_count);
+  for (uint32_t seed = 0; seed < node_count; ++seed) {
+    if (visited[seed]) {
+      continue;
+    }
+    visited[seed] = true;
+    queue.push(seed);
+    while (!queue.empty()) {
+      uint32_t node = queue.front();
+      queue.pop();
+      new_positions[node] = order.size();
+      order.emplace_back(node);
+
+      int ret = proxima_streamer_->search_impl(
+          provider->get_vector(keys[node]), query_meta, ctx);
+      CHECK_RETURN_WITH_LLOG(ret, 0, "Search neighbors failed. ret[%d]", ret);
+
+      for (auto &doc : ctx->result()) {
+        auto found = positions.find(doc.key());
+        if (found == positions.end() || found->second == node) {
+          continue;
+        }
+        uint32_t neighbor = found->second;
+        if (edges.size() < kMaxSampleEdgeCount) {
+          edges.emplace_back(node, neighbor);
+        }
+        if (!visited[neighbor]) {
+          visited[neighbor] = true;
+          queue.push(neighbor);
+        }
+      }
+    }
+  }
+
+  // Average node id distance of sampled neighbors, a proxy of page locality
+  uint64_t origin_gap = 0U;
+  uint64_t reorder_gap = 0U;
+  for (auto &edge : edges) {
+    origin_gap += edge.first > edge.second ? edge.first - edge.second
+                                           : edge.second - edge.first;
+    uint32_t first = new_positions[edge.first];
+    uint32_t second = new_positions[edge.second];
+    reorder_gap += first > second ? first - second : second - first;
+  }
+  size_t edge_count = std::max(edges.size(), (size_t)1U);
+  LLOG_INFO(
+      "Computed locality order. doc_count[%zu] edge_count[%zu] "
+      "origin_avg_gap[%zu] reorder_avg_gap[%zu]",
+      node_count, edges.size(), (size_t)(origin_gap / edge_count),
+      (size_t)(reorder_gap / edge_count));
+
+  ordered_keys->reserve(node_count);
+  for (auto node : order) {
+    ordered_keys->emplace_back(keys[node]);
+  }
+  return 0;
+}
+
 bool VectorColumnIndexer::check_column_meta(
     const meta::ColumnMeta &column_meta) {
   auto index_type = column_meta.index_type();
@@ -435,6 +586,10 @@ bool VectorColumnIndexer::check_column_meta(
                         visit_bf);
   }
 
+  // Renumber graph nodes by locality when dumping persist segment
+  reorder_on_dump_ = column_meta.parameters().get_as_bool("reorder_on_dump");
+  reorder_neighbor_count_ = max_neighbor_count > 0U ? max_neighbor_count : 16U;
+
   // Check quantize type
   auto quantize_type = column_meta.parameters().get_as_string("quantize_type");
   if (!quantize_type.empty()) {
@@ -475,10 +630,11 @@ bool VectorColumnIndexer::check_column_meta(
       "dimension[%u] "
       "measure[%s] context_count[%u] max_neighbor_count[%u] "
       "ef_construction[%u] chunk_size[%u] ef_search[%u] max_scan_ratio[%f] "
-      "visit_bf[%d] quantize_type[%s] engine_type[%d]",
+      "visit_bf[%d] quantize_type[%s] engine_type[%d] reorder_on_dump[%d]",
       index_type, data_type, dimension, metric_type.c_str(),
       this->concurrency(), max_neighbor_count, ef_construction, chunk_size,
-      ef_search, max_scan_ratio, visit_bf, quantize_type.c_str(), engine_type_);
+      ef_search, max_scan_ratio, visit_bf, quantize_type.c_str(), engine_type_,
+      reorder_on_dump_);
 
   return true;
 }
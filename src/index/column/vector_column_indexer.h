@@ -127,6 +127,11 @@ class VectorColumnIndexer : public ColumnIndexer {
 
   int open_proxima_streamer();
 
+  int dump_reordered(IndexDumperPtr dumper);
+
+  int compute_locality_order(const IndexProviderPtr &provider,
+                             std::vector<uint64_t> *ordered_keys);
+
   std::string get_engine_name() {
     if (engine_type_ == EngineTypes::PROXIMA_OSWG_STREAMER) {
       return "OswgStreamer";
@@ -144,6 +149,9 @@ class VectorColumnIndexer : public ColumnIndexer {
 
   EngineTypes engine_type_{EngineTypes::PROXIMA_OSWG_STREAMER};
 
+  bool reorder_on_dump_{false};
+  uint32_t reorder_neighbor_count_{0U};
+
   QuantizeTypes quantize_type_{QuantizeTypes::UNDEFINED};
   IndexReformerPtr reformer_{};
   IndexMeasurePtr measure_{};
@@ -22,6 +22,8 @@
 #include "common/defer.h"
 #include "common/error_code.h"
 #include "constants.h"
+#include "../column_backfill.h"
+#include "../huge_page_helper.h"
 #include "typedef.h"
 
 namespace proxima {
@@ -57,8 +59,10 @@ int VectorColumnReader::open(const meta::ColumnMeta &column_meta,
 
 int VectorColumnReader::close() {
   context_pool_.clear();
+  proxima_provider_.reset();
   proxima_searcher_->unload();
   proxima_searcher_->cleanup();
+  resident_block_.reset();
 
   opened_ = false;
   LLOG_DEBUG("Unloaded column searcher");
@@ -74,7 +78,7 @@ int VectorColumnReader::search(const std::string &query,
 
   std::vector<IndexDocumentList> batch_results;
   int ret = this->search(query, query_params, 1, filter, &batch_results);
-  (*results) = batch_results[0];
+  (*results) = std::move(batch_results[0]);
   return ret;
 }
 
@@ -180,6 +184,26 @@ int VectorColumnReader::search(
   return 0;
 }
 
+int VectorColumnReader::fetch_vector(idx_t key, ColumnData *column_data) {
+  CHECK_STATUS(opened_, true);
+
+  if (quantize_type_ != QuantizeTypes::UNDEFINED || !proxima_provider_) {
+    return ErrorCode_InvalidIndexDataFormat;
+  }
+
+  const void *vector = proxima_provider_->get_vector(key);
+  if (vector == nullptr) {
+    return ErrorCode_InexistentKey;
+  }
+
+  column_data->column_name = this->column_name();
+  column_data->data_type = data_type_;
+  column_data->dimension = proxima_meta_.dimension();
+  column_data->data.assign(reinterpret_cast<const char *>(vector),
+                           proxima_meta_.element_size());
+  return 0;
+}
+
 bool VectorColumnReader::check_column_meta(
     const meta::ColumnMeta &column_meta) {
   auto index_type = column_meta.index_type();
@@ -246,6 +270,7 @@ bool VectorColumnReader::check_column_meta(
   }
 
   // Set proxima index meta
+  data_type_ = data_type;
   proxima_meta_.set_meta(feature_type, dimension);
   proxima_meta_.set_measure(metric_type, 0, IndexParams());
 
@@ -265,6 +290,13 @@ int VectorColumnReader::open_proxima_container(
   index_file_path_ = FileHelper::MakeFilePath(
       this->collection_path(), FileID::SEGMENT_FILE, this->segment_id());
 
+  // Column added after segment dumped lives in its backfilled file
+  std::string backfill_path = ColumnBackfill::FilePath(
+      this->collection_path(), this->segment_id(), this->column_name());
+  if (FileHelper::FileExists(backfill_path)) {
+    index_file_path_ = backfill_path;
+  }
+
   if (read_options.use_mmap) {
     container_ = aitheta2::IndexFactory::CreateContainer("MMapFileContainer");
   } else {
@@ -282,6 +314,24 @@ int VectorColumnReader::open_proxima_container(
   CHECK_RETURN_WITH_LLOG(ret, 0, "Container load failed. ret[%d] file[%s]", ret,
                          index_file_path_.c_str());
 
+  // Collapse heap copy at once, mapped file pages are collapsed by
+  // khugepaged in background
+  if (read_options.huge_page) {
+    size_t advised_size =
+        HugePageHelper::AdviseContainer(container_, !read_options.use_mmap);
+    LLOG_DEBUG("Advised huge pages for container. advised_size[%zu]",
+               advised_size);
+  }
+
+  // Residency is accounted on the block owned by reader
+  resident_block_ = container_->get(COLUMN_DUMP_BLOCK + this->column_name());
+  use_mmap_ = read_options.use_mmap;
+  if (read_options.load_mode == LoadModes::MMAP_LOCKED && resident_block_) {
+    ret = MemoryHelper::LockBlock(resident_block_);
+    CHECK_RETURN_WITH_LLOG(ret, 0, "Lock block in memory failed. ret[%d]",
+                           ret);
+  }
+
   return 0;
 }
 
@@ -361,6 +411,13 @@ int VectorColumnReader::open_proxima_searcher() {
   ret = proxima_searcher_->load(block_container, nullptr);
   CHECK_RETURN_WITH_LLOG(ret, 0, "Load container failed.");
 
+  // Segment may be built outside, check it matches with schema
+  if (proxima_searcher_->meta().dimension() != index_meta.dimension()) {
+    LLOG_ERROR("Index dimension mismatched. index[%u] schema[%u]",
+               proxima_searcher_->meta().dimension(), index_meta.dimension());
+    return ErrorCode_MismatchedDimension;
+  }
+
   // Init context pool
   for (uint32_t i = 0; i < this->concurrency(); i++) {
     auto ctx = proxima_searcher_->create_context();
@@ -371,6 +428,8 @@ int VectorColumnReader::open_proxima_searcher() {
     context_pool_.emplace(std::move(ctx));
   }
 
+  // Provider serves vectors stored in graph, for rebuilding segment
+  proxima_provider_ = proxima_searcher_->create_provider();
   return 0;
 }
 
@@ -26,6 +26,7 @@
 #include "column_reader.h"
 #include "context_pool.h"
 #include "index_helper.h"
+#include "../memory_helper.h"
 #include "../typedef.h"
 
 namespace proxima {
@@ -69,6 +70,9 @@ class VectorColumnReader : public ColumnReader {
              uint32_t batch_count, FilterFunction filter,
              std::vector<IndexDocumentList> *batch_result_list) override;
 
+  //! Fetch raw vector of key, quantized index keeps no raw vectors
+  int fetch_vector(idx_t key, ColumnData *column_data) override;
+
  public:
   //! Return index file path
   std::string index_file_path() const override {
@@ -84,6 +88,12 @@ class VectorColumnReader : public ColumnReader {
     }
   }
 
+  //! Return bytes of column block resident in memory
+  size_t resident_size() const override {
+    return opened_ ? MemoryHelper::BlockResidentSize(resident_block_, use_mmap_)
+                   : 0U;
+  }
+
  private:
   bool check_column_meta(const meta::ColumnMeta &column_meta);
 
@@ -95,14 +105,18 @@ class VectorColumnReader : public ColumnReader {
   IndexContainerPtr container_{};
   IndexParams proxima_params_{};
   IndexSearcherPtr proxima_searcher_{};
+  IndexProviderPtr proxima_provider_{};
   IndexMeta proxima_meta_{};
 
   ContextPool context_pool_{};
   QuantizeTypes quantize_type_{QuantizeTypes::UNDEFINED};
+  DataTypes data_type_{DataTypes::UNDEFINED};
   IndexReformerPtr reformer_{};
   IndexMeasurePtr measure_{};
+  IndexContainerBlockPtr resident_block_{};
 
   std::string index_file_path_{};
+  bool use_mmap_{false};
   bool opened_{false};
 };
 
@@ -0,0 +1,307 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of index column backfill and rebuild
+ */
+
+#include "column_backfill.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+#include <ailego/utility/time_helper.h>
+#include "common/defer.h"
+#include "common/error_code.h"
+#include "common/logger.h"
+#include "proto/common.pb.h"
+#include "constants.h"
+#include "file_helper.h"
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+BackfillSourcePtr ForwardBackfillSource::Create(
+    const meta::CollectionMeta &schema, const meta::ColumnMeta &column_meta) {
+  auto &forward_columns = schema.forward_columns();
+  auto it = std::find(forward_columns.begin(), forward_columns.end(),
+                      column_meta.name());
+  if (it == forward_columns.end()) {
+    return nullptr;
+  }
+  return std::make_shared<ForwardBackfillSource>(
+      it - forward_columns.begin(), column_meta);
+}
+
+int ForwardBackfillSource::fetch(idx_t /*key*/, const ForwardData &forward,
+                                 ColumnData *column_data) {
+  proto::GenericValueList values;
+  if (!values.ParseFromString(forward.data)) {
+    return ErrorCode_InvalidRecord;
+  }
+  if (position_ >= (size_t)values.values_size()) {
+    return ErrorCode_InexistentColumn;
+  }
+
+  auto &value = values.values(position_);
+  column_data->column_name = column_name_;
+  column_data->data_type = data_type_;
+  column_data->dimension = dimension_;
+  if (value.has_bytes_value()) {
+    column_data->data = value.bytes_value();
+  } else if (value.has_string_value()) {
+    column_data->data = value.string_value();
+  } else {
+    return ErrorCode_InvalidRecord;
+  }
+  return 0;
+}
+
+std::string ColumnBackfill::FilePath(const std::string &collection_path,
+                                     SegmentID segment_id,
+                                     const std::string &column_name) {
+  return FileHelper::MakeFilePath(collection_path, FileID::SEGMENT_FILE,
+                                  segment_id, column_name);
+}
+
+std::string ColumnBackfill::MarkerPath(const std::string &collection_path,
+                                       SegmentID segment_id,
+                                       const std::string &column_name) {
+  return FileHelper::MakeFilePath(collection_path, FileID::SEGMENT_FILE,
+                                  segment_id, column_name + ".partial");
+}
+
+int ColumnBackfill::Mark(const std::string &collection_path,
+                         SegmentID segment_id, const std::string &column_name) {
+  std::string marker_path =
+      MarkerPath(collection_path, segment_id, column_name);
+  if (!FileHelper::TouchFile(marker_path)) {
+    LOG_ERROR("Create backfill marker failed. file[%s]", marker_path.c_str());
+    return ErrorCode_WriteData;
+  }
+  return 0;
+}
+
+void ColumnBackfill::ListFiles(const std::string &collection_path,
+                               SegmentID segment_id,
+                               const meta::CollectionMeta &schema,
+                               std::vector<std::string> *file_paths) {
+  for (auto &column_meta : schema.index_columns()) {
+    std::string file_path =
+        FilePath(collection_path, segment_id, column_meta->name());
+    if (FileHelper::FileExists(file_path)) {
+      file_paths->emplace_back(file_path);
+    }
+    std::string marker_path =
+        MarkerPath(collection_path, segment_id, column_meta->name());
+    if (FileHelper::FileExists(marker_path)) {
+      file_paths->emplace_back(marker_path);
+    }
+  }
+}
+
+int ColumnBackfill::Build(const std::string &collection_name,
+                          const std::string &collection_path,
+                          const SegmentMeta &segment_meta,
+                          const meta::ColumnMeta &column_meta,
+                          const ForwardReaderPtr &forward_reader,
+                          const DeleteStore *delete_store,
+                          BackfillSource *source, const BuildOptions &options,
+                          BuildResult *result) {
+  SegmentID segment_id = segment_meta.segment_id;
+  const std::string &column_name = column_meta.name();
+  *result = BuildResult();
+
+  // Streaming index is built in a directory of its own, so it never
+  // meets files of memory segments sharing the segment id
+  std::string build_path = ailego::StringHelper::Concat(
+      collection_path, "/backfill.", column_name, ".", segment_id);
+  FileHelper::RemoveDirectory(build_path);
+  if (!FileHelper::CreateDirectory(build_path)) {
+    LOG_ERROR("Create backfill directory failed. path[%s]",
+              build_path.c_str());
+    return ErrorCode_WriteData;
+  }
+  Defer build_defer([&build_path] { FileHelper::RemoveDirectory(build_path); });
+
+  ColumnIndexerPtr indexer =
+      ColumnIndexer::Create(collection_name, build_path, segment_id,
+                            column_name, column_meta.index_type());
+  if (!indexer) {
+    LOG_ERROR("Create column indexer failed. index_type[%d] column[%s]",
+              (int)column_meta.index_type(), column_name.c_str());
+    return ErrorCode_RuntimeError;
+  }
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  indexer->set_concurrency(1U);
+  int ret = indexer->open(column_meta, read_options);
+  CHECK_RETURN_WITH_LOG(ret, 0, "Open column indexer failed. column[%s]",
+                        column_name.c_str());
+  Defer indexer_defer([&indexer] { indexer->close(); });
+
+  // Keys of index are doc ids before segment attached
+  idx_t doc_id_delta = (idx_t)segment_meta.doc_id_delta();
+  size_t total_count = forward_reader->doc_count();
+  size_t sample_step = 0U;
+  if (options.sample_count > 0U) {
+    sample_step = std::max<size_t>(total_count / options.sample_count, 1U);
+  }
+  std::vector<ColumnData> samples;
+  std::vector<idx_t> doc_ids;
+  std::vector<ForwardData> forwards;
+  std::vector<int> codes;
+  ailego::ElapsedTime busy_timer;
+  for (size_t begin = 0U; begin < total_count; begin += BATCH_SIZE) {
+    doc_ids.clear();
+    size_t end = std::min(begin + BATCH_SIZE, total_count);
+    for (size_t i = begin; i < end; i++) {
+      idx_t doc_id = segment_meta.min_doc_id + i;
+      if (!delete_store || !delete_store->has(doc_id)) {
+        doc_ids.emplace_back(doc_id);
+      }
+    }
+
+    ret = forward_reader->batch_seek(doc_ids, &forwards, &codes);
+    CHECK_RETURN_WITH_LOG(ret, 0, "Seek forwards failed. segment_id[%zu]",
+                          (size_t)segment_id);
+
+    ColumnData column_data;
+    for (size_t i = 0; i < doc_ids.size(); i++) {
+      idx_t key = doc_ids[i] - doc_id_delta;
+      if (codes[i] != 0 || forwards[i].header.primary_key == INVALID_KEY ||
+          source->fetch(key, forwards[i], &column_data) != 0) {
+        result->skipped_count++;
+        continue;
+      }
+      ret = indexer->insert(key, column_data);
+      CHECK_RETURN_WITH_LOG(ret, 0,
+                            "Insert backfill column failed. key[%zu] "
+                            "column[%s]",
+                            (size_t)forwards[i].header.primary_key,
+                            column_name.c_str());
+      if (sample_step > 0U && result->doc_count % sample_step == 0U &&
+          samples.size() < options.sample_count) {
+        samples.emplace_back(column_data);
+      }
+      result->doc_count++;
+    }
+
+    // Sleep in proportion to time busy, so building takes its share of
+    // a cpu core on average. Time busy is wall time, including waits for
+    // forward reads
+    if (options.cpu_ratio > 0.0f && options.cpu_ratio < 1.0f) {
+      uint64_t busy_us = busy_timer.micro_seconds();
+      std::this_thread::sleep_for(std::chrono::microseconds(
+          (uint64_t)(busy_us * (1.0f - options.cpu_ratio) /
+                     options.cpu_ratio)));
+      busy_timer.reset();
+    }
+  }
+
+  if (!samples.empty()) {
+    ret = Verify(indexer, column_meta, samples, options.topk,
+                 &result->recall);
+    CHECK_RETURN_WITH_LOG(ret, 0, "Verify column failed. column[%s]",
+                          column_name.c_str());
+    result->verified = true;
+    if (result->recall < options.min_recall) {
+      LOG_ERROR(
+          "Recall of column too low, discard it. segment_id[%zu] "
+          "column[%s] recall[%f] min_recall[%f]",
+          (size_t)segment_id, column_name.c_str(), result->recall,
+          options.min_recall);
+      return ErrorCode_RuntimeError;
+    }
+  }
+
+  // Dump into a temporary file, and rename it into place as a whole
+  std::string file_path = FilePath(collection_path, segment_id, column_name);
+  std::string temp_path = file_path + ".tmp";
+  IndexDumperPtr dumper = IndexFactory::CreateDumper("FileDumper");
+  if (!dumper) {
+    LOG_ERROR("Create dumper failed.");
+    return ErrorCode_RuntimeError;
+  }
+  ret = dumper->create(temp_path);
+  CHECK_RETURN_WITH_LOG(ret, 0, "Create dumper file failed. file[%s]",
+                        temp_path.c_str());
+
+  IndexDumperPtr column_dumper = std::make_shared<IndexSegmentDumper>(
+      dumper, COLUMN_DUMP_BLOCK + column_name);
+  ret = indexer->dump(column_dumper);
+  column_dumper->close();
+  dumper->close();
+  if (ret != 0 || !FileHelper::RenameFile(temp_path, file_path)) {
+    LOG_ERROR("Dump backfill column failed. ret[%d] file[%s]", ret,
+              file_path.c_str());
+    FileHelper::RemoveFile(temp_path);
+    return ret != 0 ? ret : ErrorCode_WriteData;
+  }
+
+  LOG_INFO(
+      "Build column success. collection[%s] segment_id[%zu] column[%s] "
+      "doc_count[%zu] skipped_count[%zu] recall[%f]",
+      collection_name.c_str(), (size_t)segment_id, column_name.c_str(),
+      result->doc_count, result->skipped_count, result->recall);
+  return 0;
+}
+
+int ColumnBackfill::Verify(const ColumnIndexerPtr &indexer,
+                           const meta::ColumnMeta &column_meta,
+                           const std::vector<ColumnData> &samples,
+                           uint32_t topk, float *recall) {
+  QueryParams query_params;
+  query_params.topk = topk;
+  query_params.data_type = column_meta.data_type();
+  query_params.dimension = column_meta.dimension();
+
+  size_t expected_count = 0U;
+  size_t hit_count = 0U;
+  IndexDocumentList graph_results;
+  IndexDocumentList linear_results;
+  for (auto &sample : samples) {
+    graph_results.clear();
+    linear_results.clear();
+    query_params.is_linear = false;
+    int ret =
+        indexer->search(sample.data, query_params, nullptr, &graph_results);
+    CHECK_RETURN(ret, 0);
+    query_params.is_linear = true;
+    ret = indexer->search(sample.data, query_params, nullptr, &linear_results);
+    CHECK_RETURN(ret, 0);
+
+    std::unordered_set<uint64_t> graph_keys;
+    for (auto &doc : graph_results) {
+      graph_keys.emplace(doc.key());
+    }
+    for (auto &doc : linear_results) {
+      hit_count += graph_keys.count(doc.key());
+    }
+    expected_count += linear_results.size();
+  }
+
+  *recall = expected_count > 0U ? (float)hit_count / expected_count : 1.0f;
+  return 0;
+}
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -0,0 +1,182 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Building index columns added by schema update for dumped
+ *             segments, and rebuilding columns of dumped segments
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "column/column_indexer.h"
+#include "column/forward_reader.h"
+#include "meta/meta.h"
+#include "segment/segment.h"
+#include "collection_dataset.h"
+#include "delete_store.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+class BackfillSource;
+using BackfillSourcePtr = std::shared_ptr<BackfillSource>;
+
+/*
+ * BackfillSource provides column data of a stored document, from which
+ * a newly added index column is built.
+ */
+class BackfillSource {
+ public:
+  //! Destructor
+  virtual ~BackfillSource() = default;
+
+  //! Fill column data of document keyed in index, non-zero code skips
+  //! the document
+  virtual int fetch(idx_t key, const ForwardData &forward,
+                    ColumnData *column_data) = 0;
+};
+
+/*
+ * ForwardBackfillSource reads column data from the forward column
+ * sharing name with the index column, whose bytes are raw vector.
+ */
+class ForwardBackfillSource : public BackfillSource {
+ public:
+  //! Constructor
+  ForwardBackfillSource(size_t position, const meta::ColumnMeta &column_meta)
+      : position_(position),
+        column_name_(column_meta.name()),
+        data_type_(column_meta.data_type()),
+        dimension_(column_meta.dimension()) {}
+
+  //! Create source if schema forwards the column, or return nullptr
+  static BackfillSourcePtr Create(const meta::CollectionMeta &schema,
+                                  const meta::ColumnMeta &column_meta);
+
+  //! Fill column data of document from forward
+  int fetch(idx_t key, const ForwardData &forward,
+            ColumnData *column_data) override;
+
+ private:
+  size_t position_{0U};
+  std::string column_name_{};
+  DataTypes data_type_{DataTypes::UNDEFINED};
+  uint32_t dimension_{0U};
+};
+
+/*
+ * StoredVectorSource reads raw vectors kept by the column reader of
+ * segment, so a column is rebuilt without its forward.
+ */
+class StoredVectorSource : public BackfillSource {
+ public:
+  //! Constructor
+  explicit StoredVectorSource(ColumnReaderPtr column_reader)
+      : column_reader_(std::move(column_reader)) {}
+
+  //! Fill column data of document from stored vector
+  int fetch(idx_t key, const ForwardData & /*forward*/,
+            ColumnData *column_data) override {
+    return column_reader_->fetch_vector(key, column_data);
+  }
+
+ private:
+  ColumnReaderPtr column_reader_{};
+};
+
+/*
+ * BuildOptions tunes building a column in background.
+ */
+struct BuildOptions {
+  //! Duty cycle of the building thread, 1 means unlimited. It's not a
+  //! cpu quota, the thread sleeps after each batch for busy time scaled
+  //! by (1 - cpu_ratio) / cpu_ratio, so it averages that share of one
+  //! core, regardless of load of other threads
+  float cpu_ratio{1.0f};
+  //! Documents sampled as queries to verify recall, 0 skips it
+  uint32_t sample_count{0U};
+  //! Topk of sampled queries
+  uint32_t topk{10U};
+  //! Least recall of graph search against linear search
+  float min_recall{0.0f};
+};
+
+/*
+ * BuildResult describes a column built.
+ */
+struct BuildResult {
+  size_t doc_count{0U};
+  size_t skipped_count{0U};
+  bool verified{false};
+  float recall{0.0f};
+};
+
+/*
+ * ColumnBackfill builds an index column of a persist segment into a
+ * file of its own beside segment file. The file is renamed into place
+ * only when complete, so a reader either finds a whole column or none.
+ */
+class ColumnBackfill {
+ public:
+  //! Documents seeked from forward at once
+  static constexpr size_t BATCH_SIZE = 1024U;
+
+  //! Return path of backfilled column file of segment
+  static std::string FilePath(const std::string &collection_path,
+                              SegmentID segment_id,
+                              const std::string &column_name);
+
+  //! Return path of marker, which tells column of segment misses
+  //! documents written before the column added
+  static std::string MarkerPath(const std::string &collection_path,
+                                SegmentID segment_id,
+                                const std::string &column_name);
+
+  //! Mark column of segment to be backfilled after dumped
+  static int Mark(const std::string &collection_path, SegmentID segment_id,
+                  const std::string &column_name);
+
+  //! Collect backfill files and markers existing for segment
+  static void ListFiles(const std::string &collection_path,
+                        SegmentID segment_id,
+                        const meta::CollectionMeta &schema,
+                        std::vector<std::string> *file_paths);
+
+  //! Build column of segment from its alive documents with current
+  //! column params. Column failing recall verification is discarded.
+  static int Build(const std::string &collection_name,
+                   const std::string &collection_path,
+                   const SegmentMeta &segment_meta,
+                   const meta::ColumnMeta &column_meta,
+                   const ForwardReaderPtr &forward_reader,
+                   const DeleteStore *delete_store, BackfillSource *source,
+                   const BuildOptions &options, BuildResult *result);
+
+ private:
+  //! Measure recall of graph search against linear search
+  static int Verify(const ColumnIndexerPtr &indexer,
+                    const meta::ColumnMeta &column_meta,
+                    const std::vector<ColumnData> &samples, uint32_t topk,
+                    float *recall);
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
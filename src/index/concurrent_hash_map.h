@@ -55,6 +55,29 @@ class ConcurrentHashMap {
     return val;
   }
 
+  //! Copy value of key out under lock, return false if not found
+  bool find(TKey key, TValue *val) const {
+    bool found = false;
+    rw_lock_.lock_shared();
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+      *val = it->second;
+      found = true;
+    }
+    rw_lock_.unlock_shared();
+    return found;
+  }
+
+  //! Replace value of key, return the old one, which is released out of
+  //! lock by caller
+  TValue exchange(TKey key, TValue val) {
+    rw_lock_.lock();
+    TValue old_val = std::move(map_[key]);
+    map_[key] = std::move(val);
+    rw_lock_.unlock();
+    return old_val;
+  }
+
   //! If has key
   bool has(TKey key) const {
     bool found = false;
@@ -35,6 +35,9 @@ const std::string SEGMENT_BLOCK("SegmentBlock");
 
 const std::string FORWARD_DUMP_BLOCK("ForwardIndex");
 const std::string COLUMN_DUMP_BLOCK("ColumnIndex");
+const std::string COMPRESSED_FORWARD_META_BLOCK("CompressedForwardMeta");
+const std::string COMPRESSED_FORWARD_INDEX_BLOCK("CompressedForwardIndex");
+const std::string COMPRESSED_FORWARD_DATA_BLOCK("CompressedForwardData");
 
 const uint64_t INVALID_KEY = -1UL;
 const uint64_t INVALID_DOC_ID = -1UL;
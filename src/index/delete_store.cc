@@ -51,8 +51,10 @@ DeleteStore::~DeleteStore() {
 int DeleteStore::open(const ReadOptions &read_options) {
   CHECK_STATUS(opened_, false);
 
+  ReadOptions options = read_options;
+  options.dirty_range_flush = true;
   int ret = Snapshot::CreateAndOpen(collection_path_, FileID::DELETE_FILE,
-                                    read_options, &snapshot_);
+                                    options, &snapshot_);
   CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
 
   ret = delta_store_.mount(snapshot_->data());
@@ -92,6 +94,31 @@ int DeleteStore::close() {
   return ret;
 }
 
+int DeleteStore::reload(const ReadOptions &read_options) {
+  CHECK_STATUS(opened_, true);
+
+  SnapshotPtr snapshot;
+  int ret = Snapshot::CreateAndOpen(collection_path_, FileID::DELETE_FILE,
+                                    read_options, &snapshot);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
+
+  size_t synced_count = delta_store_.count();
+  ret = delta_store_.remount(snapshot->data());
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Remount snapshot failed.");
+
+  // Deleted docs are only appended, just sync the tail
+  for (size_t i = synced_count; i < delta_store_.count(); i++) {
+    const idx_t *doc_id = delta_store_.at(i);
+    if (doc_id != nullptr) {
+      bitmap_.set(*doc_id);
+    }
+  }
+
+  snapshot_.swap(snapshot);
+  snapshot->close();
+  return 0;
+}
+
 int DeleteStore::insert(idx_t doc_id) {
   CHECK_STATUS(opened_, true);
   bitmap_.set(doc_id);
@@ -99,6 +126,15 @@ int DeleteStore::insert(idx_t doc_id) {
   return delta_store_.append(doc_id);
 }
 
+int DeleteStore::insert(const std::vector<idx_t> &doc_ids) {
+  CHECK_STATUS(opened_, true);
+  for (auto doc_id : doc_ids) {
+    bitmap_.set(doc_id);
+  }
+
+  return delta_store_.append(doc_ids);
+}
+
 bool DeleteStore::has(idx_t doc_id) const {
   return bitmap_.test(doc_id);
 }
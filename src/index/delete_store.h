@@ -69,13 +69,24 @@ class DeleteStore {
   //! Flush memory to persist storage
   int flush();
 
+  //! Return bytes next flush would sync
+  size_t dirty_bytes() const {
+    return snapshot_ ? snapshot_->dirty_bytes() : 0U;
+  }
+
   //! Close persist storage and cleanup
   int close();
 
+  //! Reload deleted docs which are appended by another process
+  int reload(const ReadOptions &options);
+
  public:
   //! Insert a doc id
   int insert(idx_t doc_id);
 
+  //! Insert a batch of doc ids
+  int insert(const std::vector<idx_t> &doc_ids);
+
   //! Check if exist a doc id
   bool has(idx_t doc_id) const;
 
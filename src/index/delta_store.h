@@ -89,43 +89,62 @@ class DeltaStore {
     node_count_ = 0U;
   }
 
-  //! Append an element
-  int append(const T &element) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    size_t block_offset = 0U;
-    IndexBlockPtr data_block;
-
-    uint32_t block_index = data_blocks_.size() - 1;
-    size_t block_size = kNodeCountPerBlock * sizeof(T);
-    if (block_index == -1U ||
-        data_blocks_[block_index]->data_size() >= block_size) {
-      block_index++;
-      std::string new_block_name =
-          ailego::StringHelper::Concat(DATA_BLOCK, block_index);
+  //! Mount a newer persist storage of the same file, node count never
+  //! goes back while reloading
+  int remount(const IndexStoragePtr &stg) {
+    if (!stg) {
+      LOG_ERROR("Mount null storage");
+      return ErrorCode_RuntimeError;
+    }
 
-      int ret = storage_->append(new_block_name, block_size);
-      CHECK_RETURN(ret, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    IndexBlockPtr header_block = stg->get(HEADER_BLOCK);
+    if (!header_block) {
+      return ErrorCode_ReadData;
+    }
 
-      header_.block_count++;
-      header_.total_size += block_size;
-      ret = update_header();
-      CHECK_RETURN(ret, 0);
+    Header *header;
+    size_t read_len =
+        header_block->read(0, (const void **)&header, sizeof(Header));
+    if (read_len != sizeof(Header)) {
+      return ErrorCode_ReadData;
+    }
 
-      block_offset = 0U;
-      data_block = storage_->get(new_block_name);
-      data_blocks_.emplace_back(data_block);
-    } else {
-      data_block = data_blocks_[block_index];
-      block_offset = data_block->data_size();
+    std::vector<IndexBlockPtr> data_blocks;
+    for (uint32_t i = 0; i < header->block_count; i++) {
+      std::string block_name = ailego::StringHelper::Concat(DATA_BLOCK, i);
+      auto data_block = stg->get(block_name);
+      if (!data_block) {
+        return ErrorCode_ReadData;
+      }
+      data_blocks.emplace_back(data_block);
     }
 
-    size_t write_len = data_block->write(block_offset, &element, sizeof(T));
-    if (write_len != sizeof(T)) {
-      return ErrorCode_WriteData;
+    storage_ = stg;
+    header_block_ = header_block;
+    header_ = *header;
+    data_blocks_.swap(data_blocks);
+    if (header_.block_count > 0) {
+      node_count_ =
+          (header_.block_count - 1) * kNodeCountPerBlock +
+          data_blocks_[header_.block_count - 1]->data_size() / sizeof(T);
     }
+    return 0;
+  }
 
-    node_count_++;
+  //! Append an element
+  int append(const T &element) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return this->append_element(element);
+  }
+
+  //! Append a batch of elements under one lock
+  int append(const std::vector<T> &elements) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &element : elements) {
+      int ret = this->append_element(element);
+      CHECK_RETURN(ret, 0);
+    }
     return 0;
   }
 
@@ -186,6 +205,43 @@ class DeltaStore {
   }
 
  private:
+  int append_element(const T &element) {
+    size_t block_offset = 0U;
+    IndexBlockPtr data_block;
+
+    uint32_t block_index = data_blocks_.size() - 1;
+    size_t block_size = kNodeCountPerBlock * sizeof(T);
+    if (block_index == -1U ||
+        data_blocks_[block_index]->data_size() >= block_size) {
+      block_index++;
+      std::string new_block_name =
+          ailego::StringHelper::Concat(DATA_BLOCK, block_index);
+
+      int ret = storage_->append(new_block_name, block_size);
+      CHECK_RETURN(ret, 0);
+
+      header_.block_count++;
+      header_.total_size += block_size;
+      ret = update_header();
+      CHECK_RETURN(ret, 0);
+
+      block_offset = 0U;
+      data_block = storage_->get(new_block_name);
+      data_blocks_.emplace_back(data_block);
+    } else {
+      data_block = data_blocks_[block_index];
+      block_offset = data_block->data_size();
+    }
+
+    size_t write_len = data_block->write(block_offset, &element, sizeof(T));
+    if (write_len != sizeof(T)) {
+      return ErrorCode_WriteData;
+    }
+
+    node_count_++;
+    return 0;
+  }
+
   int init_storage() {
     int ret = storage_->append(HEADER_BLOCK, sizeof(Header));
     CHECK_RETURN(ret, 0);
@@ -0,0 +1,349 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of storage flushing only dirty pages
+ */
+
+#include "dirty_range_storage.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include "common/error_code.h"
+#include "common/logger.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+constexpr size_t DirtyRangeStorage::PAGE_SIZE;
+constexpr size_t DirtyRangeStorage::SYNC_CHUNK_SIZE;
+constexpr size_t DirtyRangeStorage::META_SIZE;
+
+thread_local bool DirtyRangeStorage::throttled_{false};
+std::mutex DirtyRangeStorage::limiter_mutex_{};
+ailego::RateLimiter::Pointer DirtyRangeStorage::limiter_{};
+
+/*
+ * Block marks pages it writes in a bitmap, bits are set and taken
+ * without lock on write and flush path
+ */
+class DirtyRangeStorage::Block : public IndexBlock {
+ public:
+  //! Constructor
+  Block(IndexBlockPtr block, DirtyRangeStorage *owner)
+      : block_(std::move(block)),
+        owner_(owner),
+        page_count_((block_->capacity() + PAGE_SIZE - 1) / PAGE_SIZE),
+        pages_((page_count_ + 63) / 64) {}
+
+  //! Retrieve size of data
+  size_t data_size(void) const override {
+    return block_->data_size();
+  }
+
+  //! Retrieve crc of data
+  uint32_t data_crc(void) const override {
+    return block_->data_crc();
+  }
+
+  //! Retrieve size of padding
+  size_t padding_size(void) const override {
+    return block_->padding_size();
+  }
+
+  //! Retrieve capacity of block
+  size_t capacity(void) const override {
+    return block_->capacity();
+  }
+
+  //! Fetch data from block (with own buffer)
+  size_t fetch(size_t offset, void *buf, size_t len) const override {
+    return block_->fetch(offset, buf, len);
+  }
+
+  //! Read data from block
+  size_t read(size_t offset, const void **data, size_t len) override {
+    return block_->read(offset, data, len);
+  }
+
+  //! Write data into the block with offset, and mark pages dirty, pages
+  //! appended are synced as dirty ranges as well
+  size_t write(size_t offset, const void *data, size_t len) override {
+    size_t data_size = block_->data_size();
+    size_t written = block_->write(offset, data, len);
+    if (written > 0U) {
+      this->mark(offset, written);
+    }
+    if (block_->data_size() != data_size) {
+      owner_->mark_size_dirty();
+    }
+    return written;
+  }
+
+  //! Resize size of data
+  size_t resize(size_t size) override {
+    owner_->mark_meta_dirty();
+    return block_->resize(size);
+  }
+
+  //! Update crc of data
+  void update_data_crc(uint32_t crc) override {
+    owner_->mark_meta_dirty();
+    block_->update_data_crc(crc);
+  }
+
+  //! Clone the block
+  IndexBlockPtr clone(void) override {
+    return block_->clone();
+  }
+
+ public:
+  //! Take dirty pages and sync them, return synced bytes
+  int sync(size_t *synced_bytes) {
+    *synced_bytes = 0U;
+    const void *data = nullptr;
+    size_t capacity = block_->capacity();
+    if (capacity == 0U) {
+      return 0;
+    }
+    if (block_->read(0, &data, capacity) != capacity || data == nullptr) {
+      return ErrorCode_ReadData;
+    }
+
+    // Consecutive dirty pages are synced as one range
+    size_t begin = page_count_;
+    for (size_t i = 0; i < pages_.size(); i++) {
+      uint64_t bits = pages_[i].exchange(0U, std::memory_order_acq_rel);
+      for (size_t j = 0; j < 64U; j++) {
+        size_t page = i * 64U + j;
+        bool dirty = (bits >> j) & 1U;
+        if (dirty && begin == page_count_) {
+          begin = page;
+        } else if (!dirty && begin != page_count_) {
+          int ret = this->sync_range(data, begin, page, synced_bytes);
+          if (ret != 0) {
+            return ret;
+          }
+          begin = page_count_;
+        }
+      }
+    }
+    if (begin != page_count_) {
+      return this->sync_range(data, begin, page_count_, synced_bytes);
+    }
+    return 0;
+  }
+
+  //! Return bytes of dirty pages, without taking them
+  size_t dirty_bytes() const {
+    size_t bytes = 0U;
+    for (auto &bits : pages_) {
+      uint64_t dirty = bits.load(std::memory_order_acquire);
+      bytes += __builtin_popcountll(dirty) * PAGE_SIZE;
+    }
+    return bytes;
+  }
+
+  //! Take dirty pages, return their bytes
+  size_t clear() {
+    size_t bytes = 0U;
+    for (auto &bits : pages_) {
+      uint64_t taken = bits.exchange(0U, std::memory_order_acq_rel);
+      bytes += __builtin_popcountll(taken) * PAGE_SIZE;
+    }
+    return bytes;
+  }
+
+ private:
+  //! Mark pages of written range dirty
+  void mark(size_t offset, size_t len) {
+    size_t first = offset / PAGE_SIZE;
+    size_t last = (offset + len - 1) / PAGE_SIZE;
+    if (last >= page_count_) {
+      owner_->mark_meta_dirty();
+      last = page_count_ - 1;
+    }
+    for (size_t page = first; page <= last; page++) {
+      pages_[page / 64U].fetch_or(1UL << (page % 64U),
+                                  std::memory_order_release);
+    }
+  }
+
+  //! Sync pages [begin, end), aligned to system pages
+  int sync_range(const void *data, size_t begin, size_t end,
+                 size_t *synced_bytes) {
+    static const uintptr_t system_page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t start = reinterpret_cast<uintptr_t>(data) + begin * PAGE_SIZE;
+    uintptr_t stop = std::min(
+        reinterpret_cast<uintptr_t>(data) + end * PAGE_SIZE,
+        reinterpret_cast<uintptr_t>(data) + block_->capacity());
+    start &= ~(system_page_size - 1);
+
+    while (start < stop) {
+      size_t len = std::min<size_t>(stop - start, SYNC_CHUNK_SIZE);
+      if (msync(reinterpret_cast<void *>(start), len, MS_SYNC) != 0) {
+        LOG_ERROR("Sync dirty range failed. len[%zu] errno[%d] what[%s]", len,
+                  errno, std::strerror(errno));
+        return ErrorCode_RuntimeError;
+      }
+      *synced_bytes += len;
+      start += len;
+    }
+    return 0;
+  }
+
+ private:
+  IndexBlockPtr block_{};
+  DirtyRangeStorage *owner_{nullptr};
+  size_t page_count_{0U};
+  std::vector<std::atomic<uint64_t>> pages_;
+};
+
+void DirtyRangeStorage::SetFlushRate(uint32_t kb_per_second) {
+  std::lock_guard<std::mutex> lock(limiter_mutex_);
+  if (kb_per_second == 0U) {
+    limiter_.reset();
+  } else {
+    limiter_ = ailego::RateLimiter::Create(kb_per_second);
+  }
+}
+
+uint32_t DirtyRangeStorage::FlushRate() {
+  std::lock_guard<std::mutex> lock(limiter_mutex_);
+  return limiter_ ? static_cast<uint32_t>(limiter_->get_rate() + 0.5) : 0U;
+}
+
+void DirtyRangeStorage::Throttle(size_t bytes) {
+  if (!throttled_ || bytes == 0U) {
+    return;
+  }
+
+  ailego::RateLimiter::Pointer limiter;
+  {
+    std::lock_guard<std::mutex> lock(limiter_mutex_);
+    limiter = limiter_;
+  }
+  if (!limiter) {
+    return;
+  }
+
+  // A token is a KB
+  size_t permits = (bytes + 1023U) / 1024U;
+  while (permits > 0U) {
+    int acquired = static_cast<int>(
+        std::min<size_t>(permits, std::numeric_limits<int>::max()));
+    limiter->acquire(acquired);
+    permits -= acquired;
+  }
+}
+
+std::vector<std::shared_ptr<DirtyRangeStorage::Block>>
+DirtyRangeStorage::get_blocks() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::shared_ptr<Block>> blocks;
+  blocks.reserve(blocks_.size());
+  for (auto &it : blocks_) {
+    blocks.emplace_back(it.second);
+  }
+  return blocks;
+}
+
+size_t DirtyRangeStorage::dirty_bytes() {
+  size_t bytes = 0U;
+  for (auto &block : this->get_blocks()) {
+    bytes += block->dirty_bytes();
+  }
+  if (meta_dirty_ || size_dirty_) {
+    bytes += META_SIZE;
+  }
+  return bytes;
+}
+
+int DirtyRangeStorage::flush(void) {
+  std::vector<std::shared_ptr<Block>> blocks = this->get_blocks();
+
+  // Block metas changed, let storage sync them with all data
+  if (meta_dirty_.exchange(false)) {
+    size_dirty_ = false;
+    size_t bytes = META_SIZE;
+    for (auto &block : blocks) {
+      bytes += block->clear();
+    }
+    int ret = storage_->flush();
+    if (ret != 0) {
+      meta_dirty_ = true;
+      return ret;
+    }
+    flushed_bytes_ += bytes;
+    return 0;
+  }
+
+  bool size_dirty = size_dirty_.exchange(false);
+  for (auto &block : blocks) {
+    size_t synced_bytes = 0U;
+    int ret = block->sync(&synced_bytes);
+    flushed_bytes_ += synced_bytes;
+    if (ret != 0) {
+      // Dirty pages taken are lost, fall back to sync all
+      LOG_WARN("Sync dirty ranges failed, flush whole storage.");
+      return storage_->flush();
+    }
+  }
+
+  // Data sizes grown are kept in storage metas, appended ranges are
+  // synced already, so storage flush only writes meta pages
+  if (size_dirty) {
+    int ret = storage_->flush();
+    if (ret != 0) {
+      size_dirty_ = true;
+      return ret;
+    }
+    flushed_bytes_ += META_SIZE;
+  }
+  return 0;
+}
+
+int DirtyRangeStorage::close(void) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_.clear();
+  }
+  return storage_->close();
+}
+
+IndexBlockPtr DirtyRangeStorage::get(const std::string &id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = blocks_.find(id);
+  if (it != blocks_.end()) {
+    return it->second;
+  }
+
+  IndexBlockPtr block = storage_->get(id);
+  if (!block) {
+    return block;
+  }
+  auto dirty_block = std::make_shared<Block>(block, this);
+  blocks_.emplace(id, dirty_block);
+  return dirty_block;
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
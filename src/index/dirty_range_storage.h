@@ -0,0 +1,186 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Storage flushing only dirty pages of its blocks
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <ailego/algorithm/rate_limiter.h>
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * DirtyRangeStorage decorates a mmap storage, pages written by blocks
+ * are marked dirty, and flush only syncs dirty page ranges. Storage is
+ * flushed as a whole only when block metas changed, by appending or
+ * resizing blocks. Writes growing data size are synced as dirty ranges
+ * too, then storage metas keeping data sizes are synced, which are the
+ * only pages left dirty. It only fits stores writing their blocks by
+ * Segment::write, never through pointers returned by read.
+ *
+ * Throttled threads wait for tokens of dirty bytes before flushing, and
+ * all storages share one token bucket, so routine flush spreads I/O
+ * instead of bursting, without holding locks while waiting.
+ */
+class DirtyRangeStorage : public IndexStorage {
+ public:
+  //! Granularity of dirty tracking
+  static constexpr size_t PAGE_SIZE = 4096U;
+
+  //! Max bytes synced by one msync
+  static constexpr size_t SYNC_CHUNK_SIZE = 1024U * 1024U;
+
+  //! Bytes charged for syncing storage metas
+  static constexpr size_t META_SIZE = PAGE_SIZE;
+
+  //! Constructor
+  explicit DirtyRangeStorage(IndexStoragePtr storage)
+      : storage_(std::move(storage)) {}
+
+  //! Destructor
+  ~DirtyRangeStorage() override = default;
+
+  //! Set flushed KB per second of throttled threads, 0 means unlimited
+  static void SetFlushRate(uint32_t kb_per_second);
+
+  //! Return flushed KB per second, 0 means unlimited
+  static uint32_t FlushRate();
+
+  //! Wait for tokens of bytes if current thread is throttled, called
+  //! with dirty bytes before flushing, never with locks held
+  static void Throttle(size_t bytes);
+
+  /*
+   * Current thread is throttled within the scope, used by routine flush
+   * thread
+   */
+  class ThrottleScope {
+   public:
+    ThrottleScope() {
+      throttled_ = true;
+    }
+
+    ~ThrottleScope() {
+      throttled_ = false;
+    }
+  };
+
+ public:
+  //! Initialize storage
+  int init(const IndexParams &params) override {
+    return storage_->init(params);
+  }
+
+  //! Cleanup storage
+  int cleanup(void) override {
+    return storage_->cleanup();
+  }
+
+  //! Open storage
+  int open(const std::string &path, bool create) override {
+    meta_dirty_ = true;
+    return storage_->open(path, create);
+  }
+
+  //! Flush dirty page ranges, or whole storage if block metas changed
+  int flush(void) override;
+
+  //! Close storage
+  int close(void) override;
+
+  //! Append a block into storage
+  int append(const std::string &id, size_t size) override {
+    int ret = storage_->append(id, size);
+    meta_dirty_ = true;
+    return ret;
+  }
+
+  //! Refresh meta information (checksum, update time, etc.)
+  void refresh(uint64_t check_point) override {
+    storage_->refresh(check_point);
+    meta_dirty_ = true;
+  }
+
+  //! Retrieve check point of storage
+  uint64_t check_point(void) const override {
+    return storage_->check_point();
+  }
+
+  //! Retrieve a block by id
+  IndexBlockPtr get(const std::string &id) override;
+
+  //! Test if a block exists
+  bool has(const std::string &id) const override {
+    return storage_->has(id);
+  }
+
+  //! Retrieve magic number of index
+  uint32_t magic(void) const override {
+    return storage_->magic();
+  }
+
+ public:
+  //! Return bytes flushed since opened
+  size_t flushed_bytes() const {
+    return flushed_bytes_.load(std::memory_order_relaxed);
+  }
+
+  //! Return bytes next flush would sync
+  size_t dirty_bytes();
+
+  //! Mark block metas changed, next flush syncs whole storage
+  void mark_meta_dirty() {
+    meta_dirty_ = true;
+  }
+
+  //! Mark data size of a block grown, next flush syncs storage metas
+  //! after dirty ranges
+  void mark_size_dirty() {
+    size_dirty_ = true;
+  }
+
+ private:
+  class Block;
+
+  //! Return all blocks retrieved
+  std::vector<std::shared_ptr<Block>> get_blocks();
+
+ private:
+  static thread_local bool throttled_;
+  static std::mutex limiter_mutex_;
+  static ailego::RateLimiter::Pointer limiter_;
+
+  IndexStoragePtr storage_{};
+  std::mutex mutex_{};
+  std::map<std::string, std::shared_ptr<Block>> blocks_{};
+  std::atomic<bool> meta_dirty_{true};
+  std::atomic<bool> size_dirty_{false};
+  std::atomic<size_t> flushed_bytes_{0U};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -21,6 +21,9 @@
 #pragma once
 
 #include <stdint.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <ailego/io/file.h>
 #include <ailego/utility/file_helper.h>
@@ -119,6 +122,37 @@ class FileHelper {
     return ailego::File::IsExist(dir_path);
   }
 
+  //! Create a hard link of file, fail if across file systems
+  static bool LinkFile(const std::string &src_path,
+                       const std::string &dst_path) {
+    return ::link(src_path.c_str(), dst_path.c_str()) == 0;
+  }
+
+  //! Copy file content to a new file
+  static bool CopyFile(const std::string &src_path,
+                       const std::string &dst_path) {
+    std::ifstream src(src_path, std::ios::binary);
+    std::ofstream dst(dst_path, std::ios::binary | std::ios::trunc);
+    if (!src.is_open() || !dst.is_open()) {
+      return false;
+    }
+    dst << src.rdbuf();
+    dst.flush();
+    return dst.good();
+  }
+
+  //! Rename file atomically, replace destination if exists
+  static bool RenameFile(const std::string &src_path,
+                         const std::string &dst_path) {
+    return ::rename(src_path.c_str(), dst_path.c_str()) == 0;
+  }
+
+  //! Create an empty file if not exists
+  static bool TouchFile(const std::string &file_path) {
+    std::ofstream file(file_path, std::ios::binary | std::ios::app);
+    return file.is_open();
+  }
+
   //! Return file size
   static size_t FileSize(const std::string &file_path) {
     return ailego::FileHelper::FileSize(file_path.c_str());
@@ -0,0 +1,131 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of huge page helpers
+ */
+
+#include "huge_page_helper.h"
+#include <sys/mman.h>
+#include <cerrno>
+#include <aitheta2/index_format.h>
+
+namespace proxima {
+namespace be {
+namespace index {
+
+// Padding block which moves the first block to huge page boundary
+static const std::string HUGE_PAGE_PADDING_BLOCK = "HugePagePadding";
+
+size_t HugePageHelper::Advise(const void *addr, size_t len, bool collapse) {
+  uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t end = start + len;
+  uintptr_t aligned_start = AlignUp(start);
+  uintptr_t aligned_end = end & ~(HUGE_PAGE_SIZE - 1);
+  if (addr == nullptr || aligned_start >= aligned_end) {
+    return 0U;
+  }
+
+  void *aligned_addr = reinterpret_cast<void *>(aligned_start);
+  size_t aligned_len = aligned_end - aligned_start;
+
+  // Advice is best effort, kernels without THP just keep 4K pages
+  if (madvise(aligned_addr, aligned_len, MADV_HUGEPAGE) != 0) {
+    LOG_DEBUG("Advise huge page failed. len[%zu] errno[%d]", aligned_len,
+              errno);
+    return 0U;
+  }
+
+#ifdef MADV_COLLAPSE
+  if (collapse && madvise(aligned_addr, aligned_len, MADV_COLLAPSE) != 0) {
+    LOG_DEBUG("Collapse huge page failed. len[%zu] errno[%d]", aligned_len,
+              errno);
+  }
+#else
+  (void)collapse;
+#endif
+
+  return aligned_len;
+}
+
+size_t HugePageHelper::AdviseContainer(const IndexContainerPtr &container,
+                                       bool collapse) {
+  size_t advised_size = 0U;
+  for (auto &it : container->get_all()) {
+    auto &block = it.second;
+    const void *data = nullptr;
+    size_t data_size = block->data_size();
+    if (data_size == 0U || block->read(0, &data, data_size) != data_size) {
+      continue;
+    }
+    advised_size += Advise(data, data_size, collapse);
+  }
+  return advised_size;
+}
+
+IndexBlockPtr HugePageStorage::get(const std::string &id) {
+  IndexBlockPtr block = storage_->get(id);
+  if (!block) {
+    return block;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (advised_blocks_.find(id) == advised_blocks_.end()) {
+    const void *data = nullptr;
+    size_t capacity = block->capacity();
+    if (capacity > 0U && block->read(0, &data, capacity) == capacity) {
+      HugePageHelper::Advise(data, capacity, false);
+    }
+    advised_blocks_.emplace(id);
+  }
+  return block;
+}
+
+int HugePageDumper::create(const std::string &path) {
+  int ret = dumper_->create(path);
+  if (ret != 0) {
+    return ret;
+  }
+
+  // Underlying dumper writes meta header at creation
+  file_offset_ = sizeof(aitheta2::IndexFormat::MetaHeader);
+  size_t padding_size = this->pad_to_boundary();
+  return dumper_->append(HUGE_PAGE_PADDING_BLOCK, 0U, padding_size, 0U);
+}
+
+int HugePageDumper::append(const std::string &id, size_t data_size,
+                           size_t padding_size, uint32_t crc) {
+  // Data of block has been written, pad the tail so that next block
+  // starts at huge page boundary
+  size_t extra_padding_size = this->pad_to_boundary();
+  return dumper_->append(id, data_size, padding_size + extra_padding_size,
+                         crc);
+}
+
+size_t HugePageDumper::pad_to_boundary() {
+  size_t padding_size = HugePageHelper::AlignUp(file_offset_) - file_offset_;
+  if (padding_size == 0U) {
+    return 0U;
+  }
+
+  std::string padding(padding_size, '\0');
+  return this->write(padding.data(), padding.size());
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -0,0 +1,195 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Helpers to back index memory with transparent huge pages
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * This helper class wrappers huge page advice of index memory
+ */
+class HugePageHelper {
+ public:
+  //! Size of a huge page
+  static constexpr size_t HUGE_PAGE_SIZE = 2UL * 1024UL * 1024UL;
+
+  //! Align size up to huge page size
+  static size_t AlignUp(size_t size) {
+    return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  }
+
+  //! Advise huge pages for the huge page aligned part of memory, and
+  //! collapse already populated pages synchronously if asked.
+  //! Return advised bytes
+  static size_t Advise(const void *addr, size_t len, bool collapse);
+
+  //! Advise huge pages for all blocks of a loaded container
+  static size_t AdviseContainer(const IndexContainerPtr &container,
+                                bool collapse);
+};
+
+/*
+ * HugePageStorage decorates a storage, memory of every block is advised
+ * to use huge pages once it's appended or first retrieved. Streamer
+ * chunks of memory segment are blocks of the storage.
+ */
+class HugePageStorage : public IndexStorage {
+ public:
+  //! Constructor
+  explicit HugePageStorage(IndexStoragePtr storage)
+      : storage_(std::move(storage)) {}
+
+  //! Destructor
+  ~HugePageStorage() override = default;
+
+ public:
+  //! Initialize storage
+  int init(const IndexParams &params) override {
+    return storage_->init(params);
+  }
+
+  //! Cleanup storage
+  int cleanup(void) override {
+    return storage_->cleanup();
+  }
+
+  //! Open storage
+  int open(const std::string &path, bool create) override {
+    return storage_->open(path, create);
+  }
+
+  //! Flush storage
+  int flush(void) override {
+    return storage_->flush();
+  }
+
+  //! Close storage
+  int close(void) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    advised_blocks_.clear();
+    return storage_->close();
+  }
+
+  //! Append a block into storage
+  int append(const std::string &id, size_t size) override {
+    int ret = storage_->append(id, size);
+    if (ret == 0) {
+      this->get(id);
+    }
+    return ret;
+  }
+
+  //! Refresh meta information (checksum, update time, etc.)
+  void refresh(uint64_t check_point) override {
+    storage_->refresh(check_point);
+  }
+
+  //! Retrieve check point of storage
+  uint64_t check_point(void) const override {
+    return storage_->check_point();
+  }
+
+  //! Retrieve a block by id
+  IndexBlockPtr get(const std::string &id) override;
+
+  //! Test if a block exists
+  bool has(const std::string &id) const override {
+    return storage_->has(id);
+  }
+
+  //! Retrieve magic number of index
+  uint32_t magic(void) const override {
+    return storage_->magic();
+  }
+
+ private:
+  IndexStoragePtr storage_{};
+  std::mutex mutex_{};
+  std::unordered_set<std::string> advised_blocks_{};
+};
+
+/*
+ * HugePageDumper decorates a dumper, and pads blocks so that every block
+ * of the index file starts at a huge page aligned file offset. Huge page
+ * aligned blocks can be mapped by file huge pages.
+ */
+class HugePageDumper : public aitheta2::IndexDumper {
+ public:
+  //! Constructor
+  explicit HugePageDumper(IndexDumperPtr dumper)
+      : dumper_(std::move(dumper)) {}
+
+  //! Destructor
+  ~HugePageDumper() override = default;
+
+ public:
+  //! Initialize dumper
+  int init(const IndexParams &params) override {
+    return dumper_->init(params);
+  }
+
+  //! Cleanup dumper
+  int cleanup(void) override {
+    return dumper_->cleanup();
+  }
+
+  //! Create a file, and pad file header to the first huge page boundary
+  int create(const std::string &path) override;
+
+  //! Close file
+  int close(void) override {
+    return dumper_->close();
+  }
+
+  //! Append a block meta, and pad the block to huge page boundary
+  int append(const std::string &id, size_t data_size, size_t padding_size,
+             uint32_t crc) override;
+
+  //! Write data to the storage
+  size_t write(const void *data, size_t len) override {
+    size_t written = dumper_->write(data, len);
+    file_offset_ += written;
+    return written;
+  }
+
+  //! Retrieve magic number of index
+  uint32_t magic(void) const override {
+    return dumper_->magic();
+  }
+
+ private:
+  //! Write zeros to next huge page boundary, return padding size
+  size_t pad_to_boundary();
+
+ private:
+  IndexDumperPtr dumper_{};
+  size_t file_offset_{0U};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -50,10 +50,20 @@ IDMap::~IDMap() {
 int IDMap::open(const ReadOptions &read_options) {
   CHECK_STATUS(opened_, false);
 
+  ReadOptions options = read_options;
+  options.dirty_range_flush = true;
   int ret = Snapshot::CreateAndOpen(collection_path_, FileID::ID_FILE,
-                                    read_options, &snapshot_);
+                                    options, &snapshot_);
   CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
 
+  // Followers wait for writer to upgrade key mappings
+  if (!read_options.read_only &&
+      !PersistHashMap<uint64_t, KeyEntry>::MatchLayout(snapshot_->data()) &&
+      PersistHashMap<uint64_t, idx_t>::MatchLayout(snapshot_->data())) {
+    ret = this->upgrade(options);
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Upgrade key mappings failed.");
+  }
+
   ret = key_map_.mount(snapshot_->data());
   CHECK_RETURN_WITH_CLOG(ret, 0, "Mount snapshot failed.");
 
@@ -78,30 +88,70 @@ int IDMap::close() {
   if (ret != 0) {
     LOG_WARN("Close snapshot failed.");
   }
+  lsn_migration_needed_ = false;
 
   opened_ = false;
   CLOG_DEBUG("Closed id map.");
   return ret;
 }
 
+int IDMap::reload(const ReadOptions &read_options) {
+  CHECK_STATUS(opened_, true);
+
+  SnapshotPtr snapshot;
+  int ret = Snapshot::CreateAndOpen(collection_path_, FileID::ID_FILE,
+                                    read_options, &snapshot);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
+
+  ret = key_map_.remount(snapshot->data());
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Remount snapshot failed.");
+
+  snapshot_.swap(snapshot);
+  snapshot->close();
+  return 0;
+}
+
 int IDMap::insert(uint64_t key, idx_t doc_id) {
   CHECK_STATUS(opened_, true);
 
-  int ret = key_map_.emplace(key, doc_id);
+  KeyEntry entry;
+  entry.doc_id = doc_id;
+  int ret = key_map_.emplace(key, entry);
   CHECK_RETURN(ret, 0);
   return 0;
 }
 
+int IDMap::insert(const std::vector<uint64_t> &keys,
+                  const std::vector<idx_t> &doc_ids,
+                  const std::vector<uint64_t> &lsns, std::vector<int> *codes) {
+  CHECK_STATUS(opened_, true);
+
+  std::vector<KeyEntry> entries(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    entries[i].doc_id = doc_ids[i];
+    entries[i].lsn = lsns[i];
+  }
+  key_map_.emplace(keys, entries, codes);
+  return 0;
+}
+
 bool IDMap::has(uint64_t key) const {
   return key_map_.has(key);
 }
 
 idx_t IDMap::get_mapping_id(uint64_t key) const {
-  idx_t doc_id = INVALID_DOC_ID;
-  if (key_map_.has(key)) {
-    key_map_.get(key, &doc_id);
+  KeyEntry entry;
+  key_map_.get(key, &entry);
+  return entry.doc_id;
+}
+
+bool IDMap::get_lsn(uint64_t key, uint64_t *lsn) const {
+  KeyEntry entry;
+  if (key_map_.get(key, &entry) != 0 || entry.lsn == 0U) {
+    return false;
   }
-  return doc_id;
+  *lsn = entry.lsn;
+  return true;
 }
 
 void IDMap::remove(uint64_t key) {
@@ -110,6 +160,74 @@ void IDMap::remove(uint64_t key) {
   }
 }
 
+int IDMap::remove_range(idx_t min_doc_id, idx_t max_doc_id,
+                        size_t *removed_count) {
+  CHECK_STATUS(opened_, true);
+
+  return key_map_.erase_if(
+      [min_doc_id, max_doc_id](uint64_t, const KeyEntry &entry) {
+        return entry.doc_id >= min_doc_id && entry.doc_id <= max_doc_id;
+      },
+      removed_count);
+}
+
+int IDMap::upgrade(const ReadOptions &read_options) {
+  std::vector<std::pair<uint64_t, idx_t>> pairs;
+  {
+    PersistHashMap<uint64_t, idx_t> legacy_map;
+    int ret = legacy_map.mount(snapshot_->data());
+    CHECK_RETURN(ret, 0);
+    pairs.reserve(legacy_map.size());
+    ret = legacy_map.for_each([&pairs](uint64_t key, idx_t doc_id) {
+      pairs.emplace_back(key, doc_id);
+    });
+    CHECK_RETURN(ret, 0);
+  }
+
+  // Key mappings are rewritten into a new file, which replaces the old
+  // one atomically, so a crash in between leaves the old file intact
+  ReadOptions options = read_options;
+  options.create_new = true;
+  SnapshotPtr snapshot;
+  int ret = Snapshot::CreateAndOpen(collection_path_, FileID::ID_FILE, 0U,
+                                    "upgrade", options, &snapshot);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open upgrade snapshot failed.");
+
+  PersistHashMap<uint64_t, KeyEntry> key_map;
+  ret = key_map.mount(snapshot->data());
+  CHECK_RETURN(ret, 0);
+  ret = key_map.reserve(pairs.size());
+  CHECK_RETURN(ret, 0);
+  for (auto &it : pairs) {
+    KeyEntry entry;
+    entry.doc_id = it.second;
+    ret = key_map.emplace(it.first, entry);
+    CHECK_RETURN(ret, 0);
+  }
+  key_map.unmount();
+
+  ret = snapshot->flush();
+  CHECK_RETURN(ret, 0);
+  ret = snapshot->close();
+  CHECK_RETURN(ret, 0);
+  ret = snapshot_->close();
+  CHECK_RETURN(ret, 0);
+  if (!FileHelper::RenameFile(snapshot->file_path(), snapshot_->file_path())) {
+    CLOG_ERROR("Rename upgraded id map failed. file_path[%s]",
+               snapshot->file_path().c_str());
+    return ErrorCode_RuntimeError;
+  }
+
+  snapshot_.reset();
+  ret = Snapshot::CreateAndOpen(collection_path_, FileID::ID_FILE,
+                                read_options, &snapshot_);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
+
+  lsn_migration_needed_ = !pairs.empty();
+  CLOG_INFO("Upgraded key mappings of id map. key_count[%zu]", pairs.size());
+  return 0;
+}
+
 }  // end namespace index
 }  // namespace be
 }  // end namespace proxima
@@ -33,8 +33,20 @@ namespace index {
 class IDMap;
 using IDMapPtr = std::shared_ptr<IDMap>;
 
+/*
+ * Value of a key in id map
+ */
+struct KeyEntry {
+  idx_t doc_id{INVALID_DOC_ID};
+  // Lsn last applied to the key, unknown if it's 0
+  uint64_t lsn{0U};
+};
+
 /*
  * IDMap is responsible for recording pk->doc_id pair in the collection.
+ * Lsn last applied to each key is kept beside its doc_id, so lsn of a key
+ * can be checked with one probe instead of fetching its forward. Lsn of
+ * a key is unknown if it's 0, such as documents attached or bulk built.
  */
 class IDMap {
  public:
@@ -63,22 +75,83 @@ class IDMap {
   //! Flush memory to persist storage
   int flush();
 
+  //! Return bytes next flush would sync
+  size_t dirty_bytes() const {
+    return snapshot_ ? snapshot_->dirty_bytes() : 0U;
+  }
+
   //! Close persist storage
   int close();
 
+  //! Reload key mappings which are written by another process
+  int reload(const ReadOptions &read_options);
+
  public:
   //! Insert <key, doc_id> pair
   int insert(uint64_t key, idx_t doc_id);
 
+  //! Insert a batch of <key, doc_id> pairs with lsns of them, codes are
+  //! set per pair
+  int insert(const std::vector<uint64_t> &keys,
+             const std::vector<idx_t> &doc_ids,
+             const std::vector<uint64_t> &lsns, std::vector<int> *codes);
+
   //! Remove <key, doc_id> pair
   void remove(uint64_t key);
 
+  //! Remove all pairs whose doc_id is in [min_doc_id, max_doc_id]
+  int remove_range(idx_t min_doc_id, idx_t max_doc_id, size_t *removed_count);
+
+  //! Visit all <key, doc_id> pairs
+  template <typename Visitor>
+  int for_each(Visitor visitor) const {
+    CHECK_STATUS(opened_, true);
+    return key_map_.for_each([&visitor](uint64_t key, const KeyEntry &entry) {
+      visitor(key, entry.doc_id);
+    });
+  }
+
   //! Check doc primary key exist
   bool has(uint64_t key) const;
 
   //! Get doc id by primary key
   idx_t get_mapping_id(uint64_t key) const;
 
+  //! Get lsn last applied to primary key, return false if it's unknown
+  bool get_lsn(uint64_t key, uint64_t *lsn) const;
+
+  //! Return if lsns of existing keys are never recorded, which happens
+  //! when id map is upgraded from an older version
+  bool lsn_migration_needed() const {
+    return lsn_migration_needed_;
+  }
+
+  //! Record lsns of all existing keys, which are resolved by
+  //! resolver(key, &lsn) returning false if lsn can't be resolved
+  template <typename Resolver>
+  int migrate_lsns(Resolver resolver, size_t *migrated_count) {
+    CHECK_STATUS(opened_, true);
+
+    std::vector<std::pair<uint64_t, KeyEntry>> pairs;
+    pairs.reserve(key_map_.size());
+    int ret = key_map_.for_each([&pairs](uint64_t key, const KeyEntry &entry) {
+      pairs.emplace_back(key, entry);
+    });
+    CHECK_RETURN(ret, 0);
+
+    *migrated_count = 0U;
+    for (auto &it : pairs) {
+      if (!resolver(it.first, &it.second.lsn)) {
+        continue;
+      }
+      ret = key_map_.emplace_or_assign(it.first, it.second);
+      CHECK_RETURN(ret, 0);
+      (*migrated_count)++;
+    }
+    lsn_migration_needed_ = false;
+    return snapshot_->flush();
+  }
+
  public:
   //! Return belonged collection name
   const std::string &collection_name() const {
@@ -95,12 +168,18 @@ class IDMap {
     return key_map_.size();
   }
 
+ private:
+  //! Rewrite key mappings laid out by an older version, which keeps only
+  //! doc_id of each key
+  int upgrade(const ReadOptions &read_options);
+
  private:
   std::string collection_name_{};
   std::string collection_path_{};
 
   SnapshotPtr snapshot_{};
-  PersistHashMap<uint64_t, idx_t> key_map_{};
+  PersistHashMap<uint64_t, KeyEntry> key_map_{};
+  bool lsn_migration_needed_{false};
 
   bool opened_{false};
 };
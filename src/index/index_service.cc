@@ -20,6 +20,9 @@
 
 #include "index_service.h"
 #include "common/error_code.h"
+#include "column/compressed_forward.h"
+#include "column/forward_fetcher.h"
+#include "dirty_range_storage.h"
 
 namespace proxima {
 namespace be {
@@ -44,6 +47,12 @@ int IndexService::create_collection(const std::string &collection_name,
 
   ReadOptions read_options;
   read_options.use_mmap = use_mmap_read_;
+  read_options.read_only = read_only_;
+  read_options.huge_page = huge_page_;
+  read_options.load_mode = segment_load_mode_;
+  read_options.forward_on_disk = forward_on_disk_;
+  read_options.forward_compression = forward_compression_;
+  read_options.forward_block_size = forward_block_size_;
 
   /// Notice we add a check action here:
   /// a. the collection index file exists, then we just load it.
@@ -53,6 +62,10 @@ int IndexService::create_collection(const std::string &collection_name,
       FileHelper::MakeFilePath(collection_path, FileID::MANIFEST_FILE);
   if (FileHelper::FileExists(manifest_file_path)) {
     read_options.create_new = false;
+  } else if (read_only_) {
+    LOG_ERROR("Collection index not published by writer yet. collection[%s]",
+              collection_name.c_str());
+    return ErrorCode_ReadOnlyCollection;
   } else {
     read_options.create_new = true;
   }
@@ -64,6 +77,7 @@ int IndexService::create_collection(const std::string &collection_name,
   CHECK_RETURN_WITH_LOG(ret, 0,
                         "Create and open new collection failed. collection[%s]",
                         collection_name.c_str());
+  collection->set_build_pool(build_pool_.get());
 
   collections_.emplace(collection_name, collection);
   LOG_INFO("Create new collection success. collection[%s]",
@@ -98,6 +112,12 @@ int IndexService::load_collections(
 
   ReadOptions read_options;
   read_options.use_mmap = use_mmap_read_;
+  read_options.read_only = read_only_;
+  read_options.huge_page = huge_page_;
+  read_options.load_mode = segment_load_mode_;
+  read_options.forward_on_disk = forward_on_disk_;
+  read_options.forward_compression = forward_compression_;
+  read_options.forward_block_size = forward_block_size_;
   read_options.create_new = false;
 
   int ret = 0;
@@ -108,6 +128,7 @@ int IndexService::load_collections(
         thread_pool_.get(), read_options, &collection);
     CHECK_RETURN_WITH_LOG(ret, 0, "Load collection failed. collection[%s]",
                           collection_names[i].c_str());
+    collection->set_build_pool(build_pool_.get());
 
     collections_.emplace(collection_names[i], collection);
     LOG_INFO("Load collection success. collectoin[%s]",
@@ -126,7 +147,12 @@ int IndexService::drop_collection(const std::string &collection_name) {
     return ErrorCode_InexistentCollection;
   }
 
-  collections_.get(collection_name)->close_and_cleanup();
+  // Index files are owned by writer process in read only mode
+  if (read_only_) {
+    collections_.get(collection_name)->close();
+  } else {
+    collections_.get(collection_name)->close_and_cleanup();
+  }
   collections_.erase(collection_name);
 
   LOG_INFO("Drop collection success. collection[%s]", collection_name.c_str());
@@ -182,7 +208,8 @@ int IndexService::get_latest_lsn(const std::string &collection_name,
 }
 
 int IndexService::write_records(const std::string &collection_name,
-                                const CollectionDatasetPtr &records) {
+                                const CollectionDatasetPtr &records,
+                                WriteSummary *summary) {
   CHECK_STATUS(status_, STARTED);
 
   if (!this->has_collection(collection_name)) {
@@ -191,7 +218,69 @@ int IndexService::write_records(const std::string &collection_name,
     return ErrorCode_InexistentCollection;
   }
 
-  return collections_.get(collection_name)->write_records(*records);
+  return collections_.get(collection_name)->write_records(*records, summary);
+}
+
+int IndexService::commit_records(const std::string &collection_name) {
+  CHECK_STATUS(status_, STARTED);
+
+  if (!group_commit_) {
+    return 0;
+  }
+
+  if (!this->has_collection(collection_name)) {
+    LOG_ERROR("Collection not exist, commit records failed. collection[%s]",
+              collection_name.c_str());
+    return ErrorCode_InexistentCollection;
+  }
+
+  return collections_.get(collection_name)->commit(group_commit_window_);
+}
+
+int IndexService::attach_segments(const std::string &collection_name,
+                                  const std::string &source_path,
+                                  size_t *segment_count) {
+  CHECK_STATUS(status_, STARTED);
+
+  if (!this->has_collection(collection_name)) {
+    LOG_ERROR("Collection not exist, attach segments failed. collection[%s]",
+              collection_name.c_str());
+    return ErrorCode_InexistentCollection;
+  }
+
+  return collections_.get(collection_name)
+      ->attach_segments(source_path, segment_count);
+}
+
+int IndexService::checkpoint_collection(const std::string &collection_name,
+                                        const std::string &checkpoint_path,
+                                        uint64_t *lsn) {
+  CHECK_STATUS(status_, STARTED);
+
+  if (!this->has_collection(collection_name)) {
+    LOG_ERROR("Collection not exist, checkpoint failed. collection[%s]",
+              collection_name.c_str());
+    return ErrorCode_InexistentCollection;
+  }
+
+  return collections_.get(collection_name)->checkpoint(checkpoint_path, lsn);
+}
+
+int IndexService::trace_write(const std::string &collection_name,
+                              uint64_t primary_key, bool enable,
+                              std::vector<uint64_t> *traced_keys) {
+  CHECK_STATUS(status_, STARTED);
+
+  if (!this->has_collection(collection_name)) {
+    LOG_ERROR("Collection not exist, trace write failed. collection[%s]",
+              collection_name.c_str());
+    return ErrorCode_InexistentCollection;
+  }
+
+  auto collection = collections_.get(collection_name);
+  collection->trace_key(primary_key, enable);
+  *traced_keys = collection->traced_keys();
+  return 0;
 }
 
 int IndexService::init_impl() {
@@ -206,22 +295,76 @@ int IndexService::init_impl() {
     return ErrorCode_RuntimeError;
   }
 
+  // Routine tasks hold threads of thread_pool_ all the time, index
+  // columns of a write batch are built in a dedicated pool
+  if (!read_only_ && build_thread_count_ > 1U) {
+    build_pool_ = std::make_shared<ThreadPool>(build_thread_count_, false);
+  }
+
+  if (forward_on_disk_) {
+    int ret = ForwardFetcher::Instance().init(
+        forward_fetch_thread_count_, (size_t)forward_cache_size_ * 1024 * 1024);
+    if (ret != 0) {
+      LOG_ERROR("Init forward fetcher failed.");
+      return ret;
+    }
+  }
+
+  // Blocks of compressed forwards may exist even if compression is
+  // disabled now
+  CompressedForwardCloset::BlockCache().set_capacity(
+      (size_t)forward_block_cache_size_ * 1024 * 1024);
+  WriteTracer::SetSampleRate(write_trace_sample_rate_);
+  DirtyRangeStorage::SetFlushRate(max_flush_speed_ * 1024U);
+
   LOG_INFO("IndexService initialize complete.");
   return 0;
 }
 
 int IndexService::cleanup_impl() {
   thread_count_ = 0U;
+  build_thread_count_ = 0U;
+  build_pool_.reset();
   index_directory_ = "";
   flush_internal_ = 0U;
+  refresh_internal_ = 0U;
   concurrency_ = 0U;
   use_mmap_read_ = false;
+  read_only_ = false;
+  huge_page_ = false;
+  segment_load_mode_ = LoadModes::MMAP;
+  if (forward_on_disk_) {
+    ForwardFetcher::Instance().cleanup();
+  }
+  forward_on_disk_ = false;
+  forward_fetch_thread_count_ = 0U;
+  forward_cache_size_ = 0U;
+  forward_compression_ = CompressionTypes::NONE;
+  forward_block_size_ = 0U;
+  forward_block_cache_size_ = 0U;
+  write_trace_sample_rate_ = 0U;
+  group_commit_ = false;
+  group_commit_window_ = 0U;
+  max_flush_speed_ = 0U;
+  DirtyRangeStorage::SetFlushRate(0U);
+  rebuild_deleted_ratio_ = 0U;
+  rebuild_cpu_ratio_ = 0U;
+  rebuild_min_recall_ = 0U;
 
   LOG_INFO("IndexService cleanup complete.");
   return 0;
 }
 
 int IndexService::start_impl() {
+  if (read_only_) {
+    if (refresh_internal_ > 0U) {
+      thread_pool_->submit(
+          ailego::Closure::New(this, &IndexService::do_routine_refresh));
+    }
+    LOG_INFO("IndexService start complete in read only mode.");
+    return 0;
+  }
+
   if (flush_internal_ > 0U) {
     thread_pool_->submit(
         ailego::Closure::New(this, &IndexService::do_routine_flush));
@@ -245,6 +388,9 @@ int IndexService::stop_impl() {
   optimize_flag_ = false;
   optimize_notifier_.notify();
 
+  refresh_flag_ = false;
+  refresh_notifier_.notify();
+
   thread_pool_->stop();
 
   for (auto &it : collections_) {
@@ -252,6 +398,10 @@ int IndexService::stop_impl() {
   }
   collections_.clear();
 
+  if (build_pool_) {
+    build_pool_->stop();
+  }
+
   LOG_INFO("IndexService stopped.");
   return 0;
 }
@@ -259,9 +409,36 @@ int IndexService::stop_impl() {
 bool IndexService::load_config() {
   auto &config = Config::Instance();
   thread_count_ = config.get_index_dump_thread_count();
+  build_thread_count_ = config.get_index_build_thread_count();
   index_directory_ = config.get_index_directory();
   flush_internal_ = config.get_index_flush_internal();
   optimize_internal_ = config.get_index_optimize_internal();
+  refresh_internal_ = config.get_index_refresh_internal();
+  read_only_ = config.get_index_read_only();
+  huge_page_ = config.get_index_huge_page();
+  std::string load_mode = config.get_index_segment_load_mode();
+  if (load_mode == "heap") {
+    segment_load_mode_ = LoadModes::HEAP;
+  } else if (load_mode == "mmap_locked") {
+    segment_load_mode_ = LoadModes::MMAP_LOCKED;
+  } else {
+    segment_load_mode_ = LoadModes::MMAP;
+  }
+  forward_on_disk_ = config.get_index_forward_on_disk();
+  forward_fetch_thread_count_ = config.get_index_forward_fetch_thread_count();
+  forward_cache_size_ = config.get_index_forward_cache_size();
+  forward_compression_ = config.get_index_forward_compression() == "snappy"
+                             ? CompressionTypes::SNAPPY
+                             : CompressionTypes::NONE;
+  forward_block_size_ = config.get_index_forward_block_size() * 1024U;
+  forward_block_cache_size_ = config.get_index_forward_block_cache_size();
+  write_trace_sample_rate_ = config.get_index_write_trace_sample_rate();
+  group_commit_ = config.get_index_group_commit();
+  group_commit_window_ = config.get_index_group_commit_window();
+  max_flush_speed_ = config.get_index_max_flush_speed();
+  rebuild_deleted_ratio_ = config.get_index_rebuild_deleted_ratio();
+  rebuild_cpu_ratio_ = config.get_index_rebuild_cpu_ratio();
+  rebuild_min_recall_ = config.get_index_rebuild_min_recall();
   concurrency_ =
       config.get_index_build_thread_count() + config.get_query_thread_count();
 
@@ -272,6 +449,10 @@ bool IndexService::load_config() {
 void IndexService::do_routine_flush() {
   flush_flag_ = true;
 
+  // Routine flush shares bytes per second with other collections, commits
+  // of writers are never throttled
+  DirtyRangeStorage::ThrottleScope throttle_scope;
+
   while (true) {
     if (!flush_flag_) {
       LOG_INFO("Exited flush thread");
@@ -279,6 +460,7 @@ void IndexService::do_routine_flush() {
     }
 
     for (auto it : collections_) {
+      it.second->expire();
       it.second->flush();
     }
 
@@ -289,6 +471,13 @@ void IndexService::do_routine_flush() {
 void IndexService::do_routine_optimize() {
   optimize_flag_ = true;
 
+  // Persist segments keeping too many deleted documents in graphs are
+  // rebuilt in background, verified by recall of sampled documents
+  BuildOptions rebuild_options;
+  rebuild_options.cpu_ratio = rebuild_cpu_ratio_ / 100.0f;
+  rebuild_options.sample_count = REBUILD_SAMPLE_COUNT;
+  rebuild_options.min_recall = rebuild_min_recall_ / 100.0f;
+
   while (true) {
     if (!optimize_flag_) {
       LOG_INFO("Exited optimize thread");
@@ -297,12 +486,35 @@ void IndexService::do_routine_optimize() {
 
     for (auto it : collections_) {
       it.second->optimize(thread_pool_);
+      if (rebuild_deleted_ratio_ > 0U) {
+        std::vector<SegmentID> segment_ids;
+        it.second->select_rebuild_segments(rebuild_deleted_ratio_ / 100.0f,
+                                           &segment_ids);
+        it.second->rebuild_segments(segment_ids, rebuild_options);
+      }
     }
 
     optimize_notifier_.wait_for(std::chrono::seconds(optimize_internal_));
   }
 }
 
+void IndexService::do_routine_refresh() {
+  refresh_flag_ = true;
+
+  while (true) {
+    if (!refresh_flag_) {
+      LOG_INFO("Exited refresh thread");
+      break;
+    }
+
+    for (auto it : collections_) {
+      it.second->refresh();
+    }
+
+    refresh_notifier_.wait_for(std::chrono::seconds(refresh_internal_));
+  }
+}
+
 
 }  // end namespace index
 }  // namespace be
@@ -90,7 +90,28 @@ class IndexService : public Service {
 
   //! Write records to some collection
   virtual int write_records(const std::string &collection_name,
-                            const CollectionDatasetPtr &records);
+                            const CollectionDatasetPtr &records,
+                            WriteSummary *summary);
+
+  //! Wait until records written to some collection are synced, returns
+  //! at once if group commit is disabled
+  virtual int commit_records(const std::string &collection_name);
+
+  //! Attach segments built outside to some collection
+  virtual int attach_segments(const std::string &collection_name,
+                              const std::string &source_path,
+                              size_t *segment_count);
+
+  //! Create a point-in-time checkpoint of some collection
+  virtual int checkpoint_collection(const std::string &collection_name,
+                                    const std::string &checkpoint_path,
+                                    uint64_t *lsn);
+
+  //! Start or stop tracing writes of a primary key in some collection,
+  //! and return keys traced after that
+  virtual int trace_write(const std::string &collection_name,
+                          uint64_t primary_key, bool enable,
+                          std::vector<uint64_t> *traced_keys);
 
  protected:
   //! Initialize inner members
@@ -112,22 +133,50 @@ class IndexService : public Service {
 
   void do_routine_optimize();
 
+  void do_routine_refresh();
+
+ private:
+  //! Documents sampled to verify recall of a rebuilt column
+  static constexpr uint32_t REBUILD_SAMPLE_COUNT = 100U;
+
  private:
   ThreadPoolPtr thread_pool_{};
+  ThreadPoolPtr build_pool_{};
   ConcurrentHashMap<std::string, CollectionPtr> collections_{};
 
   std::string index_directory_{};
   uint32_t thread_count_{0U};
+  uint32_t build_thread_count_{0U};
   uint32_t flush_internal_{0U};
   uint32_t optimize_internal_{0U};
   uint32_t concurrency_{0U};
+  uint32_t refresh_internal_{0U};
   bool use_mmap_read_{false};
+  bool read_only_{false};
+  bool huge_page_{false};
+  LoadModes segment_load_mode_{LoadModes::MMAP};
+  bool forward_on_disk_{false};
+  uint32_t forward_fetch_thread_count_{0U};
+  uint32_t forward_cache_size_{0U};
+  CompressionTypes forward_compression_{CompressionTypes::NONE};
+  uint32_t forward_block_size_{0U};
+  uint32_t forward_block_cache_size_{0U};
+  uint32_t write_trace_sample_rate_{0U};
+  bool group_commit_{false};
+  uint32_t group_commit_window_{0U};
+  uint32_t max_flush_speed_{0U};
+  uint32_t rebuild_deleted_ratio_{0U};
+  uint32_t rebuild_cpu_ratio_{0U};
+  uint32_t rebuild_min_recall_{0U};
 
   WaitNotifier flush_notifier_{};
   std::atomic<bool> flush_flag_{false};
 
   WaitNotifier optimize_notifier_{};
   std::atomic<bool> optimize_flag_{false};
+
+  WaitNotifier refresh_notifier_{};
+  std::atomic<bool> refresh_flag_{false};
 };
 
 
@@ -19,6 +19,7 @@
  */
 
 #include "lsn_store.h"
+#include <algorithm>
 #include "common/error_code.h"
 #include "constants.h"
 #include "file_helper.h"
@@ -50,13 +51,22 @@ LsnStore::~LsnStore() {
 int LsnStore::open(const ReadOptions &read_options) {
   CHECK_STATUS(opened_, false);
 
+  ReadOptions options = read_options;
+  options.dirty_range_flush = true;
   int ret = Snapshot::CreateAndOpen(collection_path_, FileID::LSN_FILE,
-                                    read_options, &snapshot_);
+                                    options, &snapshot_);
   CHECK_RETURN_WITH_CLOG(ret, 0, "Create snapshot failed.");
 
   ret = this->mount();
   CHECK_RETURN_WITH_CLOG(ret, 0, "Mount storage failed.");
 
+  // Lsns are appended by another process if read only, always scan them
+  if (!read_options.read_only) {
+    ret = this->recover_latest_lsn();
+    CHECK_RETURN_WITH_CLOG(ret, 0, "Recover latest lsn failed.");
+    tracking_ = true;
+  }
+
   opened_ = true;
   CLOG_DEBUG("Opened lsn store.");
   return 0;
@@ -65,11 +75,22 @@ int LsnStore::open(const ReadOptions &read_options) {
 int LsnStore::flush() {
   CHECK_STATUS(opened_, true);
 
+  {
+    ailego::WriteLock wlock(mutex_);
+    std::lock_guard<ailego::WriteLock> lock(wlock);
+    if (unsynced_count_ > 0U) {
+      int ret = update_header();
+      CHECK_RETURN(ret, 0);
+    }
+  }
   return snapshot_->flush();
 }
 
 int LsnStore::close() {
   CHECK_STATUS(opened_, true);
+  if (unsynced_count_ > 0U) {
+    update_header();
+  }
   this->unmount();
 
   int ret = snapshot_->close();
@@ -88,45 +109,29 @@ int LsnStore::append(uint64_t lsn, const std::string &lsn_context) {
   ailego::WriteLock wlock(mutex_);
   std::lock_guard<ailego::WriteLock> lock(wlock);
 
-  uint64_t expect_write_len =
-      sizeof(uint64_t) + sizeof(uint64_t) + lsn_context.size();
-  if (expect_write_len > kDataBlockSize) {
-    return ErrorCode_ExceedLimit;
-  }
-
-  uint32_t block_index = header_.tail_block_index;
-  auto data_block = data_blocks_[block_index];
+  int ret = this->append_pair(lsn, lsn_context);
+  CHECK_RETURN(ret, 0);
 
-  if (data_block->padding_size() < expect_write_len) {
-    block_index = (block_index + 1) % 2;
-    data_block = data_blocks_[block_index];
-    data_block->resize(0);
-    header_.tail_block_index = block_index;
-    update_header();
-  }
+  return this->commit_header(1U);
+}
 
-  size_t write_len =
-      data_block->write(data_block->data_size(), &lsn, sizeof(uint64_t));
-  if (write_len != sizeof(uint64_t)) {
-    return ErrorCode_WriteData;
-  }
+int LsnStore::append(const std::vector<uint64_t> &lsns,
+                     const std::vector<const std::string *> &lsn_contexts) {
+  CHECK_STATUS(opened_, true);
 
-  uint64_t lsn_context_len = lsn_context.size();
-  write_len = data_block->write(data_block->data_size(), &lsn_context_len,
-                                sizeof(uint64_t));
-  if (write_len != sizeof(uint64_t)) {
-    return ErrorCode_WriteData;
-  }
+  ailego::WriteLock wlock(mutex_);
+  std::lock_guard<ailego::WriteLock> lock(wlock);
 
-  write_len = data_block->write(data_block->data_size(), lsn_context.data(),
-                                lsn_context.size());
-  if (write_len != lsn_context.size()) {
-    return ErrorCode_WriteData;
+  int ret = 0;
+  size_t i = 0;
+  for (; i < lsns.size(); i++) {
+    ret = this->append_pair(lsns[i], *lsn_contexts[i]);
+    if (ret != 0) {
+      break;
+    }
   }
-
-  header_.lsn_count++;
-  update_header();
-  return 0;
+  this->commit_header(i);
+  return ret;
 }
 
 int LsnStore::shift() {
@@ -168,61 +173,141 @@ int LsnStore::shift() {
 int LsnStore::get_latest_lsn(uint64_t *lsn, std::string *lsn_context) {
   CHECK_STATUS(opened_, true);
 
+  if (!tracking_) {
+    return this->scan_latest_lsn(lsn, lsn_context);
+  }
+
   ailego::ReadLock rlock(mutex_);
   std::lock_guard<ailego::ReadLock> lock(rlock);
+  *lsn = latest_lsn_;
+  *lsn_context = latest_context_;
+  return 0;
+}
 
-  ailego::Heap<LSN, std::greater<LSN>> lsn_heap(kWindowSize);
-  // scan lsn data blocks
-  for (size_t i = 0; i < data_blocks_.size(); i++) {
-    auto data_block = data_blocks_[i];
-    uint64_t offset = 0;
-    while (offset < data_block->data_size()) {
-      uint64_t lsn_val = 0U;
-      size_t read_len = data_block->fetch(offset, &lsn_val, sizeof(uint64_t));
-      if (read_len != sizeof(uint64_t)) {
-        return ErrorCode_ReadData;
-      }
-      offset += sizeof(uint64_t);
+int LsnStore::scan_latest_lsn(uint64_t *lsn, std::string *lsn_context) {
+  CHECK_STATUS(opened_, true);
 
-      uint64_t lsn_context_len;
-      read_len = data_block->fetch(offset, &lsn_context_len, sizeof(uint64_t));
-      if (read_len != sizeof(uint64_t)) {
-        return ErrorCode_ReadData;
-      }
-      offset += sizeof(uint64_t);
+  ailego::ReadLock rlock(mutex_);
+  std::lock_guard<ailego::ReadLock> lock(rlock);
 
-      std::string lsn_context_val;
-      lsn_context_val.resize(lsn_context_len);
-      read_len = data_block->fetch(offset, (void *)lsn_context_val.data(),
-                                   lsn_context_len);
-      offset += lsn_context_len;
+  // Window is reused by scans of the same thread
+  static thread_local std::vector<LsnEntry> window;
+  int ret = this->scan_window(&window);
+  CHECK_RETURN(ret, 0);
+
+  // find last lsn before the first gap, or the last one if no gap
+  *lsn = 0U;
+  lsn_context->clear();
+  for (size_t i = 0; i < window.size(); i++) {
+    if (i + 1 == window.size() || window[i + 1].lsn > window[i].lsn + 1) {
+      *lsn = window[i].lsn;
+      lsn_context->assign(window[i].lsn_context, window[i].lsn_context_len);
+      break;
+    }
+  }
+  return 0;
+}
 
-      lsn_heap.emplace(LSN(lsn_val, lsn_context_val));
+int LsnStore::scan_window(std::vector<LsnEntry> *window) const {
+  // Keep the largest kWindowSize lsns in a min heap, contexts are
+  // referenced in data blocks
+  auto greater = [](const LsnEntry &lhs, const LsnEntry &rhs) {
+    return lhs.lsn > rhs.lsn;
+  };
+  window->clear();
+  window->reserve(kWindowSize);
+  for (auto &data_block : data_blocks_) {
+    uint64_t data_size = data_block->data_size();
+    const void *data = nullptr;
+    if (data_size > 0U &&
+        data_block->read(0, &data, data_size) != data_size) {
+      return ErrorCode_ReadData;
+    }
+
+    const char *cursor = reinterpret_cast<const char *>(data);
+    const char *end = cursor + data_size;
+    while (cursor + sizeof(uint64_t) * 2 <= end) {
+      LsnEntry entry;
+      memcpy(&entry.lsn, cursor, sizeof(uint64_t));
+      memcpy(&entry.lsn_context_len, cursor + sizeof(uint64_t),
+             sizeof(uint64_t));
+      entry.lsn_context = cursor + sizeof(uint64_t) * 2;
+      if (entry.lsn_context + entry.lsn_context_len > end) {
+        return ErrorCode_InvalidIndexDataFormat;
+      }
+      cursor = entry.lsn_context + entry.lsn_context_len;
+
+      if (window->size() < kWindowSize) {
+        window->emplace_back(entry);
+        std::push_heap(window->begin(), window->end(), greater);
+      } else if (greater(entry, window->front())) {
+        std::pop_heap(window->begin(), window->end(), greater);
+        window->back() = entry;
+        std::push_heap(window->begin(), window->end(), greater);
+      }
     }
   }
 
   // from small to large
-  std::sort(lsn_heap.begin(), lsn_heap.end());
-
-  // find last not continues lsn
-  LSN max_lsn;
-  bool found = false;
-  for (size_t i = 0; i + 1 < lsn_heap.size(); i++) {
-    if (lsn_heap[i + 1].lsn > lsn_heap[i].lsn + 1) {
-      max_lsn = lsn_heap[i];
-      found = true;
-      break;
-    }
+  std::sort_heap(window->begin(), window->end(), greater);
+  std::reverse(window->begin(), window->end());
+  return 0;
+}
+
+int LsnStore::recover_latest_lsn() {
+  std::vector<LsnEntry> window;
+  int ret = this->scan_window(&window);
+  CHECK_RETURN(ret, 0);
+
+  has_latest_ = false;
+  latest_lsn_ = 0U;
+  latest_context_.clear();
+  pending_lsns_.clear();
+  for (auto &entry : window) {
+    this->track_lsn(
+        entry.lsn, std::string(entry.lsn_context, entry.lsn_context_len));
   }
+  return 0;
+}
 
-  // if not find, just pick up last lsn
-  if (!found && lsn_heap.size() > 0) {
-    max_lsn = *(lsn_heap.rbegin());
+void LsnStore::track_lsn(uint64_t lsn, const std::string &lsn_context) {
+  if (!has_latest_) {
+    has_latest_ = true;
+    latest_lsn_ = lsn;
+    latest_context_ = lsn_context;
+    return;
   }
 
-  *lsn = max_lsn.lsn;
-  *lsn_context = max_lsn.lsn_context;
-  return 0;
+  // Lsns before latest one are applied already
+  if (lsn <= latest_lsn_) {
+    return;
+  }
+  if (lsn == latest_lsn_ + 1) {
+    latest_lsn_ = lsn;
+    latest_context_ = lsn_context;
+    this->advance_latest_lsn();
+    return;
+  }
+
+  // The gap leaves window once kWindowSize lsns are stored after it
+  pending_lsns_.emplace(lsn, lsn_context);
+  if (pending_lsns_.size() >= kWindowSize) {
+    auto it = pending_lsns_.begin();
+    latest_lsn_ = it->first;
+    latest_context_.swap(it->second);
+    pending_lsns_.erase(it);
+    this->advance_latest_lsn();
+  }
+}
+
+void LsnStore::advance_latest_lsn() {
+  while (!pending_lsns_.empty() &&
+         pending_lsns_.begin()->first == latest_lsn_ + 1) {
+    auto it = pending_lsns_.begin();
+    latest_lsn_ = it->first;
+    latest_context_.swap(it->second);
+    pending_lsns_.erase(it);
+  }
 }
 
 int LsnStore::mount() {
@@ -267,17 +352,79 @@ void LsnStore::unmount() {
   header_block_.reset();
   data_blocks_.clear();
   memset(&header_, 0, sizeof(header_));
+  unsynced_count_ = 0U;
+  tracking_ = false;
+  has_latest_ = false;
+  latest_lsn_ = 0U;
+  latest_context_.clear();
+  pending_lsns_.clear();
 }
 
+int LsnStore::append_pair(uint64_t lsn, const std::string &lsn_context) {
+  uint64_t expect_write_len =
+      sizeof(uint64_t) + sizeof(uint64_t) + lsn_context.size();
+  if (expect_write_len > kDataBlockSize) {
+    return ErrorCode_ExceedLimit;
+  }
+
+  uint32_t block_index = header_.tail_block_index;
+  auto data_block = data_blocks_[block_index];
+
+  if (data_block->padding_size() < expect_write_len) {
+    block_index = (block_index + 1) % 2;
+    data_block = data_blocks_[block_index];
+    data_block->resize(0);
+    header_.tail_block_index = block_index;
+    update_header();
+  }
+
+  size_t write_len =
+      data_block->write(data_block->data_size(), &lsn, sizeof(uint64_t));
+  if (write_len != sizeof(uint64_t)) {
+    return ErrorCode_WriteData;
+  }
+
+  uint64_t lsn_context_len = lsn_context.size();
+  write_len = data_block->write(data_block->data_size(), &lsn_context_len,
+                                sizeof(uint64_t));
+  if (write_len != sizeof(uint64_t)) {
+    return ErrorCode_WriteData;
+  }
+
+  write_len = data_block->write(data_block->data_size(), lsn_context.data(),
+                                lsn_context.size());
+  if (write_len != lsn_context.size()) {
+    return ErrorCode_WriteData;
+  }
+
+  header_.lsn_count++;
+  if (tracking_) {
+    this->track_lsn(lsn, lsn_context);
+  }
+  return 0;
+}
+
+
 int LsnStore::update_header() {
   size_t write_len = header_block_->write(0, &header_, sizeof(Header));
   if (write_len != sizeof(Header)) {
     return ErrorCode_WriteData;
   }
 
+  unsynced_count_ = 0U;
   return 0;
 }
 
+int LsnStore::commit_header(size_t append_count) {
+  // Tail block index is persisted at once while switching blocks, only
+  // lsn count may be behind after crash
+  unsynced_count_ += append_count;
+  if (unsynced_count_ < kHeaderSyncCount) {
+    return 0;
+  }
+  return this->update_header();
+}
+
 
 }  // end namespace index
 }  // namespace be
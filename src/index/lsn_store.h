@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <ailego/container/heap.h>
+#include <map>
 #include <ailego/parallel/lock.h>
 #include "common/macro_define.h"
 #include "snapshot.h"
@@ -35,6 +35,10 @@ using LsnStorePtr = std::shared_ptr<LsnStore>;
 
 /*
  * LsnStore is mainly for storage of mysql log sequence number and context.
+ * Latest lsn is the last one before the first gap, among the latest
+ * kWindowSize stored lsns. Writer tracks it in memory as lsns appended,
+ * and it never goes back. Header is persisted once per kHeaderSyncCount
+ * appends, besides switching data blocks, flushing and closing.
  */
 class LsnStore {
  public:
@@ -51,26 +55,12 @@ class LsnStore {
                 "Header must be aligned with 64 bytes");
 
   /*
-   * LSN struct, includes lsn and context
+   * LSN entry in data blocks, context is referenced in place
    */
-  struct LSN {
+  struct LsnEntry {
     uint64_t lsn{0U};
-    std::string lsn_context;
-
-    LSN() = default;
-
-    LSN(uint64_t lsn_val, const std::string &lsn_context_val) {
-      lsn = lsn_val;
-      lsn_context = lsn_context_val;
-    }
-
-    bool operator<(const LSN &other) const {
-      return lsn < other.lsn;
-    }
-
-    bool operator>(const LSN &other) const {
-      return lsn > other.lsn;
-    }
+    const char *lsn_context{nullptr};
+    uint64_t lsn_context_len{0U};
   };
 
  public:
@@ -100,6 +90,11 @@ class LsnStore {
   //! Flush memory to persist storage
   int flush();
 
+  //! Return bytes next flush would sync
+  size_t dirty_bytes() const {
+    return snapshot_ ? snapshot_->dirty_bytes() : 0U;
+  }
+
   //! Close persist storage
   int close();
 
@@ -107,12 +102,19 @@ class LsnStore {
   //! Append <lsn, lsn_context> pair
   int append(uint64_t lsn, const std::string &lsn_context);
 
+  //! Append a batch of <lsn, lsn_context> pairs, header is updated once
+  int append(const std::vector<uint64_t> &lsns,
+             const std::vector<const std::string *> &lsn_contexts);
+
   //! Shift inner segment
   int shift();
 
   //! Get latest lsn and context
   int get_latest_lsn(uint64_t *lsn, std::string *lsn_context);
 
+  //! Get latest lsn and context by scanning data blocks
+  int scan_latest_lsn(uint64_t *lsn, std::string *lsn_context);
+
  public:
   //! Return collection name
   const std::string &collection_name() const {
@@ -136,8 +138,21 @@ class LsnStore {
 
   int update_header();
 
+  int commit_header(size_t append_count);
+
+  int append_pair(uint64_t lsn, const std::string &lsn_context);
+
+  int scan_window(std::vector<LsnEntry> *window) const;
+
+  int recover_latest_lsn();
+
+  void track_lsn(uint64_t lsn, const std::string &lsn_context);
+
+  void advance_latest_lsn();
+
  private:
   static constexpr uint64_t kWindowSize = 2000;
+  static constexpr uint64_t kHeaderSyncCount = 1024;
   static constexpr uint64_t kDataBlockCount = 3;
   static constexpr uint64_t kDataBlockSize = 1UL * 1024UL * 1024UL;
 
@@ -150,8 +165,16 @@ class LsnStore {
   IndexBlockPtr header_block_{};
   std::vector<IndexBlockPtr> data_blocks_{};
   Header header_;
+  size_t unsynced_count_{0U};
   ailego::SharedMutex mutex_{};
 
+  // Latest lsn tracked by writer, and lsns after its following gap
+  bool tracking_{false};
+  bool has_latest_{false};
+  uint64_t latest_lsn_{0U};
+  std::string latest_context_{};
+  std::map<uint64_t, std::string> pending_lsns_{};
+
   bool opened_{false};
 };
 
@@ -0,0 +1,127 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of memory helpers
+ */
+
+#include "memory_helper.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+namespace proxima {
+namespace be {
+namespace index {
+
+static inline size_t PageSize() {
+  static size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+int MemoryHelper::Lock(const void *addr, size_t len) {
+  if (addr == nullptr || len == 0U) {
+    return 0;
+  }
+
+  // mlock rounds address down to page boundary itself
+  if (mlock(addr, len) != 0) {
+    LOG_ERROR(
+        "Lock memory failed, check RLIMIT_MEMLOCK of process. len[%zu] "
+        "errno[%d]",
+        len, errno);
+    return ErrorCode_RuntimeError;
+  }
+  return 0;
+}
+
+size_t MemoryHelper::ResidentSize(const void *addr, size_t len) {
+  if (addr == nullptr || len == 0U) {
+    return 0U;
+  }
+
+  size_t page_size = PageSize();
+  uintptr_t start = reinterpret_cast<uintptr_t>(addr) & ~(page_size - 1);
+  uintptr_t end = reinterpret_cast<uintptr_t>(addr) + len;
+  size_t page_count = (end - start + page_size - 1) / page_size;
+
+  std::vector<unsigned char> pages(page_count);
+  if (mincore(reinterpret_cast<void *>(start), end - start, pages.data()) !=
+      0) {
+    LOG_DEBUG("Probe resident pages failed. len[%zu] errno[%d]", len, errno);
+    return 0U;
+  }
+
+  size_t resident_count = 0U;
+  for (auto page : pages) {
+    resident_count += (page & 1U);
+  }
+  return std::min(resident_count * page_size, len);
+}
+
+int MemoryHelper::LockBlock(const IndexContainerBlockPtr &block) {
+  const void *data = nullptr;
+  size_t data_size = block->data_size();
+  if (block->read(0, &data, data_size) != data_size) {
+    LOG_ERROR("Read block failed. data_size[%zu]", data_size);
+    return ErrorCode_ReadData;
+  }
+  return Lock(data, data_size);
+}
+
+int MemoryHelper::AdviseRandomBlock(const IndexContainerBlockPtr &block) {
+  const void *data = nullptr;
+  size_t data_size = block->data_size();
+  if (data_size == 0U || block->read(0, &data, data_size) != data_size) {
+    return 0;
+  }
+
+  // madvise requires page aligned address
+  uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(PageSize() - 1);
+  uintptr_t end = reinterpret_cast<uintptr_t>(data) + data_size;
+  if (madvise(reinterpret_cast<void *>(start), end - start, MADV_RANDOM) !=
+      0) {
+    LOG_DEBUG("Advise random access failed. len[%zu] errno[%d]", data_size,
+              errno);
+    return ErrorCode_RuntimeError;
+  }
+  return 0;
+}
+
+size_t MemoryHelper::BlockResidentSize(const IndexContainerBlockPtr &block,
+                                       bool use_mmap) {
+  if (!block) {
+    return 0U;
+  }
+
+  size_t data_size = block->data_size();
+  if (!use_mmap) {
+    return data_size;
+  }
+
+  const void *data = nullptr;
+  if (block->read(0, &data, data_size) != data_size) {
+    return 0U;
+  }
+  return ResidentSize(data, data_size);
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
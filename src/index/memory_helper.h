@@ -0,0 +1,56 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Helpers to lock index memory and count its resident size
+ */
+
+#pragma once
+
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * This helper class wrappers residency operations of index memory
+ */
+class MemoryHelper {
+ public:
+  //! Lock pages of memory in RAM
+  static int Lock(const void *addr, size_t len);
+
+  //! Return bytes of memory resident in RAM
+  static size_t ResidentSize(const void *addr, size_t len);
+
+  //! Advise random access of a mapped container block, which disables
+  //! read ahead of it
+  static int AdviseRandomBlock(const IndexContainerBlockPtr &block);
+
+  //! Lock pages of a container block in RAM
+  static int LockBlock(const IndexContainerBlockPtr &block);
+
+  //! Return resident bytes of a container block. Heap blocks are always
+  //! resident, mapped blocks are probed page by page
+  static size_t BlockResidentSize(const IndexContainerBlockPtr &block,
+                                  bool use_mmap);
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
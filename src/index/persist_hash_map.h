@@ -113,6 +113,25 @@ class PersistHashMap {
     return ErrorCode_Success;
   }
 
+  //! Check if blocks of persist storage are laid out with node type of
+  //! this map, storage without any block matches all node types
+  static bool MatchLayout(const IndexStoragePtr &stg) {
+    auto block = stg->get(ailego::StringHelper::Concat(DATA_BLOCK, 0));
+    if (!block) {
+      return true;
+    }
+
+    const void *data = nullptr;
+    if (block->read(0, &data, sizeof(BlockHeader)) != sizeof(BlockHeader)) {
+      return false;
+    }
+    size_t bucket_count = static_cast<const BlockHeader *>(data)->bucket_count;
+    size_t node_count = bucket_count * kLoadFactor;
+    return block->data_size() == sizeof(BlockHeader) +
+                                     bucket_count * sizeof(uint32_t) +
+                                     node_count * sizeof(NodeType);
+  }
+
   //! Unmount persist storage
   void unmount() {
     storage_ = nullptr;
@@ -120,6 +139,16 @@ class PersistHashMap {
     blocks_header_.clear();
   }
 
+  //! Mount a newer persist storage of the same file, readers are blocked
+  //! until it finished
+  int remount(const IndexStoragePtr &stg) {
+    ailego::WriteLock wlock(mutex_);
+    std::lock_guard<ailego::WriteLock> signal_lock(wlock);
+
+    this->unmount();
+    return this->mount(stg);
+  }
+
   //! Reserve
   int reserve(size_t bucket_count) {
     ailego::WriteLock wlock(mutex_);
@@ -135,25 +164,19 @@ class PersistHashMap {
   int emplace(const TKey &key, const TValue &val) {
     ailego::WriteLock wlock(mutex_);
     std::lock_guard<ailego::WriteLock> signal_lock(wlock);
+    return emplace_pair(key, val);
+  }
 
-    size_t block_idx = -1UL;
-    for (int idx = blocks_.size() - 1; idx >= 0; --idx) {
-      if (blocks_header_[idx].free_header != INVALID_NODE_ID) {
-        block_idx = idx;
-        break;
-      }
-    }
-
-    if (ailego_unlikely(block_idx == -1UL)) {
-      int ret = add_block();
-      if (ret < 0) {
-        return ret;
-      }
-      block_idx = ret;
+  //! Emplace a batch of key-value pairs under one lock, codes are set
+  //! per pair
+  void emplace(const std::vector<TKey> &keys, const std::vector<TValue> &vals,
+               std::vector<int> *codes) {
+    ailego::WriteLock wlock(mutex_);
+    std::lock_guard<ailego::WriteLock> signal_lock(wlock);
+    codes->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*codes)[i] = emplace_pair(keys[i], vals[i]);
     }
-
-    int ret = emplace_in_block(block_idx, key, val);
-    return ret;
   }
 
   int emplace_or_assign(const TKey &key, const TValue &val) {
@@ -225,62 +248,160 @@ class PersistHashMap {
                                    const NodeType *pre_node,
                                    uint32_t pre_node_idx, size_t bucket_offset,
                                    size_t block_idx) {
-      auto &block = blocks_[block_idx];
-
-      // free node
-      if (pre_node == nullptr) {
-        if (ailego_unlikely(
-                block->write(bucket_offset, &(node->next), sizeof(uint32_t)) !=
-                sizeof(uint32_t))) {
-          LOG_ERROR("Failed to write bucket content for block idx %zu",
-                    block_idx);
-          return ErrorCode_WriteData;
+      return erase_node(node, node_idx, pre_node, pre_node_idx, bucket_offset,
+                        block_idx);
+    });
+
+    return ret;
+  }
+
+  //! Visit all key-value pairs
+  template <typename Visitor>
+  int for_each(Visitor visitor) const {
+    ailego::ReadLock rlock(mutex_);
+    std::lock_guard<ailego::ReadLock> signal_lock(rlock);
+
+    for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+      auto &block = blocks_[idx];
+      uint32_t bucket_count = blocks_header_[idx].bucket_count;
+      for (uint32_t slot = 0; slot < bucket_count; ++slot) {
+        size_t bucket_offset = sizeof(BlockHeader) + slot * sizeof(uint32_t);
+        const void *data = nullptr;
+        if (ailego_unlikely(block->read(bucket_offset, &data,
+                                        sizeof(uint32_t)) !=
+                            sizeof(uint32_t))) {
+          LOG_ERROR("Failed to read bucket content from block idx %zu", idx);
+          return ErrorCode_ReadData;
         }
-      } else {
-        NodeType writable_node = *pre_node;
-        writable_node.next = node->next;
-        size_t offset =
-            sizeof(BlockHeader) +
-            blocks_header_[block_idx].bucket_count * sizeof(uint32_t) +
-            pre_node_idx * sizeof(NodeType);
-        if (ailego_unlikely(
-                block->write(offset, &writable_node, sizeof(NodeType)) !=
-                sizeof(NodeType))) {
-          LOG_ERROR("Failed to write node content for block idx %zu",
-                    block_idx);
-          return ErrorCode_WriteData;
+
+        uint32_t next = *static_cast<const uint32_t *>(data);
+        while (next != INVALID_NODE_ID) {
+          size_t offset = sizeof(BlockHeader) +
+                          bucket_count * sizeof(uint32_t) +
+                          next * sizeof(NodeType);
+          if (ailego_unlikely(block->read(offset, &data, sizeof(NodeType)) !=
+                              sizeof(NodeType))) {
+            LOG_ERROR("Failed to read node content from block idx %zu", idx);
+            return ErrorCode_ReadData;
+          }
+          const NodeType *node = static_cast<const NodeType *>(data);
+          visitor(node->first, node->second);
+          next = node->next;
         }
       }
+    }
+    return ErrorCode_Success;
+  }
 
-      // recycle node
-      NodeType writable_node = *node;
-      writable_node.next = blocks_header_[block_idx].free_header;
+  //! Erase all pairs matched with predicate in one pass, return erased count
+  template <typename Predicate>
+  int erase_if(Predicate pred, size_t *erased_count) {
+    ailego::WriteLock wlock(mutex_);
+    std::lock_guard<ailego::WriteLock> signal_lock(wlock);
+
+    size_t count = 0;
+    for (size_t idx = 0; idx < blocks_.size(); ++idx) {
+      auto &block = blocks_[idx];
+      uint32_t bucket_count = blocks_header_[idx].bucket_count;
+      for (uint32_t slot = 0; slot < bucket_count; ++slot) {
+        size_t bucket_offset = sizeof(BlockHeader) + slot * sizeof(uint32_t);
+        const void *data = nullptr;
+        if (ailego_unlikely(block->read(bucket_offset, &data,
+                                        sizeof(uint32_t)) !=
+                            sizeof(uint32_t))) {
+          LOG_ERROR("Failed to read bucket content from block idx %zu", idx);
+          return ErrorCode_ReadData;
+        }
+
+        const NodeType *pre_node = nullptr;
+        uint32_t pre_node_idx = INVALID_NODE_ID;
+        uint32_t next = *static_cast<const uint32_t *>(data);
+        while (next != INVALID_NODE_ID) {
+          size_t offset = sizeof(BlockHeader) +
+                          bucket_count * sizeof(uint32_t) +
+                          next * sizeof(NodeType);
+          if (ailego_unlikely(block->read(offset, &data, sizeof(NodeType)) !=
+                              sizeof(NodeType))) {
+            LOG_ERROR("Failed to read node content from block idx %zu", idx);
+            return ErrorCode_ReadData;
+          }
+          const NodeType *node = static_cast<const NodeType *>(data);
+          uint32_t node_idx = next;
+          next = node->next;
+          if (pred(node->first, node->second)) {
+            int ret = erase_node(node, node_idx, pre_node, pre_node_idx,
+                                 bucket_offset, idx);
+            if (ailego_unlikely(ret < 0)) {
+              return ret;
+            }
+            ++count;
+          } else {
+            pre_node = node;
+            pre_node_idx = node_idx;
+          }
+        }
+      }
+    }
+
+    if (erased_count) {
+      *erased_count = count;
+    }
+    return ErrorCode_Success;
+  }
+
+ private:
+  int erase_node(const NodeType *node, uint32_t node_idx,
+                 const NodeType *pre_node, uint32_t pre_node_idx,
+                 size_t bucket_offset, size_t block_idx) {
+    auto &block = blocks_[block_idx];
+
+    // free node
+    if (pre_node == nullptr) {
+      if (ailego_unlikely(
+              block->write(bucket_offset, &(node->next), sizeof(uint32_t)) !=
+              sizeof(uint32_t))) {
+        LOG_ERROR("Failed to write bucket content for block idx %zu",
+                  block_idx);
+        return ErrorCode_WriteData;
+      }
+    } else {
+      NodeType writable_node = *pre_node;
+      writable_node.next = node->next;
       size_t offset =
           sizeof(BlockHeader) +
           blocks_header_[block_idx].bucket_count * sizeof(uint32_t) +
-          node_idx * sizeof(NodeType);
+          pre_node_idx * sizeof(NodeType);
       if (ailego_unlikely(block->write(offset, &writable_node,
                                        sizeof(NodeType)) != sizeof(NodeType))) {
         LOG_ERROR("Failed to write node content for block idx %zu", block_idx);
         return ErrorCode_WriteData;
       }
+    }
 
-      blocks_header_[block_idx].free_header = node_idx;
-      blocks_header_[block_idx].node_count -= 1;
-      if (ailego_unlikely(block->write(0, &blocks_header_[block_idx],
-                                       sizeof(BlockHeader)) !=
-                          sizeof(BlockHeader))) {
-        LOG_ERROR("Failed to write block header for block idx %zu", block_idx);
-        return ErrorCode_WriteData;
-      }
+    // recycle node
+    NodeType writable_node = *node;
+    writable_node.next = blocks_header_[block_idx].free_header;
+    size_t offset = sizeof(BlockHeader) +
+                    blocks_header_[block_idx].bucket_count * sizeof(uint32_t) +
+                    node_idx * sizeof(NodeType);
+    if (ailego_unlikely(block->write(offset, &writable_node,
+                                     sizeof(NodeType)) != sizeof(NodeType))) {
+      LOG_ERROR("Failed to write node content for block idx %zu", block_idx);
+      return ErrorCode_WriteData;
+    }
 
-      return ErrorCode_Success;
-    });
+    blocks_header_[block_idx].free_header = node_idx;
+    blocks_header_[block_idx].node_count -= 1;
+    if (ailego_unlikely(
+            block->write(0, &blocks_header_[block_idx], sizeof(BlockHeader)) !=
+            sizeof(BlockHeader))) {
+      LOG_ERROR("Failed to write block header for block idx %zu", block_idx);
+      return ErrorCode_WriteData;
+    }
 
-    return ret;
+    return ErrorCode_Success;
   }
 
- private:
   size_t constrain_hash(size_t hash, size_t block_capacity) const {
     size_t slot = hash % block_capacity;
     return sizeof(BlockHeader) + slot * sizeof(uint32_t);
@@ -334,6 +455,26 @@ class PersistHashMap {
     return ErrorCode_InexistentKey;
   }
 
+  int emplace_pair(const TKey &key, const TValue &val) {
+    size_t block_idx = -1UL;
+    for (int idx = blocks_.size() - 1; idx >= 0; --idx) {
+      if (blocks_header_[idx].free_header != INVALID_NODE_ID) {
+        block_idx = idx;
+        break;
+      }
+    }
+
+    if (ailego_unlikely(block_idx == -1UL)) {
+      int ret = add_block();
+      if (ret < 0) {
+        return ret;
+      }
+      block_idx = ret;
+    }
+
+    return emplace_in_block(block_idx, key, val);
+  }
+
   int emplace_in_block(size_t block_idx, const TKey &key, const TValue &value) {
     auto &block = blocks_[block_idx];
 
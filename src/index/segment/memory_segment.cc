@@ -23,6 +23,7 @@
 #include <ailego/utility/time_helper.h>
 #include "common/error_code.h"
 #include "../file_helper.h"
+#include "../huge_page_helper.h"
 #include "../typedef.h"
 
 namespace proxima {
@@ -33,7 +34,7 @@ namespace index {
 MemorySegmentPtr MemorySegment::Create(const std::string &collection_name,
                                        const std::string &collection_path,
                                        const SegmentMeta &segment_meta,
-                                       const meta::CollectionMeta *schema,
+                                       const meta::CollectionMetaPtr &schema,
                                        const DeleteStore *delete_store,
                                        const IDMap *id_map,
                                        uint32_t concurrency) {
@@ -44,7 +45,7 @@ MemorySegmentPtr MemorySegment::Create(const std::string &collection_name,
 
 int MemorySegment::CreateAndOpen(
     const std::string &collection_name, const std::string &collection_path,
-    const SegmentMeta &segment_meta, const meta::CollectionMeta *schema,
+    const SegmentMeta &segment_meta, const meta::CollectionMetaPtr &schema,
     const DeleteStore *delete_store, const IDMap *id_map, uint32_t concurrency,
     const ReadOptions &read_options, MemorySegmentPtr *memory_segment) {
   *memory_segment = Create(collection_name, collection_path, segment_meta,
@@ -67,14 +68,21 @@ MemorySegment::~MemorySegment() {
 int MemorySegment::open(const ReadOptions &read_options) {
   CHECK_STATUS(opened_, false);
 
+  huge_page_ = read_options.huge_page;
+
   int ret = open_forward_indexer(read_options);
   CHECK_RETURN(ret, 0);
 
   ret = open_column_indexers(read_options);
   CHECK_RETURN(ret, 0);
 
-  segment_meta_.index_file_count = this->get_index_file_count();
-  segment_meta_.index_file_size = this->get_index_file_size();
+  size_t index_file_count = this->get_index_file_count();
+  size_t index_file_size = this->get_index_file_size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    segment_meta_.index_file_count = index_file_count;
+    segment_meta_.index_file_size = index_file_size;
+  }
 
   opened_ = true;
   SLOG_INFO("Opened memory segment.");
@@ -117,8 +125,13 @@ int MemorySegment::flush() {
     it.second->flush();
   }
 
-  segment_meta_.index_file_count = this->get_index_file_count();
-  segment_meta_.index_file_size = this->get_index_file_size();
+  size_t index_file_count = this->get_index_file_count();
+  size_t index_file_size = this->get_index_file_size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    segment_meta_.index_file_count = index_file_count;
+    segment_meta_.index_file_size = index_file_size;
+  }
   return 0;
 }
 
@@ -136,12 +149,18 @@ int MemorySegment::dump() {
     retry++;
   }
 
-  auto dumper = aitheta2::IndexFactory::CreateDumper("FileDumper");
+  IndexDumperPtr dumper = aitheta2::IndexFactory::CreateDumper("FileDumper");
   if (!dumper) {
     SLOG_ERROR("Create dumper failed.");
     return ErrorCode_RuntimeError;
   }
 
+  // Align blocks to huge page boundary, so that mapped segment file
+  // can be backed by file huge pages
+  if (huge_page_) {
+    dumper = std::make_shared<HugePageDumper>(dumper);
+  }
+
   std::string segment_file_path = FileHelper::MakeFilePath(
       collection_path_, FileID::SEGMENT_FILE, segment_meta_.segment_id);
 
@@ -156,8 +175,12 @@ int MemorySegment::dump() {
 
   dumper->close();
 
-  segment_meta_.index_file_count = 1U;
-  segment_meta_.index_file_size = FileHelper::FileSize(segment_file_path);
+  size_t index_file_size = FileHelper::FileSize(segment_file_path);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    segment_meta_.index_file_count = 1U;
+    segment_meta_.index_file_size = index_file_size;
+  }
   return 0;
 }
 
@@ -184,18 +207,57 @@ int MemorySegment::insert(const Record &record, idx_t *doc_id) {
   AutoCounter ac(active_insert_count_);
 
   // 1. insert into forward indexer first
+  int ret = this->insert_forward(record, doc_id);
+  CHECK_RETURN(ret, 0);
+
+  // 2. insert into column indexers
+  return this->insert_columns(record, *doc_id);
+}
+
+int MemorySegment::insert_forward(const Record &record, idx_t *doc_id) {
+  return this->insert_forward(record, std::string(record.forward_data),
+                              doc_id);
+}
+
+int MemorySegment::insert_forward(Record &&record, idx_t *doc_id) {
+  std::string forward_data = std::move(record.forward_data);
+  return this->insert_forward(record, std::move(forward_data), doc_id);
+}
+
+int MemorySegment::insert_forward(const Record &record,
+                                  std::string &&forward_data, idx_t *doc_id) {
+  CHECK_STATUS(opened_, true);
+
+  AutoCounter ac(active_insert_count_);
+
+  // stamp write time if record not carries one for collection with ttl,
+  // it drives expiry, forwards of other collections are kept as written
+  uint64_t timestamp = record.timestamp;
+  if (timestamp == 0U && schema_->ttl_seconds() > 0U) {
+    timestamp = ailego::Realtime::Seconds();
+  }
+
   ForwardData fwd_data;
   fwd_data.header.primary_key = record.primary_key;
-  fwd_data.header.timestamp = record.timestamp;
+  fwd_data.header.timestamp = timestamp;
   fwd_data.header.lsn = record.lsn;
   fwd_data.header.revision = record.revision;
-  fwd_data.data = std::move(record.forward_data);
+  fwd_data.data = std::move(forward_data);
 
   int ret = forward_indexer_->insert(fwd_data, doc_id);
   CHECK_RETURN_WITH_SLOG(ret, 0, "Insert into forward indexer failed. key[%zu]",
                          (size_t)record.primary_key);
 
-  // 2. insert into column indexers
+  update_stats(record, *doc_id, timestamp);
+  return 0;
+}
+
+int MemorySegment::insert_columns(const Record &record, idx_t doc_id) {
+  CHECK_STATUS(opened_, true);
+
+  AutoCounter ac(active_insert_count_);
+
+  int ret = 0;
   for (size_t i = 0; i < record.column_datas.size(); i++) {
     auto &column_data = record.column_datas[i];
     std::string column_name = column_data.column_name;
@@ -207,17 +269,129 @@ int MemorySegment::insert(const Record &record, idx_t *doc_id) {
     }
 
     auto &column_indexer = column_indexers_.get(column_name);
-    ret = column_indexer->insert(*doc_id, column_data);
+    ret = column_indexer->insert(doc_id, column_data);
     CHECK_RETURN_WITH_SLOG(
         ret, 0, "Insert into column indexer failed. key[%zu] column[%s]",
         (size_t)record.primary_key, column_name.c_str());
   }
 
-  // 3. update segment stats
-  update_stats(record, *doc_id);
   return 0;
 }
 
+//! Check if two records carry the same columns in the same order
+static bool SameColumnLayout(const std::vector<ColumnData> &lhs,
+                             const std::vector<ColumnData> &rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].column_name != rhs[i].column_name) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int MemorySegment::insert_columns(const std::vector<const Record *> &records,
+                                  const std::vector<idx_t> &doc_ids,
+                                  ThreadPool *pool, std::vector<int> *codes,
+                                  std::vector<ColumnBuildStats> *column_stats) {
+  CHECK_STATUS(opened_, true);
+
+  AutoCounter ac(active_insert_count_);
+  codes->assign(records.size(), 0);
+  column_stats->clear();
+  if (records.empty()) {
+    return 0;
+  }
+
+  // Resolve column indexers once per batch, rows of a request share the
+  // column layout of the first row
+  auto &layout = records[0]->column_datas;
+  std::vector<ColumnIndexerPtr> plan;
+  plan.reserve(layout.size());
+  column_stats->resize(layout.size());
+  for (size_t i = 0; i < layout.size(); i++) {
+    auto &column_name = layout[i].column_name;
+    (*column_stats)[i].column_name = column_name;
+    if (column_indexers_.has(column_name)) {
+      plan.emplace_back(column_indexers_.get(column_name));
+    } else {
+      SLOG_ERROR("Not find column indexer. column[%s]", column_name.c_str());
+      plan.emplace_back(nullptr);
+    }
+  }
+  std::vector<bool> planned(records.size(), false);
+  for (size_t i = 0; i < records.size(); i++) {
+    planned[i] = SameColumnLayout(records[i]->column_datas, layout);
+  }
+
+  // Each column keeps its own codes, they are merged after all finished
+  std::vector<std::vector<int>> column_codes(plan.size());
+  if (pool != nullptr && plan.size() > 1U) {
+    auto group = pool->make_group();
+    for (size_t i = 0; i < plan.size(); i++) {
+      if (plan[i]) {
+        group->submit(ailego::Closure::New(
+            this, &MemorySegment::do_insert_column, plan[i], i, &records,
+            &doc_ids, &planned, &column_codes[i], &(*column_stats)[i]));
+      }
+    }
+    group->wait_finish();
+  } else {
+    for (size_t i = 0; i < plan.size(); i++) {
+      if (plan[i]) {
+        this->do_insert_column(plan[i], i, &records, &doc_ids, &planned,
+                               &column_codes[i], &(*column_stats)[i]);
+      }
+    }
+  }
+
+  for (auto &it : column_codes) {
+    for (size_t i = 0; i < it.size(); i++) {
+      if (it[i] != 0) {
+        (*codes)[i] = it[i];
+      }
+    }
+  }
+
+  // Rows with another column layout are inserted one by one
+  for (size_t i = 0; i < records.size(); i++) {
+    if (!planned[i]) {
+      (*codes)[i] = this->insert_columns(*records[i], doc_ids[i]);
+    }
+  }
+  return 0;
+}
+
+void MemorySegment::do_insert_column(ColumnIndexerPtr column_indexer,
+                                     size_t column,
+                                     const std::vector<const Record *> *records,
+                                     const std::vector<idx_t> *doc_ids,
+                                     const std::vector<bool> *planned,
+                                     std::vector<int> *codes,
+                                     ColumnBuildStats *stats) {
+  ailego::ElapsedTime timer;
+  codes->assign(records->size(), 0);
+  for (size_t i = 0; i < records->size(); i++) {
+    if (!(*planned)[i]) {
+      continue;
+    }
+    auto &record = *(*records)[i];
+    int ret =
+        column_indexer->insert((*doc_ids)[i], record.column_datas[column]);
+    if (ret != 0) {
+      SLOG_ERROR("Insert into column indexer failed. key[%zu] column[%s]",
+                 (size_t)record.primary_key, stats->column_name.c_str());
+      (*codes)[i] = ret;
+      continue;
+    }
+    stats->insert_count++;
+  }
+  stats->total_build_us = timer.micro_seconds();
+  stats->max_batch_build_us = stats->total_build_us;
+}
+
 int MemorySegment::remove(idx_t doc_id) {
   CHECK_STATUS(opened_, true);
 
@@ -281,7 +455,7 @@ int MemorySegment::update(idx_t doc_id, const Record &record) {
   fwd_data.header.timestamp = record.timestamp;
   fwd_data.header.lsn = record.lsn;
   fwd_data.header.revision = record.revision;
-  fwd_data.data = std::move(record.forward_data);
+  fwd_data.data = std::move(forward_data);
 
   int ret = forward_indexer_->update(doc_id, fwd_data);
   CHECK_RETURN_WITH_SLOG(ret, 0, "Update forward indexer failed. key[%zu]",
@@ -320,7 +494,7 @@ int MemorySegment::knn_search(const std::string &column_name,
       this->knn_search(column_name, query, query_params, 1, &batch_results);
   CHECK_RETURN(ret, 0);
 
-  (*result) = batch_results[0];
+  (*result) = std::move(batch_results[0]);
   return 0;
 }
 
@@ -335,15 +509,17 @@ int MemorySegment::knn_search(const std::string &column_name,
 
   ailego::ElapsedTime timer;
   uint64_t query_id = query_params.query_id;
-  if (!column_indexers_.has(column_name)) {
-    SLOG_ERROR("Column not exist. query_id[%zu] column[%s]", (size_t)query_id,
-               column_name.c_str());
-    return ErrorCode_InexistentColumn;
+  // Columns are validated by schema in query layer, the dumping segment
+  // keeps columns it was opened with, so column added later is empty
+  ColumnIndexerPtr column_indexer;
+  if (!column_indexers_.find(column_name, &column_indexer)) {
+    SLOG_INFO("Column not built in segment, return empty results. "
+              "query_id[%zu] column[%s]",
+              (size_t)query_id, column_name.c_str());
+    batch_results->resize(batch_count);
+    return 0;
   }
 
-  // check query format
-  auto &column_indexer = column_indexers_.get(column_name);
-
   // search columns
   std::vector<IndexDocumentList> batch_search_results;
   FilterFunction filter = nullptr;
@@ -359,11 +535,14 @@ int MemorySegment::knn_search(const std::string &column_name,
       ret, 0, "Column indexer search failed. query_id[%zu] column[%s]",
       (size_t)query_id, column_name.c_str());
 
-  // fill results
+  // fill results, documents in boundary segment may be expired
+  uint64_t expire_timestamp =
+      this->boundary_expire_timestamp(schema_->ttl_seconds());
   uint32_t res_num = 0U;
   for (size_t i = 0; i < batch_search_results.size(); i++) {
     auto &search_results = batch_search_results[i];
     QueryResultList output_result_list;
+    output_result_list.reserve(search_results.size());
     for (size_t j = 0; j < search_results.size(); j++) {
       idx_t doc_id = search_results[j].key();
       ForwardData fwd_data;
@@ -374,16 +553,24 @@ int MemorySegment::knn_search(const std::string &column_name,
             (size_t)query_id, (size_t)doc_id, column_name.c_str());
         continue;
       }
+      // Closet fetch is the only copy of forward bytes in segment
+      if (query_params.forward_stats) {
+        query_params.forward_stats->add_copy(
+            sizeof(ForwardData::ForwardHeader) + fwd_data.data.size(), true);
+      }
+      if (IsExpired(fwd_data.header.timestamp, expire_timestamp)) {
+        continue;
+      }
       QueryResult res;
       res.primary_key = fwd_data.header.primary_key;
       res.score = search_results[j].score();
       res.revision = fwd_data.header.revision;
       res.forward_data = std::move(fwd_data.data);
       res.lsn = fwd_data.header.lsn;
-      output_result_list.emplace_back(res);
+      output_result_list.emplace_back(std::move(res));
     }
     res_num += search_results.size();
-    batch_results->emplace_back(output_result_list);
+    batch_results->emplace_back(std::move(output_result_list));
   }
 
   SLOG_DEBUG(
@@ -403,11 +590,13 @@ int MemorySegment::kv_search(uint64_t primary_key, QueryResult *result) {
   result->primary_key = INVALID_KEY;
 
   if (!delete_store_->has(doc_id)) {
-    if (doc_id >= segment_meta_.min_doc_id &&
-        doc_id <= segment_meta_.max_doc_id) {
+    if (this->is_in_range(doc_id)) {
       ForwardData fwd_data;
       int ret = forward_indexer_->seek(doc_id, &fwd_data);
-      if (ret == 0 && fwd_data.header.primary_key != INVALID_KEY) {
+      if (ret == 0 && fwd_data.header.primary_key != INVALID_KEY &&
+          !IsExpired(fwd_data.header.timestamp,
+                     this->boundary_expire_timestamp(
+                         schema_->ttl_seconds()))) {
         result->primary_key = fwd_data.header.primary_key;
         result->revision = fwd_data.header.revision;
         result->forward_data = std::move(fwd_data.data);
@@ -450,6 +639,7 @@ int MemorySegment::add_column(const meta::ColumnMetaPtr &column_meta) {
 
   ReadOptions read_options;
   read_options.use_mmap = true;
+  read_options.huge_page = huge_page_;
   read_options.create_new = true;
 
   ColumnIndexerPtr column_indexer = ColumnIndexer::Create(
@@ -541,36 +731,34 @@ int MemorySegment::dump_column_indexers(const IndexDumperPtr &dumper) {
   return 0;
 }
 
-void MemorySegment::update_stats(const Record &record, idx_t doc_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  segment_meta_.doc_count++;
-
-  if (doc_id > segment_meta_.max_doc_id) {
-    segment_meta_.max_doc_id = doc_id;
-  }
-
-  if (record.primary_key < segment_meta_.min_primary_key) {
-    segment_meta_.min_primary_key = record.primary_key;
-  }
-
-  if (record.primary_key > segment_meta_.max_primary_key) {
-    segment_meta_.max_primary_key = record.primary_key;
-  }
-
-  if (record.timestamp < segment_meta_.min_timestamp) {
-    segment_meta_.min_timestamp = record.timestamp;
-  }
-
-  if (record.timestamp > segment_meta_.max_timestamp) {
-    segment_meta_.max_timestamp = record.timestamp;
-  }
+void MemorySegment::update_stats(const Record &record, idx_t doc_id,
+                                 uint64_t timestamp) {
+  MemorySegmentStats::UpdateMax(&stats_.max_doc_id, doc_id);
+  MemorySegmentStats::UpdateMin(&stats_.min_primary_key, record.primary_key);
+  MemorySegmentStats::UpdateMax(&stats_.max_primary_key, record.primary_key);
+  MemorySegmentStats::UpdateMin(&stats_.min_timestamp, timestamp);
+  MemorySegmentStats::UpdateMax(&stats_.max_timestamp, timestamp);
+  MemorySegmentStats::UpdateMin(&stats_.min_lsn, record.lsn);
+  MemorySegmentStats::UpdateMax(&stats_.max_lsn, record.lsn);
+
+  // Counted last, so a fold counting the document sees its stats
+  stats_.doc_count.fetch_add(1U, std::memory_order_release);
+}
 
-  if (record.lsn > segment_meta_.max_lsn) {
-    segment_meta_.max_lsn = record.lsn;
-  }
+SegmentMeta MemorySegment::segment_meta() const {
+  // Fields of meta are written under the lock, stats are folded into
+  // the copy
+  std::lock_guard<std::mutex> lock(mutex_);
+  SegmentMeta meta = segment_meta_;
+  stats_.fold(&meta);
+  return meta;
+}
 
-  if (record.lsn < segment_meta_.min_lsn) {
-    segment_meta_.min_lsn = record.lsn;
+void MemorySegment::get_index_files(
+    std::vector<std::string> *file_paths) const {
+  file_paths->emplace_back(forward_indexer_->index_file_path());
+  for (auto &it : column_indexers_) {
+    file_paths->emplace_back(it.second->index_file_path());
   }
 }
 
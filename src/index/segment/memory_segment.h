@@ -26,6 +26,7 @@
 #include "meta/meta.h"
 #include "segment.h"
 #include "../collection_dataset.h"
+#include "../collection_stats.h"
 #include "../column/column_indexer.h"
 #include "../column/forward_indexer.h"
 #include "../concurrent_hash_map.h"
@@ -39,6 +40,65 @@ namespace index {
 class MemorySegment;
 using MemorySegmentPtr = std::shared_ptr<MemorySegment>;
 
+/*
+ * MemorySegmentStats keeps stats of a writing segment in atomic
+ * accumulators, so that concurrent inserts update them without any lock.
+ * They are folded into segment meta on read.
+ */
+struct MemorySegmentStats {
+  std::atomic<uint64_t> doc_count{0U};
+  std::atomic<uint64_t> max_doc_id{0U};
+  std::atomic<uint64_t> min_primary_key{0U};
+  std::atomic<uint64_t> max_primary_key{0U};
+  std::atomic<uint64_t> min_timestamp{0U};
+  std::atomic<uint64_t> max_timestamp{0U};
+  std::atomic<uint64_t> min_lsn{0U};
+  std::atomic<uint64_t> max_lsn{0U};
+
+  //! Seed accumulators with stats of meta
+  void reset(const SegmentMeta &meta) {
+    doc_count = meta.doc_count;
+    max_doc_id = meta.max_doc_id;
+    min_primary_key = meta.min_primary_key;
+    max_primary_key = meta.max_primary_key;
+    min_timestamp = meta.min_timestamp;
+    max_timestamp = meta.max_timestamp;
+    min_lsn = meta.min_lsn;
+    max_lsn = meta.max_lsn;
+  }
+
+  //! Fold accumulators into meta. Document count is loaded first, and
+  //! other fields cover at least the documents counted.
+  void fold(SegmentMeta *meta) const {
+    meta->doc_count = doc_count.load(std::memory_order_acquire);
+    meta->max_doc_id = max_doc_id.load(std::memory_order_relaxed);
+    meta->min_primary_key = min_primary_key.load(std::memory_order_relaxed);
+    meta->max_primary_key = max_primary_key.load(std::memory_order_relaxed);
+    meta->min_timestamp = min_timestamp.load(std::memory_order_relaxed);
+    meta->max_timestamp = max_timestamp.load(std::memory_order_relaxed);
+    meta->min_lsn = min_lsn.load(std::memory_order_relaxed);
+    meta->max_lsn = max_lsn.load(std::memory_order_relaxed);
+  }
+
+  //! Lower value if val is less
+  static void UpdateMin(std::atomic<uint64_t> *value, uint64_t val) {
+    uint64_t current = value->load(std::memory_order_relaxed);
+    while (val < current &&
+           !value->compare_exchange_weak(current, val,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+
+  //! Raise value if val is greater
+  static void UpdateMax(std::atomic<uint64_t> *value, uint64_t val) {
+    uint64_t current = value->load(std::memory_order_relaxed);
+    while (val > current &&
+           !value->compare_exchange_weak(current, val,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+};
+
 /*
  * A MemorySegment represents block of index data in memory, with
  * streaming insert and search ability at the same time. You can
@@ -52,7 +112,7 @@ class MemorySegment : public Segment {
   //! Constructor
   MemorySegment(const std::string &coll_name, const std::string &coll_path,
                 const SegmentMeta &seg_meta,
-                const meta::CollectionMeta *schema_ptr,
+                const meta::CollectionMetaPtr &schema_ptr,
                 const DeleteStore *delete_store_ptr, const IDMap *id_map_ptr,
                 uint32_t concurrency_val)
       : schema_(schema_ptr),
@@ -62,6 +122,7 @@ class MemorySegment : public Segment {
     this->set_collection_name(coll_name);
     this->set_collection_path(coll_path);
     this->set_segment_meta(seg_meta);
+    stats_.reset(seg_meta);
   }
 
 
@@ -72,7 +133,7 @@ class MemorySegment : public Segment {
   static MemorySegmentPtr Create(const std::string &collection_name,
                                  const std::string &collection_path,
                                  const SegmentMeta &segment_meta,
-                                 const meta::CollectionMeta *schema,
+                                 const meta::CollectionMetaPtr &schema,
                                  const DeleteStore *delete_store,
                                  const IDMap *id_map, uint32_t concurrency);
 
@@ -80,7 +141,7 @@ class MemorySegment : public Segment {
   static int CreateAndOpen(const std::string &collection_name,
                            const std::string &collection_path,
                            const SegmentMeta &segment_meta,
-                           const meta::CollectionMeta *schema,
+                           const meta::CollectionMetaPtr &schema,
                            const DeleteStore *delete_store, const IDMap *id_map,
                            uint32_t concurrency,
                            const ReadOptions &read_options,
@@ -106,6 +167,24 @@ class MemorySegment : public Segment {
   //! Insert a record & alloc a doc_id
   int insert(const Record &record, idx_t *doc_id);
 
+  //! Insert forward of a record & alloc a doc_id
+  int insert_forward(const Record &record, idx_t *doc_id);
+
+  //! Insert forward of a record & alloc a doc_id, forward data of record
+  //! is moved out, and other fields are kept
+  int insert_forward(Record &&record, idx_t *doc_id);
+
+  //! Insert index columns of a record with allocated doc_id
+  int insert_columns(const Record &record, idx_t doc_id);
+
+  //! Insert index columns of a batch of records with allocated doc_ids.
+  //! Columns are built in parallel in pool, rows keep their order in each
+  //! column. Codes are set per record, build stats per column
+  int insert_columns(const std::vector<const Record *> &records,
+                     const std::vector<idx_t> &doc_ids, ThreadPool *pool,
+                     std::vector<int> *codes,
+                     std::vector<ColumnBuildStats> *column_stats);
+
   //! Remove a record
   int remove(idx_t doc_id);
 
@@ -140,14 +219,27 @@ class MemorySegment : public Segment {
  public:
   //! Set segment state
   void update_state(SegmentState new_state) {
+    std::lock_guard<std::mutex> lock(mutex_);
     segment_meta_.state = new_state;
   }
 
   //! Return forward count
   size_t doc_count() const override {
-    return segment_meta_.doc_count;
+    return stats_.doc_count.load(std::memory_order_relaxed);
+  }
+
+  //! Return a copy of segment meta with stats folded in
+  SegmentMeta segment_meta() const override;
+
+  //! Check if doc id in range of segment
+  bool is_in_range(idx_t doc_id) const override {
+    return doc_id >= segment_meta_.min_doc_id &&
+           doc_id <= stats_.max_doc_id.load(std::memory_order_relaxed);
   }
 
+  //! Get paths of all index files
+  void get_index_files(std::vector<std::string> *file_paths) const;
+
  public:
   //! Get forward reader
   ForwardReaderPtr get_forward_reader() const override {
@@ -164,6 +256,9 @@ class MemorySegment : public Segment {
   }
 
  private:
+  int insert_forward(const Record &record, std::string &&forward_data,
+                     idx_t *doc_id);
+
   int open_forward_indexer(const ReadOptions &read_options);
 
   int open_column_indexers(const ReadOptions &read_options);
@@ -172,7 +267,17 @@ class MemorySegment : public Segment {
 
   int dump_column_indexers(const IndexDumperPtr &dumper);
 
-  void update_stats(const Record &record, idx_t doc_id);
+  void update_stats(const Record &record, idx_t doc_id, uint64_t timestamp);
+
+  void do_insert_column(ColumnIndexerPtr column_indexer, size_t column,
+                        const std::vector<const Record *> *records,
+                        const std::vector<idx_t> *doc_ids,
+                        const std::vector<bool> *planned,
+                        std::vector<int> *codes, ColumnBuildStats *stats);
+
+  uint64_t min_timestamp() const override {
+    return stats_.min_timestamp.load(std::memory_order_relaxed);
+  }
 
   size_t get_index_file_count();
 
@@ -182,7 +287,7 @@ class MemorySegment : public Segment {
   static constexpr uint32_t MAX_WAIT_RETRY_COUNT = 60U;
 
  private:
-  const meta::CollectionMeta *schema_{nullptr};
+  meta::CollectionMetaPtr schema_{};
   const DeleteStore *delete_store_{nullptr};
   const IDMap *id_map_{nullptr};
   uint32_t concurrency_{0U};
@@ -190,9 +295,11 @@ class MemorySegment : public Segment {
   ForwardIndexerPtr forward_indexer_{};
   ConcurrentHashMap<std::string, ColumnIndexerPtr> column_indexers_{};
 
-  std::mutex mutex_{};
+  MemorySegmentStats stats_{};
+  mutable std::mutex mutex_{};
   std::atomic<uint64_t> active_insert_count_{0U};
   std::atomic<uint64_t> active_search_count_{0U};
+  bool huge_page_{false};
   bool opened_{false};
 };
 
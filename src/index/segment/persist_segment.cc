@@ -19,9 +19,13 @@
  */
 
 #include "persist_segment.h"
+#include <ailego/io/file.h>
 #include <ailego/utility/time_helper.h>
+#include <aitheta2/index_unpacker.h>
 #include "common/auto_counter.h"
 #include "common/error_code.h"
+#include "../column_backfill.h"
+#include "../constants.h"
 #include "../file_helper.h"
 
 namespace proxima {
@@ -31,7 +35,7 @@ namespace index {
 PersistSegmentPtr PersistSegment::Create(const std::string &collection_name,
                                          const std::string &collection_path,
                                          const SegmentMeta &segment_meta,
-                                         const meta::CollectionMeta *schema,
+                                         const meta::CollectionMetaPtr &schema,
                                          const DeleteStore *delete_store,
                                          const IDMap *id_map,
                                          uint32_t concurrency) {
@@ -42,7 +46,7 @@ PersistSegmentPtr PersistSegment::Create(const std::string &collection_name,
 
 int PersistSegment::CreateAndLoad(
     const std::string &collection_name, const std::string &collection_path,
-    const SegmentMeta &segment_meta, const meta::CollectionMeta *schema,
+    const SegmentMeta &segment_meta, const meta::CollectionMetaPtr &schema,
     const DeleteStore *delete_store, const IDMap *id_map, uint32_t concurrency,
     const ReadOptions &read_options, PersistSegmentPtr *persist_segment) {
   (*persist_segment) = Create(collection_name, collection_path, segment_meta,
@@ -68,6 +72,17 @@ int PersistSegment::load(const ReadOptions &read_options) {
   ret = load_column_readers(read_options);
   CHECK_RETURN_WITH_SLOG(ret, 0, "Load column searchers failed.");
 
+  // Documents deleted before loaded are counted once
+  size_t deleted_count = 0U;
+  if (delete_store_) {
+    for (size_t i = 0; i < segment_meta_.doc_count; i++) {
+      if (delete_store_->has(segment_meta_.min_doc_id + i)) {
+        deleted_count++;
+      }
+    }
+  }
+  deleted_count_ = deleted_count;
+
   SLOG_DEBUG("Load persist segment success.");
   loaded_ = true;
 
@@ -105,6 +120,21 @@ int PersistSegment::unload() {
   return 0;
 }
 
+size_t PersistSegment::resident_size() const {
+  if (!loaded_) {
+    return 0U;
+  }
+
+  size_t resident_size = forward_reader_->resident_size();
+  for (auto &it : column_readers_) {
+    // Empty column has no reader
+    if (it.second != nullptr) {
+      resident_size += it.second->resident_size();
+    }
+  }
+  return resident_size;
+}
+
 int PersistSegment::knn_search(const std::string &column_name,
                                const std::string &query,
                                const QueryParams &query_params,
@@ -115,7 +145,7 @@ int PersistSegment::knn_search(const std::string &column_name,
       this->knn_search(column_name, query, query_params, 1, &batch_results);
   CHECK_RETURN(ret, 0);
 
-  (*results) = batch_results[0];
+  (*results) = std::move(batch_results[0]);
   return 0;
 }
 
@@ -131,16 +161,17 @@ int PersistSegment::knn_search(const std::string &column_name,
   ailego::ElapsedTime timer;
   uint64_t query_id = query_params.query_id;
 
-  if (!column_readers_.has(column_name)) {
+  // Reader is copied out, it may be replaced by backfill meanwhile
+  ColumnReaderPtr column_reader;
+  if (!column_readers_.find(column_name, &column_reader)) {
     SLOG_ERROR("Column not exist. query_id[%zu] column_name[%s]",
                (size_t)query_id, column_name.c_str());
     return ErrorCode_InexistentColumn;
   }
 
-  auto &column_reader = column_readers_.get(column_name);
   // check if column searcher is empty searcher
   // it means this column added later by update schema
-  // so we just return empty results
+  // and not backfilled yet, so we just return empty results
   if (!column_reader) {
     SLOG_INFO(
         "Empty column searcher return empty results. query_id[%zu] "
@@ -148,14 +179,18 @@ int PersistSegment::knn_search(const std::string &column_name,
         "res_num[0] cost[%zums] column[%s]",
         (size_t)query_id, batch_count, query_params.topk,
         (size_t)timer.milli_seconds(), column_name.c_str());
+    batch_results->resize(batch_count);
     return 0;
   }
 
   // search columns
   std::vector<IndexDocumentList> batch_search_results;
   FilterFunction filter = nullptr;
+  idx_t doc_id_delta = (idx_t)segment_meta_.doc_id_delta();
   if (delete_store_ && delete_store_->count() > 0) {
-    filter = [this](idx_t doc_id) { return delete_store_->has(doc_id); };
+    filter = [this, doc_id_delta](idx_t key) {
+      return delete_store_->has(key + doc_id_delta);
+    };
   }
 
   int ret = column_reader->search(query, query_params, batch_count, filter,
@@ -164,30 +199,55 @@ int PersistSegment::knn_search(const std::string &column_name,
       ret, 0, "Column searcher search failed. query_id[%zu] column[%s]",
       (size_t)query_id, column_name.c_str());
 
-  // fill results
+  // fill results, documents in boundary segment may be expired
+  uint64_t expire_timestamp =
+      this->boundary_expire_timestamp(schema_->ttl_seconds());
   uint32_t res_num = 0U;
+
+  // Forwards of whole batch are fetched at once
+  std::vector<idx_t> doc_ids;
+  for (auto &search_results : batch_search_results) {
+    for (size_t j = 0; j < search_results.size(); j++) {
+      doc_ids.emplace_back(search_results[j].key() + doc_id_delta);
+    }
+  }
+  std::vector<ForwardData> forwards;
+  std::vector<int> codes;
+  ret = forward_reader_->batch_seek(doc_ids, &forwards, &codes);
+  CHECK_RETURN_WITH_SLOG(ret, 0, "Forward reader seek failed. query_id[%zu]",
+                         (size_t)query_id);
+
+  size_t fwd_pos = 0U;
   for (size_t i = 0; i < batch_search_results.size(); i++) {
     auto &search_results = batch_search_results[i];
     QueryResultList output_result_list;
-    for (size_t j = 0; j < search_results.size(); j++) {
-      idx_t doc_id = search_results[j].key();
-      ForwardData fwd_data;
-      ret = forward_reader_->seek(doc_id, &fwd_data);
-      if (ret != 0) {
+    output_result_list.reserve(search_results.size());
+    for (size_t j = 0; j < search_results.size(); j++, fwd_pos++) {
+      idx_t doc_id = doc_ids[fwd_pos];
+      ForwardData &fwd_data = forwards[fwd_pos];
+      if (codes[fwd_pos] != 0) {
         SLOG_WARN("Forward not exist. query_id[%zu] doc_id[%zu] column[%s] ",
                   (size_t)query_id, (size_t)doc_id, column_name.c_str());
         continue;
       }
+      // Closet fetch is the only copy of forward bytes in segment
+      if (query_params.forward_stats) {
+        query_params.forward_stats->add_copy(
+            sizeof(ForwardData::ForwardHeader) + fwd_data.data.size(), true);
+      }
+      if (IsExpired(fwd_data.header.timestamp, expire_timestamp)) {
+        continue;
+      }
       QueryResult res;
       res.primary_key = fwd_data.header.primary_key;
       res.score = search_results[j].score();
       res.revision = fwd_data.header.revision;
       res.forward_data = std::move(fwd_data.data);
       res.lsn = fwd_data.header.lsn;
-      output_result_list.emplace_back(res);
+      output_result_list.emplace_back(std::move(res));
     }
     res_num += search_results.size();
-    batch_results->emplace_back(output_result_list);
+    batch_results->emplace_back(std::move(output_result_list));
   }
 
   SLOG_DEBUG(
@@ -211,7 +271,10 @@ int PersistSegment::kv_search(uint64_t primary_key, QueryResult *result) {
         doc_id <= segment_meta_.max_doc_id) {
       ForwardData fwd_data;
       int ret = forward_reader_->seek(doc_id, &fwd_data);
-      if (ret == 0 && fwd_data.header.primary_key != INVALID_KEY) {
+      if (ret == 0 && fwd_data.header.primary_key != INVALID_KEY &&
+          !IsExpired(fwd_data.header.timestamp,
+                     this->boundary_expire_timestamp(
+                         schema_->ttl_seconds()))) {
         result->primary_key = fwd_data.header.primary_key;
         result->revision = fwd_data.header.revision;
         result->forward_data = std::move(fwd_data.data);
@@ -234,8 +297,17 @@ int PersistSegment::remove_column(const std::string &column_name) {
     return 0;
   }
 
-  column_readers_.get(column_name)->close();
+  // Empty column of pending backfill has no reader, and the reader is
+  // closed by searches still holding it
   column_readers_.erase(column_name);
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_columns_.erase(column_name);
+  }
+  FileHelper::RemoveFile(ColumnBackfill::FilePath(
+      collection_path_, segment_meta_.segment_id, column_name));
+  FileHelper::RemoveFile(ColumnBackfill::MarkerPath(
+      collection_path_, segment_meta_.segment_id, column_name));
 
   SLOG_INFO("Remove column done. column[%s]", column_name.c_str());
   return 0;
@@ -250,13 +322,53 @@ int PersistSegment::add_column(const meta::ColumnMetaPtr &column_meta) {
     return 0;
   }
 
-  // occupy a empty column, it will skip in query process
+  // occupy a empty column, it will skip in query process until
+  // backfilled
   column_readers_.emplace(column_name, ColumnReaderPtr());
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_columns_.emplace(column_name);
+  }
 
   SLOG_INFO("Add column success. column[%s]", column_name.c_str());
   return 0;
 }
 
+int PersistSegment::publish_column(const meta::ColumnMeta &column_meta,
+                                   const ReadOptions &read_options) {
+  CHECK_STATUS(loaded_, true);
+  std::string column_name = column_meta.name();
+  if (!column_readers_.has(column_name)) {
+    SLOG_WARN("Column not exist, publish failed. column[%s]",
+              column_name.c_str());
+    return ErrorCode_InexistentColumn;
+  }
+
+  ColumnReaderPtr column_reader;
+  int ret = this->open_column_reader(column_meta, read_options, &column_reader);
+  CHECK_RETURN(ret, 0);
+
+  // Old reader is released here, or by the last search holding it
+  ColumnReaderPtr old_reader =
+      column_readers_.exchange(column_name, std::move(column_reader));
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_columns_.erase(column_name);
+  }
+  FileHelper::RemoveFile(ColumnBackfill::MarkerPath(
+      collection_path_, segment_meta_.segment_id, column_name));
+
+  SLOG_INFO("Publish backfilled column success. column[%s]",
+            column_name.c_str());
+  return 0;
+}
+
+std::vector<std::string> PersistSegment::pending_columns() const {
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  return std::vector<std::string>(pending_columns_.begin(),
+                                  pending_columns_.end());
+}
+
 int PersistSegment::load_forward_reader(const ReadOptions &read_options) {
   forward_reader_ = ForwardReader::Create(collection_name_, collection_path_,
                                           segment_meta_.segment_id);
@@ -274,23 +386,55 @@ int PersistSegment::load_forward_reader(const ReadOptions &read_options) {
 }
 
 int PersistSegment::load_column_readers(const ReadOptions &read_options) {
+  // Columns added after segment dumped have no block in segment file,
+  // only metas of blocks are read to find them
+  std::string segment_path = FileHelper::MakeFilePath(
+      collection_path_, FileID::SEGMENT_FILE, segment_meta_.segment_id);
+  ailego::File file;
+  if (!file.open(segment_path, true)) {
+    SLOG_ERROR("Open segment file failed. file[%s]", segment_path.c_str());
+    return ErrorCode_RuntimeError;
+  }
+  std::string buffer;
+  auto read_data = [&file, &buffer](size_t offset, const void **data,
+                                    size_t len) -> size_t {
+    buffer.resize(len);
+    *data = buffer.data();
+    return file.read(static_cast<ssize_t>(offset), &buffer[0], len);
+  };
+  aitheta2::IndexUnpacker unpacker;
+  if (!unpacker.unpack(read_data, file.size(), false)) {
+    SLOG_ERROR("Unpack segment file failed. file[%s]", segment_path.c_str());
+    return ErrorCode_RuntimeError;
+  }
+  const auto &blocks = unpacker.segments();
+
   for (auto &column_meta : schema_->index_columns()) {
     std::string column_name = column_meta->name();
-
-    ColumnReaderPtr new_column_reader = ColumnReader::Create(
-        collection_name_, collection_path_, segment_meta_.segment_id,
-        column_name, column_meta->index_type());
-    if (!new_column_reader) {
-      SLOG_ERROR("Create column reader failed. index_type[%d] column[%s]",
-                 column_meta->index_type(), column_name.c_str());
-      return ErrorCode_RuntimeError;
+    SegmentID seg_id = segment_meta_.segment_id;
+
+    // Column missing in segment file is empty until backfilled, and
+    // column of a marked segment misses documents written before added
+    bool backfilled = FileHelper::FileExists(
+        ColumnBackfill::FilePath(collection_path_, seg_id, column_name));
+    if (!backfilled &&
+        blocks.find(COLUMN_DUMP_BLOCK + column_name) == blocks.end()) {
+      SLOG_INFO("Column not built in segment, wait for backfill. column[%s]",
+                column_name.c_str());
+      column_readers_.emplace(column_name, ColumnReaderPtr());
+      pending_columns_.emplace(column_name);
+      continue;
+    }
+    if (!backfilled &&
+        FileHelper::FileExists(ColumnBackfill::MarkerPath(
+            collection_path_, seg_id, column_name))) {
+      pending_columns_.emplace(column_name);
     }
 
-    new_column_reader->set_concurrency(concurrency_);
-    int ret = new_column_reader->open(*column_meta.get(), read_options);
-    CHECK_RETURN_WITH_SLOG(
-        ret, 0, "Open column reader failed. index_type[%d] column[%s]",
-        column_meta->index_type(), column_name.c_str());
+    ColumnReaderPtr new_column_reader;
+    int ret = this->open_column_reader(*column_meta, read_options,
+                                       &new_column_reader);
+    CHECK_RETURN(ret, 0);
 
     column_readers_.emplace(column_name, new_column_reader);
   }
@@ -298,6 +442,29 @@ int PersistSegment::load_column_readers(const ReadOptions &read_options) {
   return 0;
 }
 
+int PersistSegment::open_column_reader(const meta::ColumnMeta &column_meta,
+                                       const ReadOptions &read_options,
+                                       ColumnReaderPtr *column_reader) {
+  std::string column_name = column_meta.name();
+  ColumnReaderPtr new_column_reader = ColumnReader::Create(
+      collection_name_, collection_path_, segment_meta_.segment_id,
+      column_name, column_meta.index_type());
+  if (!new_column_reader) {
+    SLOG_ERROR("Create column reader failed. index_type[%d] column[%s]",
+               (int)column_meta.index_type(), column_name.c_str());
+    return ErrorCode_RuntimeError;
+  }
+
+  new_column_reader->set_concurrency(concurrency_);
+  int ret = new_column_reader->open(column_meta, read_options);
+  CHECK_RETURN_WITH_SLOG(
+      ret, 0, "Open column reader failed. index_type[%d] column[%s]",
+      (int)column_meta.index_type(), column_name.c_str());
+
+  *column_reader = std::move(new_column_reader);
+  return 0;
+}
+
 
 }  // end namespace index
 }  // namespace be
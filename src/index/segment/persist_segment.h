@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <set>
 #include <unordered_map>
 #include <ailego/parallel/lock.h>
 #include "common/macro_define.h"
@@ -52,7 +54,7 @@ class PersistSegment : public Segment {
   //! Constructor
   PersistSegment(const std::string &coll_name, const std::string &coll_path,
                  const SegmentMeta &seg_meta,
-                 const meta::CollectionMeta *schema_ptr,
+                 const meta::CollectionMetaPtr &schema_ptr,
                  const DeleteStore *delete_store_ptr, const IDMap *id_map_ptr,
                  uint32_t concurrency_val)
       : schema_(schema_ptr),
@@ -71,7 +73,7 @@ class PersistSegment : public Segment {
   static PersistSegmentPtr Create(const std::string &coll_name,
                                   const std::string &coll_path,
                                   const SegmentMeta &seg_meta,
-                                  const meta::CollectionMeta *schema_ptr,
+                                  const meta::CollectionMetaPtr &schema_ptr,
                                   const DeleteStore *delete_store_ptr,
                                   const IDMap *id_map_ptr,
                                   uint32_t concurrency_val);
@@ -80,7 +82,7 @@ class PersistSegment : public Segment {
   static int CreateAndLoad(const std::string &collection_name,
                            const std::string &collection_path,
                            const SegmentMeta &segment_meta,
-                           const meta::CollectionMeta *schema,
+                           const meta::CollectionMetaPtr &schema,
                            const DeleteStore *delete_store, const IDMap *id_map,
                            uint32_t concurrency,
                            const ReadOptions &read_options,
@@ -114,12 +116,34 @@ class PersistSegment : public Segment {
   //! Add a index column
   int add_column(const meta::ColumnMetaPtr &column_meta) override;
 
+  //! Open backfilled column and replace the one serving, searches
+  //! holding the old reader finish on it
+  int publish_column(const meta::ColumnMeta &column_meta,
+                     const ReadOptions &read_options);
+
+  //! Return columns which miss documents and wait for backfill
+  std::vector<std::string> pending_columns() const;
+
  public:
   //! Return forward count
   size_t doc_count() const override {
     return forward_reader_->doc_count();
   }
 
+  //! Return bytes of forward and columns resident in memory
+  size_t resident_size() const;
+
+  //! Return count of documents deleted, counted when loaded and then
+  //! by collection on each delete
+  size_t deleted_count() const {
+    return deleted_count_.load(std::memory_order_relaxed);
+  }
+
+  //! Count documents deleted after loaded
+  void add_deleted_count(size_t count) {
+    deleted_count_.fetch_add(count, std::memory_order_relaxed);
+  }
+
  public:
   //! Get forward reader
   ForwardReaderPtr get_forward_reader() const override {
@@ -129,10 +153,9 @@ class PersistSegment : public Segment {
   //! Get column reader
   ColumnReaderPtr get_column_reader(
       const std::string &column_name) const override {
-    if (!column_readers_.has(column_name)) {
-      return ColumnReaderPtr();
-    }
-    return column_readers_.get(column_name);
+    ColumnReaderPtr column_reader;
+    column_readers_.find(column_name, &column_reader);
+    return column_reader;
   }
 
  private:
@@ -140,19 +163,26 @@ class PersistSegment : public Segment {
 
   int load_column_readers(const ReadOptions &read_options);
 
+  int open_column_reader(const meta::ColumnMeta &column_meta,
+                         const ReadOptions &read_options,
+                         ColumnReaderPtr *column_reader);
+
  private:
   static constexpr uint32_t MAX_WAIT_RETRY_COUNT = 60U;
 
  private:
-  const meta::CollectionMeta *schema_{nullptr};
+  meta::CollectionMetaPtr schema_{};
   const DeleteStore *delete_store_{nullptr};
   const IDMap *id_map_{nullptr};
   uint32_t concurrency_{0U};
 
   ForwardReaderPtr forward_reader_{};
   ConcurrentHashMap<std::string, ColumnReaderPtr> column_readers_{};
+  mutable std::mutex pending_mutex_{};
+  std::set<std::string> pending_columns_{};
 
   std::atomic<uint64_t> active_search_count_{0U};
+  std::atomic<size_t> deleted_count_{0U};
   bool loaded_{false};
 };
 
@@ -61,6 +61,12 @@ class PersistSegmentManager {
   //! Upload all segments
   int unload_segments();
 
+  //! Remove a specific segment, it will be unloaded after last reference
+  //! released
+  void remove_segment(SegmentID segment_id) {
+    segments_.erase(segment_id);
+  }
+
   //! Return whether has some segment
   bool has_segment(SegmentID segment_id) {
     return segments_.has(segment_id);
@@ -71,6 +77,13 @@ class PersistSegmentManager {
     return segments_.size();
   }
 
+  //! Return ids of loaded persist segments
+  void get_segment_ids(std::vector<SegmentID> *segment_ids) {
+    for (auto &it : segments_) {
+      segment_ids->emplace_back(it.first);
+    }
+  }
+
  private:
   std::string collection_name_{};
   std::string collection_path_{};
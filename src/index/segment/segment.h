@@ -21,7 +21,9 @@
 
 #pragma once
 
+#include <string.h>
 #include <memory>
+#include <ailego/utility/time_helper.h>
 #include "common/macro_define.h"
 #include "common/types.h"
 #include "meta/meta.h"
@@ -68,13 +70,32 @@ struct SegmentMeta {
   uint64_t max_timestamp{0U};
   uint64_t min_lsn{0U};
   uint64_t max_lsn{0U};
-  uint32_t reserved_[8];
+  // Offset from doc id to the key stored in index files, it's non-zero
+  // only for segments attached from outside. Old manifests may hold any
+  // bytes here, so it is valid only along with the magic.
+  int64_t doc_id_delta_{0};
+  uint32_t doc_id_delta_magic_{0U};
+  uint32_t reserved_[5];
 
   SegmentMeta() {
     min_primary_key = INVALID_KEY;
     min_timestamp = -1UL;
     min_lsn = -1UL;
+    memset(reserved_, 0, sizeof(reserved_));
   }
+
+  //! Return offset from doc id to key, 0 for metas of old manifests
+  int64_t doc_id_delta() const {
+    return doc_id_delta_magic_ == DOC_ID_DELTA_MAGIC ? doc_id_delta_ : 0;
+  }
+
+  //! Set offset from doc id to key
+  void set_doc_id_delta(int64_t delta) {
+    doc_id_delta_ = delta;
+    doc_id_delta_magic_ = DOC_ID_DELTA_MAGIC;
+  }
+
+  static constexpr uint32_t DOC_ID_DELTA_MAGIC = 0x444C5441;
 };
 
 static_assert(sizeof(SegmentMeta) % 64 == 0,
@@ -114,12 +135,13 @@ class SegmentProvider {
     return segment_meta_.min_doc_id;
   }
 
-  //! Return segment meta
-  const SegmentMeta &segment_meta() const {
+  //! Return a copy of segment meta
+  virtual SegmentMeta segment_meta() const {
     return segment_meta_;
   }
 
-  bool is_in_range(idx_t doc_id) const {
+  //! Check if doc id in range of segment
+  virtual bool is_in_range(idx_t doc_id) const {
     if (doc_id >= segment_meta_.min_doc_id &&
         doc_id <= segment_meta_.max_doc_id) {
       return true;
@@ -131,6 +153,29 @@ class SegmentProvider {
   //! Return document count
   virtual size_t doc_count() const = 0;
 
+ public:
+  //! Return timestamp before which documents expired, 0 means never expire
+  static uint64_t ExpireTimestamp(uint64_t ttl_seconds) {
+    uint64_t now = ailego::Realtime::Seconds();
+    return (ttl_seconds > 0 && now > ttl_seconds) ? now - ttl_seconds : 0U;
+  }
+
+  //! Check if timestamp expired, zero timestamp never expires
+  static bool IsExpired(uint64_t timestamp, uint64_t expire_timestamp) {
+    return timestamp != 0U && timestamp < expire_timestamp;
+  }
+
+ protected:
+  //! Return expire timestamp if segment may contain expired documents,
+  //! otherwise return 0 to skip per-document check
+  uint64_t boundary_expire_timestamp(uint64_t ttl_seconds) const {
+    uint64_t expire_timestamp = ExpireTimestamp(ttl_seconds);
+    if (expire_timestamp > 0U && this->min_timestamp() < expire_timestamp) {
+      return expire_timestamp;
+    }
+    return 0U;
+  }
+
  protected:
   void set_collection_name(const std::string &val) {
     collection_name_ = val;
@@ -144,6 +189,11 @@ class SegmentProvider {
     segment_meta_ = val;
   }
 
+  //! Return min timestamp of documents
+  virtual uint64_t min_timestamp() const {
+    return segment_meta_.min_timestamp;
+  }
+
  protected:
   std::string collection_name_{};
   std::string collection_path_{};
@@ -20,6 +20,8 @@
 
 #include "snapshot.h"
 #include <aitheta2/index_factory.h>
+#include "dirty_range_storage.h"
+#include "huge_page_helper.h"
 
 namespace proxima {
 namespace be {
@@ -74,6 +76,17 @@ int Snapshot::open(const ReadOptions &read_options) {
     return ErrorCode_RuntimeError;
   }
 
+  // Streamer chunks are blocks of storage, advise them while allocated
+  if (read_options.huge_page) {
+    storage_ = std::make_shared<HugePageStorage>(storage_);
+  }
+
+  // Followers never flush, only writer tracks dirty pages
+  if (read_options.use_mmap && read_options.dirty_range_flush &&
+      !read_options.read_only) {
+    storage_ = std::make_shared<DirtyRangeStorage>(storage_);
+  }
+
   if (suffix_id_ != INVALID_SEGMENT_ID) {
     if (suffix_name_.empty()) {
       file_path_ = FileHelper::MakeFilePath(dir_path_, file_id_, suffix_id_);
@@ -105,6 +118,11 @@ int Snapshot::flush() {
   return storage_->flush();
 }
 
+size_t Snapshot::dirty_bytes() const {
+  auto storage = std::dynamic_pointer_cast<DirtyRangeStorage>(storage_);
+  return storage ? storage->dirty_bytes() : 0U;
+}
+
 int Snapshot::close() {
   CHECK_STATUS(opened_, true);
 
@@ -38,6 +38,21 @@ namespace index {
 struct ReadOptions {
   bool use_mmap{false};
   bool create_new{false};
+  // Open index files written by another process, never modify them
+  bool read_only{false};
+  // Back index memory with transparent huge pages
+  bool huge_page{false};
+  // How collection loads persist segments
+  LoadModes load_mode{LoadModes::MMAP};
+  // Keep forwards of persist segments on disk, fetch them in batches
+  bool forward_on_disk{false};
+  // Compression of forward blocks dumped into persist segments
+  CompressionTypes forward_compression{CompressionTypes::NONE};
+  // Raw bytes of a compressed forward block
+  uint32_t forward_block_size{16U * 1024U};
+  // Flush only pages written since last flush, for stores writing blocks
+  // only by Segment::write
+  bool dirty_range_flush{false};
 };
 
 class Snapshot;
@@ -87,6 +102,9 @@ class Snapshot {
   //! Flush memory data to persist storage
   int flush();
 
+  //! Return bytes next flush would sync, 0 if dirty ranges are untracked
+  size_t dirty_bytes() const;
+
   //! Close persist storage
   int close();
 
@@ -42,6 +42,7 @@ using IndexContextPtr = aitheta2::IndexContext::Pointer;
 using IndexSearcherPtr = aitheta2::IndexSearcher::Pointer;
 using IndexContainerBlockPtr = aitheta2::IndexContainer::Segment::Pointer;
 using IndexStreamerPtr = aitheta2::IndexStreamer::Pointer;
+using IndexProviderPtr = aitheta2::IndexStreamer::Provider::Pointer;
 using ThreadPoolPtr = std::shared_ptr<aitheta2::SingleQueueIndexThreads>;
 using IndexReformerPtr = std::shared_ptr<aitheta2::IndexReformer>;
 using IndexMeasurePtr = std::shared_ptr<aitheta2::IndexMeasure>;
@@ -49,27 +49,18 @@ VersionManager::~VersionManager() {
 int VersionManager::open(const ReadOptions &read_options) {
   CHECK_STATUS(opened_, false);
 
+  ReadOptions options = read_options;
+  options.dirty_range_flush = true;
   int ret = Snapshot::CreateAndOpen(collection_path_, FileID::MANIFEST_FILE,
-                                    read_options, &snapshot_);
+                                    options, &snapshot_);
   CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
 
   ret = version_store_.mount(snapshot_->data());
   CHECK_RETURN_WITH_CLOG(ret, 0, "Mount snapshot failed.");
 
   // Load current version, segments
-  if (version_store_.total_version_count() > 0) {
-    VersionSet version_set;
-    ret = version_store_.get_version_set(&version_set);
-    CHECK_RETURN(ret, 0);
-
-    for (uint32_t i = 0; i < version_set.segment_count; i++) {
-      SegmentID segment_id = version_set.segment_ids[i];
-      SegmentMeta segment_meta;
-      ret = version_store_.get_segment_meta(segment_id, &segment_meta);
-      CHECK_RETURN(ret, 0);
-      current_version_.emplace_back(segment_meta);
-    }
-  }
+  ret = this->load_current_version(&current_version_);
+  CHECK_RETURN(ret, 0);
 
   opened_ = true;
   CLOG_DEBUG("Opened version manager.");
@@ -98,6 +89,31 @@ int VersionManager::close() {
   return ret;
 }
 
+int VersionManager::reload(const ReadOptions &read_options) {
+  CHECK_STATUS(opened_, true);
+
+  // Manifest may be rewritten by another process, map it again to
+  // see appended blocks
+  SnapshotPtr snapshot;
+  int ret = Snapshot::CreateAndOpen(collection_path_, FileID::MANIFEST_FILE,
+                                    read_options, &snapshot);
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Create and open snapshot failed.");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  version_store_.unmount();
+  ret = version_store_.mount(snapshot->data());
+  CHECK_RETURN_WITH_CLOG(ret, 0, "Mount snapshot failed.");
+
+  std::vector<SegmentMeta> segment_metas;
+  ret = this->load_current_version(&segment_metas);
+  CHECK_RETURN(ret, 0);
+
+  current_version_.swap(segment_metas);
+  snapshot_.swap(snapshot);
+  snapshot->close();
+  return 0;
+}
+
 int VersionManager::apply(const VersionEdit &edit) {
   CHECK_STATUS(opened_, true);
 
@@ -129,6 +145,26 @@ int VersionManager::apply(const VersionEdit &edit) {
   return version_store_.update_version_set(version_set);
 }
 
+int VersionManager::load_current_version(
+    std::vector<SegmentMeta> *segment_metas) {
+  if (version_store_.total_version_count() == 0) {
+    return 0;
+  }
+
+  VersionSet version_set;
+  int ret = version_store_.get_version_set(&version_set);
+  CHECK_RETURN(ret, 0);
+
+  for (uint32_t i = 0; i < version_set.segment_count; i++) {
+    SegmentID segment_id = version_set.segment_ids[i];
+    SegmentMeta segment_meta;
+    ret = version_store_.get_segment_meta(segment_id, &segment_meta);
+    CHECK_RETURN(ret, 0);
+    segment_metas->emplace_back(segment_meta);
+  }
+  return 0;
+}
+
 
 }  // end namespace index
 }  // namespace be
@@ -75,9 +75,17 @@ class VersionManager {
   //! Flush memory to persist storage
   int flush();
 
+  //! Return bytes next flush would sync
+  size_t dirty_bytes() const {
+    return snapshot_ ? snapshot_->dirty_bytes() : 0U;
+  }
+
   //! Close persist storage and cleanup
   int close();
 
+  //! Reload manifest which is written by another process
+  int reload(const ReadOptions &options);
+
  public:
   //! Apply a version edit
   int apply(const VersionEdit &edit);
@@ -148,6 +156,9 @@ class VersionManager {
     return version_store_.total_segment_count();
   }
 
+ private:
+  int load_current_version(std::vector<SegmentMeta> *segment_metas);
+
  private:
   std::string collection_name_{};
   std::string collection_path_{};
@@ -0,0 +1,99 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of sampled tracing of rows on write path
+ */
+
+#include "write_tracer.h"
+#include <algorithm>
+#include <ailego/utility/time_helper.h>
+#include "typedef.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+std::atomic<uint32_t> WriteTracer::sample_rate_{
+    WriteTracer::DEFAULT_SAMPLE_RATE};
+std::atomic<uint64_t> WriteTracer::sample_second_{0U};
+std::atomic<uint32_t> WriteTracer::sample_count_{0U};
+
+void WriteTracer::trace_key(uint64_t primary_key, bool enable) {
+  mutex_.lock();
+  if (enable) {
+    traced_keys_.insert(primary_key);
+  } else {
+    traced_keys_.erase(primary_key);
+  }
+  traced_count_.store(static_cast<uint32_t>(traced_keys_.size()),
+                      std::memory_order_relaxed);
+  mutex_.unlock();
+
+  LOG_INFO("Write trace %s. collection[%s] key[%zu]",
+           enable ? "enabled" : "disabled", collection_name_.c_str(),
+           (size_t)primary_key);
+}
+
+std::vector<uint64_t> WriteTracer::traced_keys() const {
+  mutex_.lock_shared();
+  std::vector<uint64_t> keys(traced_keys_.begin(), traced_keys_.end());
+  mutex_.unlock_shared();
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+bool WriteTracer::Sample() {
+  uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+  if (rate == 0U) {
+    return false;
+  }
+
+  // Budget is reset by the first caller of a new second, a few events
+  // over budget at the boundary are acceptable
+  uint64_t now = ailego::Monotime::Seconds();
+  uint64_t second = sample_second_.load(std::memory_order_relaxed);
+  if (second != now &&
+      sample_second_.compare_exchange_strong(second, now,
+                                             std::memory_order_relaxed)) {
+    sample_count_.store(0U, std::memory_order_relaxed);
+  }
+  return sample_count_.fetch_add(1U, std::memory_order_relaxed) < rate;
+}
+
+void WriteTracer::emit(const char *event, const Record &record, int code,
+                       uint64_t rt_us, bool traced) const {
+  LOG_INFO(
+      "Write trace. collection[%s] event[%s] key[%zu] lsn[%zu] "
+      "code[%d] rt[%zuus] traced[%d]",
+      collection_name_.c_str(), event, (size_t)record.primary_key,
+      (size_t)record.lsn, code, (size_t)rt_us, traced);
+}
+
+void WriteTracer::emit_summary(const WriteSummary &summary) const {
+  LOG_INFO(
+      "Write batch summary. collection[%s] rows[%zu] inserted[%zu] "
+      "updated[%zu] deleted[%zu] folded[%zu] failed[%zu] rt[%zuus]",
+      collection_name_.c_str(), (size_t)summary.row_count,
+      (size_t)summary.insert_count, (size_t)summary.update_count,
+      (size_t)summary.delete_count, (size_t)summary.folded_count,
+      (size_t)summary.failed_count, (size_t)summary.cost_us);
+}
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
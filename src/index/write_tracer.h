@@ -0,0 +1,120 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Sampled tracing of rows on write path
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <ailego/parallel/lock.h>
+#include "collection_dataset.h"
+#include "collection_stats.h"
+
+namespace proxima {
+namespace be {
+namespace index {
+
+/*
+ * WriteTracer emits structured events of written rows. Events of all
+ * collections share a per second budget, so the write path never pays
+ * for log formatting of every row. Keys traced on demand are always
+ * emitted regardless of the budget.
+ */
+class WriteTracer {
+ public:
+  //! Default sampled events per second
+  static constexpr uint32_t DEFAULT_SAMPLE_RATE = 10U;
+
+  //! Constructor
+  explicit WriteTracer(const std::string &collection_name)
+      : collection_name_(collection_name) {}
+
+  //! Destructor
+  ~WriteTracer() = default;
+
+  //! Set sampled events per second of all collections, 0 disables sampling
+  static void SetSampleRate(uint32_t events_per_second) {
+    sample_rate_.store(events_per_second, std::memory_order_relaxed);
+  }
+
+  //! Return sampled events per second
+  static uint32_t SampleRate() {
+    return sample_rate_.load(std::memory_order_relaxed);
+  }
+
+  //! Take one event from budget of current second
+  static bool Sample();
+
+ public:
+  //! Start or stop tracing every write of a primary key
+  void trace_key(uint64_t primary_key, bool enable);
+
+  //! Return keys traced now
+  std::vector<uint64_t> traced_keys() const;
+
+  //! Emit an event of a row if it's traced or sampled
+  void trace(const char *event, const Record &record, int code,
+             uint64_t rt_us) {
+    bool traced = this->is_traced(record.primary_key);
+    if (traced || Sample()) {
+      this->emit(event, record, code, rt_us, traced);
+    }
+  }
+
+  //! Emit summary of a write batch if it's sampled
+  void trace_summary(const WriteSummary &summary) {
+    if (Sample()) {
+      this->emit_summary(summary);
+    }
+  }
+
+ private:
+  //! Return if key is traced, no lock is taken if nothing is traced
+  bool is_traced(uint64_t primary_key) const {
+    if (traced_count_.load(std::memory_order_relaxed) == 0U) {
+      return false;
+    }
+    mutex_.lock_shared();
+    bool found = traced_keys_.find(primary_key) != traced_keys_.end();
+    mutex_.unlock_shared();
+    return found;
+  }
+
+  void emit(const char *event, const Record &record, int code, uint64_t rt_us,
+            bool traced) const;
+
+  void emit_summary(const WriteSummary &summary) const;
+
+ private:
+  static std::atomic<uint32_t> sample_rate_;
+  static std::atomic<uint64_t> sample_second_;
+  static std::atomic<uint32_t> sample_count_;
+
+  std::string collection_name_{};
+  std::atomic<uint32_t> traced_count_{0U};
+  std::unordered_set<uint64_t> traced_keys_{};
+  mutable ailego::SharedMutex mutex_{};
+};
+
+
+}  // end namespace index
+}  // namespace be
+}  // end namespace proxima
@@ -473,6 +473,8 @@ class CollectionBase {
   explicit CollectionBase(const CollectionBase &param)
       : name_(param.name_),
         max_docs_per_segment_(param.max_docs_per_segment_),
+        ttl_seconds_(param.ttl_seconds_),
+        load_mode_(param.load_mode_),
         forward_columns_(param.forward_columns_) {
     for (auto column : param.index_columns_) {
       index_columns_.emplace_back(std::make_shared<ColumnMeta>(*column));
@@ -540,6 +542,26 @@ class CollectionBase {
     max_docs_per_segment_ = count;
   }
 
+  //! Retrieve time to live of documents in seconds
+  uint64_t ttl_seconds() const {
+    return ttl_seconds_;
+  }
+
+  //! Set time to live of documents in seconds, 0 means never expire
+  void set_ttl_seconds(uint64_t seconds) {
+    ttl_seconds_ = seconds;
+  }
+
+  //! Retrieve load mode of persist segments
+  LoadModes load_mode() const {
+    return load_mode_;
+  }
+
+  //! Set load mode of persist segments
+  void set_load_mode(LoadModes mode) {
+    load_mode_ = mode;
+  }
+
   //! Retrieve forward columns
   const ForwardColumns &forward_columns() const {
     return forward_columns_;
@@ -640,6 +662,14 @@ class CollectionBase {
   // value of system.
   uint64_t max_docs_per_segment_{0};
 
+  //! Time to live of documents in seconds, optional field, 0 means never
+  // expire.
+  uint64_t ttl_seconds_{0};
+
+  //! Load mode of persist segments, optional field, default follows index
+  // service.
+  LoadModes load_mode_{LoadModes::DEFAULT};
+
   //! Forward columns
   ForwardColumns forward_columns_{};
 
@@ -777,6 +807,8 @@ class CollectionMeta : public CollectionBase {
   //! Merge update param
   int merge_update_param(const CollectionBase &param) {
     set_max_docs_per_segment(param.max_docs_per_segment());
+    set_ttl_seconds(param.ttl_seconds());
+    set_load_mode(param.load_mode());
     mutable_forward_columns()->assign(param.forward_columns().begin(),
                                       param.forward_columns().end());
 
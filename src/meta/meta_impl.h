@@ -298,6 +298,26 @@ class CollectionImpl : public CollectionObject {
     meta_->set_max_docs_per_segment(count);
   }
 
+  //! Retrieve time to live of documents in seconds
+  uint64_t ttl_seconds() const override {
+    return meta_->ttl_seconds();
+  }
+
+  //! Set time to live of documents in seconds
+  void set_ttl_seconds(uint64_t seconds) override {
+    meta_->set_ttl_seconds(seconds);
+  }
+
+  //! Retrieve load mode of persist segments
+  uint32_t load_mode() const override {
+    return static_cast<uint32_t>(meta_->load_mode());
+  }
+
+  //! Set load mode of persist segments
+  void set_load_mode(uint32_t mode) override {
+    meta_->set_load_mode(static_cast<LoadModes>(mode));
+  }
+
   //! Retrieve collection revision
   uint32_t revision() const override {
     return meta_->revision();
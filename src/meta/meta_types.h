@@ -178,6 +178,18 @@ class CollectionObject {
   //! Set split document count
   virtual void set_max_docs_per_segment(uint64_t) = 0;
 
+  //! Retrieve time to live of documents in seconds
+  virtual uint64_t ttl_seconds() const = 0;
+
+  //! Set time to live of documents in seconds
+  virtual void set_ttl_seconds(uint64_t) = 0;
+
+  //! Retrieve load mode of persist segments
+  virtual uint32_t load_mode() const = 0;
+
+  //! Set load mode of persist segments
+  virtual void set_load_mode(uint32_t) = 0;
+
   //! Retrieve collection revision
   virtual uint32_t revision() const = 0;
 
@@ -43,15 +43,15 @@ DEFINE_SQLITE_SQL(kCreateCollection,
                   "INSERT INTO "
                   "collections(name, uid, uuid, forward_columns, "
                   "max_docs_per_segment, revision, status, "
-                  "current, io_mode) "
-                  "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9);");
+                  "current, io_mode, ttl_seconds, load_mode) "
+                  "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11);");
 
 // Update Collection SQL
 DEFINE_SQLITE_SQL(
     kUpdateCollection,
     "UPDATE collections set name=?1, uid=?2, "
     "forward_columns=?3, max_docs_per_segment=?4, revision=?5, status=?6, "
-    "current=?7, io_mode=?8 WHERE uuid=?9;");
+    "current=?7, io_mode=?8, ttl_seconds=?9, load_mode=?10 WHERE uuid=?11;");
 
 // Delete Collection SQL
 DEFINE_SQLITE_SQL(kDeleteCollection, "DELETE FROM collections WHERE name=?1;");
@@ -183,6 +183,9 @@ int SQLiteMetaStore::create_collection(const CollectionObject &collection) {
         sqlite3_bind_int(s, 7, collection.status());
         sqlite3_bind_int(s, 8, collection.current());
         sqlite3_bind_int(s, 9, collection.io_mode());
+        sqlite3_bind_int64(
+            s, 10, static_cast<sqlite3_int64>(collection.ttl_seconds()));
+        sqlite3_bind_int(s, 11, collection.load_mode());
         return 0;
       },
       nullptr);
@@ -213,7 +216,10 @@ int SQLiteMetaStore::update_collection(const CollectionObject &collection) {
         sqlite3_bind_int(s, 6, collection.status());
         sqlite3_bind_int(s, 7, collection.current());
         sqlite3_bind_int(s, 8, collection.io_mode());
-        sqlite3_bind_text(s, 9, collection.uuid().c_str(),
+        sqlite3_bind_int64(
+            s, 9, static_cast<sqlite3_int64>(collection.ttl_seconds()));
+        sqlite3_bind_int(s, 10, collection.load_mode());
+        sqlite3_bind_text(s, 11, collection.uuid().c_str(),
                           collection.uuid().length(), nullptr);
         return 0;
       },
@@ -280,6 +286,8 @@ static std::function<int(sqlite3_stmt *)> BuildFetcher(
     collection_ptr->set_status(sqlite3_column_int(s, 7));
     collection_ptr->set_current(sqlite3_column_int(s, 8));
     collection_ptr->set_io_mode(sqlite3_column_int(s, 9));
+    collection_ptr->set_ttl_seconds(sqlite3_column_int64(s, 10));
+    collection_ptr->set_load_mode(sqlite3_column_int(s, 11));
     return 0;
   };
 }
@@ -558,7 +566,9 @@ int SQLiteMetaStore::sync(sqlite3 *handle) {
       "    revision INTEGER, \n"
       "    status INTEGER, \n"
       "    current INTEGER, \n"
-      "    io_mode INTEGER\n"
+      "    io_mode INTEGER, \n"
+      "    ttl_seconds INTEGER DEFAULT 0, \n"
+      "    load_mode INTEGER DEFAULT 0\n"
       ");"
       "CREATE TABLE IF NOT EXISTS database_repositories ("
       "    id INTEGER PRIMARY KEY AUTOINCREMENT, \n"
@@ -576,6 +586,27 @@ int SQLiteMetaStore::sync(sqlite3 *handle) {
     LOG_ERROR("Failed to create table. msg[%s]", sqlite3_errstr(code));
     return PROXIMA_BE_ERROR_CODE(RuntimeError);
   }
+
+  // Upgrade collections table which created by elder version, columns
+  // must be added in order of declaration
+  for (const char *column : {"ttl_seconds", "load_mode"}) {
+    std::string probe_sql =
+        std::string("SELECT ") + column + " FROM collections LIMIT 0;";
+    sqlite3_stmt *probe = nullptr;
+    code = sqlite3_prepare_v2(handle, probe_sql.c_str(), -1, &probe, nullptr);
+    sqlite3_finalize(probe);
+    if (code == SQLITE_OK) {
+      continue;
+    }
+
+    std::string alter_sql = std::string("ALTER TABLE collections ADD COLUMN ") +
+                            column + " INTEGER DEFAULT 0;";
+    code = sqlite3_exec(handle, alter_sql.c_str(), nullptr, nullptr, nullptr);
+    if (code != SQLITE_OK) {
+      LOG_ERROR("Failed to upgrade table. msg[%s]", sqlite3_errstr(code));
+      return PROXIMA_BE_ERROR_CODE(RuntimeError);
+    }
+  }
   return 0;
 }
 
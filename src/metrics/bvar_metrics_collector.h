@@ -92,6 +92,26 @@ class BvarMetricsCollector : public MetricsCollector {
     write_batch_ << batch;
   }
 
+  void report_write_folded_count(uint32_t count) override {
+    write_folded_count_ << count;
+  }
+
+  void report_write_rejected_count(uint32_t count) override {
+    write_rejected_count_ << count;
+  }
+
+  void report_query_arena_size(uint64_t bytes) override {
+    query_arena_size_ << bytes;
+  }
+
+  void report_get_document_arena_size(uint64_t bytes) override {
+    get_document_arena_size_ << bytes;
+  }
+
+  void report_write_arena_size(uint64_t bytes) override {
+    write_arena_size_ << bytes;
+  }
+
  private:
   using IntRecorder = bvar::IntRecorder;
   using LatencyRecorder = bvar::LatencyRecorder;
@@ -124,6 +144,10 @@ class BvarMetricsCollector : public MetricsCollector {
   // query count per query_type
   std::vector<std::unique_ptr<LongAdder>> query_type_counter_;
   std::vector<std::unique_ptr<WindowedLongAdder>> query_type_counter_second_;
+  // average arena bytes per query request
+  IntRecorder query_arena_size_;
+  WindowedIntRecorder query_arena_size_second_{
+      MODULE_QUERY, "arena_size_second", &query_arena_size_, 1};
 
   //! get document metrics
   // get document request and rt
@@ -138,6 +162,10 @@ class BvarMetricsCollector : public MetricsCollector {
   WindowedLongAdder get_document_failure_count_second_{
       MODULE_GET_DOCUMENT, "failure_count_second", &get_document_failure_count_,
       1};
+  // average arena bytes per get document request
+  IntRecorder get_document_arena_size_;
+  WindowedIntRecorder get_document_arena_size_second_{
+      MODULE_GET_DOCUMENT, "arena_size_second", &get_document_arena_size_, 1};
 
   //! write metrics
   // write request and rt
@@ -157,6 +185,18 @@ class BvarMetricsCollector : public MetricsCollector {
   IntRecorder write_batch_;
   WindowedIntRecorder write_batch_second_{MODULE_WRITE, "batch_second",
                                           &write_batch_, 1};
+  // operations folded into others of the same key
+  LongAdder write_folded_count_;
+  WindowedLongAdder write_folded_count_second_{
+      MODULE_WRITE, "folded_count_second", &write_folded_count_, 1};
+  // rows of a batch rejected by collection
+  LongAdder write_rejected_count_;
+  WindowedLongAdder write_rejected_count_second_{
+      MODULE_WRITE, "rejected_count_second", &write_rejected_count_, 1};
+  // average arena bytes per write request
+  IntRecorder write_arena_size_;
+  WindowedIntRecorder write_arena_size_second_{
+      MODULE_WRITE, "arena_size_second", &write_arena_size_, 1};
 };
 
 }  // namespace metrics
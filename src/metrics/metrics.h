@@ -44,6 +44,11 @@ class QueryMetrics {
     query_type_ = request.query_type();
   }
 
+  //! Update arena bytes allocated by request
+  void update_with_arena_size(uint64_t bytes) {
+    arena_size_ = bytes;
+  }
+
   ~QueryMetrics() {
     if (batch_ <= 0) {
       return;
@@ -54,6 +59,9 @@ class QueryMetrics {
     metrics_obj.report_query_rt(type_, batch_, single_rt_us);
     metrics_obj.report_query_count_by_type(query_type_, batch_);
     metrics_obj.report_query_batch(batch_);
+    if (arena_size_ > 0) {
+      metrics_obj.report_query_arena_size(arena_size_);
+    }
     if (*ret_ == 0) {
       metrics_obj.report_query_success_count(batch_);
     } else {
@@ -81,6 +89,7 @@ class QueryMetrics {
   size_t batch_{0};
   proto::QueryRequest_QueryType query_type_{
       proto::QueryRequest_QueryType_QT_KNN};
+  uint64_t arena_size_{0};
   ailego::ElapsedTime timer_;
 };
 
@@ -100,6 +109,9 @@ class GetDocumentMetrics {
     auto rt_us = timer_.micro_seconds();
     auto &metrics_obj = MetricsCollector::GetInstance();
     metrics_obj.report_get_document_rt(type_, rt_us);
+    if (arena_size_ > 0) {
+      metrics_obj.report_get_document_arena_size(arena_size_);
+    }
     if (*ret_ == 0) {
       metrics_obj.report_get_document_success_count();
     } else {
@@ -107,9 +119,15 @@ class GetDocumentMetrics {
     }
   }
 
+  //! Update arena bytes allocated by request
+  void update_with_arena_size(uint64_t bytes) {
+    arena_size_ = bytes;
+  }
+
  private:
   ProtocolType type_{ProtocolType::kGrpc};
   const int *ret_{nullptr};
+  uint64_t arena_size_{0};
   ailego::ElapsedTime timer_;
 };
 
@@ -144,6 +162,9 @@ class WriteMetrics {
                                                            delete_doc_count_);
     }
     metrics_obj.report_write_batch(batch_);
+    if (arena_size_ > 0) {
+      metrics_obj.report_write_arena_size(arena_size_);
+    }
     if (*ret_ == 0) {
       metrics_obj.report_write_success_count(batch_);
     } else {
@@ -177,6 +198,11 @@ class WriteMetrics {
     batch_ = req.rows_size();
   }
 
+  //! Update arena bytes allocated by request
+  void update_with_arena_size(uint64_t bytes) {
+    arena_size_ = bytes;
+  }
+
  private:
   ProtocolType type_{ProtocolType::kGrpc};
   const int *ret_{nullptr};
@@ -185,6 +211,7 @@ class WriteMetrics {
   size_t update_doc_count_{0};
   size_t delete_doc_count_{0};
   size_t batch_{0};
+  uint64_t arena_size_{0};
 };
 
 
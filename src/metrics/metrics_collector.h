@@ -80,6 +80,19 @@ class MetricsCollector {
 
   virtual void report_write_batch(uint32_t /*batch*/) {}
 
+  //! report operations folded into others of the same key in a batch
+  virtual void report_write_folded_count(uint32_t /*count*/) {}
+
+  //! report rows of a batch rejected by collection
+  virtual void report_write_rejected_count(uint32_t /*count*/) {}
+
+  //! report arena bytes allocated per request
+  virtual void report_query_arena_size(uint64_t /*bytes*/) {}
+
+  virtual void report_get_document_arena_size(uint64_t /*bytes*/) {}
+
+  virtual void report_write_arena_size(uint64_t /*bytes*/) {}
+
  private:
   static std::string metrics_name_;
 };
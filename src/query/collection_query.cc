@@ -19,6 +19,7 @@
  */
 
 #include "collection_query.h"
+#include <algorithm>
 #include "common/error_code.h"
 #include "common/logger.h"
 #include "forward_serializer.h"
@@ -93,16 +94,56 @@ ColumnNameList *ContextImpl::get_forward_columns(
   return &iit.first->second;
 }
 
+const std::vector<size_t> &ContextImpl::get_projection(
+    uint64_t revision, const ColumnNameList &columns) {
+  auto it = revision_to_projection_.find(revision);
+  if (it != revision_to_projection_.end()) {
+    return it->second;
+  }
+  std::vector<size_t> positions;
+  for (auto &column : projected_columns_) {
+    auto cit = std::find(columns.begin(), columns.end(), column);
+    if (cit != columns.end()) {
+      positions.emplace_back(cit - columns.begin());
+    }
+  }
+  auto iit = revision_to_projection_.emplace(revision, std::move(positions));
+  return iit.first->second;
+}
+
 int ContextImpl::fill_forward(const index::QueryResult &forward,
                               proto::Document *doc) {
   auto *columns = get_forward_columns(forward);
-  int code = PROXIMA_BE_ERROR_CODE(InvalidRevision);
-  if (columns) {
+  if (!columns) {
+    return PROXIMA_BE_ERROR_CODE(InvalidRevision);
+  }
+  int values_size = doc->forward_column_values_size();
+  int code = 0;
+  if (projected_columns_.empty()) {
     code = ForwardSerializer::FillForward(forward, *columns, doc);
+  } else {
+    code = ForwardSerializer::FillForward(
+        forward, *columns, get_projection(forward.revision, *columns), doc);
+  }
+
+  // Parsed bytes and string values own a copy of their bytes
+  for (int i = values_size; i < doc->forward_column_values_size(); ++i) {
+    auto &value = doc->forward_column_values(i).value();
+    if (value.has_bytes_value()) {
+      forward_stats_.add_copy(value.bytes_value().size(), true);
+    } else if (value.has_string_value()) {
+      forward_stats_.add_copy(value.string_value().size(), true);
+    }
   }
   return code;
 }
 
+void ContextImpl::report_forward_stats() {
+  profiler()->add("forward_copy_count", forward_stats_.copy_count.load());
+  profiler()->add("forward_copy_bytes", forward_stats_.copy_bytes.load());
+  profiler()->add("forward_alloc_count", forward_stats_.alloc_count.load());
+}
+
 //! Constructor
 CollectionQuery::CollectionQuery(uint64_t traceID,
                                  const proto::QueryRequest *pb_request,
@@ -115,7 +156,12 @@ CollectionQuery::CollectionQuery(uint64_t traceID,
                   std::move(meta_wrapper), std::move(profiler_ptr),
                   std::move(executor_ptr)),
       request_(pb_request),
-      response_(pb_response) {}
+      response_(pb_response) {
+  if (request_) {
+    set_forward_projection(ColumnNameList(request_->forward_columns().begin(),
+                                          request_->forward_columns().end()));
+  }
+}
 
 //! Destructor
 CollectionQuery::~CollectionQuery() = default;
@@ -68,6 +68,23 @@ class ContextImpl : public Query, public CollectionQueryContext {
   //! Get forward columns
   ColumnNameList *get_forward_columns(const index::QueryResult &forward);
 
+  //! Set projected forward columns, all columns filled if empty
+  void set_forward_projection(const ColumnNameList &columns) {
+    projected_columns_ = columns;
+  }
+
+  //! Get positions of projected columns in forward columns of revision
+  const std::vector<size_t> &get_projection(uint64_t revision,
+                                            const ColumnNameList &columns);
+
+  //! Retrieve copy stats of forward bytes served by this query
+  index::ForwardCopyStats *mutable_forward_stats() {
+    return &forward_stats_;
+  }
+
+  //! Report copy stats of forward bytes to profiler
+  void report_forward_stats();
+
   //! Check valid executor
   bool valid_executor() const {
     return executor_ != nullptr;
@@ -91,6 +108,15 @@ class ContextImpl : public Query, public CollectionQueryContext {
 
   //! revision map
   std::unordered_map<uint64_t, ColumnNameList> revision_to_forward_columns_;
+
+  //! Projected forward columns
+  ColumnNameList projected_columns_{};
+
+  //! Projected column positions of each revision
+  std::unordered_map<uint64_t, std::vector<size_t>> revision_to_projection_;
+
+  //! Copies and allocations of forward bytes
+  index::ForwardCopyStats forward_stats_{};
 };
 
 
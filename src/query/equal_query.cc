@@ -34,7 +34,12 @@ EqualQuery::EqualQuery(uint64_t traceID, const proto::GetDocumentRequest *req,
                        proto::GetDocumentResponse *resp)
     : ContextImpl(traceID, index, meta_wrapper, profiler_ptr, executor_ptr),
       request_(req),
-      response_(resp) {}
+      response_(resp) {
+  if (request_) {
+    set_forward_projection(ColumnNameList(request_->forward_columns().begin(),
+                                          request_->forward_columns().end()));
+  }
+}
 
 //! Destructor
 EqualQuery::~EqualQuery() = default;
@@ -92,6 +97,9 @@ int EqualQuery::evaluate() {
       if (task->hit()) {  // Pick first hit document, drop others
         proto::Document *doc = response_->mutable_document();
         doc->set_primary_key(primary_key());
+        // Segment fetched a copy of the hit record
+        mutable_forward_stats()->add_copy(
+            task->forward().forward_data.size(), true);
         code = fill_forward(task->forward(), doc);
         if (code != 0) {
           LOG_WARN("Fill forward failed. code[%d] what[%s]", code,
@@ -101,6 +109,7 @@ int EqualQuery::evaluate() {
       }
     }
   }
+  report_forward_stats();
   return code;
 }
 
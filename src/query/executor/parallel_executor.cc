@@ -48,7 +48,9 @@ int ParallelExecutor::execute_tasks(const TaskPtrList &tasks) {
   auto iter = tasks.begin();
   // Keep the head task, schedule others to other coroutines
   while (++iter != tasks.end()) {
-    code = scheduler_->schedule(*iter);
+    int node = (*iter)->numa_node();
+    code = node < 0 ? scheduler_->schedule(*iter)
+                    : scheduler_->schedule_on_node(*iter, node);
     // Break loop, if schedule task failed，handle schedule error in
     // wait_finish function
     if (code != 0) {
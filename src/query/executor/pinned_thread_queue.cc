@@ -0,0 +1,133 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Implementation of pinned thread queue
+ */
+
+#include "pinned_thread_queue.h"
+#include "common/error_code.h"
+#include "common/logger.h"
+#include "common/numa_topology.h"
+
+namespace proxima {
+namespace be {
+namespace query {
+
+PinnedThreadQueue::PinnedThreadQueue(uint32_t node) : node_(node) {}
+
+PinnedThreadQueue::~PinnedThreadQueue() {
+  if (started()) {
+    stop();
+  }
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+int PinnedThreadQueue::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (status_ != Status::INITIALIZED) {
+    LOG_ERROR("Failed to start PinnedThreadQueue, which has been started");
+    return PROXIMA_BE_ERROR_CODE(RuntimeError);
+  }
+
+  worker_ = std::thread(&PinnedThreadQueue::run, this);
+  status_ = Status::STARTED;
+  LOG_DEBUG("PinnedThreadQueue success to start, node[%u]", node_);
+  return 0;
+}
+
+int PinnedThreadQueue::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (status_ != Status::STARTED) {
+    LOG_DEBUG("Can't stop an queue, which does not started yet. node[%u]",
+              node_);
+    return PROXIMA_BE_ERROR_CODE(RuntimeError);
+  }
+
+  status_ = Status::STOPPED;
+  cond_.notify_all();
+  LOG_INFO("PinnedThreadQueue stopped, node[%u]", node_);
+  return 0;
+}
+
+int PinnedThreadQueue::join() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (status_ != Status::STOPPED) {
+      LOG_ERROR("Can't join an queue, which did not stop yet, node[%u]",
+                node_);
+      return PROXIMA_BE_ERROR_CODE(RuntimeError);
+    }
+  }
+
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  status_ = Status::JOINED;
+  return 0;
+}
+
+int PinnedThreadQueue::put(const TaskPtr &task) {
+  if (task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (status_ == Status::STARTED) {
+      task->status(Task::Status::SCHEDULED);
+      tasks_.emplace_back(task);
+      cond_.notify_one();
+      LOG_DEBUG("Scheduled task[%s] on node[%u]", task->name().c_str(),
+                node_);
+      return 0;
+    }
+  }
+  LOG_ERROR("Failed to schedule task");
+  return PROXIMA_BE_ERROR_CODE(RuntimeError);
+}
+
+bool PinnedThreadQueue::started() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return status_ == Status::STARTED;
+}
+
+void PinnedThreadQueue::run() {
+  NumaTopology::Instance().bind_thread(node_);
+
+  while (true) {
+    TaskPtr task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] {
+        return !tasks_.empty() || status_ != Status::STARTED;
+      });
+      // Drain pending tasks before exit, waiters rely on them finished
+      if (tasks_.empty()) {
+        break;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    // Task may have been run by waiter already, run is a no-op then
+    task->run();
+  }
+  LOG_INFO("PinnedThreadQueue worker exited, node[%u]", node_);
+}
+
+}  // namespace query
+}  // namespace be
+}  // namespace proxima
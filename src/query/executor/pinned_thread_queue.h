@@ -0,0 +1,95 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Task queue running on a thread bound to a numa node
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "task_queue.h"
+
+namespace proxima {
+namespace be {
+namespace query {
+
+/*!
+ * Implementation of TaskQueue interface, which runs tasks on a dedicated
+ * thread bound to the cpus of a numa node. Bthread workers can't be
+ * pinned individually, so numa aware scheduler uses this queue instead.
+ */
+class PinnedThreadQueue : public TaskQueue {
+ public:
+  //! Constructor
+  explicit PinnedThreadQueue(uint32_t node);
+
+  //! Destructor
+  ~PinnedThreadQueue() override;
+
+ public:
+  //! Retrieve numa node of queue
+  uint32_t node() const {
+    return node_;
+  }
+
+  //! Start task queue, return value 0 for success, otherwise failed
+  int start() override;
+
+  //! Stop task queue, return value 0 for success, otherwise failed
+  int stop() override;
+
+  //! Join task queue, return value 0 for success, otherwise failed
+  int join() override;
+
+  //! Put the task in queue
+  //! @return,     0: succeed, mark status of task as Scheduled
+  //!          other: failed
+  int put(const TaskPtr &task) override;
+
+  //! Retrieve start flags
+  bool started() const override;
+
+ private:
+  //! Worker routine
+  void run();
+
+ private:
+  //! Numa node which worker bound to
+  uint32_t node_{0U};
+
+  //! Worker thread
+  std::thread worker_{};
+
+  //! Pending tasks
+  std::deque<TaskPtr> tasks_{};
+
+  //! Guard of tasks and status
+  mutable std::mutex mutex_{};
+
+  //! Notify worker new task arrived or queue stopped
+  std::condition_variable cond_{};
+
+  //! Queue status
+  TaskQueue::Status status_{TaskQueue::Status::INITIALIZED};
+};
+
+
+}  // namespace query
+}  // namespace be
+}  // namespace proxima
@@ -19,11 +19,14 @@
  */
 
 #include "scheduler.h"
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include "common/error_code.h"
 #include "common/logger.h"
+#include "common/numa_topology.h"
 #include "bthread_queue.h"
+#include "pinned_thread_queue.h"
 
 namespace proxima {
 namespace be {
@@ -73,6 +76,11 @@ class SchedulerImpl : public Scheduler {
     return PROXIMA_BE_ERROR_CODE(UnreadyQueue);
   }
 
+  //! Dispatch task to execution queue, ignore node
+  int schedule_on_node(TaskPtr task, uint32_t /* node */) override {
+    return schedule(std::move(task));
+  }
+
   //! Retrieve concurrency field
   uint32_t concurrency() const override {
     return concurrency_;
@@ -115,13 +123,120 @@ class SchedulerImpl : public Scheduler {
   Selector selector_{};
 };
 
+/*!
+ * Numa aware scheduler, workers are split into per node groups bound to
+ * the cpus of node, and tasks are dispatched to the group of their node
+ */
+class NumaSchedulerImpl : public Scheduler {
+ public:
+  //! Constructor
+  NumaSchedulerImpl() = default;
+
+  //! Destructor
+  ~NumaSchedulerImpl() override {
+    recycle_queue();
+  }
+
+ public:
+  //! Dispatch task to execution queue of any node
+  int schedule(TaskPtr task) override {
+    if (!node_queues_.empty()) {
+      uint32_t node =
+          selector_.pick(static_cast<uint32_t>(node_queues_.size()));
+      return schedule_on_node(std::move(task), node);
+    }
+    return PROXIMA_BE_ERROR_CODE(UnreadyQueue);
+  }
+
+  //! Dispatch task to execution queue of node
+  int schedule_on_node(TaskPtr task, uint32_t node) override {
+    if (!node_queues_.empty()) {
+      auto &queues = node_queues_[node % node_queues_.size()];
+      uint32_t pos = node_selectors_[node % node_queues_.size()].pick(
+          static_cast<uint32_t>(queues.size()));
+      LOG_DEBUG("Selector return[%u], node[%u], task[%s]", pos, node,
+                task->name().c_str());
+      return queues[pos]->put(task);
+    }
+    return PROXIMA_BE_ERROR_CODE(UnreadyQueue);
+  }
+
+  //! Retrieve concurrency field
+  uint32_t concurrency() const override {
+    return concurrency_;
+  }
+
+  //! Set concurrency field
+  uint32_t concurrency(uint32_t concurrent) override {
+    recycle_queue();
+    concurrency_ = resize(concurrent);
+    return concurrency_;
+  }
+
+ private:
+  //! Split queues evenly across nodes, at least one for each node
+  uint32_t resize(uint32_t size) {
+    auto &topology = NumaTopology::Instance();
+    uint32_t node_count = std::max(topology.node_count(), 1U);
+    uint32_t per_node = std::max((size + node_count - 1) / node_count, 1U);
+
+    uint32_t count = 0U;
+    node_queues_.resize(node_count);
+    node_selectors_.reset(new RoundRobinSelector[node_count]);
+    for (uint32_t node = 0; node < node_count; node++) {
+      for (uint32_t i = 0; i < per_node; i++) {
+        TaskQueuePtr queue = std::make_shared<PinnedThreadQueue>(node);
+        if (queue->start() == 0) {
+          node_queues_[node].emplace_back(queue);
+          count++;
+        }
+      }
+      if (node_queues_[node].empty()) {
+        LOG_ERROR("Start task queue of numa node failed. node[%u]", node);
+        recycle_queue();
+        return 0U;
+      }
+    }
+    LOG_INFO("Numa aware scheduler started. node_count[%u] queue_count[%u]",
+             node_count, count);
+    return count;
+  }
+
+  void recycle_queue() {
+    for (auto &queues : node_queues_) {
+      for (auto &queue : queues) {
+        queue->stop();
+        queue->join();
+      }
+    }
+    node_queues_.clear();
+  }
+
+ private:
+  //! Concurrency
+  uint32_t concurrency_{0};
+  //! Execution queues of each node
+  std::vector<TaskQueueVector> node_queues_{};
+  //! Selector of nodes
+  RoundRobinSelector selector_{};
+  //! Selectors of queues in each node
+  std::unique_ptr<RoundRobinSelector[]> node_selectors_{};
+};
+
 //! Retrieve default scheduler reference
 SchedulerPtr Scheduler::Default() {
   static SchedulerPtr kScheduler =
-      SchedulerPtr(new SchedulerImpl<RoundRobinSelector>());
+      NumaTopology::Instance().enabled()
+          ? Scheduler::NumaAware()
+          : SchedulerPtr(new SchedulerImpl<RoundRobinSelector>());
   return kScheduler;
 }
 
+//! Create numa aware scheduler
+SchedulerPtr Scheduler::NumaAware() {
+  return SchedulerPtr(new NumaSchedulerImpl());
+}
+
 //! Retrieve hardware concurrency
 uint32_t Scheduler::HostConcurrency() {
   return std::thread::hardware_concurrency();
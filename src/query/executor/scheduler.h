@@ -39,6 +39,10 @@ class Scheduler {
   //! Static helper function, get default scheduler
   static SchedulerPtr Default();
 
+  //! Static helper function, create a scheduler whose workers are grouped
+  //! and bound by numa nodes of NumaTopology::Instance()
+  static SchedulerPtr NumaAware();
+
   //! Default system concurrency
   static uint32_t HostConcurrency();
 
@@ -50,6 +54,10 @@ class Scheduler {
   //! Dispatch task to execution queue, return 0 for success, otherwise failed
   virtual int schedule(TaskPtr task) = 0;
 
+  //! Dispatch task to execution queue of numa node, which falls back to
+  //! schedule(task) if scheduler is not numa aware
+  virtual int schedule_on_node(TaskPtr task, uint32_t node) = 0;
+
   //! Retrieve concurrency of scheduler
   virtual uint32_t concurrency() const = 0;
 
@@ -88,6 +88,11 @@ class Task {
 
   //! Wait until task has been finished， return value same with finished()
   virtual bool wait_finish() = 0;
+
+  //! Retrieve numa node which task prefers to run on, -1 for any node
+  virtual int numa_node() const {
+    return -1;
+  }
 };
 
 
@@ -19,6 +19,8 @@
  */
 
 #include "forward_serializer.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 #include "common/error_code.h"
 #include "common/logger.h"
 
@@ -53,6 +55,66 @@ int ForwardSerializer::FillForward(const index::QueryResult &forward,
   return 0;
 }
 
+int ForwardSerializer::FillForward(const index::QueryResult &forward,
+                                   const ColumnNameList &columns,
+                                   const std::vector<size_t> &positions,
+                                   proto::Document *doc) {
+  using google::protobuf::internal::WireFormatLite;
+
+  // Slot of each column in projection, -1 for unprojected ones
+  std::vector<int> slots(columns.size(), -1);
+  for (size_t i = 0; i < positions.size(); i++) {
+    slots[positions[i]] = static_cast<int>(i);
+  }
+
+  // Values of GenericValueList are length delimited fields with number 1
+  const std::string &buf = forward.forward_data;
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t *>(buf.data()),
+      static_cast<int>(buf.size()));
+  std::vector<proto::GenericValue> values(positions.size());
+  size_t pos = 0;
+  for (uint32_t tag = input.ReadTag(); tag != 0; tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) != 1 ||
+        WireFormatLite::GetTagWireType(tag) !=
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return PROXIMA_BE_ERROR_CODE(MismatchedForward);
+      }
+      continue;
+    }
+
+    uint32_t len = 0;
+    if (!input.ReadVarint32(&len)) {
+      return PROXIMA_BE_ERROR_CODE(MismatchedForward);
+    }
+    if (pos < slots.size() && slots[pos] >= 0) {
+      auto limit = input.PushLimit(static_cast<int>(len));
+      bool parsed = values[slots[pos]].ParseFromCodedStream(&input);
+      input.PopLimit(limit);
+      if (!parsed) {
+        return PROXIMA_BE_ERROR_CODE(MismatchedForward);
+      }
+    } else if (!input.Skip(static_cast<int>(len))) {
+      return PROXIMA_BE_ERROR_CODE(MismatchedForward);
+    }
+    pos++;
+  }
+
+  if (pos != columns.size()) {
+    LOG_DEBUG("Mismatch forwards. buf_size[%lu], values[%zu], forwards[%lu]",
+              buf.size(), pos, columns.size());
+    return PROXIMA_BE_ERROR_CODE(MismatchedForward);
+  }
+
+  for (size_t i = 0; i < positions.size(); i++) {
+    proto::GenericKeyValue *kv = doc->add_forward_column_values();
+    kv->set_key(columns[positions[i]]);
+    kv->mutable_value()->Swap(&values[i]);
+  }
+  return 0;
+}
+
 }  // namespace query
 }  // namespace be
 }  // namespace proxima
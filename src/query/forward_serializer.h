@@ -40,6 +40,14 @@ class ForwardSerializer {
   //! Fill forward field
   static int FillForward(const index::QueryResult &forward,
                          const ColumnNameList &columns, proto::Document *doc);
+
+  //! Fill projected forward fields, positions refer to columns. Only
+  //! values of projected columns are parsed, others are skipped in wire
+  //! format
+  static int FillForward(const index::QueryResult &forward,
+                         const ColumnNameList &columns,
+                         const std::vector<size_t> &positions,
+                         proto::Document *doc);
 };
 
 
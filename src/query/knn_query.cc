@@ -108,6 +108,7 @@ int KNNQuery::evaluate() {
     // Merge Result
     code = collect_result();
   }
+  report_forward_stats();
   profiler()->close_stage();
   return code;
 }
@@ -193,6 +194,7 @@ int KNNQuery::build_query_param(
   query_param_.dimension = param.dimension();
   query_param_.radius = param.radius();
   query_param_.is_linear = param.is_linear();
+  query_param_.forward_stats = mutable_forward_stats();
   be::IndexParamsHelper::SerializeToParams(param.extra_params(),
                                            &query_param_.extra_params);
   return 0;
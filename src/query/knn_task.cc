@@ -20,6 +20,7 @@
 
 #include "knn_task.h"
 #include "common/error_code.h"
+#include "common/numa_topology.h"
 
 namespace proxima {
 namespace be {
@@ -38,6 +39,14 @@ const std::vector<index::QueryResultList> &KNNTask::result() const {
   return result_;
 }
 
+int KNNTask::numa_node() const {
+  auto &topology = NumaTopology::Instance();
+  if (!segment_ || !topology.enabled()) {
+    return -1;
+  }
+  return static_cast<int>(topology.node_of(segment_->segment_id()));
+}
+
 int KNNTask::do_run() {
   if (!segment_ || !context_) {
     return PROXIMA_BE_ERROR_CODE(InvalidSegment);
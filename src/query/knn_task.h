@@ -54,6 +54,9 @@ class KNNTask : public BthreadTask {
   //! Retrieve result of knn_search
   const std::vector<index::QueryResultList> &result() const;
 
+  //! Retrieve numa node owning the segment
+  int numa_node() const override;
+
  private:
   //! Run search task
   int do_run() override;
@@ -186,7 +186,9 @@ void ProximaRequestHandler::write(
   metrics.update_with_write_request(*request);
   LOG_DEBUG("%s", request->ShortDebugString().c_str());
   brpc::ClosureGuard done_guard(done);
-  code = this->write_impl(*request, response);
+  RequestArena arena;
+  code = this->write_impl(*request, &arena, response);
+  metrics.update_with_arena_size(arena.space_allocated());
 }
 
 void ProximaRequestHandler::query(::google::protobuf::RpcController *,
@@ -233,6 +235,35 @@ void ProximaRequestHandler::get_version(
   SetStatus(0, response->mutable_status());
 }
 
+void ProximaRequestHandler::attach_segments(
+    ::google::protobuf::RpcController * /*controller*/,
+    const proto::AttachSegmentsRequest *request,
+    proto::AttachSegmentsResponse *response,
+    ::google::protobuf::Closure *done) {
+  brpc::ClosureGuard done_guard(done);
+  int ret = admin_agent_->attach_segments(*request, response);
+  SetStatus(ret, response->mutable_status());
+}
+
+void ProximaRequestHandler::checkpoint_collection(
+    ::google::protobuf::RpcController * /*controller*/,
+    const proto::CheckpointCollectionRequest *request,
+    proto::CheckpointCollectionResponse *response,
+    ::google::protobuf::Closure *done) {
+  brpc::ClosureGuard done_guard(done);
+  int ret = admin_agent_->checkpoint_collection(*request, response);
+  SetStatus(ret, response->mutable_status());
+}
+
+void ProximaRequestHandler::trace_write(
+    ::google::protobuf::RpcController * /*controller*/,
+    const proto::TraceWriteRequest *request,
+    proto::TraceWriteResponse *response, ::google::protobuf::Closure *done) {
+  brpc::ClosureGuard done_guard(done);
+  int ret = admin_agent_->trace_write(*request, response);
+  SetStatus(ret, response->mutable_status());
+}
+
 void ProximaRequestHandler::collection(
     ::google::protobuf::RpcController *controller,
     const proto::HttpRequest * /*request*/, proto::HttpResponse * /*response*/,
@@ -293,15 +324,17 @@ void ProximaRequestHandler::write(::google::protobuf::RpcController *controller,
   if (code == 0) {
     const std::string http_body =
         brpc_controller->request_attachment().to_string();
-    proto::WriteRequest pb_request;
-    code = ParseRequestFromJson(http_body, &pb_request);
+    RequestArena arena;
+    auto *pb_request = arena.create_message<proto::WriteRequest>();
+    code = ParseRequestFromJson(http_body, pb_request);
     if (code == 0) {
-      pb_request.set_collection_name(collection_name);
-      metrics.update_with_write_request(pb_request);
-      code = this->write_impl(pb_request, &status);
+      pb_request->set_collection_name(collection_name);
+      metrics.update_with_write_request(*pb_request);
+      code = this->write_impl(*pb_request, &arena, &status);
     } else {
       SetStatus(code, &status);
     }
+    metrics.update_with_arena_size(arena.space_allocated());
   }
 
   SerializeResponse(status, brpc_controller);
@@ -317,21 +350,24 @@ void ProximaRequestHandler::query(::google::protobuf::RpcController *controller,
   metrics::QueryMetrics metrics{metrics::ProtocolType::kHttp, &code};
   auto *brpc_controller = dynamic_cast<brpc::Controller *>(controller);
 
+  // Request and response are released with arena in one shot
+  RequestArena arena;
+  auto *pb_response = arena.create_message<proto::QueryResponse>();
+
   // Check http method
-  proto::QueryResponse pb_response;
   RETURN_IF_NOT_HTTP_METHOD(brpc_controller, brpc::HTTP_METHOD_POST,
-                            &pb_response, pb_response.mutable_status())
+                            pb_response, pb_response->mutable_status())
 
   std::string collection_name;
   code = parse_collection(brpc_controller, &collection_name);
   if (code == 0) {
     const std::string body = brpc_controller->request_attachment().to_string();
-    proto::QueryRequest pb_request;
-    code = ParseRequestFromJson(body, &pb_request);
+    auto *pb_request = arena.create_message<proto::QueryRequest>();
+    code = ParseRequestFromJson(body, pb_request);
     if (code == 0) {
-      metrics.update_with_query_request(pb_request);
-      pb_request.set_collection_name(collection_name);
-      code = query_agent_->search(&pb_request, &pb_response);
+      metrics.update_with_query_request(*pb_request);
+      pb_request->set_collection_name(collection_name);
+      code = query_agent_->search(pb_request, pb_response);
       if (code != 0) {
         LOG_ERROR("Can't handle query. code[%d] what[%s]", code,
                   ErrorCode::What(code));
@@ -339,9 +375,10 @@ void ProximaRequestHandler::query(::google::protobuf::RpcController *controller,
     }
   }
 
-  pb_response.set_latency_us(latency.micro_seconds());
-  SetStatus(code, pb_response.mutable_status());
-  SerializeResponse(pb_response, brpc_controller);
+  pb_response->set_latency_us(latency.micro_seconds());
+  SetStatus(code, pb_response->mutable_status());
+  SerializeResponse(*pb_response, brpc_controller);
+  metrics.update_with_arena_size(arena.space_allocated());
 }
 
 void ProximaRequestHandler::get_document_by_key(
@@ -354,20 +391,34 @@ void ProximaRequestHandler::get_document_by_key(
   int code = 0;
   metrics::GetDocumentMetrics metrics{ProtocolType::kHttp, &code};
 
+  // Request and response are released with arena in one shot
+  RequestArena arena;
+  auto *pb_response = arena.create_message<proto::GetDocumentResponse>();
+
   // Check http method
-  proto::GetDocumentResponse pb_response;
   RETURN_IF_NOT_HTTP_METHOD(brpc_controller, brpc::HTTP_METHOD_GET,
-                            &pb_response, pb_response.mutable_status())
+                            pb_response, pb_response->mutable_status())
 
   std::string collection_name;
   code = parse_collection(brpc_controller, &collection_name);
   if (code == 0) {
-    proto::GetDocumentRequest pb_request;
-    pb_request.set_collection_name(collection_name);
+    auto *pb_request = arena.create_message<proto::GetDocumentRequest>();
+    pb_request->set_collection_name(collection_name);
     auto *key = brpc_controller->http_request().uri().GetQuery("key");
+    // Projected forward columns are separated by comma
+    auto *columns = brpc_controller->http_request().uri().GetQuery("columns");
+    if (columns) {
+      std::vector<std::string> column_names;
+      ailego::StringHelper::Split<std::string>(*columns, ',', &column_names);
+      for (auto &column_name : column_names) {
+        if (!column_name.empty()) {
+          pb_request->add_forward_columns(column_name);
+        }
+      }
+    }
     if (key) {
-      pb_request.set_primary_key(std::strtoull(key->c_str(), nullptr, 10));
-      code = query_agent_->search_by_key(&pb_request, &pb_response);
+      pb_request->set_primary_key(std::strtoull(key->c_str(), nullptr, 10));
+      code = query_agent_->search_by_key(pb_request, pb_response);
       if (code != 0) {
         LOG_ERROR("Can't handle query. code[%d] what[%s]", code,
                   ErrorCode::What(code));
@@ -377,8 +428,9 @@ void ProximaRequestHandler::get_document_by_key(
     }
   }
 
-  SetStatus(code, pb_response.mutable_status());
-  SerializeResponse(pb_response, brpc_controller);
+  SetStatus(code, pb_response->mutable_status());
+  SerializeResponse(*pb_response, brpc_controller);
+  metrics.update_with_arena_size(arena.space_allocated());
 }
 
 void ProximaRequestHandler::list_collections(
@@ -415,6 +467,7 @@ void ProximaRequestHandler::get_version(
 }
 
 int ProximaRequestHandler::write_impl(const proto::WriteRequest &request,
+                                      RequestArena *arena,
                                       proto::Status *response) {
   auto &collection_name = request.collection_name();
   auto meta = index_agent_->get_collection_meta(collection_name);
@@ -426,8 +479,8 @@ int ProximaRequestHandler::write_impl(const proto::WriteRequest &request,
   }
 
   agent::WriteRequest write_request;
-  int code =
-      WriteRequestBuilder::build(*meta, *column_order, request, &write_request);
+  int code = WriteRequestBuilder::build(*meta, *column_order, request,
+                                       &write_request, arena->arena());
   if (code != 0) {
     SetStatus(code, response);
     LOG_ERROR("Write request builder build failed. code[%d] collection[%s]",
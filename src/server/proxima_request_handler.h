@@ -24,6 +24,7 @@
 #include <brpc/server.h>
 #include "admin/admin_agent.h"
 #include "agent/index_agent.h"
+#include "common/request_arena.h"
 #include "proto/proxima_be.pb.h"
 #include "query/query_agent.h"
 
@@ -85,6 +86,21 @@ class ProximaRequestHandler : public proto::ProximaService,
                    proto::GetVersionResponse *response,
                    ::google::protobuf::Closure *done) override;
 
+  void attach_segments(::google::protobuf::RpcController *controller,
+                       const proto::AttachSegmentsRequest *request,
+                       proto::AttachSegmentsResponse *response,
+                       ::google::protobuf::Closure *done) override;
+
+  void checkpoint_collection(::google::protobuf::RpcController *controller,
+                             const proto::CheckpointCollectionRequest *request,
+                             proto::CheckpointCollectionResponse *response,
+                             ::google::protobuf::Closure *done) override;
+
+  void trace_write(::google::protobuf::RpcController *controller,
+                   const proto::TraceWriteRequest *request,
+                   proto::TraceWriteResponse *response,
+                   ::google::protobuf::Closure *done) override;
+
 
  public:
   // Restful apis from HttpProximaService
@@ -127,7 +143,8 @@ class ProximaRequestHandler : public proto::ProximaService,
   }
 
  private:
-  int write_impl(const proto::WriteRequest &request, proto::Status *response);
+  int write_impl(const proto::WriteRequest &request, RequestArena *arena,
+                 proto::Status *response);
 
   void create_collection(brpc::Controller *controller);
 
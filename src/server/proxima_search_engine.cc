@@ -26,6 +26,7 @@
 #include "common/config.h"
 #include "common/error_code.h"
 #include "common/logger.h"
+#include "common/numa_topology.h"
 #include "metrics/metrics_collector.h"
 
 namespace proxima {
@@ -58,6 +59,16 @@ int ProximaSearchEngine::init(bool daemonized, const std::string &pid_file) {
     return ret;
   }
 
+  // init numa topology before segments loaded and query workers started
+  if (config.get_query_numa_aware()) {
+    ret = NumaTopology::Instance().init(
+        config.get_query_numa_simulated_node_count());
+    if (ret != 0) {
+      LOG_ERROR("ProximaSE init numa topology error");
+      return ret;
+    }
+  }
+
   // init meta agent
   meta_agent_ = meta::MetaAgent::Create(config.get_meta_uri());
   if (!meta_agent_) {
@@ -31,7 +31,8 @@ using RequestType = agent::WriteRequest::RequestType;
 int WriteRequestBuilder::build(const meta::CollectionMeta &meta,
                                const agent::ColumnOrder &column_order,
                                const proto::WriteRequest &pb_request,
-                               agent::WriteRequest *write_request) {
+                               agent::WriteRequest *write_request,
+                               google::protobuf::Arena *arena) {
   // get if indexes and forwards sequence are strictly match collection meta
   bool index_full_match = false;
   bool forward_full_match = false;
@@ -44,14 +45,22 @@ int WriteRequestBuilder::build(const meta::CollectionMeta &meta,
     return ret;
   }
 
+  // Forward values of all rows are reordered through one scratch list,
+  // which keeps cleared values for following rows
+  proto::GenericValueList local_value_list;
+  proto::GenericValueList *value_list =
+      arena ? google::protobuf::Arena::CreateMessage<proto::GenericValueList>(
+                  arena)
+            : &local_value_list;
+
   RequestType request_type =
       meta.repository() ? RequestType::PROXY : RequestType::DIRECT;
   if (request_type == RequestType::PROXY) {
     ret = build_proxy_request(meta, column_order, pb_request, index_full_match,
-                              forward_full_match, write_request);
+                              forward_full_match, value_list, write_request);
   } else {
     ret = build_direct_request(meta, column_order, pb_request, index_full_match,
-                               forward_full_match, write_request);
+                               forward_full_match, value_list, write_request);
   }
   if (ret != 0) {
     LOG_ERROR("Build write request failed. collection[%s]",
@@ -232,7 +241,8 @@ int WriteRequestBuilder::validate_request(
 int WriteRequestBuilder::build_proxy_request(
     const meta::CollectionMeta &meta, const agent::ColumnOrder &column_order,
     const proto::WriteRequest &pb_request, bool index_full_match,
-    bool forward_full_match, agent::WriteRequest *write_request) {
+    bool forward_full_match, proto::GenericValueList *value_list,
+    agent::WriteRequest *write_request) {
   auto &row_meta = pb_request.row_meta();
   auto &collection = pb_request.collection_name();
 
@@ -242,7 +252,7 @@ int WriteRequestBuilder::build_proxy_request(
         std::make_shared<index::CollectionDataset>(0);
     auto &row = pb_request.rows(i);
     int ret = build_record(row, row_meta, meta, column_order, index_full_match,
-                           forward_full_match, record.get());
+                           forward_full_match, value_list, record.get());
     if (ret != 0) {
       LOG_ERROR("Build record failed. id[%d] collection[%s]", i,
                 collection.c_str());
@@ -260,18 +270,20 @@ int WriteRequestBuilder::build_proxy_request(
 int WriteRequestBuilder::build_direct_request(
     const meta::CollectionMeta &meta, const agent::ColumnOrder &column_order,
     const proto::WriteRequest &pb_request, bool index_full_match,
-    bool forward_full_match, agent::WriteRequest *write_request) {
+    bool forward_full_match, proto::GenericValueList *value_list,
+    agent::WriteRequest *write_request) {
   auto &row_meta = pb_request.row_meta();
   auto &collection = pb_request.collection_name();
 
   // schema revision default 0
   index::CollectionDatasetPtr dataset =
       std::make_shared<index::CollectionDataset>(0);
+  dataset->reserve(static_cast<size_t>(pb_request.rows_size()));
 
   for (int i = 0; i < pb_request.rows_size(); ++i) {
     auto &row = pb_request.rows(i);
     int ret = build_record(row, row_meta, meta, column_order, index_full_match,
-                           forward_full_match, dataset.get());
+                           forward_full_match, value_list, dataset.get());
     if (ret != 0) {
       LOG_ERROR("Build record failed. id[%d] collection[%s]", i,
                 collection.c_str());
@@ -290,7 +302,7 @@ int WriteRequestBuilder::build_record(
     const proto::WriteRequest::RowMeta &row_meta,
     const meta::CollectionMeta &meta, const agent::ColumnOrder &column_order,
     bool index_full_match, bool forward_full_match,
-    index::CollectionDataset *dataset) {
+    proto::GenericValueList *value_list, index::CollectionDataset *dataset) {
   auto *row_data = dataset->add_row_data();
   row_data->primary_key = row.primary_key();
 
@@ -317,7 +329,7 @@ int WriteRequestBuilder::build_record(
 
   // build forwards data
   int ret = build_forwards_data(row, row_meta, column_order, meta,
-                                forward_full_match, row_data);
+                                forward_full_match, value_list, row_data);
   if (ret != 0) {
     LOG_ERROR("Build forwards data failed. collection[%s]",
               meta.name().c_str());
@@ -338,7 +350,8 @@ int WriteRequestBuilder::build_forwards_data(
     const proto::WriteRequest::Row &row,
     const proto::WriteRequest::RowMeta &row_meta,
     const agent::ColumnOrder &column_order, const meta::CollectionMeta &meta,
-    bool forward_full_match, index::CollectionDataset::RowData *row_data) {
+    bool forward_full_match, proto::GenericValueList *value_list,
+    index::CollectionDataset::RowData *row_data) {
   // if forward_full_match is true, direct serialized
   auto *forward_data = &(row_data->forward_data);
   if (forward_full_match) {
@@ -350,12 +363,12 @@ int WriteRequestBuilder::build_forwards_data(
     return 0;
   }
 
-  // init the value list
-  proto::GenericValueList value_list;
+  // init the value list, cleared values are reused
+  value_list->Clear();
   auto &forward_order = column_order.get_forward_order();
   size_t meta_forward_size = meta.forward_columns().size();
   for (size_t i = 0; i < meta_forward_size; ++i) {
-    value_list.add_values();
+    value_list->add_values();
   }
 
   // fill the value list
@@ -366,7 +379,7 @@ int WriteRequestBuilder::build_forwards_data(
     auto it = forward_order.find(forward_column);
     if (it != forward_order.end()) {
       if (it->second < meta_forward_size) {
-        value_list.mutable_values(it->second)->CopyFrom(forward_values[i]);
+        value_list->mutable_values(it->second)->CopyFrom(forward_values[i]);
       } else {
         LOG_ERROR(
             "Forward order invalid. forward[%s] index[%zu] "
@@ -383,7 +396,7 @@ int WriteRequestBuilder::build_forwards_data(
   }
 
   // copy forward data
-  if (!value_list.SerializeToString(forward_data)) {
+  if (!value_list->SerializeToString(forward_data)) {
     LOG_ERROR("Forward columns serialize failed. collection[%s]",
               meta.name().c_str());
     return ErrorCode_SerializeError;
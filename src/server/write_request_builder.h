@@ -32,11 +32,12 @@ namespace server {
  */
 class WriteRequestBuilder {
  public:
-  //! build write request
+  //! build write request, scratch messages are created on arena if set
   static int build(const meta::CollectionMeta &meta,
                    const agent::ColumnOrder &column_order,
                    const proto::WriteRequest &pb_request,
-                   agent::WriteRequest *write_request);
+                   agent::WriteRequest *write_request,
+                   google::protobuf::Arena *arena = nullptr);
 
  private:
   static void get_index_and_forward_mode(const proto::WriteRequest &request,
@@ -54,6 +55,7 @@ class WriteRequestBuilder {
                                  const agent::ColumnOrder &column_order,
                                  const proto::WriteRequest &pb_request,
                                  bool index_full_match, bool forward_full_match,
+                                 proto::GenericValueList *value_list,
                                  agent::WriteRequest *write_request);
 
   static int build_direct_request(const meta::CollectionMeta &meta,
@@ -61,6 +63,7 @@ class WriteRequestBuilder {
                                   const proto::WriteRequest &pb_request,
                                   bool index_full_match,
                                   bool forward_full_match,
+                                  proto::GenericValueList *value_list,
                                   agent::WriteRequest *write_request);
 
   static int build_record(const proto::WriteRequest::Row &row,
@@ -68,6 +71,7 @@ class WriteRequestBuilder {
                           const meta::CollectionMeta &meta,
                           const agent::ColumnOrder &column_order,
                           bool index_full_match, bool forward_full_match,
+                          proto::GenericValueList *value_list,
                           index::CollectionDataset *dataset);
 
   static int build_forwards_data(const proto::WriteRequest::Row &row,
@@ -75,6 +79,7 @@ class WriteRequestBuilder {
                                  const agent::ColumnOrder &column_order,
                                  const meta::CollectionMeta &meta,
                                  bool forward_full_match,
+                                 proto::GenericValueList *value_list,
                                  index::CollectionDataset::RowData *row_data);
 
   static int build_indexes_data(const proto::WriteRequest::Row &row,
@@ -36,6 +36,8 @@ proto::CollectionConfig GetTestCollectionConfig() {
   proto::CollectionConfig config;
   config.set_collection_name("collection");
   config.set_max_docs_per_segment(1000);
+  config.set_ttl_seconds(86400);
+  config.set_load_mode(proto::CollectionConfig_LoadMode_LM_MMAP_LOCKED);
   config.add_forward_column_names("f1");
   config.add_forward_column_names("f2");
   config.add_forward_column_names("f3");
@@ -67,6 +69,8 @@ TEST(AdminProtoConverterTest, PBToCollectionBase) {
   ASSERT_EQ(AdminProtoConverter::PBToCollectionBase(config, &c), 0);
   EXPECT_EQ(c.name(), "collection");
   EXPECT_EQ(c.max_docs_per_segment(), 1000);
+  EXPECT_EQ(c.ttl_seconds(), 86400);
+  EXPECT_EQ(c.load_mode(), LoadModes::MMAP_LOCKED);
   EXPECT_THAT(c.forward_columns(),
               testing::ContainerEq(vector<string>{"f1", "f2", "f3"}));
   EXPECT_FALSE(c.repository());
@@ -115,6 +119,8 @@ TEST(AdminProtoConverterTest, CollectionMetaToPB) {
   EXPECT_EQ(info.status(), proto::CollectionInfo_CollectionStatus_CS_SERVING);
   auto &conf = info.config();
   EXPECT_EQ(conf.max_docs_per_segment(), 1000);
+  EXPECT_EQ(conf.ttl_seconds(), 86400);
+  EXPECT_EQ(conf.load_mode(), proto::CollectionConfig_LoadMode_LM_MMAP_LOCKED);
   EXPECT_EQ(conf.forward_column_names_size(), 3);
   EXPECT_EQ(conf.forward_column_names(0), "f1");
   EXPECT_EQ(conf.forward_column_names(1), "f2");
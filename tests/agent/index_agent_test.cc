@@ -471,6 +471,71 @@ TEST_F(IndexAgentTest, TestWriteSuccessWithProxy) {
   ASSERT_EQ(ret, 0);
 }
 
+TEST_F(IndexAgentTest, TestWriteSuccessWithProxyBatch) {
+  IndexAgentPtr agent = IndexAgent::Create(meta_service_);
+  int ret = agent->init();
+  ASSERT_EQ(ret, 0);
+
+  EXPECT_CALL(*meta_service_, get_latest_collections(_))
+      .WillOnce(testing::Return(0));
+  ret = agent->start();
+  ASSERT_EQ(ret, 0);
+
+  meta::CollectionMetaPtr schema = proxy_schema_;
+  EXPECT_CALL(*meta_service_, get_current_collection(_))
+      .WillRepeatedly(
+          Invoke([&schema](const std::string &) -> meta::CollectionMetaPtr {
+            return schema;
+          }));
+  ret = agent->create_collection(collection_name_);
+  ASSERT_EQ(ret, 0);
+
+  // Rows of the template request are copied with other keys, rows of a
+  // key keep their order although they go through one sub batch
+  WriteRequest request;
+  request.set_collection_name(collection_name_);
+  request.set_request_type(WriteRequest::RequestType::PROXY);
+  request.set_magic_number(agent->agent_timestamp_);
+  auto &row_template = proxy_request_.get_collection_dataset(0)->get(0);
+  index::CollectionDatasetPtr dataset =
+      std::make_shared<index::CollectionDataset>(0);
+  for (size_t i = 0; i < 1000; ++i) {
+    auto *row = dataset->add_row_data();
+    *row = row_template;
+    row->primary_key = i;
+    row->lsn = i + 1;
+  }
+  for (size_t i = 0; i < 10; ++i) {
+    auto *row = dataset->add_row_data();
+    *row = row_template;
+    row->primary_key = i;
+    row->lsn = 1000 + i + 1;
+    row->operation_type = OperationTypes::UPDATE;
+  }
+  request.add_collection_dataset(dataset);
+  ret = agent->write(request);
+  ASSERT_EQ(ret, 0);
+
+  auto counter = agent->counter_map_->get_counter(collection_name_);
+  for (int i = 0; i < 100 && counter->active_count() > 0; ++i) {
+    usleep(100000);
+  }
+  ASSERT_EQ(counter->active_count(), 0U);
+
+  uint64_t lsn = 0;
+  std::string lsn_context;
+  ret = agent->get_latest_lsn(collection_name_, &lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 1010U);
+
+  ret = agent->drop_collection(collection_name_);
+  ASSERT_EQ(ret, 0);
+  ret = agent->stop();
+  ASSERT_EQ(ret, 0);
+  ret = agent->cleanup();
+  ASSERT_EQ(ret, 0);
+}
+
 TEST_F(IndexAgentTest, TestWriteSuccessWithDirect) {
   IndexAgentPtr agent = IndexAgent::Create(meta_service_);
   int ret = agent->init();
@@ -0,0 +1,78 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ *   \author   haichao.chc
+ *   \date     Oct 2021
+ *   \brief
+ */
+
+#define private public
+#include "common/numa_topology.h"
+#undef private
+
+#include <sched.h>
+#include <algorithm>
+#include <thread>
+#include <gtest/gtest.h>
+
+using namespace proxima::be;
+
+TEST(NumaTopologyTest, TestParseCpuList) {
+  std::vector<uint32_t> cpus;
+  ASSERT_TRUE(NumaTopology::ParseCpuList("0-3,8,10-11", &cpus));
+  ASSERT_EQ(cpus, std::vector<uint32_t>({0, 1, 2, 3, 8, 10, 11}));
+
+  cpus.clear();
+  ASSERT_TRUE(NumaTopology::ParseCpuList("", &cpus));
+  ASSERT_TRUE(cpus.empty());
+
+  ASSERT_FALSE(NumaTopology::ParseCpuList("5-2", &cpus));
+}
+
+TEST(NumaTopologyTest, TestSimulate) {
+  NumaTopology topology;
+  ASSERT_FALSE(topology.enabled());
+  ASSERT_EQ(topology.node_of(3), 0);
+
+  ASSERT_EQ(topology.init(2), 0);
+  ASSERT_TRUE(topology.enabled());
+  ASSERT_TRUE(topology.simulated());
+  ASSERT_EQ(topology.node_count(), 2);
+  ASSERT_FALSE(topology.cpus(0).empty());
+  ASSERT_FALSE(topology.cpus(1).empty());
+  ASSERT_EQ(topology.node_of(2), 0);
+  ASSERT_EQ(topology.node_of(3), 1);
+
+  // bound thread only runs on cpus of node
+  std::thread worker([&topology] {
+    ASSERT_EQ(topology.bind_thread(1), 0);
+    int cpu = sched_getcpu();
+    auto &cpus = topology.cpus(1);
+    ASSERT_NE(std::find(cpus.begin(), cpus.end(), (uint32_t)cpu), cpus.end());
+  });
+  worker.join();
+
+  topology.cleanup();
+  ASSERT_FALSE(topology.enabled());
+}
+
+TEST(NumaTopologyTest, TestDetect) {
+  NumaTopology topology;
+  // Hosts without sysfs numa nodes fail to detect
+  if (topology.init(0) == 0) {
+    ASSERT_FALSE(topology.simulated());
+    ASSERT_GT(topology.node_count(), 0);
+  }
+}
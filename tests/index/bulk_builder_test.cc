@@ -0,0 +1,165 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "index/bulk_builder.h"
+#include <gtest/gtest.h>
+#include "index/collection.h"
+
+using namespace proxima::be;
+using namespace proxima::be::index;
+
+class BulkBuilderTest : public testing::Test {
+ protected:
+  void SetUp() {
+    char cmd_buf[100];
+    snprintf(cmd_buf, 100, "rm -rf ./bulk_teachers/");
+    system(cmd_buf);
+
+    FillSchema();
+  }
+
+  void TearDown() {}
+
+  void FillSchema() {
+    schema_ = std::make_shared<meta::CollectionMeta>();
+    meta::ColumnMetaPtr column_meta = std::make_shared<meta::ColumnMeta>();
+    column_meta->set_name("face");
+    column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+    column_meta->set_data_type(DataTypes::VECTOR_FP32);
+    column_meta->set_dimension(16);
+    column_meta->mutable_parameters()->set("metric_type", "SquaredEuclidean");
+    schema_->append(column_meta);
+    schema_->set_name("bulk_teachers");
+    schema_->set_revision(0);
+    schema_->set_max_docs_per_segment(300);
+  }
+
+ protected:
+  meta::CollectionMetaPtr schema_{};
+};
+
+TEST_F(BulkBuilderTest, TestGeneral) {
+  index::ThreadPool thread_pool(10, false);
+  BulkBuilderPtr builder =
+      BulkBuilder::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(builder, nullptr);
+
+  int ret = builder->open();
+  ASSERT_EQ(ret, 0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    Record record;
+    record.primary_key = i;
+    record.operation_type = OperationTypes::INSERT;
+    record.lsn = i;
+    record.forward_data = "hello";
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+
+    std::vector<float> fvec(16U);
+    for (size_t j = 0; j < 16U; j++) {
+      fvec[j] = i * 1.0f;
+    }
+    new_column.data =
+        std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+    record.column_datas.emplace_back(new_column);
+
+    ret = builder->add(record);
+    ASSERT_EQ(ret, 0);
+  }
+
+  // duplicate key
+  Record dup_record;
+  dup_record.primary_key = 10;
+  ret = builder->add(dup_record);
+  ASSERT_EQ(ret, ErrorCode_DuplicateKey);
+
+  ret = builder->finish();
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(builder->stats().doc_count, 1000);
+  ASSERT_EQ(builder->stats().segment_count, 4);
+
+  // building into an existing directory is forbidden
+  BulkBuilderPtr dup_builder =
+      BulkBuilder::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ret = dup_builder->open();
+  ASSERT_EQ(ret, ErrorCode_DuplicateCollection);
+
+  // output can be opened by collection directly
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = false;
+  ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  uint64_t lsn;
+  std::string lsn_context;
+  ret = collection->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 999);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  // 4 persist segments and an empty writing segment
+  ASSERT_EQ(segments.size(), 5);
+
+  size_t total_doc_count = 0;
+  for (auto &segment : segments) {
+    total_doc_count += segment->doc_count();
+  }
+  ASSERT_EQ(total_doc_count, 1000);
+
+  for (size_t i = 0; i < 1000; i += 7) {
+    std::vector<float> fvec(16U);
+    for (size_t j = 0; j < 16U; j++) {
+      fvec[j] = i * 1.0f;
+    }
+    std::string query((char *)fvec.data(), fvec.size() * sizeof(float));
+    QueryParams query_params;
+    query_params.topk = 10;
+    query_params.data_type = DataTypes::VECTOR_FP32;
+    query_params.dimension = 16;
+
+    bool found = false;
+    for (auto &segment : segments) {
+      QueryResultList result_list;
+      ret = segment->knn_search("face", query, query_params, &result_list);
+      ASSERT_EQ(ret, 0);
+      if (!result_list.empty() && result_list[0].score == 0.0f) {
+        ASSERT_EQ(result_list[0].primary_key, i);
+        ASSERT_EQ(result_list[0].lsn, i);
+        found = true;
+      }
+
+      QueryResult kv_result;
+      ret = segment->kv_search(i, &kv_result);
+      ASSERT_EQ(ret, 0);
+      if (kv_result.primary_key != INVALID_KEY) {
+        ASSERT_EQ(kv_result.primary_key, i);
+        ASSERT_EQ(kv_result.forward_data, "hello");
+      }
+    }
+    ASSERT_TRUE(found);
+  }
+
+  collection->close();
+}
@@ -15,7 +15,15 @@
  */
 
 #include "index/collection.h"
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <thread>
 #include <gtest/gtest.h>
+#include "index/bulk_builder.h"
+#include "index/file_helper.h"
+#include "proto/common.pb.h"
 
 using namespace proxima::be;
 using namespace proxima::be::index;
@@ -689,3 +697,1487 @@ TEST_F(CollectionTest, TestUpdateSchema) {
   ret = collection->update_schema(new_schema);
   ASSERT_EQ(ret, 0);
 }
+
+TEST_F(CollectionTest, TestBackfillColumn) {
+  index::ThreadPool thread_pool(10, false);
+  auto make_vector = [](uint64_t key, float scale) {
+    std::vector<float> fvec(16U, key * scale);
+    return std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+  };
+  auto add_row = [&](CollectionDataset *records, uint64_t key) {
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = OperationTypes::INSERT;
+    row->lsn = key;
+    // vector of face2 is forwarded before it is indexed
+    proto::GenericValueList values;
+    values.add_values()->set_bytes_value(make_vector(key, 2.0f));
+    values.SerializeToString(&row->forward_data);
+    CollectionDataset::ColumnData column;
+    column.column_name = "face";
+    column.data_type = DataTypes::VECTOR_FP32;
+    column.dimension = 16;
+    column.data = make_vector(key, 1.0f);
+    row->column_datas.emplace_back(column);
+  };
+
+  schema_->mutable_forward_columns()->emplace_back("face2");
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  schema_->set_max_docs_per_segment(100);
+  for (uint64_t i = 0; i < 250; i++) {
+    CollectionDataset records(0);
+    add_row(&records, i);
+    ret = collection->write_records(records);
+    ASSERT_EQ(ret, 0);
+  }
+
+  auto persist_count = [&collection]() {
+    CollectionStats stats;
+    collection->get_stats(&stats);
+    size_t count = 0U;
+    for (auto &segment_stats : stats.segment_stats) {
+      if (segment_stats.state == SegmentState::PERSIST) {
+        count++;
+      }
+    }
+    return count;
+  };
+  for (size_t retry = 0; retry < 100 && persist_count() < 2U; retry++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(persist_count(), 2U);
+
+  auto new_schema = std::make_shared<meta::CollectionMeta>(*schema_);
+  meta::ColumnMetaPtr column_meta = std::make_shared<meta::ColumnMeta>();
+  column_meta->set_name("face2");
+  column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  column_meta->set_data_type(DataTypes::VECTOR_FP32);
+  column_meta->set_dimension(16);
+  column_meta->mutable_parameters()->set("metric_type", "SquaredEuclidean");
+  new_schema->append(column_meta);
+  new_schema->set_revision(1);
+  ret = collection->update_schema(new_schema);
+  ASSERT_EQ(ret, 0);
+
+  // writes of older revision go on while backfilling
+  for (uint64_t i = 250; i < 260; i++) {
+    CollectionDataset records(0);
+    add_row(&records, i);
+    ret = collection->write_records(records);
+    ASSERT_EQ(ret, 0);
+  }
+
+  BackfillStats backfill;
+  for (size_t retry = 0; retry < 100; retry++) {
+    CollectionStats stats;
+    collection->get_stats(&stats);
+    if (stats.backfill_stats.size() == 1U) {
+      backfill = stats.backfill_stats[0];
+      if (backfill.done_segment_count == backfill.total_segment_count) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(backfill.column_name, "face2");
+  ASSERT_EQ(backfill.schema_revision, 1U);
+  ASSERT_EQ(backfill.total_segment_count, 2U);
+  ASSERT_EQ(backfill.done_segment_count, 2U);
+  ASSERT_EQ(backfill.failed_segment_count, 0U);
+
+  // historical documents of persist segments are searched by new column
+  auto check_persist_segments = [&](const CollectionPtr &target) {
+    std::vector<SegmentPtr> segments;
+    ASSERT_EQ(target->get_segments(&segments), 0);
+    size_t doc_count = 0U;
+    for (auto &segment : segments) {
+      auto segment_meta = segment->segment_meta();
+      if (segment_meta.state != SegmentState::PERSIST) {
+        continue;
+      }
+      QueryParams query_params;
+      query_params.topk = 1;
+      query_params.data_type = DataTypes::VECTOR_FP32;
+      query_params.dimension = 16;
+      for (uint64_t key = segment_meta.min_primary_key;
+           key <= segment_meta.max_primary_key; key++) {
+        QueryResultList results;
+        ret = segment->knn_search("face2", make_vector(key, 2.0f),
+                                  query_params, &results);
+        ASSERT_EQ(ret, 0);
+        ASSERT_EQ(results.size(), 1U);
+        ASSERT_EQ(results[0].primary_key, key);
+        doc_count++;
+      }
+    }
+    ASSERT_EQ(doc_count, backfill.backfilled_doc_count);
+  };
+  check_persist_segments(collection);
+  collection->close();
+
+  // backfilled columns are loaded after reopened
+  CollectionPtr reopened = Collection::Create(new_schema->name(), "./",
+                                              new_schema, 10, &thread_pool);
+  read_options.create_new = false;
+  ret = reopened->open(read_options);
+  ASSERT_EQ(ret, 0);
+  check_persist_segments(reopened);
+  reopened->close();
+}
+
+TEST_F(CollectionTest, TestNoBackfillAfterSchemaUpdate) {
+  index::ThreadPool thread_pool(10, false);
+  auto make_vector = [](uint64_t key, float scale) {
+    std::vector<float> fvec(16U, key * scale);
+    return std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+  };
+
+  schema_->set_max_docs_per_segment(100);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto new_schema = std::make_shared<meta::CollectionMeta>(*schema_);
+  meta::ColumnMetaPtr column_meta = std::make_shared<meta::ColumnMeta>();
+  column_meta->set_name("face2");
+  column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  column_meta->set_data_type(DataTypes::VECTOR_FP32);
+  column_meta->set_dimension(16);
+  column_meta->mutable_parameters()->set("metric_type", "SquaredEuclidean");
+  new_schema->append(column_meta);
+  new_schema->set_revision(1);
+  ret = collection->update_schema(new_schema);
+  ASSERT_EQ(ret, 0);
+
+  // datasets carry no schema revision, rows of them hold all columns
+  for (uint64_t i = 0; i < 150; i++) {
+    CollectionDataset records(0);
+    auto *row = records.add_row_data();
+    row->primary_key = i;
+    row->operation_type = OperationTypes::INSERT;
+    row->lsn = i;
+    for (auto &column_name : {"face", "face2"}) {
+      CollectionDataset::ColumnData column;
+      column.column_name = column_name;
+      column.data_type = DataTypes::VECTOR_FP32;
+      column.dimension = 16;
+      column.data = make_vector(i, 1.0f);
+      row->column_datas.emplace_back(column);
+    }
+    ret = collection->write_records(records);
+    ASSERT_EQ(ret, 0);
+  }
+
+  auto persist_count = [&collection]() {
+    CollectionStats stats;
+    collection->get_stats(&stats);
+    size_t count = 0U;
+    for (auto &segment_stats : stats.segment_stats) {
+      if (segment_stats.state == SegmentState::PERSIST) {
+        count++;
+      }
+    }
+    return count;
+  };
+  for (size_t retry = 0; retry < 100 && persist_count() < 1U; retry++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(persist_count(), 1U);
+  collection->close();
+
+  // dumped segment indexed the new column already, neither dumping nor
+  // loading it schedules backfill
+  CollectionPtr reopened = Collection::Create(new_schema->name(), "./",
+                                              new_schema, 10, &thread_pool);
+  read_options.create_new = false;
+  ret = reopened->open(read_options);
+  ASSERT_EQ(ret, 0);
+  CollectionStats stats;
+  ret = reopened->get_stats(&stats);
+  ASSERT_EQ(ret, 0);
+  ASSERT_TRUE(stats.backfill_stats.empty());
+  reopened->close();
+}
+
+TEST_F(CollectionTest, TestRebuildSegments) {
+  index::ThreadPool thread_pool(10, false);
+  auto make_vector = [](uint64_t key) {
+    std::vector<float> fvec(16U, key * 1.0f);
+    return std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+  };
+  auto write_row = [&](const CollectionPtr &target, uint64_t key,
+                       OperationTypes operation_type) {
+    CollectionDataset records(0);
+    auto *row = records.add_row_data();
+    row->primary_key = key;
+    row->operation_type = operation_type;
+    row->lsn = key;
+    if (operation_type == OperationTypes::INSERT) {
+      row->forward_data = "hello";
+      CollectionDataset::ColumnData column;
+      column.column_name = "face";
+      column.data_type = DataTypes::VECTOR_FP32;
+      column.dimension = 16;
+      column.data = make_vector(key);
+      row->column_datas.emplace_back(column);
+    }
+    return target->write_records(records);
+  };
+
+  schema_->set_max_docs_per_segment(100);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  for (uint64_t i = 0; i < 250; i++) {
+    ASSERT_EQ(write_row(collection, i, OperationTypes::INSERT), 0);
+  }
+  auto persist_count = [&collection]() {
+    CollectionStats stats;
+    collection->get_stats(&stats);
+    size_t count = 0U;
+    for (auto &segment_stats : stats.segment_stats) {
+      if (segment_stats.state == SegmentState::PERSIST) {
+        count++;
+      }
+    }
+    return count;
+  };
+  for (size_t retry = 0; retry < 100 && persist_count() < 2U; retry++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(persist_count(), 2U);
+
+  // half documents of the first segment are deleted
+  for (uint64_t i = 0; i < 50; i++) {
+    ASSERT_EQ(write_row(collection, i, OperationTypes::DELETE), 0);
+  }
+  std::vector<SegmentID> segment_ids;
+  collection->select_rebuild_segments(0.3f, &segment_ids);
+  ASSERT_EQ(segment_ids, std::vector<SegmentID>{0U});
+
+  auto wait_rebuilt = [&collection](uint64_t segment_count) {
+    RebuildStats rebuild;
+    for (size_t retry = 0; retry < 100; retry++) {
+      CollectionStats stats;
+      collection->get_stats(&stats);
+      rebuild = stats.rebuild_stats;
+      if (rebuild.done_segment_count + rebuild.failed_segment_count ==
+          segment_count) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return rebuild;
+  };
+
+  // column failing recall verification is never swapped in
+  BuildOptions options;
+  options.cpu_ratio = 0.5f;
+  options.sample_count = 20U;
+  options.min_recall = 1.1f;
+  ASSERT_EQ(collection->rebuild_segments(segment_ids, options), 0);
+  RebuildStats rebuild = wait_rebuilt(1U);
+  ASSERT_EQ(rebuild.failed_segment_count, 1U);
+  ASSERT_EQ(rebuild.rejected_column_count, 1U);
+  ASSERT_GE(rebuild.last_recall, 0.9f);
+  ASSERT_FALSE(FileHelper::FileExists(
+      ColumnBackfill::FilePath(collection->dir_path(), 0U, "face")));
+
+  options.min_recall = 0.9f;
+  ASSERT_EQ(collection->rebuild_segments(segment_ids, options), 0);
+  rebuild = wait_rebuilt(2U);
+  ASSERT_EQ(rebuild.done_segment_count, 1U);
+  ASSERT_EQ(rebuild.rebuilt_doc_count, 50U);
+  ASSERT_EQ(rebuild.dropped_doc_count, 50U);
+
+  // deleted documents are dropped from graph, alive ones are searched
+  auto check_rebuilt = [&](const CollectionPtr &target) {
+    std::vector<SegmentID> selected;
+    target->select_rebuild_segments(0.3f, &selected);
+    ASSERT_TRUE(selected.empty());
+
+    std::vector<SegmentPtr> segments;
+    ASSERT_EQ(target->get_segments(&segments), 0);
+    QueryParams query_params;
+    query_params.topk = 1;
+    query_params.data_type = DataTypes::VECTOR_FP32;
+    query_params.dimension = 16;
+    for (auto &segment : segments) {
+      if (segment->segment_id() != 0U) {
+        continue;
+      }
+      for (uint64_t key = 50; key < 100; key++) {
+        QueryResultList results;
+        ret = segment->knn_search("face", make_vector(key), query_params,
+                                  &results);
+        ASSERT_EQ(ret, 0);
+        ASSERT_EQ(results.size(), 1U);
+        ASSERT_EQ(results[0].primary_key, key);
+      }
+    }
+  };
+  check_rebuilt(collection);
+  collection->close();
+
+  // rebuilt columns are loaded after reopened
+  CollectionPtr reopened =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  read_options.create_new = false;
+  ret = reopened->open(read_options);
+  ASSERT_EQ(ret, 0);
+  check_rebuilt(reopened);
+  reopened->close();
+}
+
+TEST_F(CollectionTest, TestExpireSegment) {
+  index::ThreadPool thread_pool(10, false);
+  schema_->set_max_docs_per_segment(100);
+  schema_->set_ttl_seconds(3600);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(collection, nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // first 100 records expired, and dump to a persist segment,
+  // then insert 50 expired and 50 fresh records into writing segment
+  uint64_t expired_timestamp = ailego::Realtime::Seconds() - 7200;
+  for (size_t i = 0; i < 200; i++) {
+    CollectionDatasetPtr add_records = std::make_shared<CollectionDataset>(1);
+    CollectionDataset::RowData *new_row = add_records->add_row_data();
+    new_row->primary_key = i;
+    new_row->operation_type = OperationTypes::INSERT;
+    new_row->lsn = i;
+    new_row->timestamp = i < 150 ? expired_timestamp : 0;
+    new_row->forward_data = "hello";
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+
+    std::vector<float> fvec(16U);
+    for (size_t j = 0; j < 16U; j++) {
+      fvec[j] = i * 1.0f;
+    }
+    std::string vector((char *)fvec.data(), fvec.size() * sizeof(float));
+    new_column.data = vector;
+
+    new_row->column_datas.emplace_back(new_column);
+    ret = collection->write_records(*add_records);
+    ASSERT_EQ(ret, 0);
+
+    if (i == 99) {
+      sleep(2);
+    }
+  }
+
+  CollectionStats stats;
+  ret = collection->get_stats(&stats);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(stats.total_segment_count, 2);
+  ASSERT_EQ(stats.segment_stats[0].max_timestamp, expired_timestamp);
+
+  ret = collection->expire();
+  ASSERT_EQ(ret, 0);
+
+  CollectionStats expired_stats;
+  ret = collection->get_stats(&expired_stats);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(expired_stats.total_segment_count, 1);
+  ASSERT_EQ(expired_stats.total_doc_count, 100);
+  ASSERT_EQ(expired_stats.segment_stats[0].state, SegmentState::WRITING);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 1);
+
+  // boundary segment filters expired documents
+  QueryResult kv_result;
+  ret = segments[0]->kv_search(120, &kv_result);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(kv_result.primary_key, INVALID_KEY);
+  ret = segments[0]->kv_search(180, &kv_result);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(kv_result.primary_key, 180);
+
+  std::vector<float> fvec(16U);
+  for (size_t j = 0; j < 16U; j++) {
+    fvec[j] = 120 * 1.0f;
+  }
+  std::string query((char *)fvec.data(), fvec.size() * sizeof(float));
+  QueryParams query_params;
+  query_params.topk = 100;
+  query_params.data_type = DataTypes::VECTOR_FP32;
+  query_params.dimension = 16;
+  QueryResultList result_list;
+  ret = segments[0]->knn_search("face", query, query_params, &result_list);
+  ASSERT_EQ(ret, 0);
+  ASSERT_GT(result_list.size(), 0);
+  for (auto &result : result_list) {
+    ASSERT_GE(result.primary_key, 150);
+  }
+
+  // key mappings of expired segment purged, key can be inserted again
+  CollectionDatasetPtr add_records = std::make_shared<CollectionDataset>(1);
+  CollectionDataset::RowData *new_row = add_records->add_row_data();
+  new_row->primary_key = 10;
+  new_row->operation_type = OperationTypes::INSERT;
+  new_row->lsn = 200;
+  new_row->forward_data = "hello";
+  ret = collection->write_records(*add_records);
+  ASSERT_EQ(ret, 0);
+}
+
+TEST_F(CollectionTest, TestAttachSegments) {
+  index::ThreadPool thread_pool(10, false);
+  system("rm -rf ./attach_source/");
+  FileHelper::CreateDirectory("./attach_source");
+
+  auto make_record = [](uint64_t key, const std::string &forward) {
+    Record record;
+    record.primary_key = key;
+    record.operation_type = OperationTypes::INSERT;
+    record.lsn = key;
+    record.forward_data = forward;
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+    std::vector<float> fvec(16U, key * 1.0f);
+    new_column.data =
+        std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+    record.column_datas.emplace_back(new_column);
+    return record;
+  };
+
+  // build keys [50, 250) outside with 2 segments
+  schema_->set_max_docs_per_segment(100);
+  BulkBuilderPtr builder = BulkBuilder::Create(
+      schema_->name(), "./attach_source", schema_, 10, &thread_pool);
+  int ret = builder->open();
+  ASSERT_EQ(ret, 0);
+  for (size_t i = 50; i < 250; i++) {
+    ret = builder->add(make_record(i, "attached"));
+    ASSERT_EQ(ret, 0);
+  }
+  ret = builder->finish();
+  ASSERT_EQ(ret, 0);
+
+  // serving collection holds keys [0, 100)
+  schema_->set_max_docs_per_segment(0);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+  for (size_t i = 0; i < 100; i++) {
+    CollectionDataset records(0);
+    *records.add_row_data() = make_record(i, "hello");
+    ret = collection->write_records(records);
+    ASSERT_EQ(ret, 0);
+  }
+
+  // mismatched source directory is rejected
+  size_t segment_count = 0U;
+  ret = collection->attach_segments("./attach_source/not_exist",
+                                    &segment_count);
+  ASSERT_NE(ret, 0);
+
+  ret = collection->attach_segments("./attach_source/teachers",
+                                    &segment_count);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segment_count, 2);
+
+  // writes continue behind attached range
+  CollectionDataset records(0);
+  *records.add_row_data() = make_record(300, "hello");
+  ret = collection->write_records(records);
+  ASSERT_EQ(ret, 0);
+  collection->close();
+
+  collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  read_options.create_new = false;
+  ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  CollectionStats stats;
+  ret = collection->get_stats(&stats);
+  ASSERT_EQ(ret, 0);
+  // old writing segment, 2 attached segments and new writing segment
+  ASSERT_EQ(stats.total_segment_count, 4);
+  ASSERT_EQ(stats.total_doc_count, 301);
+  ASSERT_EQ(stats.delete_doc_count, 50);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+
+  auto kv_search = [&segments](uint64_t key) {
+    QueryResult found;
+    found.primary_key = INVALID_KEY;
+    for (auto &segment : segments) {
+      QueryResult result;
+      segment->kv_search(key, &result);
+      if (result.primary_key != INVALID_KEY) {
+        found = result;
+      }
+    }
+    return found;
+  };
+  ASSERT_EQ(kv_search(10).forward_data, "hello");
+  ASSERT_EQ(kv_search(60).forward_data, "attached");
+  ASSERT_EQ(kv_search(200).forward_data, "attached");
+  ASSERT_EQ(kv_search(300).forward_data, "hello");
+
+  // knn of attached segments returns shifted doc ids, and shadowed
+  // documents are filtered out
+  std::vector<float> fvec(16U, 60.0f);
+  std::string query((char *)fvec.data(), fvec.size() * sizeof(float));
+  QueryParams query_params;
+  query_params.topk = 1;
+  query_params.data_type = DataTypes::VECTOR_FP32;
+  query_params.dimension = 16;
+  size_t hit_count = 0U;
+  for (auto &segment : segments) {
+    QueryResultList result_list;
+    ret = segment->knn_search("face", query, query_params, &result_list);
+    ASSERT_EQ(ret, 0);
+    if (!result_list.empty() && result_list[0].score == 0.0f) {
+      ASSERT_EQ(result_list[0].primary_key, 60);
+      ASSERT_EQ(result_list[0].forward_data, "attached");
+      hit_count++;
+    }
+  }
+  ASSERT_EQ(hit_count, 1);
+
+  collection->close();
+}
+
+TEST_F(CollectionTest, TestAttachSegmentsWhileWriting) {
+  index::ThreadPool thread_pool(10, false);
+  system("rm -rf ./attach_source/");
+  FileHelper::CreateDirectory("./attach_source");
+
+  auto make_record = [](uint64_t key, const std::string &forward) {
+    Record record;
+    record.primary_key = key;
+    record.operation_type = OperationTypes::INSERT;
+    record.lsn = key;
+    record.forward_data = forward;
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+    std::vector<float> fvec(16U, key * 1.0f);
+    new_column.data =
+        std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+    record.column_datas.emplace_back(new_column);
+    return record;
+  };
+
+  // build keys [5000, 5200) outside with 2 segments
+  schema_->set_max_docs_per_segment(100);
+  BulkBuilderPtr builder = BulkBuilder::Create(
+      schema_->name(), "./attach_source", schema_, 10, &thread_pool);
+  int ret = builder->open();
+  ASSERT_EQ(ret, 0);
+  for (size_t i = 5000; i < 5200; i++) {
+    ret = builder->add(make_record(i, "attached"));
+    ASSERT_EQ(ret, 0);
+  }
+  ret = builder->finish();
+  ASSERT_EQ(ret, 0);
+
+  schema_->set_max_docs_per_segment(0);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // writer inserts more documents than the gap behind writing segment
+  // while segments are attached
+  std::atomic<size_t> written_count{0U};
+  std::atomic<int> write_code{0};
+  std::thread writer([&] {
+    for (size_t i = 0; i < 3000; i++) {
+      CollectionDataset records(0);
+      *records.add_row_data() = make_record(i, "hello");
+      int code = collection->write_records(records);
+      if (code != 0) {
+        write_code = code;
+        return;
+      }
+      written_count++;
+    }
+  });
+  while (written_count < 100 && write_code == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  size_t segment_count = 0U;
+  ret = collection->attach_segments("./attach_source/teachers",
+                                    &segment_count);
+  writer.join();
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segment_count, 2);
+  ASSERT_EQ(write_code, 0);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+
+  // doc id ranges of segments never overlap
+  std::vector<SegmentMeta> metas;
+  for (auto &segment : segments) {
+    if (segment->doc_count() > 0) {
+      metas.emplace_back(segment->segment_meta());
+    }
+  }
+  std::sort(metas.begin(), metas.end(),
+            [](const SegmentMeta &a, const SegmentMeta &b) {
+              return a.min_doc_id < b.min_doc_id;
+            });
+  for (size_t i = 1; i < metas.size(); i++) {
+    ASSERT_GT(metas[i].min_doc_id, metas[i - 1].max_doc_id);
+  }
+
+  auto kv_search = [&segments](uint64_t key) {
+    QueryResult found;
+    found.primary_key = INVALID_KEY;
+    for (auto &segment : segments) {
+      QueryResult result;
+      segment->kv_search(key, &result);
+      if (result.primary_key != INVALID_KEY) {
+        found = result;
+      }
+    }
+    return found;
+  };
+  for (uint64_t key = 0; key < 3000; key++) {
+    ASSERT_EQ(kv_search(key).forward_data, "hello");
+  }
+  for (uint64_t key = 5000; key < 5200; key++) {
+    ASSERT_EQ(kv_search(key).forward_data, "attached");
+  }
+
+  collection->close();
+}
+
+TEST_F(CollectionTest, TestReadOnlyFollower) {
+  index::ThreadPool thread_pool(10, false);
+  schema_->set_max_docs_per_segment(100);
+
+  auto write_records = [](CollectionPtr collection, uint64_t begin,
+                          uint64_t end, OperationTypes operation_type) {
+    for (uint64_t i = begin; i < end; i++) {
+      CollectionDataset records(0);
+      auto *new_row = records.add_row_data();
+      new_row->primary_key = i;
+      new_row->operation_type = operation_type;
+      new_row->lsn = i;
+      new_row->forward_data = "hello";
+
+      CollectionDataset::ColumnData new_column;
+      new_column.column_name = "face";
+      new_column.data_type = DataTypes::VECTOR_FP32;
+      new_column.dimension = 16;
+      std::vector<float> fvec(16U, i * 1.0f);
+      new_column.data =
+          std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+      new_row->column_datas.emplace_back(new_column);
+      int ret = collection->write_records(records);
+      if (ret != 0) {
+        return ret;
+      }
+    }
+    return 0;
+  };
+
+  // writer publishes one persist segment, close waits dumping finished
+  CollectionPtr writer =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions writer_options;
+  writer_options.use_mmap = true;
+  writer_options.create_new = true;
+  int ret = writer->open(writer_options);
+  ASSERT_EQ(ret, 0);
+  ret = write_records(writer, 0, 150, OperationTypes::INSERT);
+  ASSERT_EQ(ret, 0);
+  writer->close();
+
+  writer =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  writer_options.create_new = false;
+  ret = writer->open(writer_options);
+  ASSERT_EQ(ret, 0);
+
+  // read only collection can not be created
+  CollectionPtr follower =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions follower_options;
+  follower_options.use_mmap = true;
+  follower_options.read_only = true;
+  follower_options.create_new = true;
+  ret = follower->open(follower_options);
+  ASSERT_NE(ret, 0);
+
+  follower =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  follower_options.create_new = false;
+  ret = follower->open(follower_options);
+  ASSERT_EQ(ret, 0);
+  ASSERT_TRUE(follower->read_only());
+
+  auto kv_search = [&follower](uint64_t key) {
+    std::vector<SegmentPtr> segments;
+    follower->get_segments(&segments);
+    QueryResult found;
+    found.primary_key = INVALID_KEY;
+    for (auto &segment : segments) {
+      QueryResult result;
+      segment->kv_search(key, &result);
+      if (result.primary_key != INVALID_KEY) {
+        found = result;
+      }
+    }
+    return found;
+  };
+
+  std::vector<SegmentPtr> segments;
+  ret = follower->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 1);
+  ASSERT_EQ(kv_search(50).primary_key, 50);
+  ASSERT_EQ(kv_search(120).primary_key, INVALID_KEY);
+
+  ret = write_records(follower, 300, 301, OperationTypes::INSERT);
+  ASSERT_EQ(ret, ErrorCode_ReadOnlyCollection);
+  ASSERT_EQ(follower->dump(), ErrorCode_ReadOnlyCollection);
+
+  // writer publishes the second segment and deletes a published document
+  ret = write_records(writer, 150, 250, OperationTypes::INSERT);
+  ASSERT_EQ(ret, 0);
+  ret = write_records(writer, 10, 11, OperationTypes::DELETE);
+  ASSERT_EQ(ret, 0);
+  writer->close();
+
+  ret = follower->refresh();
+  ASSERT_EQ(ret, 0);
+  segments.clear();
+  ret = follower->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 2);
+  ASSERT_EQ(kv_search(120).primary_key, 120);
+  ASSERT_EQ(kv_search(10).primary_key, INVALID_KEY);
+
+  follower->close();
+}
+
+TEST_F(CollectionTest, TestCheckpointRestore) {
+  index::ThreadPool thread_pool(10, false);
+  system("rm -rf ./checkpoint/");
+  FileHelper::CreateDirectory("./checkpoint");
+  schema_->set_max_docs_per_segment(100);
+
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto write_record = [](CollectionPtr coll, uint64_t key,
+                         OperationTypes operation_type) {
+    CollectionDataset records(0);
+    auto *new_row = records.add_row_data();
+    new_row->primary_key = key;
+    new_row->operation_type = operation_type;
+    new_row->lsn = key;
+    new_row->forward_data = "hello";
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+    std::vector<float> fvec(16U, key * 1.0f);
+    new_column.data =
+        std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+    new_row->column_datas.emplace_back(new_column);
+    return coll->write_records(records);
+  };
+
+  // top 10 keys of all segments
+  auto knn_search = [](CollectionPtr coll, float value) {
+    std::vector<SegmentPtr> segments;
+    coll->get_segments(&segments);
+    std::vector<float> fvec(16U, value);
+    std::string query((char *)fvec.data(), fvec.size() * sizeof(float));
+    QueryParams query_params;
+    query_params.topk = 10;
+    query_params.data_type = DataTypes::VECTOR_FP32;
+    query_params.dimension = 16;
+
+    QueryResultList all_results;
+    for (auto &segment : segments) {
+      QueryResultList results;
+      segment->knn_search("face", query, query_params, &results);
+      all_results.insert(all_results.end(), results.begin(), results.end());
+    }
+    std::sort(all_results.begin(), all_results.end(),
+              [](const QueryResult &a, const QueryResult &b) {
+                return a.score < b.score ||
+                       (a.score == b.score && a.primary_key < b.primary_key);
+              });
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < all_results.size() && i < 10; i++) {
+      keys.emplace_back(all_results[i].primary_key);
+    }
+    return keys;
+  };
+
+  // one persist segment and a writing segment, with a deleted document
+  for (uint64_t i = 0; i < 150; i++) {
+    ret = write_record(collection, i, OperationTypes::INSERT);
+    ASSERT_EQ(ret, 0);
+  }
+  ret = write_record(collection, 5, OperationTypes::DELETE);
+  ASSERT_EQ(ret, 0);
+
+  uint64_t lsn = 0U;
+  ret = collection->checkpoint("./checkpoint", &lsn);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 149);
+  ASSERT_TRUE(FileHelper::FileExists(
+      FileHelper::MakeFilePath("./checkpoint/teachers", FileID::SEGMENT_FILE,
+                               0)));
+
+  std::vector<std::vector<uint64_t>> expected_results;
+  for (float value : {0.0f, 5.0f, 99.0f, 120.0f}) {
+    expected_results.emplace_back(knn_search(collection, value));
+  }
+
+  // checkpoint never overwrites an existing one
+  ret = collection->checkpoint("./checkpoint", &lsn);
+  ASSERT_NE(ret, 0);
+
+  // writes after checkpoint are invisible to restored collection
+  for (uint64_t i = 150; i < 160; i++) {
+    ret = write_record(collection, i, OperationTypes::INSERT);
+    ASSERT_EQ(ret, 0);
+  }
+  collection->close();
+
+  CollectionPtr restored = Collection::Create(schema_->name(), "./checkpoint",
+                                              schema_, 10, &thread_pool);
+  read_options.create_new = false;
+  ret = restored->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  CollectionStats stats;
+  ret = restored->get_stats(&stats);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(stats.total_doc_count, 150);
+  ASSERT_EQ(stats.delete_doc_count, 1);
+
+  std::string lsn_context;
+  ret = restored->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 149);
+
+  size_t query_index = 0U;
+  for (float value : {0.0f, 5.0f, 99.0f, 120.0f}) {
+    ASSERT_EQ(knn_search(restored, value), expected_results[query_index++]);
+  }
+
+  // restored collection is writable
+  ret = write_record(restored, 155, OperationTypes::INSERT);
+  ASSERT_EQ(ret, 0);
+  restored->close();
+}
+
+TEST_F(CollectionTest, TestLoadModes) {
+  index::ThreadPool thread_pool(10, false);
+  schema_->set_max_docs_per_segment(100);
+
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  for (uint64_t i = 0; i < 150; i++) {
+    CollectionDataset records(0);
+    auto *new_row = records.add_row_data();
+    new_row->primary_key = i;
+    new_row->operation_type = OperationTypes::INSERT;
+    new_row->lsn = i;
+    new_row->forward_data = "hello";
+
+    CollectionDataset::ColumnData new_column;
+    new_column.column_name = "face";
+    new_column.data_type = DataTypes::VECTOR_FP32;
+    new_column.dimension = 16;
+    std::vector<float> fvec(16U, i * 1.0f);
+    new_column.data =
+        std::string((char *)fvec.data(), fvec.size() * sizeof(float));
+    new_row->column_datas.emplace_back(new_column);
+    ret = collection->write_records(records);
+    ASSERT_EQ(ret, 0);
+  }
+  // close waits dumping finished
+  collection->close();
+
+  // load mode of collection overrides the one of read options
+  read_options.create_new = false;
+  read_options.load_mode = LoadModes::HEAP;
+  for (auto load_mode :
+       {LoadModes::MMAP, LoadModes::MMAP_LOCKED, LoadModes::HEAP}) {
+    schema_->set_load_mode(load_mode);
+    collection =
+        Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+    ret = collection->open(read_options);
+    ASSERT_EQ(ret, 0);
+
+    CollectionStats stats;
+    ret = collection->get_stats(&stats);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(stats.total_segment_count, 2);
+    ASSERT_GT(stats.total_resident_size, 0U);
+    ASSERT_EQ(stats.segment_stats[0].resident_size, stats.total_resident_size);
+    ASSERT_LE(stats.total_resident_size,
+              stats.segment_stats[0].index_file_size);
+
+    std::vector<SegmentPtr> segments;
+    collection->get_segments(&segments);
+    QueryResult result;
+    segments[0]->kv_search(50, &result);
+    ASSERT_EQ(result.primary_key, 50);
+    collection->close();
+  }
+}
+
+TEST_F(CollectionTest, TestParallelColumnBuild) {
+  meta::ColumnMetaPtr column_meta = std::make_shared<meta::ColumnMeta>();
+  column_meta->set_name("hand");
+  column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  column_meta->set_data_type(DataTypes::VECTOR_FP32);
+  column_meta->set_dimension(8);
+  column_meta->mutable_parameters()->set("metric_type", "SquaredEuclidean");
+  schema_->append(column_meta);
+
+  index::ThreadPool thread_pool(10, false);
+  index::ThreadPool build_pool(4, false);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(collection, nullptr);
+  collection->set_build_pool(&build_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto make_column = [](const std::string &name, uint32_t dimension,
+                        float value) {
+    CollectionDataset::ColumnData column;
+    column.column_name = name;
+    column.data_type = DataTypes::VECTOR_FP32;
+    column.dimension = dimension;
+    std::vector<float> fvec(dimension, value);
+    column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+    return column;
+  };
+
+  // Batches of 100 rows, a duplicate key in the last batch fails alone
+  for (size_t batch = 0; batch < 10; batch++) {
+    CollectionDataset records(1);
+    for (size_t i = batch * 100; i < (batch + 1) * 100; i++) {
+      auto *row = records.add_row_data();
+      row->primary_key = i;
+      row->operation_type = OperationTypes::INSERT;
+      row->lsn = i;
+      row->forward_data = "hello";
+      row->column_datas.emplace_back(make_column("face", 16, i * 1.0f));
+      row->column_datas.emplace_back(make_column("hand", 8, i * 2.0f));
+    }
+    if (batch == 9) {
+      auto *row = records.add_row_data();
+      *row = records.get(0);
+      row->lsn = 1000;
+      ASSERT_EQ(collection->write_records(records), ErrorCode_DuplicateKey);
+    } else {
+      ASSERT_EQ(collection->write_records(records), 0);
+    }
+  }
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 1);
+  ASSERT_EQ(segments[0]->doc_count(), 1000);
+
+  for (size_t i = 0; i < 1000; i += 7) {
+    QueryParams query_params;
+    query_params.topk = 10;
+    query_params.data_type = DataTypes::VECTOR_FP32;
+
+    query_params.dimension = 16;
+    QueryResultList result_list;
+    ret = segments[0]->knn_search("face", make_column("face", 16, i).data,
+                                  query_params, &result_list);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(result_list[0].primary_key, i);
+    ASSERT_EQ(result_list[0].lsn, i);
+
+    query_params.dimension = 8;
+    result_list.clear();
+    ret = segments[0]->knn_search("hand", make_column("hand", 8, i * 2.0f).data,
+                                  query_params, &result_list);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(result_list[0].primary_key, i);
+  }
+
+  CollectionStats stats;
+  ret = collection->get_stats(&stats);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(stats.total_doc_count, 1000);
+  ASSERT_EQ(stats.column_build_stats.size(), 2);
+  for (auto &it : stats.column_build_stats) {
+    ASSERT_TRUE(it.column_name == "face" || it.column_name == "hand");
+    ASSERT_EQ(it.insert_count, 1000);
+    ASSERT_GE(it.total_build_us, it.max_batch_build_us);
+  }
+  collection->close();
+}
+
+TEST_F(CollectionTest, TestBatchWrite) {
+  index::ThreadPool thread_pool(10, false);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(collection, nullptr);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto add_row = [](CollectionDataset *records, uint64_t key, uint64_t lsn,
+                    OperationTypes operation_type) {
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = operation_type;
+    row->lsn = lsn;
+    row->lsn_context = "batch" + std::to_string(lsn);
+    row->forward_data = "hello";
+    if (operation_type != OperationTypes::DELETE) {
+      CollectionDataset::ColumnData column;
+      column.column_name = "face";
+      column.data_type = DataTypes::VECTOR_FP32;
+      column.dimension = 16;
+      std::vector<float> fvec(16U, key * 1.0f);
+      column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+      row->column_datas.emplace_back(column);
+    }
+  };
+
+  // Inserts, deletes of a part of them, then inserts of deleted keys
+  // again, all in one dataset
+  CollectionDataset records(0);
+  uint64_t lsn = 0;
+  for (size_t i = 0; i < 1000; i++) {
+    add_row(&records, i, lsn++, OperationTypes::INSERT);
+  }
+  for (size_t i = 0; i < 1000; i += 2) {
+    add_row(&records, i, lsn++, OperationTypes::DELETE);
+  }
+  for (size_t i = 0; i < 100; i += 2) {
+    add_row(&records, i, lsn++, OperationTypes::INSERT);
+  }
+  ret = collection->write_records(records);
+  ASSERT_EQ(ret, 0);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 1);
+  auto exists = [&segments](uint64_t key) {
+    QueryResult result;
+    segments[0]->kv_search(key, &result);
+    return result.primary_key == key;
+  };
+  for (size_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(exists(i), i % 2 == 1 || i < 100);
+  }
+
+  uint64_t latest_lsn;
+  std::string lsn_context;
+  ret = collection->get_latest_lsn(&latest_lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(latest_lsn, lsn - 1);
+  ASSERT_EQ(lsn_context, "batch" + std::to_string(lsn - 1));
+
+  // Deleting inexistent keys fails, others in batch still apply
+  CollectionDataset deletes(0);
+  add_row(&deletes, 1, lsn++, OperationTypes::DELETE);
+  add_row(&deletes, 200, lsn++, OperationTypes::DELETE);
+  add_row(&deletes, 3, lsn++, OperationTypes::DELETE);
+  ASSERT_EQ(collection->write_records(deletes), ErrorCode_InexistentKey);
+  ASSERT_FALSE(exists(1));
+  ASSERT_FALSE(exists(3));
+  ASSERT_TRUE(exists(5));
+  collection->close();
+}
+
+TEST_F(CollectionTest, TestWriteFolding) {
+  index::ThreadPool thread_pool(10, false);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(collection, nullptr);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto add_row = [](CollectionDataset *records, uint64_t key, uint64_t lsn,
+                    OperationTypes operation_type) {
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = operation_type;
+    row->lsn = lsn;
+    row->lsn_check = true;
+    row->lsn_context = "fold" + std::to_string(lsn);
+    row->forward_data = "hello" + std::to_string(lsn);
+    if (operation_type != OperationTypes::DELETE) {
+      CollectionDataset::ColumnData column;
+      column.column_name = "face";
+      column.data_type = DataTypes::VECTOR_FP32;
+      column.dimension = 16;
+      std::vector<float> fvec(16U, lsn * 1.0f);
+      column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+      row->column_datas.emplace_back(column);
+    }
+  };
+
+  // Key 3 and 4 exist before
+  CollectionDataset initial(0);
+  add_row(&initial, 3, 1, OperationTypes::INSERT);
+  add_row(&initial, 4, 2, OperationTypes::INSERT);
+  ASSERT_EQ(collection->write_records(initial), 0);
+
+  // Lsns of folded rows are kept, latest lsn is not stuck at a gap
+  CollectionDataset updates(0);
+  add_row(&updates, 1, 3, OperationTypes::INSERT);
+  add_row(&updates, 1, 4, OperationTypes::UPDATE);
+  add_row(&updates, 1, 5, OperationTypes::UPDATE);
+  WriteSummary summary;
+  ret = collection->write_records(updates, &summary);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(summary.row_count, 3U);
+  ASSERT_EQ(summary.folded_count, 2U);
+
+  uint64_t lsn;
+  std::string lsn_context;
+  ret = collection->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 5U);
+  ASSERT_EQ(lsn_context, "fold5");
+
+  CollectionDataset records(0);
+  add_row(&records, 2, 6, OperationTypes::INSERT);
+  add_row(&records, 3, 7, OperationTypes::UPDATE);
+  add_row(&records, 2, 8, OperationTypes::DELETE);
+  add_row(&records, 1, 9, OperationTypes::UPDATE);
+  add_row(&records, 3, 10, OperationTypes::DELETE);
+  add_row(&records, 4, 11, OperationTypes::DELETE);
+  add_row(&records, 4, 12, OperationTypes::INSERT);
+  ret = collection->write_records(records, &summary);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(summary.row_count, 7U);
+  // Net effect: update 1, delete 3, update 4
+  ASSERT_EQ(summary.folded_count, 4U);
+  ASSERT_EQ(summary.insert_count, 0U);
+  ASSERT_EQ(summary.update_count, 2U);
+  ASSERT_EQ(summary.delete_count, 1U);
+  ASSERT_EQ(summary.failed_count, 0U);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segments.size(), 1);
+  // Folded rows never reach the segment
+  ASSERT_EQ(segments[0]->doc_count(), 5U);
+
+  QueryResult result;
+  segments[0]->kv_search(1, &result);
+  ASSERT_EQ(result.primary_key, 1U);
+  ASSERT_EQ(result.lsn, 9U);
+  ASSERT_EQ(result.forward_data, "hello9");
+  segments[0]->kv_search(2, &result);
+  ASSERT_EQ(result.primary_key, INVALID_KEY);
+  segments[0]->kv_search(3, &result);
+  ASSERT_EQ(result.primary_key, INVALID_KEY);
+  segments[0]->kv_search(4, &result);
+  ASSERT_EQ(result.primary_key, 4U);
+  ASSERT_EQ(result.lsn, 12U);
+
+  // Invalid operations fail alone, and are not counted as folded
+  CollectionDataset invalid(0);
+  add_row(&invalid, 1, 13, OperationTypes::INSERT);
+  add_row(&invalid, 5, 14, OperationTypes::UPDATE);
+  add_row(&invalid, 1, 8, OperationTypes::UPDATE);
+  add_row(&invalid, 1, 15, OperationTypes::UPDATE);
+  ret = collection->write_records(invalid, &summary);
+  ASSERT_NE(ret, 0);
+  ASSERT_EQ(summary.folded_count, 0U);
+  ASSERT_EQ(summary.update_count, 1U);
+  ASSERT_EQ(summary.failed_count, 3U);
+  segments[0]->kv_search(1, &result);
+  ASSERT_EQ(result.lsn, 15U);
+  collection->close();
+}
+
+TEST_F(CollectionTest, TestLsnMigration) {
+  index::ThreadPool thread_pool(10, false);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ASSERT_NE(collection, nullptr);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  auto add_row = [](CollectionDataset *records, uint64_t key, uint64_t lsn,
+                    OperationTypes operation_type) {
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = operation_type;
+    row->lsn = lsn;
+    row->lsn_check = true;
+    row->lsn_context = "migrate";
+    row->forward_data = "hello" + std::to_string(lsn);
+    CollectionDataset::ColumnData column;
+    column.column_name = "face";
+    column.data_type = DataTypes::VECTOR_FP32;
+    column.dimension = 16;
+    std::vector<float> fvec(16U, lsn * 1.0f);
+    column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+    row->column_datas.emplace_back(column);
+  };
+
+  CollectionDataset records(0);
+  for (size_t i = 1; i <= 10; i++) {
+    add_row(&records, i, i * 10, OperationTypes::INSERT);
+  }
+  ret = collection->write_records(records);
+  ASSERT_EQ(ret, 0);
+  ret = collection->close();
+  ASSERT_EQ(ret, 0);
+
+  // Id map written by an older version keeps only doc ids of keys
+  std::vector<std::pair<uint64_t, idx_t>> pairs;
+  {
+    IDMapPtr id_map;
+    read_options.create_new = false;
+    ret = IDMap::CreateAndOpen(schema_->name(), "./teachers", read_options,
+                               &id_map);
+    ASSERT_EQ(ret, 0);
+    ret = id_map->for_each([&pairs](uint64_t key, idx_t doc_id) {
+      pairs.emplace_back(key, doc_id);
+    });
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(pairs.size(), 10U);
+    id_map->close();
+
+    ReadOptions legacy_options = read_options;
+    legacy_options.create_new = true;
+    SnapshotPtr snapshot;
+    ret = Snapshot::CreateAndOpen("./teachers", FileID::ID_FILE,
+                                  legacy_options, &snapshot);
+    ASSERT_EQ(ret, 0);
+    PersistHashMap<uint64_t, idx_t> legacy_map;
+    ret = legacy_map.mount(snapshot->data());
+    ASSERT_EQ(ret, 0);
+    for (auto &it : pairs) {
+      ASSERT_EQ(legacy_map.emplace(it.first, it.second), 0);
+    }
+    legacy_map.unmount();
+    snapshot->close();
+  }
+
+  collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // Lsns are checked without reading forwards after migration
+  for (size_t i = 1; i <= 10; i++) {
+    CollectionDataset stale(0);
+    add_row(&stale, i, i * 10, OperationTypes::UPDATE);
+    ASSERT_EQ(collection->write_records(stale), ErrorCode_InvalidRecord);
+
+    CollectionDataset newer(0);
+    add_row(&newer, i, i * 10 + 1, OperationTypes::UPDATE);
+    ASSERT_EQ(collection->write_records(newer), 0);
+  }
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  QueryResult result;
+  segments[0]->kv_search(5, &result);
+  ASSERT_EQ(result.lsn, 51U);
+  ASSERT_EQ(result.forward_data, "hello51");
+
+  collection->close();
+}
+
+// Smoke test of reopening a collection killed while committing. Dirty
+// pages of killed process survive in page cache, so it can't tell if
+// commits synced, which IndexServiceTest.TestGroupCommit checks instead.
+TEST_F(CollectionTest, TestCommitCrashRecovery) {
+  auto add_row = [](CollectionDataset *records, uint64_t key) {
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = OperationTypes::INSERT;
+    row->lsn = key;
+    row->lsn_context = "commit" + std::to_string(key);
+    row->forward_data = "hello";
+    CollectionDataset::ColumnData column;
+    column.column_name = "face";
+    column.data_type = DataTypes::VECTOR_FP32;
+    column.dimension = 16;
+    std::vector<float> fvec(16U, key * 1.0f);
+    column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+    row->column_datas.emplace_back(column);
+  };
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    // Child ingests until killed, keys of a request are reported only
+    // after the request is committed
+    close(fds[0]);
+    index::ThreadPool thread_pool(4, false);
+    CollectionPtr collection;
+    ReadOptions read_options;
+    read_options.use_mmap = true;
+    read_options.create_new = true;
+    if (Collection::CreateAndOpen(schema_->name(), "./", schema_, 10,
+                                  &thread_pool, read_options,
+                                  &collection) != 0) {
+      _exit(1);
+    }
+
+    std::vector<std::thread> writers;
+    for (uint64_t t = 0; t < 4U; t++) {
+      writers.emplace_back([&, t] {
+        for (uint64_t batch = 0; batch < 10000U; batch++) {
+          CollectionDataset records(0);
+          std::vector<uint64_t> keys;
+          for (uint64_t i = 0; i < 10U; i++) {
+            keys.emplace_back((t * 10000U + batch) * 10U + i);
+            add_row(&records, keys.back());
+          }
+          if (collection->write_records(records) != 0 ||
+              collection->commit(200U) != 0) {
+            _exit(1);
+          }
+          size_t size = keys.size() * sizeof(uint64_t);
+          if (write(fds[1], keys.data(), size) != (ssize_t)size) {
+            _exit(1);
+          }
+        }
+      });
+    }
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    _exit(0);
+  }
+
+  // Kill the child in the middle of ingesting
+  close(fds[1]);
+  std::vector<uint64_t> acked_keys;
+  uint64_t key = 0U;
+  while (acked_keys.size() < 3000U &&
+         read(fds[0], &key, sizeof(key)) == sizeof(key)) {
+    acked_keys.emplace_back(key);
+  }
+  ASSERT_EQ(kill(pid, SIGKILL), 0);
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  close(fds[0]);
+  ASSERT_EQ(acked_keys.size(), 3000U);
+  ASSERT_TRUE(WIFSIGNALED(status));
+
+  // Every acked key is found after reopening
+  index::ThreadPool thread_pool(4, false);
+  CollectionPtr collection =
+      Collection::Create(schema_->name(), "./", schema_, 10, &thread_pool);
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = false;
+  int ret = collection->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  std::vector<SegmentPtr> segments;
+  ret = collection->get_segments(&segments);
+  ASSERT_EQ(ret, 0);
+  auto exists = [&segments](uint64_t primary_key) {
+    for (auto &segment : segments) {
+      QueryResult result;
+      segment->kv_search(primary_key, &result);
+      if (result.primary_key == primary_key) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (auto acked_key : acked_keys) {
+    ASSERT_TRUE(exists(acked_key));
+  }
+
+  // Writing goes on after recovery
+  CollectionDataset records(0);
+  add_row(&records, 1000000U);
+  ASSERT_EQ(collection->write_records(records), 0);
+  ASSERT_EQ(collection->commit(0U), 0);
+  collection->close();
+}
@@ -199,4 +199,88 @@ TEST_F(ColumnReaderTest, TestQuantizeINT8InnerProduct) {
   ASSERT_EQ(1000, result_list[0].key());
   ASSERT_NEAR(result_list[0].score(), 16.0f, 0.1f);
   column_reader->close();
-}
\ No newline at end of file
+}
+TEST_F(ColumnReaderTest, TestReorderOnDump) {
+  auto column_indexer =
+      ColumnIndexer::Create("test_collection", "./", 0, "test_column",
+                            IndexTypes::PROXIMA_GRAPH_INDEX);
+
+  meta::ColumnMeta meta;
+  meta.set_name("test_column");
+  meta.set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  meta.set_data_type(DataTypes::VECTOR_FP32);
+  meta.set_dimension(16);
+  meta.mutable_parameters()->set("engine", "HNSW");
+  meta.mutable_parameters()->set("reorder_on_dump", true);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = column_indexer->open(meta, read_options);
+  ASSERT_EQ(ret, 0);
+
+  // insert in interleaved order, so insertion order is far from locality
+  for (size_t i = 0; i < 1000; i++) {
+    size_t doc = (i % 2 == 0) ? i / 2 : 999 - i / 2;
+    std::vector<float> fvec(16U);
+    for (size_t j = 0; j < 16U; j++) {
+      fvec[j] = doc * 1.0f;
+    }
+
+    std::string vector((char *)fvec.data(), fvec.size() * sizeof(float));
+    ColumnData column_data;
+    column_data.column_name = "test_column";
+    column_data.data_type = DataTypes::VECTOR_FP32;
+    column_data.dimension = 16;
+    column_data.data = vector;
+    ret = column_indexer->insert(doc + 10000, column_data);
+    ASSERT_EQ(ret, 0);
+  }
+
+  auto dumper = aitheta2::IndexFactory::CreateDumper("FileDumper");
+  ASSERT_NE(dumper, nullptr);
+
+  ret = dumper->create("data.seg.0");
+  ASSERT_EQ(ret, 0);
+
+  IndexDumperPtr column_dumper = std::make_shared<IndexSegmentDumper>(
+      dumper, COLUMN_DUMP_BLOCK + "test_column");
+
+  ret = column_indexer->dump(column_dumper);
+  ASSERT_EQ(ret, 0);
+  ASSERT_FALSE(FileHelper::FileExists("./data.pxa.test_column.reorder.0"));
+
+  column_dumper->close();
+  dumper->close();
+  ret = column_indexer->close();
+  ASSERT_EQ(ret, 0);
+
+  auto column_reader =
+      ColumnReader::Create("test_collection", "./", 0, "test_column",
+                           IndexTypes::PROXIMA_GRAPH_INDEX);
+  ASSERT_NE(column_reader, nullptr);
+
+  column_reader->set_concurrency(10);
+  read_options.create_new = false;
+  ret = column_reader->open(meta, read_options);
+  ASSERT_EQ(ret, 0);
+
+  // reordered graph keeps doc_id of every node
+  for (size_t i = 0; i < 1000; i++) {
+    std::vector<float> fvec(16U);
+    for (size_t j = 0; j < 16U; j++) {
+      fvec[j] = i * 1.0f;
+    }
+
+    IndexDocumentList result_list;
+    std::string query((char *)fvec.data(), fvec.size() * sizeof(float));
+    QueryParams query_params;
+    query_params.topk = 10;
+    ret = column_reader->search(query, query_params, nullptr, &result_list);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(result_list[0].score(), 0.0f);
+    ASSERT_EQ(result_list[0].key(), i + 10000);
+  }
+
+  column_reader->close();
+}
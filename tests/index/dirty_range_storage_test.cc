@@ -0,0 +1,142 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "index/dirty_range_storage.h"
+#include <gtest/gtest.h>
+#include <ailego/utility/time_helper.h>
+#include <aitheta2/index_factory.h>
+#include "index/file_helper.h"
+
+using namespace proxima::be;
+using namespace proxima::be::index;
+
+class DirtyRangeStorageTest : public testing::Test {
+ protected:
+  void SetUp() {
+    FileHelper::RemoveFile(file_path_);
+  }
+
+  void TearDown() {
+    DirtyRangeStorage::SetFlushRate(0U);
+    FileHelper::RemoveFile(file_path_);
+  }
+
+  std::shared_ptr<DirtyRangeStorage> OpenStorage(bool create_new) {
+    auto storage = std::make_shared<DirtyRangeStorage>(
+        aitheta2::IndexFactory::CreateStorage("MMapFileStorage"));
+    IndexParams params;
+    if (storage->init(params) != 0 ||
+        storage->open(file_path_, create_new) != 0) {
+      return nullptr;
+    }
+    return storage;
+  }
+
+ protected:
+  std::string file_path_{"./dirty_range.data"};
+};
+
+TEST_F(DirtyRangeStorageTest, TestFlushDirtyRanges) {
+  const size_t page_size = DirtyRangeStorage::PAGE_SIZE;
+  auto storage = OpenStorage(true);
+  ASSERT_NE(storage, nullptr);
+  ASSERT_EQ(storage->append("block", 64 * page_size), 0);
+  IndexBlockPtr block = storage->get("block");
+  ASSERT_NE(block, nullptr);
+  ASSERT_EQ(storage->get("block"), block);
+
+  // Appending block changed metas, storage is flushed as a whole
+  ASSERT_EQ(storage->flush(), 0);
+  size_t flushed_bytes = storage->flushed_bytes();
+
+  // Nothing written, nothing flushed
+  ASSERT_EQ(storage->flush(), 0);
+  ASSERT_EQ(storage->flushed_bytes(), flushed_bytes);
+
+  // Only pages written are flushed, appended pages grow data size and
+  // are flushed with storage metas
+  uint64_t values[3] = {1U, 2U, 3U};
+  ASSERT_EQ(block->write(0, &values[0], sizeof(uint64_t)), sizeof(uint64_t));
+  ASSERT_EQ(block->write(page_size - 4, &values[1], sizeof(uint64_t)),
+            sizeof(uint64_t));
+  ASSERT_EQ(block->write(10 * page_size, &values[2], sizeof(uint64_t)),
+            sizeof(uint64_t));
+  ASSERT_EQ(storage->dirty_bytes(),
+            3 * page_size + DirtyRangeStorage::META_SIZE);
+  ASSERT_EQ(storage->flush(), 0);
+  size_t dirty_bytes = storage->flushed_bytes() - flushed_bytes;
+  ASSERT_GE(dirty_bytes, 3 * page_size);
+  ASSERT_LT(dirty_bytes, 6 * page_size);
+
+  flushed_bytes = storage->flushed_bytes();
+  ASSERT_EQ(storage->dirty_bytes(), 0U);
+  ASSERT_EQ(storage->flush(), 0);
+  ASSERT_EQ(storage->flushed_bytes(), flushed_bytes);
+  block.reset();
+  ASSERT_EQ(storage->close(), 0);
+
+  // Written values persist
+  storage = OpenStorage(false);
+  ASSERT_NE(storage, nullptr);
+  block = storage->get("block");
+  ASSERT_NE(block, nullptr);
+  uint64_t value = 0U;
+  ASSERT_EQ(block->fetch(0, &value, sizeof(value)), sizeof(value));
+  ASSERT_EQ(value, 1U);
+  ASSERT_EQ(block->fetch(page_size - 4, &value, sizeof(value)), sizeof(value));
+  ASSERT_EQ(value, 2U);
+  ASSERT_EQ(block->fetch(10 * page_size, &value, sizeof(value)),
+            sizeof(value));
+  ASSERT_EQ(value, 3U);
+  block.reset();
+  storage->close();
+}
+
+TEST_F(DirtyRangeStorageTest, TestThrottle) {
+  const size_t page_size = DirtyRangeStorage::PAGE_SIZE;
+  auto storage = OpenStorage(true);
+  ASSERT_NE(storage, nullptr);
+  ASSERT_EQ(storage->append("block", 256 * page_size), 0);
+  IndexBlockPtr block = storage->get("block");
+  ASSERT_NE(block, nullptr);
+  ASSERT_EQ(storage->flush(), 0);
+
+  DirtyRangeStorage::SetFlushRate(1024U);
+  ASSERT_EQ(DirtyRangeStorage::FlushRate(), 1024U);
+
+  std::string data(128 * page_size, 'a');
+  auto write_and_flush = [&]() {
+    ASSERT_EQ(block->write(0, data.data(), data.size()), data.size());
+    DirtyRangeStorage::Throttle(storage->dirty_bytes());
+    ASSERT_EQ(storage->flush(), 0);
+  };
+
+  // Threads out of throttle scope are never limited
+  write_and_flush();
+  write_and_flush();
+
+  // 512KB are flushed each time at 1MB per second
+  {
+    DirtyRangeStorage::ThrottleScope scope;
+    ailego::ElapsedTime timer;
+    write_and_flush();
+    write_and_flush();
+    write_and_flush();
+    ASSERT_GE(timer.milli_seconds(), 500U);
+  }
+  block.reset();
+  storage->close();
+}
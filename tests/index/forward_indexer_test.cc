@@ -154,3 +154,28 @@ TEST_F(ForwardIndexerTest, TestMultiThread) {
   }
   pool.wait_finish();
 }
+
+TEST_F(ForwardIndexerTest, TestDeserializeInPlace) {
+  ForwardData forward;
+  forward.header.primary_key = 7;
+  forward.header.lsn = 9;
+  forward.data = std::string(1024, 'x');
+
+  std::string buffer;
+  forward.serialize(&buffer);
+  const char *tail = buffer.data() + buffer.size() - 1;
+
+  ForwardData copied;
+  copied.deserialize(buffer);
+  ASSERT_EQ(buffer.size(), sizeof(ForwardData::ForwardHeader) + 1024U);
+
+  ForwardData moved;
+  moved.deserialize(std::move(buffer));
+  ASSERT_EQ(moved.header.primary_key, 7U);
+  ASSERT_EQ(moved.header.lsn, 9U);
+  ASSERT_EQ(moved.data, copied.data);
+  // Buffer is taken over instead of copied
+  ASSERT_EQ(moved.data.data() + moved.data.size() - 1 +
+                sizeof(ForwardData::ForwardHeader),
+            tail);
+}
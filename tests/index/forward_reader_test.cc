@@ -18,6 +18,8 @@
 #include <memory>
 #include <unordered_map>
 #include <gtest/gtest.h>
+#include "index/column/compressed_forward.h"
+#include "index/column/forward_fetcher.h"
 #include "index/column/forward_indexer.h"
 #include "index/file_helper.h"
 
@@ -112,3 +114,174 @@ TEST_F(ForwardReaderTest, TestGeneral) {
 
   forward_reader->close();
 }
+
+TEST_F(ForwardReaderTest, TestBatchSeekOnDisk) {
+  auto forward_indexer = ForwardIndexer::Create("test_collection", "./", 0);
+  ASSERT_TRUE(forward_indexer != nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+
+  forward_indexer->set_start_doc_id(0);
+  int ret = forward_indexer->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    ForwardData forward;
+    forward.header.primary_key = i;
+    forward.header.lsn = i;
+    forward.header.revision = i;
+    forward.data = "hello";
+
+    idx_t doc_id = 0U;
+    ret = forward_indexer->insert(forward, &doc_id);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(doc_id, i);
+  }
+
+  auto dumper = aitheta2::IndexFactory::CreateDumper("FileDumper");
+  ASSERT_NE(dumper, nullptr);
+  ret = dumper->create("data.seg.0");
+  ASSERT_EQ(ret, 0);
+
+  IndexDumperPtr fwd_dumper =
+      std::make_shared<IndexSegmentDumper>(dumper, FORWARD_DUMP_BLOCK);
+  ret = forward_indexer->dump(fwd_dumper);
+  ASSERT_EQ(ret, 0);
+  fwd_dumper->close();
+  dumper->close();
+  ret = forward_indexer->close();
+  ASSERT_EQ(ret, 0);
+
+  auto &fetcher = ForwardFetcher::Instance();
+  ret = fetcher.init(4, 1024 * 1024);
+  ASSERT_EQ(ret, 0);
+
+  // Forwards on disk are mapped even if heap mode asked
+  auto forward_reader = ForwardReader::Create("test_collection", "./", 0);
+  read_options.use_mmap = false;
+  read_options.create_new = false;
+  read_options.forward_on_disk = true;
+  ret = forward_reader->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  std::vector<idx_t> doc_ids;
+  for (size_t i = 0; i < 1000; i += 10) {
+    doc_ids.emplace_back(i);
+  }
+  std::vector<ForwardData> forwards;
+  std::vector<int> codes;
+  uint64_t miss_count = fetcher.miss_count();
+  ret = forward_reader->batch_seek(doc_ids, &forwards, &codes);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(forwards.size(), doc_ids.size());
+  ASSERT_EQ(fetcher.miss_count() - miss_count, doc_ids.size());
+  for (size_t i = 0; i < doc_ids.size(); i++) {
+    ASSERT_EQ(codes[i], 0);
+    ASSERT_EQ(forwards[i].header.primary_key, doc_ids[i]);
+    ASSERT_EQ(forwards[i].data, "hello");
+  }
+
+  // Second batch is served by cache
+  uint64_t hit_count = fetcher.hit_count();
+  ret = forward_reader->batch_seek(doc_ids, &forwards, &codes);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(fetcher.hit_count() - hit_count, doc_ids.size());
+  ASSERT_EQ(forwards[1].header.lsn, 10U);
+
+  for (size_t i = 0; i < 1000; i++) {
+    do_search(forward_reader.get(), i);
+  }
+
+  // Cache is bounded by capacity
+  fetcher.init(4, 64);
+  ASSERT_LE(fetcher.cache().size(), 64U);
+
+  forward_reader->close();
+  fetcher.cleanup();
+}
+
+TEST_F(ForwardReaderTest, TestCompressedForward) {
+  auto forward_indexer = ForwardIndexer::Create("test_collection", "./", 0);
+  ASSERT_TRUE(forward_indexer != nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  read_options.forward_compression = CompressionTypes::SNAPPY;
+  read_options.forward_block_size = 1024U;
+
+  forward_indexer->set_start_doc_id(0);
+  int ret = forward_indexer->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    ForwardData forward;
+    forward.header.primary_key = i;
+    forward.header.lsn = i;
+    forward.header.revision = i;
+    forward.data = "hello";
+
+    idx_t doc_id = 0U;
+    ret = forward_indexer->insert(forward, &doc_id);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(doc_id, i);
+  }
+  ret = forward_indexer->remove(500);
+  ASSERT_EQ(ret, 0);
+
+  auto dumper = aitheta2::IndexFactory::CreateDumper("FileDumper");
+  ASSERT_NE(dumper, nullptr);
+  ret = dumper->create("data.seg.0");
+  ASSERT_EQ(ret, 0);
+
+  IndexDumperPtr fwd_dumper =
+      std::make_shared<IndexSegmentDumper>(dumper, FORWARD_DUMP_BLOCK);
+  ret = forward_indexer->dump(fwd_dumper);
+  ASSERT_EQ(ret, 0);
+  fwd_dumper->close();
+  dumper->close();
+  ret = forward_indexer->close();
+  ASSERT_EQ(ret, 0);
+
+  auto &block_cache = CompressedForwardCloset::BlockCache();
+  block_cache.clear();
+  for (bool use_mmap : {true, false}) {
+    auto forward_reader = ForwardReader::Create("test_collection", "./", 0);
+    read_options.use_mmap = use_mmap;
+    read_options.create_new = false;
+    ret = forward_reader->open(read_options);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(forward_reader->doc_count(), 1000U);
+
+    for (size_t i = 0; i < 1000; i++) {
+      if (i == 500) {
+        ForwardData forward;
+        ASSERT_NE(forward_reader->seek(i, &forward), 0);
+        continue;
+      }
+      do_search(forward_reader.get(), i);
+    }
+
+    // Decompressed blocks are shared by batches
+    size_t cached_count = block_cache.count();
+    ASSERT_GT(cached_count, 1U);
+    std::vector<idx_t> doc_ids = {0, 1, 499, 500, 501, 999};
+    std::vector<ForwardData> forwards;
+    std::vector<int> codes;
+    ret = forward_reader->batch_seek(doc_ids, &forwards, &codes);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(block_cache.count(), cached_count);
+    for (size_t i = 0; i < doc_ids.size(); i++) {
+      if (doc_ids[i] == 500) {
+        ASSERT_NE(codes[i], 0);
+      } else {
+        ASSERT_EQ(codes[i], 0);
+        ASSERT_EQ(forwards[i].header.primary_key, doc_ids[i]);
+      }
+    }
+    forward_reader->close();
+  }
+  block_cache.clear();
+}
@@ -0,0 +1,123 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "index/huge_page_helper.h"
+#include <sys/mman.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <aitheta2/index_format.h>
+#include "index/column/forward_indexer.h"
+#include "index/column/forward_reader.h"
+#include "index/file_helper.h"
+#include "index/snapshot.h"
+
+using namespace proxima::be;
+using namespace proxima::be::index;
+
+class HugePageHelperTest : public testing::Test {
+ protected:
+  void SetUp() {
+    FileHelper::RemoveFile("./data.fwd.0");
+    FileHelper::RemoveFile("./data.seg.0");
+  }
+
+  void TearDown() {}
+};
+
+TEST_F(HugePageHelperTest, TestAdvise) {
+  size_t len = 4 * HugePageHelper::HUGE_PAGE_SIZE;
+  void *addr = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(addr, MAP_FAILED);
+
+  // Only whole huge pages inside range are advised, and it's zero if
+  // kernel does not support transparent huge pages
+  char *data = (char *)addr + 1;
+  size_t advised_size = HugePageHelper::Advise(data, len - 1, true);
+  ASSERT_EQ(advised_size % HugePageHelper::HUGE_PAGE_SIZE, 0U);
+  ASSERT_LT(advised_size, len);
+
+  ASSERT_EQ(HugePageHelper::Advise(data, 4096, false), 0U);
+  ASSERT_EQ(HugePageHelper::Advise(nullptr, len, false), 0U);
+  munmap(addr, len);
+}
+
+TEST_F(HugePageHelperTest, TestAlignedDump) {
+  auto forward_indexer = ForwardIndexer::Create("test_collection", "./", 0);
+  ASSERT_TRUE(forward_indexer != nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.huge_page = true;
+  read_options.create_new = true;
+
+  forward_indexer->set_start_doc_id(0);
+  int ret = forward_indexer->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    ForwardData forward;
+    forward.header.primary_key = i;
+    forward.header.lsn = i;
+    forward.header.revision = i;
+    forward.data = "hello";
+
+    idx_t doc_id = 0U;
+    ret = forward_indexer->insert(forward, &doc_id);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(doc_id, i);
+  }
+
+  IndexDumperPtr dumper = std::make_shared<HugePageDumper>(
+      aitheta2::IndexFactory::CreateDumper("FileDumper"));
+  ret = dumper->create("data.seg.0");
+  ASSERT_EQ(ret, 0);
+
+  IndexDumperPtr fwd_dumper =
+      std::make_shared<IndexSegmentDumper>(dumper, FORWARD_DUMP_BLOCK);
+  ret = forward_indexer->dump(fwd_dumper);
+  ASSERT_EQ(ret, 0);
+  fwd_dumper->close();
+  dumper->close();
+  ret = forward_indexer->close();
+  ASSERT_EQ(ret, 0);
+
+  // Forward block starts with its own meta header at huge page boundary
+  aitheta2::IndexFormat::MetaHeader header;
+  std::ifstream file("data.seg.0", std::ios::binary);
+  file.seekg(HugePageHelper::HUGE_PAGE_SIZE);
+  file.read((char *)&header, sizeof(header));
+  ASSERT_TRUE(file.good());
+  ASSERT_EQ(header.version, aitheta2::IndexFormat::FORMAT_VERSION);
+  ASSERT_EQ(header.meta_header_size, sizeof(header));
+
+  for (bool use_mmap : {true, false}) {
+    auto forward_reader = ForwardReader::Create("test_collection", "./", 0);
+    read_options.use_mmap = use_mmap;
+    read_options.create_new = false;
+    ret = forward_reader->open(read_options);
+    ASSERT_EQ(ret, 0);
+
+    for (size_t i = 0; i < 1000; i++) {
+      ForwardData forward;
+      ret = forward_reader->seek(i, &forward);
+      ASSERT_EQ(ret, 0);
+      ASSERT_EQ(forward.header.primary_key, i);
+      ASSERT_EQ(forward.data, "hello");
+    }
+    forward_reader->close();
+  }
+}
@@ -24,7 +24,7 @@ class IDMapTest : public testing::Test {
  protected:
   void SetUp() {
     char cmd_buf[100];
-    snprintf(cmd_buf, 100, "rm -rf ./data.id");
+    snprintf(cmd_buf, 100, "rm -rf ./data.id ./data.id.upgrade.0");
     system(cmd_buf);
   }
 
@@ -88,3 +88,157 @@ TEST_F(IDMapTest, TestGeneral) {
     ASSERT_EQ(doc_id, i);
   }
 }
+
+TEST_F(IDMapTest, TestBatchInsert) {
+  auto id_map = IDMap::Create("collection_test", "./");
+  ASSERT_NE(id_map, nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = id_map->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  std::vector<uint64_t> keys;
+  std::vector<idx_t> doc_ids;
+  std::vector<uint64_t> lsns;
+  for (size_t i = 0; i < 20000; i++) {
+    keys.emplace_back(i * 3);
+    doc_ids.emplace_back(i);
+    lsns.emplace_back(i + 100);
+  }
+  std::vector<int> codes;
+  ret = id_map->insert(keys, doc_ids, lsns, &codes);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(codes.size(), keys.size());
+  for (size_t i = 0; i < 20000; i++) {
+    ASSERT_EQ(codes[i], 0);
+    ASSERT_EQ(id_map->get_mapping_id(i * 3), i);
+    uint64_t lsn = 0U;
+    ASSERT_TRUE(id_map->get_lsn(i * 3, &lsn));
+    ASSERT_EQ(lsn, i + 100);
+  }
+  ASSERT_EQ(id_map->count(), 20000U);
+
+  // Duplicate key keeps the lsn of its doc id
+  std::vector<int> dup_codes;
+  ret = id_map->insert({3, 60000}, {30000, 30001}, {7, 8}, &dup_codes);
+  ASSERT_EQ(ret, 0);
+  ASSERT_NE(dup_codes[0], 0);
+  ASSERT_EQ(dup_codes[1], 0);
+  uint64_t lsn = 0U;
+  ASSERT_TRUE(id_map->get_lsn(3, &lsn));
+  ASSERT_EQ(lsn, 101U);
+  ASSERT_TRUE(id_map->get_lsn(60000, &lsn));
+  ASSERT_EQ(lsn, 8U);
+  ASSERT_FALSE(id_map->get_lsn(1, &lsn));
+
+  ret = id_map->close();
+  ASSERT_EQ(ret, 0);
+}
+
+TEST_F(IDMapTest, TestLsnMigration) {
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+
+  // Id map written by an older version keeps only doc ids of keys
+  {
+    SnapshotPtr snapshot;
+    int ret = Snapshot::CreateAndOpen("./", FileID::ID_FILE, read_options,
+                                      &snapshot);
+    ASSERT_EQ(ret, 0);
+    PersistHashMap<uint64_t, idx_t> legacy_map;
+    ret = legacy_map.mount(snapshot->data());
+    ASSERT_EQ(ret, 0);
+    for (size_t i = 0; i < 1000; i++) {
+      ret = legacy_map.emplace(i, i * 2);
+      ASSERT_EQ(ret, 0);
+    }
+    legacy_map.unmount();
+    ret = snapshot->close();
+    ASSERT_EQ(ret, 0);
+  }
+
+  auto id_map = IDMap::Create("collection_test", "./");
+  ASSERT_NE(id_map, nullptr);
+
+  // Followers never upgrade key mappings
+  read_options.create_new = false;
+  read_options.read_only = true;
+  int ret = id_map->open(read_options);
+  ASSERT_NE(ret, 0);
+
+  read_options.read_only = false;
+  id_map = IDMap::Create("collection_test", "./");
+  ret = id_map->open(read_options);
+  ASSERT_EQ(ret, 0);
+  ASSERT_TRUE(id_map->lsn_migration_needed());
+  ASSERT_FALSE(FileHelper::FileExists("./data.id.upgrade.0"));
+  ASSERT_EQ(id_map->count(), 1000U);
+  uint64_t lsn = 0U;
+  for (size_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(id_map->get_mapping_id(i), i * 2);
+    ASSERT_FALSE(id_map->get_lsn(i, &lsn));
+  }
+
+  size_t migrated_count = 0U;
+  ret = id_map->migrate_lsns(
+      [](uint64_t key, uint64_t *val) {
+        if (key % 10 == 0) {
+          return false;
+        }
+        *val = key + 1;
+        return true;
+      },
+      &migrated_count);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(migrated_count, 900U);
+  ASSERT_FALSE(id_map->lsn_migration_needed());
+  ret = id_map->close();
+  ASSERT_EQ(ret, 0);
+
+  ret = id_map->open(read_options);
+  ASSERT_EQ(ret, 0);
+  ASSERT_FALSE(id_map->lsn_migration_needed());
+  for (size_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(id_map->get_mapping_id(i), i * 2);
+    if (i % 10 == 0) {
+      ASSERT_FALSE(id_map->get_lsn(i, &lsn));
+    } else {
+      ASSERT_TRUE(id_map->get_lsn(i, &lsn));
+      ASSERT_EQ(lsn, i + 1);
+    }
+  }
+  ret = id_map->close();
+  ASSERT_EQ(ret, 0);
+}
+
+TEST_F(IDMapTest, TestLsnOfLargeDocId) {
+  auto id_map = IDMap::Create("collection_test", "./");
+  ASSERT_NE(id_map, nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = id_map->open(read_options);
+  ASSERT_EQ(ret, 0);
+  ASSERT_FALSE(id_map->lsn_migration_needed());
+
+  // Lsns are kept with keys, never sized by doc ids
+  std::vector<int> codes;
+  ret = id_map->insert({1, 2}, {10, 1UL << 40}, {5, 6}, &codes);
+  ASSERT_EQ(ret, 0);
+  uint64_t lsn = 0U;
+  ASSERT_TRUE(id_map->get_lsn(2, &lsn));
+  ASSERT_EQ(lsn, 6U);
+  ASSERT_EQ(id_map->get_mapping_id(2), 1UL << 40);
+  ASSERT_LT(FileHelper::FileSize(id_map->file_path()), 1UL << 20);
+
+  ret = id_map->insert(3, 11);
+  ASSERT_EQ(ret, 0);
+  ASSERT_FALSE(id_map->get_lsn(3, &lsn));
+  ASSERT_EQ(id_map->get_mapping_id(4), INVALID_DOC_ID);
+  ret = id_map->close();
+  ASSERT_EQ(ret, 0);
+}
@@ -14,7 +14,16 @@
  *   limitations under the License.
  */
 
+#define private public
+#define protected public
+#include "common/config.h"
+#include "index/collection.h"
 #include "index/index_service.h"
+#undef private
+#undef protected
+
+#include <atomic>
+#include <thread>
 #include <gtest/gtest.h>
 
 using namespace proxima::be;
@@ -157,3 +166,81 @@ TEST_F(IndexServiceTest, TestMultiThread) {
   pool.wait_finish();
   index_service.stop();
 }
+
+TEST_F(IndexServiceTest, TestGroupCommit) {
+  auto write_record = [](IndexService *service, const std::string &name,
+                         uint64_t key) {
+    CollectionDatasetPtr records = std::make_shared<CollectionDataset>(0);
+    auto *row = records->add_row_data();
+    row->primary_key = key;
+    row->operation_type = OperationTypes::INSERT;
+    row->lsn = key;
+    row->forward_data = "hello";
+    CollectionDataset::ColumnData column;
+    column.column_name = "face";
+    column.data_type = DataTypes::VECTOR_FP32;
+    column.dimension = 16;
+    std::vector<float> fvec(16U, key * 1.0f);
+    column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+    row->column_datas.emplace_back(column);
+    WriteSummary summary;
+    return service->write_records(name, records, &summary);
+  };
+  auto *index_config = Config::Instance().config_.mutable_index_config();
+
+  // Without group commit, commits are acked at once without syncing
+  index_config->set_group_commit(false);
+  {
+    IndexService index_service;
+    ASSERT_EQ(index_service.init(), 0);
+    ASSERT_EQ(index_service.start(), 0);
+    ASSERT_EQ(index_service.create_collection("teachers", schema_), 0);
+    CollectionPtr collection = index_service.collections_.get("teachers");
+
+    ASSERT_EQ(write_record(&index_service, "teachers", 1U), 0);
+    ASSERT_EQ(index_service.commit_records("teachers"), 0);
+    ASSERT_EQ(collection->synced_seq_.load(), 0U);
+    index_service.stop();
+  }
+
+  // With group commit, every ack follows a sync covering its batch
+  index_config->set_group_commit(true);
+  index_config->set_group_commit_window(200U);
+  {
+    IndexService index_service;
+    ASSERT_EQ(index_service.init(), 0);
+    ASSERT_EQ(index_service.start(), 0);
+    ASSERT_EQ(index_service.create_collection("students", schema1_), 0);
+    CollectionPtr collection = index_service.collections_.get("students");
+
+    std::atomic<size_t> uncovered_count{0U};
+    std::atomic<size_t> failed_count{0U};
+    std::vector<std::thread> writers;
+    for (uint64_t t = 0; t < 4U; t++) {
+      writers.emplace_back([&, t] {
+        for (uint64_t i = 0; i < 100U; i++) {
+          // Sequence of this batch is above the one read before writing
+          uint64_t seq = collection->written_seq_.load();
+          if (write_record(&index_service, "students", t * 100U + i) != 0 ||
+              index_service.commit_records("students") != 0) {
+            failed_count++;
+            continue;
+          }
+          if (collection->synced_seq_.load() <= seq) {
+            uncovered_count++;
+          }
+        }
+      });
+    }
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    ASSERT_EQ(failed_count.load(), 0U);
+    ASSERT_EQ(uncovered_count.load(), 0U);
+    ASSERT_EQ(collection->synced_seq_.load(), 400U);
+    index_service.stop();
+  }
+
+  index_config->set_group_commit(false);
+  index_config->set_group_commit_window(0U);
+}
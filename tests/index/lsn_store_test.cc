@@ -20,6 +20,8 @@
 #undef private
 #undef protected
 
+#include <algorithm>
+#include <random>
 #include <ailego/parallel/thread_pool.h>
 #include <ailego/utility/time_helper.h>
 #include <gtest/gtest.h>
@@ -141,3 +143,115 @@ TEST_F(LsnStoreTest, TestMultiThread) {
   ASSERT_EQ(lsn_context_val,
             std::string("JDBC://hello") + std::to_string(9999));
 }
+
+TEST_F(LsnStoreTest, TestBatchAppend) {
+  LsnStorePtr lsn_store = LsnStore::Create("teachers", "./");
+  ASSERT_TRUE(lsn_store != nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = lsn_store->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // Batches cross data block boundaries
+  for (size_t batch = 0; batch < 40; batch++) {
+    std::vector<uint64_t> lsns;
+    std::vector<std::string> contexts;
+    std::vector<const std::string *> lsn_contexts;
+    for (size_t i = batch * 1000; i < (batch + 1) * 1000; i++) {
+      lsns.emplace_back(i);
+      contexts.emplace_back("JDBC://hello" + std::to_string(i));
+    }
+    for (auto &context : contexts) {
+      lsn_contexts.emplace_back(&context);
+    }
+    ret = lsn_store->append(lsns, lsn_contexts);
+    ASSERT_EQ(ret, 0);
+  }
+  ASSERT_EQ(lsn_store->count(), 40000U);
+  ASSERT_EQ(lsn_store->header_.tail_block_index, 1);
+
+  uint64_t lsn;
+  std::string lsn_context;
+  ret = lsn_store->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 39999);
+  ASSERT_EQ(lsn_context, "JDBC://hello39999");
+
+  ret = lsn_store->close();
+  ASSERT_EQ(ret, 0);
+}
+
+TEST_F(LsnStoreTest, TestLatestLsnTracking) {
+  LsnStorePtr lsn_store = LsnStore::Create("teachers", "./");
+  ASSERT_TRUE(lsn_store != nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = lsn_store->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // Lsns arrive out of order in small groups, 100 and 3000 are lost
+  std::vector<uint64_t> lsns;
+  for (uint64_t i = 0; i < 6000; i++) {
+    if (i != 100 && i != 3000) {
+      lsns.emplace_back(i);
+    }
+  }
+  std::mt19937 gen(7);
+  for (size_t i = 1; i + 8 <= lsns.size(); i += 8) {
+    std::shuffle(lsns.begin() + i, lsns.begin() + i + 8, gen);
+  }
+
+  uint64_t lsn = 0U;
+  uint64_t scanned_lsn = 0U;
+  std::string lsn_context;
+  std::string scanned_context;
+  for (auto val : lsns) {
+    ret = lsn_store->append(val, "JDBC://hello" + std::to_string(val));
+    ASSERT_EQ(ret, 0);
+    ret = lsn_store->get_latest_lsn(&lsn, &lsn_context);
+    ASSERT_EQ(ret, 0);
+    ret = lsn_store->scan_latest_lsn(&scanned_lsn, &scanned_context);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(lsn, scanned_lsn);
+    ASSERT_EQ(lsn_context, scanned_context);
+  }
+  ASSERT_EQ(lsn, 5999U);
+
+  // Header is persisted in groups, and at last while closing
+  ASSERT_EQ(lsn_store->count(), lsns.size());
+  ret = lsn_store->close();
+  ASSERT_EQ(ret, 0);
+
+  read_options.create_new = false;
+  ret = lsn_store->open(read_options);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn_store->count(), lsns.size());
+  ret = lsn_store->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 5999U);
+  ASSERT_EQ(lsn_context, "JDBC://hello5999");
+
+  // Latest lsn is recovered with its gap on open
+  ret = lsn_store->append(6001, "JDBC://hello6001");
+  ASSERT_EQ(ret, 0);
+  ret = lsn_store->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 5999U);
+  ret = lsn_store->close();
+  ASSERT_EQ(ret, 0);
+
+  ret = lsn_store->open(read_options);
+  ASSERT_EQ(ret, 0);
+  ret = lsn_store->append(6000, "JDBC://hello6000");
+  ASSERT_EQ(ret, 0);
+  ret = lsn_store->get_latest_lsn(&lsn, &lsn_context);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(lsn, 6001U);
+  ASSERT_EQ(lsn_context, "JDBC://hello6001");
+  ret = lsn_store->close();
+  ASSERT_EQ(ret, 0);
+}
@@ -15,6 +15,7 @@
  */
 
 #include "index/segment/memory_segment.h"
+#include <thread>
 #include <ailego/utility/file_helper.h>
 #include <gtest/gtest.h>
 
@@ -62,8 +63,8 @@ TEST_F(MemorySegmentTest, TestGeneral) {
   segment_meta.segment_id = 0;
 
   MemorySegmentPtr memory_segment =
-      MemorySegment::Create("teachers", "./teachers/", segment_meta,
-                            schema_.get(), &delete_store, &id_map, 5);
+      MemorySegment::Create("teachers", "./teachers/", segment_meta, schema_,
+                            &delete_store, &id_map, 5);
   ASSERT_TRUE(memory_segment != nullptr);
 
   ret = memory_segment->open(read_options);
@@ -153,3 +154,63 @@ TEST_F(MemorySegmentTest, TestGeneral) {
     ASSERT_EQ(result.forward_data, std::string("hello") + std::to_string(i));
   }
 }
+
+TEST_F(MemorySegmentTest, TestConcurrentInsertStats) {
+  DeleteStore delete_store("teachers", "./teachers/");
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = delete_store.open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  IDMap id_map("teachers", "./teachers/");
+  ret = id_map.open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  SegmentMeta segment_meta;
+  segment_meta.segment_id = 0;
+  MemorySegmentPtr memory_segment =
+      MemorySegment::Create("teachers", "./teachers/", segment_meta, schema_,
+                            &delete_store, &id_map, 5);
+  ASSERT_TRUE(memory_segment != nullptr);
+  ret = memory_segment->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  const size_t thread_count = 8U;
+  const size_t doc_count = 500U;
+  std::atomic<size_t> failed_count{0U};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < doc_count; i++) {
+        Record record;
+        record.primary_key = 100U + t * doc_count + i;
+        record.lsn = record.primary_key * 2;
+        record.timestamp = 1000U + record.primary_key;
+        record.forward_data = "hello";
+        idx_t doc_id;
+        if (memory_segment->insert_forward(record, &doc_id) != 0) {
+          failed_count++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(failed_count.load(), 0U);
+
+  size_t total_count = thread_count * doc_count;
+  auto meta = memory_segment->segment_meta();
+  ASSERT_EQ(memory_segment->doc_count(), total_count);
+  ASSERT_EQ(meta.doc_count, total_count);
+  ASSERT_EQ(meta.max_doc_id, total_count - 1);
+  ASSERT_EQ(meta.min_primary_key, 100U);
+  ASSERT_EQ(meta.max_primary_key, 100U + total_count - 1);
+  ASSERT_EQ(meta.min_lsn, 200U);
+  ASSERT_EQ(meta.max_lsn, (100U + total_count - 1) * 2);
+  ASSERT_EQ(meta.min_timestamp, 1100U);
+  ASSERT_EQ(meta.max_timestamp, 1100U + total_count - 1);
+  ASSERT_TRUE(memory_segment->is_in_range(total_count - 1));
+  ASSERT_FALSE(memory_segment->is_in_range(total_count));
+}
@@ -77,7 +77,7 @@ class MockIndexService : public IndexService {
   //! Write records to some collection
   MOCK_METHOD(int, write_records,
               (const std::string &collection_name,
-               const CollectionDatasetPtr &records),
+               const CollectionDatasetPtr &records, WriteSummary *summary),
               (override));
 
  protected:
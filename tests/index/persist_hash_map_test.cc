@@ -124,3 +124,42 @@ TEST_F(PersistHashMapTest, TestGeneral) {
     ASSERT_EQ(doc_id, i + 1);
   }
 }
+
+TEST_F(PersistHashMapTest, TestEraseIf) {
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+
+  SnapshotPtr snapshot;
+  int ret = Snapshot::CreateAndOpen("./idmap", FileID::ID_FILE, read_options,
+                                    &snapshot);
+  ASSERT_EQ(ret, 0);
+
+  PersistHashMap<uint64_t, idx_t> id_map;
+  ret = id_map.mount(snapshot->data());
+  ASSERT_EQ(ret, 0);
+
+  // small reserve to make sure multiple blocks and long chains
+  ASSERT_EQ(0, id_map.reserve(1000));
+  for (size_t i = 0; i < 20000; i++) {
+    ASSERT_EQ(0, id_map.emplace(i, i * 2));
+  }
+
+  size_t erased_count = 0;
+  ret = id_map.erase_if(
+      [](uint64_t, idx_t doc_id) { return doc_id >= 10000 && doc_id < 30000; },
+      &erased_count);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(erased_count, 10000);
+  ASSERT_EQ(id_map.size(), 10000);
+
+  for (size_t i = 0; i < 20000; i++) {
+    ASSERT_EQ(id_map.has(i), i < 5000 || i >= 15000);
+  }
+
+  // recycled nodes can be reused
+  for (size_t i = 5000; i < 15000; i++) {
+    ASSERT_EQ(0, id_map.emplace(i, i));
+  }
+  ASSERT_EQ(id_map.size(), 20000);
+}
@@ -64,8 +64,8 @@ TEST_F(PersistSegmentTest, TestGeneral) {
   segment_meta.segment_id = 0;
 
   MemorySegmentPtr memory_segment =
-      MemorySegment::Create("teachers", "./teachers/", segment_meta,
-                            schema_.get(), &delete_store, &id_map, 5);
+      MemorySegment::Create("teachers", "./teachers/", segment_meta, schema_,
+                            &delete_store, &id_map, 5);
   ASSERT_TRUE(memory_segment != nullptr);
 
   ret = memory_segment->open(read_options);
@@ -101,7 +101,7 @@ TEST_F(PersistSegmentTest, TestGeneral) {
   ASSERT_EQ(ret, 0);
 
   PersistSegmentPtr persist_segment = PersistSegment::Create(
-      "teachers", "./teachers/", memory_segment->segment_meta(), schema_.get(),
+      "teachers", "./teachers/", memory_segment->segment_meta(), schema_,
       &delete_store, &id_map, 5);
   ASSERT_NE(persist_segment, nullptr);
 
@@ -109,8 +109,8 @@ TEST_F(PersistSegmentTest, TestGeneral) {
   ret = persist_segment->load(read_options);
   ASSERT_EQ(ret, 0);
 
-  auto &meta0 = memory_segment->segment_meta();
-  auto &meta1 = persist_segment->segment_meta();
+  auto meta0 = memory_segment->segment_meta();
+  auto meta1 = persist_segment->segment_meta();
   ASSERT_EQ(meta0.segment_id, meta1.segment_id);
   ASSERT_EQ(meta0.state, meta1.state);
   ASSERT_EQ(meta0.index_file_size, meta1.index_file_size);
@@ -154,6 +154,8 @@ TEST_F(PersistSegmentTest, TestGeneral) {
     query_params.data_type = DataTypes::VECTOR_FP32;
     query_params.dimension = 16;
     query_params.radius = 0.1f;
+    ForwardCopyStats forward_stats;
+    query_params.forward_stats = &forward_stats;
 
     QueryResultList result_list;
     ret =
@@ -165,6 +167,12 @@ TEST_F(PersistSegmentTest, TestGeneral) {
     ASSERT_EQ(result_list[0].score, 0.0f);
     ASSERT_EQ(result_list[0].lsn, i);
     ASSERT_EQ(result_list[0].forward_data, "hello");
+
+    // Only the closet fetch copies forward bytes
+    ASSERT_EQ(forward_stats.copy_count.load(), 1U);
+    ASSERT_EQ(forward_stats.alloc_count.load(), 1U);
+    ASSERT_EQ(forward_stats.copy_bytes.load(),
+              sizeof(ForwardData::ForwardHeader) + 5U);
   }
 
   for (size_t i = 0; i < 1000; i++) {
@@ -177,3 +177,48 @@ TEST_F(VersionManagerTest, TestVersionEdit) {
   ASSERT_EQ(version_manager->current_version()[1].segment_id, 12);
   ASSERT_EQ(version_manager->current_version()[2].segment_id, 13);
 }
+
+TEST_F(VersionManagerTest, TestDocIdDelta) {
+  auto version_manager = VersionManager::Create("collection_test", "./");
+  ASSERT_NE(version_manager, nullptr);
+
+  ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = version_manager->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  // reserved bytes of old manifests are not trusted
+  SegmentMeta old_meta;
+  ret = version_manager->alloc_segment_meta(&old_meta);
+  ASSERT_EQ(ret, 0);
+  old_meta.state = SegmentState::PERSIST;
+  old_meta.doc_id_delta_ = 12345;
+  ret = version_manager->update_segment_meta(old_meta);
+  ASSERT_EQ(ret, 0);
+
+  SegmentMeta attached_meta;
+  ret = version_manager->alloc_segment_meta(&attached_meta);
+  ASSERT_EQ(ret, 0);
+  attached_meta.state = SegmentState::PERSIST;
+  attached_meta.set_doc_id_delta(-100);
+  ret = version_manager->update_segment_meta(attached_meta);
+  ASSERT_EQ(ret, 0);
+  version_manager->close();
+
+  version_manager = VersionManager::Create("collection_test", "./");
+  read_options.create_new = false;
+  ret = version_manager->open(read_options);
+  ASSERT_EQ(ret, 0);
+
+  SegmentMeta segment_meta;
+  ret = version_manager->get_segment_meta(old_meta.segment_id, &segment_meta);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segment_meta.doc_id_delta(), 0);
+
+  ret = version_manager->get_segment_meta(attached_meta.segment_id,
+                                          &segment_meta);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(segment_meta.doc_id_delta(), -100);
+  version_manager->close();
+}
@@ -0,0 +1,68 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#define private public
+#define protected public
+#include "index/write_tracer.h"
+#undef private
+#undef protected
+
+#include <gtest/gtest.h>
+
+using namespace proxima::be;
+using namespace proxima::be::index;
+
+TEST(WriteTracerTest, TestTraceKey) {
+  WriteTracer tracer("teachers");
+  ASSERT_FALSE(tracer.is_traced(1));
+  ASSERT_TRUE(tracer.traced_keys().empty());
+
+  tracer.trace_key(3, true);
+  tracer.trace_key(1, true);
+  tracer.trace_key(3, true);
+  ASSERT_TRUE(tracer.is_traced(1));
+  ASSERT_TRUE(tracer.is_traced(3));
+  ASSERT_FALSE(tracer.is_traced(2));
+  auto keys = tracer.traced_keys();
+  ASSERT_EQ(keys.size(), 2U);
+  ASSERT_EQ(keys[0], 1U);
+  ASSERT_EQ(keys[1], 3U);
+
+  tracer.trace_key(3, false);
+  tracer.trace_key(5, false);
+  ASSERT_FALSE(tracer.is_traced(3));
+  ASSERT_EQ(tracer.traced_keys().size(), 1U);
+  ASSERT_EQ(tracer.traced_count_.load(), 1U);
+}
+
+TEST(WriteTracerTest, TestSample) {
+  WriteTracer::SetSampleRate(0U);
+  ASSERT_FALSE(WriteTracer::Sample());
+
+  // Budget of a second is never exceeded
+  WriteTracer::SetSampleRate(100U);
+  size_t sampled = 0U;
+  for (size_t i = 0; i < 10000U; i++) {
+    if (WriteTracer::Sample()) {
+      sampled++;
+    }
+  }
+  ASSERT_GT(sampled, 0U);
+  ASSERT_LE(sampled, 200U);
+
+  WriteTracer::SetSampleRate(WriteTracer::DEFAULT_SAMPLE_RATE);
+  ASSERT_EQ(WriteTracer::SampleRate(), WriteTracer::DEFAULT_SAMPLE_RATE);
+}
@@ -65,6 +65,8 @@ TEST(SqliteMetaStoreTest, TestCollectionFunction) {
   meta.set_uid("uid");
   meta.mutable_forward_columns()->assign({"forward1", "forward2"});
   meta.set_max_docs_per_segment(10);
+  meta.set_ttl_seconds(3600);
+  meta.set_load_mode(LoadModes::HEAP);
   meta.set_revision(10);
   meta.set_status(CollectionStatus::INITIALIZED);
   meta.set_current(false);
@@ -84,6 +86,9 @@ TEST(SqliteMetaStoreTest, TestCollectionFunction) {
   EXPECT_EQ(row_count, 1);
   EXPECT_EQ(meta.max_docs_per_segment(),
             collection_record->max_docs_per_segment());
+  EXPECT_EQ(meta.ttl_seconds(), collection_record->ttl_seconds());
+  EXPECT_EQ(static_cast<uint32_t>(meta.load_mode()),
+            collection_record->load_mode());
   EXPECT_EQ(meta.revision(), collection_record->revision());
 
 
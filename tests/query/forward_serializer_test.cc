@@ -0,0 +1,78 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ *
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief
+ */
+
+#include "query/forward_serializer.h"
+#include <gtest/gtest.h>
+
+using namespace proxima::be;
+using namespace proxima::be::query;
+
+static index::QueryResult MakeForward() {
+  proto::GenericValueList values;
+  values.add_values()->set_string_value("name");
+  values.add_values()->set_int32_value(30);
+  values.add_values()->set_bytes_value(std::string(1024, 'x'));
+  values.add_values()->set_float_value(1.5f);
+
+  index::QueryResult forward;
+  values.SerializeToString(&forward.forward_data);
+  return forward;
+}
+
+TEST(ForwardSerializerTest, TestFillAll) {
+  ColumnNameList columns{"name", "age", "blob", "score"};
+  proto::Document doc;
+  ASSERT_EQ(ForwardSerializer::FillForward(MakeForward(), columns, &doc), 0);
+  ASSERT_EQ(doc.forward_column_values_size(), 4);
+  ASSERT_EQ(doc.forward_column_values(3).key(), "score");
+  ASSERT_FLOAT_EQ(doc.forward_column_values(3).value().float_value(), 1.5f);
+}
+
+TEST(ForwardSerializerTest, TestFillProjected) {
+  ColumnNameList columns{"name", "age", "blob", "score"};
+  proto::Document doc;
+
+  // Projection order is kept
+  std::vector<size_t> positions{3, 1};
+  ASSERT_EQ(
+      ForwardSerializer::FillForward(MakeForward(), columns, positions, &doc),
+      0);
+  ASSERT_EQ(doc.forward_column_values_size(), 2);
+  ASSERT_EQ(doc.forward_column_values(0).key(), "score");
+  ASSERT_FLOAT_EQ(doc.forward_column_values(0).value().float_value(), 1.5f);
+  ASSERT_EQ(doc.forward_column_values(1).key(), "age");
+  ASSERT_EQ(doc.forward_column_values(1).value().int32_value(), 30);
+
+  // Empty projection fills nothing but still validates the record
+  doc.Clear();
+  ASSERT_EQ(ForwardSerializer::FillForward(MakeForward(), columns, {}, &doc),
+            0);
+  ASSERT_EQ(doc.forward_column_values_size(), 0);
+
+  ColumnNameList more_columns{"name", "age", "blob", "score", "extra"};
+  ASSERT_NE(ForwardSerializer::FillForward(MakeForward(), more_columns,
+                                           positions, &doc),
+            0);
+
+  index::QueryResult broken = MakeForward();
+  broken.forward_data.resize(broken.forward_data.size() - 100);
+  ASSERT_NE(
+      ForwardSerializer::FillForward(broken, columns, positions, &doc), 0);
+}
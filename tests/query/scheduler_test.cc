@@ -19,7 +19,10 @@
  */
 
 #include "query/executor/scheduler.h"
+#include <sched.h>
+#include <algorithm>
 #include <gtest/gtest.h>
+#include "common/numa_topology.h"
 #include "task-inl.h"
 
 using namespace proxima::be::query;
@@ -45,3 +48,58 @@ TEST(SchedulerTest, TestScheduler) {
 
   ASSERT_TRUE(task->wait_finish());
 }
+
+class NodeTaskImpl : public BthreadTask {
+ public:
+  NodeTaskImpl(uint32_t node) : BthreadTask("node task"), node_(node) {}
+
+  int numa_node() const override {
+    return static_cast<int>(node_);
+  }
+
+  int cpu() const {
+    return cpu_;
+  }
+
+ private:
+  int do_run() override {
+    cpu_ = sched_getcpu();
+    return 0;
+  }
+
+ private:
+  uint32_t node_{0U};
+  int cpu_{-1};
+};
+
+TEST(SchedulerTest, TestNumaAwareScheduler) {
+  auto &topology = proxima::be::NumaTopology::Instance();
+  ASSERT_EQ(topology.init(2), 0);
+
+  SchedulerPtr scheduler = Scheduler::NumaAware();
+  ASSERT_EQ(scheduler->concurrency(), 0);
+  ASSERT_TRUE(scheduler->schedule(CreateTask(kName, kCode)) != 0);
+
+  // at least one queue for each node
+  ASSERT_EQ(scheduler->concurrency(1), 2);
+  ASSERT_EQ(scheduler->concurrency(4), 4);
+
+  for (uint32_t node = 0; node < 2; node++) {
+    for (int i = 0; i < 10; i++) {
+      auto task = std::make_shared<NodeTaskImpl>(node);
+      ASSERT_EQ(scheduler->schedule_on_node(task, task->numa_node()), 0);
+      ASSERT_TRUE(task->wait_finish());
+      ASSERT_EQ(task->exit_code(), 0);
+      auto &cpus = topology.cpus(node);
+      ASSERT_NE(std::find(cpus.begin(), cpus.end(), (uint32_t)task->cpu()),
+                cpus.end());
+    }
+  }
+
+  TaskPtr task = CreateTask(kName, kCode, kMillSeconds);
+  ASSERT_EQ(scheduler->schedule(task), 0);
+  ASSERT_TRUE(task->wait_finish());
+
+  scheduler.reset();
+  topology.cleanup();
+}
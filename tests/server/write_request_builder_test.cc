@@ -19,6 +19,7 @@
 #undef private
 #include <gtest/gtest.h>
 #include "common/error_code.h"
+#include "common/request_arena.h"
 
 using namespace ::proxima::be;
 using namespace ::proxima::be::server;
@@ -179,6 +180,32 @@ TEST_F(WriteRequestBuilderTest, TestCreateSuccessWithDirectWrite) {
   ASSERT_FLOAT_EQ(vector_data[3], 4.0);
 }
 
+TEST_F(WriteRequestBuilderTest, TestCreateSuccessWithArena) {
+  RequestArena arena;
+  auto *request = arena.create_message<proto::WriteRequest>();
+  meta::CollectionMetaPtr meta;
+  agent::ColumnOrderMapPtr order_map;
+  fill_collection_info(*request, &meta, &order_map, false);
+  auto column_order = order_map->get_column_order(request->collection_name());
+
+  agent::WriteRequest write_request;
+  int ret = WriteRequestBuilder::build(*meta, *column_order, *request,
+                                       &write_request, arena.arena());
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(arena.message_count(), 1U);
+  ASSERT_GT(arena.space_allocated(), 0U);
+  ASSERT_GE(arena.space_allocated(), arena.space_used());
+
+  ::proxima::be::proto::GenericValueList forward_list;
+  forward_list.add_values()->set_float_value(10.0);
+  forward_list.add_values()->set_int32_value(20);
+  std::string expected_forward_str;
+  forward_list.SerializeToString(&expected_forward_str);
+  auto &records = write_request.get_collection_dataset();
+  ASSERT_EQ(records.size(), (size_t)1);
+  ASSERT_EQ(records[0]->get(0).forward_data, expected_forward_str);
+}
+
 TEST_F(WriteRequestBuilderTest, TestCreateFailedWithDimensionMismatched) {
   proto::WriteRequest request;
   meta::CollectionMetaPtr meta;
@@ -378,9 +405,11 @@ TEST_F(WriteRequestBuilderTest, TestBuildForwardsDataWithFull) {
   auto *row = request.mutable_rows(0);
   auto &row_meta = request.row_meta();
   index::CollectionDataset::RowData row_data;
+  proto::GenericValueList value_list;
   bool forward_full_match = true;
   int ret = WriteRequestBuilder::build_forwards_data(
-      *row, row_meta, *column_order, *meta, forward_full_match, &row_data);
+      *row, row_meta, *column_order, *meta, forward_full_match, &value_list,
+      &row_data);
   ASSERT_EQ(ret, 0);
 }
 
@@ -394,10 +423,20 @@ TEST_F(WriteRequestBuilderTest, TestBuildForwardsDataWithNotFull) {
   auto *row = request.mutable_rows(0);
   auto &row_meta = request.row_meta();
   index::CollectionDataset::RowData row_data;
+  proto::GenericValueList value_list;
   bool forward_full_match = false;
   int ret = WriteRequestBuilder::build_forwards_data(
-      *row, row_meta, *column_order, *meta, forward_full_match, &row_data);
+      *row, row_meta, *column_order, *meta, forward_full_match, &value_list,
+      &row_data);
+  ASSERT_EQ(ret, 0);
+
+  // Scratch value list is reused by following rows
+  index::CollectionDataset::RowData next_row_data;
+  ret = WriteRequestBuilder::build_forwards_data(
+      *row, row_meta, *column_order, *meta, forward_full_match, &value_list,
+      &next_row_data);
   ASSERT_EQ(ret, 0);
+  ASSERT_EQ(next_row_data.forward_data, row_data.forward_data);
 }
 
 TEST_F(WriteRequestBuilderTest, TestBuildForwardsDataWithInvalidForwardColumn) {
@@ -411,9 +450,11 @@ TEST_F(WriteRequestBuilderTest, TestBuildForwardsDataWithInvalidForwardColumn) {
   auto *row_meta = request.mutable_row_meta();
   row_meta->set_forward_column_names(0, "invalid");
   index::CollectionDataset::RowData row_data;
+  proto::GenericValueList value_list;
   bool forward_full_match = false;
   int ret = WriteRequestBuilder::build_forwards_data(
-      *row, *row_meta, *column_order, *meta, forward_full_match, &row_data);
+      *row, *row_meta, *column_order, *meta, forward_full_match, &value_list,
+      &row_data);
   ASSERT_EQ(ret, ErrorCode_InvalidWriteRequest);
 }
 
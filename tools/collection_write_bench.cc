@@ -0,0 +1,206 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Benchmark of proxy write throughput with batched requests
+ */
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <ailego/hash/jump_hash.h>
+#include <ailego/parallel/thread_queue.h>
+#include <gflags/gflags.h>
+#include "common/logger.h"
+#include "common/version.h"
+#include "index/collection.h"
+#include "index/file_helper.h"
+#include "meta/meta.h"
+
+using namespace proxima::be;
+
+DEFINE_string(output, "./collection_write_bench",
+              "Sepecify output index directory");
+DEFINE_uint32(count, 100000, "Document count of each round");
+DEFINE_uint32(threads, 8, "Threads count of write queue");
+DEFINE_uint32(dimension, 16, "Dimension of vectors");
+
+static inline void PrintUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << " collection_write_bench <args>" << std::endl << std::endl;
+  std::cout << "Args: " << std::endl;
+  std::cout << " --output           Sepecify output index directory"
+            << "(default ./collection_write_bench)" << std::endl;
+  std::cout << " --count            Document count of each round"
+            << "(default 100000)" << std::endl;
+  std::cout << " --threads          Threads count of write queue"
+            << "(default 8)" << std::endl;
+  std::cout << " --dimension        Dimension of vectors"
+            << "(default 16)" << std::endl;
+  std::cout << " --help, -h         Dipslay help info" << std::endl;
+  std::cout << " --version, -v      Dipslay version info" << std::endl;
+  std::cout << std::endl
+            << "Requests carry 1, 10 and 1000 rows in each round, rows are "
+            << "written one task per row as before, and one task per "
+            << "sub batch as proxy write does now" << std::endl;
+}
+
+static meta::CollectionMetaPtr MakeSchema() {
+  auto schema = std::make_shared<meta::CollectionMeta>();
+  auto column_meta = std::make_shared<meta::ColumnMeta>();
+  column_meta->set_name("face");
+  column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  column_meta->set_data_type(DataTypes::VECTOR_FP32);
+  column_meta->set_dimension(FLAGS_dimension);
+  column_meta->mutable_parameters()->set("metric_type", "SquaredEuclidean");
+  schema->append(column_meta);
+  schema->set_name("write_bench");
+  schema->set_max_docs_per_segment(0);
+  return schema;
+}
+
+static void AddRow(uint64_t key, index::CollectionDataset *dataset) {
+  auto *row = dataset->add_row_data();
+  row->primary_key = key;
+  row->operation_type = OperationTypes::INSERT;
+  row->lsn = key;
+  row->lsn_context = "bench";
+  row->forward_data = "hello";
+
+  index::ColumnData column;
+  column.column_name = "face";
+  column.data_type = DataTypes::VECTOR_FP32;
+  column.dimension = FLAGS_dimension;
+  std::vector<float> fvec(FLAGS_dimension, (float)(key % 1000));
+  column.data.assign((char *)fvec.data(), fvec.size() * sizeof(float));
+  row->column_datas.emplace_back(std::move(column));
+}
+
+//! Write rows of a task, as IndexAgent::write_dataset does
+static void WriteRows(index::Collection *collection,
+                      index::CollectionDatasetPtr rows,
+                      std::atomic<uint64_t> *written_count,
+                      std::atomic<uint64_t> *failed_count) {
+  if (collection->write_records(*rows) != 0) {
+    *failed_count += rows->size();
+  }
+  *written_count += rows->size();
+}
+
+//! Write count rows in requests of batch_size rows, return cost in ms
+static bool RunWrites(uint32_t batch_size, bool batched, uint64_t *cost) {
+  std::string path = FLAGS_output + "/" + std::to_string(batch_size) +
+                     (batched ? "_batched/" : "_per_row/");
+  index::FileHelper::CreateDirectory(path);
+
+  index::ThreadPool thread_pool(2, false);
+  index::CollectionPtr collection;
+  index::ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = index::Collection::CreateAndOpen(
+      "write_bench", path, MakeSchema(), FLAGS_threads, &thread_pool,
+      read_options, &collection);
+  if (ret != 0) {
+    LOG_ERROR("Open collection failed.");
+    return false;
+  }
+
+  std::atomic<uint64_t> written_count{0U};
+  std::atomic<uint64_t> failed_count{0U};
+
+  ailego::ElapsedTime timer;
+  {
+    ailego::ThreadQueue queue(FLAGS_threads);
+    int32_t shard_count = static_cast<int32_t>(queue.count());
+    for (uint32_t begin = 0; begin < FLAGS_count; begin += batch_size) {
+      uint32_t end = std::min(begin + batch_size, FLAGS_count);
+      if (!batched) {
+        for (uint32_t key = begin; key < end; key++) {
+          auto dataset = std::make_shared<index::CollectionDataset>(0);
+          AddRow(key, dataset.get());
+          queue.execute(key, WriteRows, collection.get(), dataset,
+                        &written_count, &failed_count);
+        }
+        continue;
+      }
+
+      std::vector<index::CollectionDatasetPtr> shards(shard_count);
+      for (uint32_t key = begin; key < end; key++) {
+        int32_t shard = ailego::JumpHash(key, shard_count);
+        if (!shards[shard]) {
+          shards[shard] = std::make_shared<index::CollectionDataset>(0);
+        }
+        AddRow(key, shards[shard].get());
+      }
+      for (auto &shard : shards) {
+        if (shard) {
+          queue.execute(shard->get(0).primary_key, WriteRows,
+                        collection.get(), shard, &written_count,
+                        &failed_count);
+        }
+      }
+    }
+
+    // Pending tasks are dropped at stop, wait for all written
+    while (written_count < FLAGS_count) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    queue.stop();
+  }
+  *cost = timer.milli_seconds();
+
+  collection->close_and_cleanup();
+  return failed_count == 0U;
+}
+
+int main(int argc, char **argv) {
+  // Parse arguments
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (!strcmp(arg, "-help") || !strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+      PrintUsage();
+      exit(0);
+    } else if (!strcmp(arg, "-version") || !strcmp(arg, "--version") ||
+               !strcmp(arg, "-v")) {
+      std::cout << proxima::be::Version::Details() << std::endl;
+      exit(0);
+    }
+  }
+  gflags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+
+  // Adjust log level to prevent print too many logs
+  aitheta2::IndexLoggerBroker::SetLevel(aitheta2::IndexLogger::LEVEL_WARN);
+
+  index::FileHelper::RemoveDirectory(FLAGS_output);
+  index::FileHelper::CreateDirectory(FLAGS_output);
+
+  for (uint32_t batch_size : {1U, 10U, 1000U}) {
+    uint64_t per_row_cost = 0U;
+    uint64_t batched_cost = 0U;
+    if (!RunWrites(batch_size, false, &per_row_cost) ||
+        !RunWrites(batch_size, true, &batched_cost)) {
+      LOG_ERROR("Run writes failed. batch_size[%u]", batch_size);
+      exit(1);
+    }
+    std::cout << "batch_size[" << batch_size << "] per_row_qps["
+              << FLAGS_count * 1000UL / std::max<uint64_t>(per_row_cost, 1U)
+              << "] batched_qps["
+              << FLAGS_count * 1000UL / std::max<uint64_t>(batched_cost, 1U)
+              << "]" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,303 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Benchmark of segment search backed by 4K pages and
+ *             transparent huge pages
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <gflags/gflags.h>
+#include "common/logger.h"
+#include "common/version.h"
+#include "index/collection.h"
+#include "index/file_helper.h"
+#include "index/typedef.h"
+#include "meta/meta.h"
+
+using namespace proxima::be;
+
+DEFINE_string(output, "./huge_page_bench", "Sepecify output index directory");
+DEFINE_uint32(count, 200000, "Document count of the benchmark segment");
+DEFINE_uint32(dimension, 128, "Dimension of random vectors");
+DEFINE_uint32(query_count, 2000, "Query count of each round");
+DEFINE_uint32(topk, 10, "Topk of each query");
+DEFINE_uint32(concurrency, 10, "Threads count for building index");
+
+struct BenchResult {
+  size_t anon_huge_kb{0U};
+  size_t file_huge_kb{0U};
+  double avg_latency_us{0.0};
+  uint64_t p99_latency_us{0U};
+};
+
+static inline void PrintUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << " huge_page_bench <args>" << std::endl << std::endl;
+  std::cout << "Args: " << std::endl;
+  std::cout << " --output           Sepecify output index directory"
+            << "(default ./huge_page_bench)" << std::endl;
+  std::cout << " --count            Document count of segment(default 200000)"
+            << std::endl;
+  std::cout << " --dimension        Dimension of vectors(default 128)"
+            << std::endl;
+  std::cout << " --query_count      Query count of each round(default 2000)"
+            << std::endl;
+  std::cout << " --topk             Topk of each query(default 10)"
+            << std::endl;
+  std::cout << " --concurrency      Threads count for building(default 10)"
+            << std::endl;
+  std::cout << " --help, -h         Dipslay help info" << std::endl;
+  std::cout << " --version, -v      Dipslay version info" << std::endl;
+  std::cout << std::endl
+            << "Transparent huge pages should be enabled as madvise or always, "
+            << "run under perf to see dTLB difference, e.g. "
+            << "perf stat -e dTLB-load-misses huge_page_bench" << std::endl;
+}
+
+static meta::CollectionMetaPtr MakeSchema(const std::string &name) {
+  auto column_meta = std::make_shared<meta::ColumnMeta>();
+  column_meta->set_name("vector");
+  column_meta->set_index_type(IndexTypes::PROXIMA_GRAPH_INDEX);
+  column_meta->set_data_type(DataTypes::VECTOR_FP32);
+  column_meta->set_dimension(FLAGS_dimension);
+  column_meta->mutable_parameters()->set("engine", "HNSW");
+
+  auto schema = std::make_shared<meta::CollectionMeta>();
+  schema->set_name(name);
+  schema->set_max_docs_per_segment(0);
+  schema->append(column_meta);
+  return schema;
+}
+
+static std::string RandomVector(std::mt19937 *gen) {
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> vec(FLAGS_dimension);
+  for (auto &v : vec) {
+    v = dist(*gen);
+  }
+  return std::string((const char *)vec.data(), vec.size() * sizeof(float));
+}
+
+//! Sum a field of smaps rollup in kB
+static size_t HugePageSize(const std::string &field) {
+  std::ifstream file("/proc/self/smaps_rollup");
+  std::string line;
+  size_t total = 0U;
+  while (std::getline(file, line)) {
+    if (line.compare(0, field.size(), field) == 0) {
+      total += std::strtoull(line.c_str() + field.size(), nullptr, 10);
+    }
+  }
+  return total;
+}
+
+static bool BuildCollection(const meta::CollectionMetaPtr &schema,
+                            bool huge_page, bool dump,
+                            index::ThreadPool *thread_pool,
+                            index::CollectionPtr *opened_collection) {
+  index::CollectionPtr collection;
+  index::ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.huge_page = huge_page;
+  read_options.create_new = true;
+  int ret = index::Collection::CreateAndOpen(
+      schema->name(), FLAGS_output, schema, FLAGS_concurrency, thread_pool,
+      read_options, &collection);
+  if (ret != 0) {
+    LOG_ERROR("Create collection failed. name[%s]", schema->name().c_str());
+    return false;
+  }
+
+  // Same seed makes all collections hold identical data
+  std::mt19937 gen(1000);
+  for (uint32_t i = 0; i < FLAGS_count; i++) {
+    index::CollectionDataset records(0);
+    auto *row = records.add_row_data();
+    row->operation_type = OperationTypes::INSERT;
+    row->primary_key = i;
+    row->lsn = i;
+
+    index::ColumnData column_data;
+    column_data.column_name = "vector";
+    column_data.data_type = DataTypes::VECTOR_FP32;
+    column_data.dimension = FLAGS_dimension;
+    column_data.data = RandomVector(&gen);
+    row->column_datas.emplace_back(column_data);
+    collection->write_records(records);
+  }
+
+  if (!dump) {
+    *opened_collection = collection;
+    return true;
+  }
+
+  ailego::ElapsedTime timer;
+  ret = collection->dump();
+  if (ret == 0) {
+    // close waits until dumping finished
+    ret = collection->close();
+  }
+  std::cout << "Dump segment complete. collection[" << schema->name()
+            << "] cost[" << timer.milli_seconds() << "ms]" << std::endl;
+  return ret == 0;
+}
+
+static bool RunQueries(const index::CollectionPtr &collection,
+                       BenchResult *result) {
+  std::vector<index::SegmentPtr> segments;
+  collection->get_segments(&segments);
+
+  index::QueryParams query_params;
+  query_params.topk = FLAGS_topk;
+  query_params.data_type = DataTypes::VECTOR_FP32;
+  query_params.dimension = FLAGS_dimension;
+
+  std::mt19937 gen(2000);
+  std::vector<uint64_t> latencies;
+  latencies.reserve(FLAGS_query_count);
+  for (uint32_t i = 0; i < FLAGS_query_count; i++) {
+    std::string query = RandomVector(&gen);
+    ailego::ElapsedTime timer;
+    for (auto &segment : segments) {
+      index::QueryResultList results;
+      segment->knn_search("vector", query, query_params, &results);
+    }
+    latencies.emplace_back(timer.micro_seconds());
+  }
+  if (latencies.empty()) {
+    return false;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t total_latency = 0U;
+  for (auto latency : latencies) {
+    total_latency += latency;
+  }
+  result->anon_huge_kb = HugePageSize("AnonHugePages:");
+  result->file_huge_kb = HugePageSize("FilePmdMapped:");
+  result->avg_latency_us = (double)total_latency / latencies.size();
+  result->p99_latency_us = latencies[latencies.size() * 99 / 100];
+  return true;
+}
+
+static bool RunPersistQueries(const meta::CollectionMetaPtr &schema,
+                              bool huge_page, LoadModes load_mode,
+                              index::ThreadPool *thread_pool,
+                              BenchResult *result) {
+  index::CollectionPtr collection;
+  index::ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.huge_page = huge_page;
+  read_options.load_mode = load_mode;
+  read_options.create_new = false;
+  int ret = index::Collection::CreateAndOpen(
+      schema->name(), FLAGS_output, schema, FLAGS_concurrency, thread_pool,
+      read_options, &collection);
+  if (ret != 0) {
+    LOG_ERROR("Open collection failed. name[%s]", schema->name().c_str());
+    return false;
+  }
+
+  bool succ = RunQueries(collection, result);
+  collection->close();
+  return succ;
+}
+
+static void PrintResult(const std::string &name, const BenchResult &result) {
+  std::cout << name << ": anon_huge_pages[" << result.anon_huge_kb
+            << "kB] file_huge_pages[" << result.file_huge_kb
+            << "kB] avg_latency[" << result.avg_latency_us
+            << "us] p99_latency[" << result.p99_latency_us << "us]"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Parse arguments
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (!strcmp(arg, "-help") || !strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+      PrintUsage();
+      exit(0);
+    } else if (!strcmp(arg, "-version") || !strcmp(arg, "--version") ||
+               !strcmp(arg, "-v")) {
+      std::cout << proxima::be::Version::Details() << std::endl;
+      exit(0);
+    }
+  }
+  gflags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+
+  // Adjust log level to prevent print too many logs
+  aitheta2::IndexLoggerBroker::SetLevel(aitheta2::IndexLogger::LEVEL_WARN);
+
+  index::FileHelper::RemoveDirectory(FLAGS_output);
+  index::FileHelper::CreateDirectory(FLAGS_output);
+  index::ThreadPool thread_pool(FLAGS_concurrency, false);
+
+  // Memory segments, streamer chunks with and without huge page advice
+  std::vector<std::pair<std::string, BenchResult>> results;
+  for (bool huge_page : {false, true}) {
+    std::string name = huge_page ? "memory_thp" : "memory_4k";
+    index::CollectionPtr collection;
+    BenchResult result;
+    if (!BuildCollection(MakeSchema(name), huge_page, false, &thread_pool,
+                         &collection) ||
+        !RunQueries(collection, &result)) {
+      LOG_ERROR("Run memory segment queries failed.");
+      exit(1);
+    }
+    collection->close();
+    results.emplace_back(name, result);
+  }
+
+  // Persist segments, 4K layout and huge page aligned layout
+  auto origin_schema = MakeSchema("origin");
+  auto aligned_schema = MakeSchema("aligned");
+  if (!BuildCollection(origin_schema, false, true, &thread_pool, nullptr) ||
+      !BuildCollection(aligned_schema, true, true, &thread_pool, nullptr)) {
+    LOG_ERROR("Build segments failed.");
+    exit(1);
+  }
+
+  struct PersistMode {
+    std::string name;
+    bool huge_page;
+    LoadModes load_mode;
+  };
+  std::vector<PersistMode> modes = {
+      {"mmap_4k", false, LoadModes::MMAP},
+      {"mmap_thp", true, LoadModes::MMAP},
+      {"heap_4k", false, LoadModes::HEAP},
+      {"heap_thp", true, LoadModes::HEAP}};
+  for (auto &mode : modes) {
+    BenchResult result;
+    if (!RunPersistQueries(mode.huge_page ? aligned_schema : origin_schema,
+                           mode.huge_page, mode.load_mode, &thread_pool,
+                           &result)) {
+      LOG_ERROR("Run persist segment queries failed.");
+      exit(1);
+    }
+    results.emplace_back(mode.name, result);
+  }
+
+  for (auto &it : results) {
+    PrintResult(it.first, it.second);
+  }
+  return 0;
+}
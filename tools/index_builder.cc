@@ -20,12 +20,14 @@
  */
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <gflags/gflags.h>
 #include "common/logger.h"
 #include "common/protobuf_helper.h"
 #include "common/types.h"
 #include "common/version.h"
+#include "index/bulk_builder.h"
 #include "index/collection.h"
 #include "index/typedef.h"
 #include "meta/meta.h"
@@ -38,6 +40,8 @@ DEFINE_string(schema, "", "Specify the schema of collection");
 DEFINE_string(file, "", "Specify input data file");
 DEFINE_string(output, "./", "Sepecify output index directory");
 DEFINE_uint32(concurrency, 10, "Threads count for building index");
+DEFINE_bool(bulk, false, "Build segments offline without write path");
+DEFINE_uint64(shard_size, 0, "Max docs of each segment in bulk mode");
 
 static bool ValidateNotEmpty(const char *flagname, const std::string &value) {
   return !value.empty();
@@ -53,6 +57,8 @@ struct Record {
   uint32_t dimension;
 };
 
+using RecordHandler = std::function<void(const Record &)>;
+
 meta::CollectionMetaPtr g_collection_meta;
 
 static inline void PrintUsage() {
@@ -67,6 +73,12 @@ static inline void PrintUsage() {
   std::cout << " --concurrency      Sepecify threads count for building "
                "index(default 10)"
             << std::endl;
+  std::cout << " --bulk             Build segments offline in bulk "
+               "mode(default false)"
+            << std::endl;
+  std::cout << " --shard_size       Max docs of each segment in bulk "
+               "mode(default 0, use schema)"
+            << std::endl;
   std::cout << " --help, -h         Dipslay help info" << std::endl;
   std::cout << " --version, -v      Dipslay version info" << std::endl;
 }
@@ -154,10 +166,7 @@ static bool ParseSchema() {
   return true;
 }
 
-static void DoInsertCollection(index::Collection *collection,
-                               const Record &record) {
-  index::CollectionDataset records(0);
-  auto *row = records.add_row_data();
+static void FillRowData(const Record &record, index::Record *row) {
   row->operation_type = OperationTypes::INSERT;
   row->primary_key = record.key;
 
@@ -177,12 +186,16 @@ static void DoInsertCollection(index::Collection *collection,
   index_column.dimension = record.dimension;
   index_column.data = record.vector;
   row->column_datas.emplace_back(index_column);
+}
 
+static void DoInsertCollection(index::Collection *collection,
+                               const Record &record) {
+  index::CollectionDataset records(0);
+  FillRowData(record, records.add_row_data());
   collection->write_records(records);
 }
 
-static bool LoadFromVecsFile(aitheta2::IndexThreads::TaskGroup *group,
-                             index::Collection *collection) {
+static bool LoadFromVecsFile(const RecordHandler &handler) {
   tools::VecsReader reader;
   if (!reader.load(FLAGS_file)) {
     LOG_ERROR("Load vecs file failed.");
@@ -197,13 +210,12 @@ static bool LoadFromVecsFile(aitheta2::IndexThreads::TaskGroup *group,
     record.key = key;
     record.vector.append(feature, reader.index_meta().element_size());
     record.dimension = reader.index_meta().dimension();
-    group->submit(ailego::Closure::New(DoInsertCollection, collection, record));
+    handler(record);
   }
   return true;
 }
 
-static bool LoadFromTextFile(aitheta2::IndexThreads::TaskGroup *group,
-                             index::Collection *collection) {
+static bool LoadFromTextFile(const RecordHandler &handler) {
   std::ifstream file_stream(FLAGS_file);
   if (!file_stream.is_open()) {
     LOG_ERROR("Can't open input file[%s]", FLAGS_file.c_str());
@@ -284,13 +296,64 @@ static bool LoadFromTextFile(aitheta2::IndexThreads::TaskGroup *group,
       record.attributes = res[2];
     }
 
-    group->submit(ailego::Closure::New(DoInsertCollection, collection, record));
+    handler(record);
   }
   file_stream.close();
 
   return true;
 }
 
+static bool LoadRecords(const RecordHandler &handler) {
+  if (FLAGS_file.find(".vecs") != std::string::npos) {
+    return LoadFromVecsFile(handler);
+  }
+  return LoadFromTextFile(handler);
+}
+
+static bool BulkBuildIndex() {
+  index::ThreadPool thread_pool(FLAGS_concurrency, false);
+  if (FLAGS_shard_size > 0) {
+    g_collection_meta->set_max_docs_per_segment(FLAGS_shard_size);
+  }
+
+  auto builder = index::BulkBuilder::Create(
+      g_collection_meta->name(), FLAGS_output, g_collection_meta,
+      FLAGS_concurrency, &thread_pool);
+  int ret = builder->open();
+  if (ret != 0) {
+    return false;
+  }
+
+  // Records are added sequentially, builder parallelizes index building
+  bool success = true;
+  auto handler = [&builder, &success](const Record &record) {
+    index::Record row;
+    FillRowData(record, &row);
+    if (success && builder->add(std::move(row)) != 0) {
+      success = false;
+    }
+  };
+  if (!LoadRecords(handler)) {
+    success = false;
+  }
+
+  ret = builder->finish();
+  if (!success || ret != 0) {
+    return false;
+  }
+
+  auto &stats = builder->stats();
+  std::cout << "Bulk build index complete. collection["
+            << g_collection_meta->name() << "] doc_count[" << stats.doc_count
+            << "] segment_count[" << stats.segment_count << "] forward_cost["
+            << stats.forward_cost_us / 1000 << "ms] index_cost["
+            << stats.index_cost_us / 1000 << "ms] dump_cost["
+            << stats.dump_cost_us / 1000 << "ms] total_cost["
+            << stats.total_cost_us / 1000 << "ms] docs_per_second["
+            << stats.docs_per_second() << "]" << std::endl;
+  return true;
+}
+
 static bool BuildIndex() {
   index::ThreadPool thread_pool(FLAGS_concurrency, false);
 
@@ -311,14 +374,12 @@ static bool BuildIndex() {
   // Writing into collection in parallel
   auto group = thread_pool.make_group();
 
-  if (FLAGS_file.find(".vecs") != std::string::npos) {
-    if (!LoadFromVecsFile(group.get(), new_collection.get())) {
-      return false;
-    }
-  } else {
-    if (!LoadFromTextFile(group.get(), new_collection.get())) {
-      return false;
-    }
+  auto handler = [&group, &new_collection](const Record &record) {
+    group->submit(ailego::Closure::New(DoInsertCollection,
+                                       new_collection.get(), record));
+  };
+  if (!LoadRecords(handler)) {
+    return false;
   }
 
   group->wait_finish();
@@ -366,7 +427,8 @@ int main(int argc, char **argv) {
   }
 
   // Start to build index
-  if (!BuildIndex()) {
+  bool success = FLAGS_bulk ? BulkBuildIndex() : BuildIndex();
+  if (!success) {
     LOG_ERROR("Build index error.");
     exit(1);
   }
@@ -0,0 +1,152 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Benchmark of lsn store appending and latest lsn lookup
+ */
+
+#include <iostream>
+#include <gflags/gflags.h>
+#include "common/logger.h"
+#include "common/version.h"
+#include "index/file_helper.h"
+#include "index/lsn_store.h"
+
+using namespace proxima::be;
+
+DEFINE_string(output, "./lsn_store_bench", "Sepecify output index directory");
+DEFINE_uint32(count, 1000000, "Lsn count to append");
+DEFINE_uint32(batch, 100, "Lsn count of a batch append");
+DEFINE_uint32(lookups, 1000, "Lookup count of latest lsn");
+
+static inline void PrintUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << " lsn_store_bench <args>" << std::endl << std::endl;
+  std::cout << "Args: " << std::endl;
+  std::cout << " --output           Sepecify output index directory"
+            << "(default ./lsn_store_bench)" << std::endl;
+  std::cout << " --count            Lsn count to append"
+            << "(default 1000000)" << std::endl;
+  std::cout << " --batch            Lsn count of a batch append"
+            << "(default 100)" << std::endl;
+  std::cout << " --lookups          Lookup count of latest lsn"
+            << "(default 1000)" << std::endl;
+  std::cout << " --help, -h         Dipslay help info" << std::endl;
+  std::cout << " --version, -v      Dipslay version info" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Parse arguments
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (!strcmp(arg, "-help") || !strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+      PrintUsage();
+      exit(0);
+    } else if (!strcmp(arg, "-version") || !strcmp(arg, "--version") ||
+               !strcmp(arg, "-v")) {
+      std::cout << proxima::be::Version::Details() << std::endl;
+      exit(0);
+    }
+  }
+  gflags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+
+  index::FileHelper::RemoveDirectory(FLAGS_output);
+  index::FileHelper::CreateDirectory(FLAGS_output);
+
+  index::LsnStorePtr lsn_store;
+  index::ReadOptions read_options;
+  read_options.use_mmap = true;
+  read_options.create_new = true;
+  int ret = index::LsnStore::CreateAndOpen("lsn_bench", FLAGS_output,
+                                           read_options, &lsn_store);
+  if (ret != 0) {
+    LOG_ERROR("Open lsn store failed.");
+    exit(1);
+  }
+
+  // Contexts look like binlog positions
+  std::vector<std::string> contexts(FLAGS_batch);
+  std::vector<const std::string *> lsn_contexts(FLAGS_batch);
+  std::vector<uint64_t> lsns(FLAGS_batch);
+  for (uint32_t i = 0; i < FLAGS_batch; i++) {
+    lsn_contexts[i] = &contexts[i];
+  }
+
+  // 1. single appends
+  uint32_t half = FLAGS_count / 2;
+  ailego::ElapsedTime timer;
+  for (uint32_t i = 0; i < half; i++) {
+    ret = lsn_store->append(i, "mysql-bin.000001:" + std::to_string(i));
+    if (ret != 0) {
+      LOG_ERROR("Append lsn failed. lsn[%u]", i);
+      exit(1);
+    }
+  }
+  uint64_t single_ns = timer.micro_seconds() * 1000UL;
+
+  // 2. batch appends
+  timer.reset();
+  for (uint32_t begin = half; begin < FLAGS_count; begin += FLAGS_batch) {
+    size_t size = std::min(FLAGS_batch, FLAGS_count - begin);
+    lsns.resize(size);
+    lsn_contexts.resize(size);
+    for (size_t i = 0; i < size; i++) {
+      lsns[i] = begin + i;
+      contexts[i] = "mysql-bin.000001:" + std::to_string(begin + i);
+    }
+    ret = lsn_store->append(lsns, lsn_contexts);
+    if (ret != 0) {
+      LOG_ERROR("Append lsns failed. lsn[%u]", begin);
+      exit(1);
+    }
+  }
+  uint64_t batch_ns = timer.micro_seconds() * 1000UL;
+
+  // 3. latest lsn tracked in memory, and scanned from data blocks
+  uint64_t lsn = 0U;
+  std::string lsn_context;
+  timer.reset();
+  for (uint32_t i = 0; i < FLAGS_lookups; i++) {
+    lsn_store->get_latest_lsn(&lsn, &lsn_context);
+  }
+  uint64_t lookup_ns = timer.micro_seconds() * 1000UL;
+
+  uint64_t scanned_lsn = 0U;
+  std::string scanned_context;
+  timer.reset();
+  for (uint32_t i = 0; i < FLAGS_lookups; i++) {
+    lsn_store->scan_latest_lsn(&scanned_lsn, &scanned_context);
+  }
+  uint64_t scan_ns = timer.micro_seconds() * 1000UL;
+
+  if (lsn != scanned_lsn || lsn_context != scanned_context) {
+    LOG_ERROR("Latest lsn mismatch. lsn[%zu] scanned_lsn[%zu]", (size_t)lsn,
+              (size_t)scanned_lsn);
+    exit(1);
+  }
+
+  uint32_t batch_count = FLAGS_count - half;
+  std::cout << "append_ns[" << single_ns / std::max(half, 1U)
+            << "] batch_append_ns[" << batch_ns / std::max(batch_count, 1U)
+            << "] latest_lsn_ns[" << lookup_ns / std::max(FLAGS_lookups, 1U)
+            << "] scan_latest_lsn_ns["
+            << scan_ns / std::max(FLAGS_lookups, 1U) << "] latest_lsn["
+            << lsn << "]" << std::endl;
+
+  lsn_store->close();
+  index::FileHelper::RemoveDirectory(FLAGS_output);
+  return 0;
+}
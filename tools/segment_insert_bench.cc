@@ -0,0 +1,183 @@
+/**
+ *   Copyright 2021 Alibaba, Inc. and its affiliates. All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+
+ *   \author   Haichao.chc
+ *   \date     Oct 2021
+ *   \brief    Benchmark of concurrent inserts into a memory segment
+ */
+
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <gflags/gflags.h>
+#include "common/logger.h"
+#include "common/version.h"
+#include "index/file_helper.h"
+#include "index/segment/memory_segment.h"
+#include "meta/meta.h"
+
+using namespace proxima::be;
+
+DEFINE_string(output, "./segment_insert_bench",
+              "Sepecify output index directory");
+DEFINE_uint32(count, 1000000, "Document count of each round");
+DEFINE_uint32(max_threads, 16, "Max threads count of inserting");
+
+static inline void PrintUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << " segment_insert_bench <args>" << std::endl << std::endl;
+  std::cout << "Args: " << std::endl;
+  std::cout << " --output           Sepecify output index directory"
+            << "(default ./segment_insert_bench)" << std::endl;
+  std::cout << " --count            Document count of each round"
+            << "(default 1000000)" << std::endl;
+  std::cout << " --max_threads      Max threads count of inserting"
+            << "(default 16)" << std::endl;
+  std::cout << " --help, -h         Dipslay help info" << std::endl;
+  std::cout << " --version, -v      Dipslay version info" << std::endl;
+  std::cout << std::endl
+            << "Threads count doubles from 1 to max_threads in each round, "
+            << "forwards are inserted only so that segment stats stay on "
+            << "the hot path" << std::endl;
+}
+
+//! Run func in threads, each handles a slice of count, return cost in ms
+template <typename Func>
+static uint64_t RunThreads(uint32_t thread_count, Func func) {
+  ailego::ElapsedTime timer;
+  std::vector<std::thread> threads;
+  uint32_t slice = FLAGS_count / thread_count;
+  for (uint32_t t = 0; t < thread_count; t++) {
+    threads.emplace_back(func, t * slice, (t + 1) * slice);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return timer.milli_seconds();
+}
+
+static bool RunSegmentInserts(const meta::CollectionMetaPtr &schema,
+                              uint32_t thread_count, uint64_t *cost) {
+  std::string path = FLAGS_output + "/" + std::to_string(thread_count) + "/";
+  index::FileHelper::CreateDirectory(path);
+
+  index::ReadOptions read_options;
+  read_options.use_mmap = false;
+  read_options.create_new = true;
+  index::DeleteStore delete_store(schema->name(), path);
+  index::IDMap id_map(schema->name(), path);
+  if (delete_store.open(read_options) != 0 || id_map.open(read_options) != 0) {
+    LOG_ERROR("Open delete store or id map failed.");
+    return false;
+  }
+
+  index::MemorySegmentPtr segment;
+  int ret = index::MemorySegment::CreateAndOpen(
+      schema->name(), path, index::SegmentMeta(), schema, &delete_store,
+      &id_map, thread_count, read_options, &segment);
+  if (ret != 0) {
+    LOG_ERROR("Open memory segment failed.");
+    return false;
+  }
+
+  *cost = RunThreads(thread_count, [&segment](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      index::Record record;
+      record.primary_key = i;
+      record.lsn = i;
+      record.forward_data = "hello";
+      index::idx_t doc_id;
+      segment->insert_forward(record, &doc_id);
+    }
+  });
+
+  bool succ = segment->segment_meta().doc_count ==
+              (FLAGS_count / thread_count) * thread_count;
+  segment->close_and_remove_files();
+  return succ;
+}
+
+//! Cost of stats updates alone, lock free against a mutex guarded meta
+static void RunStatsUpdates(uint32_t thread_count, uint64_t *atomic_cost,
+                            uint64_t *mutex_cost) {
+  index::MemorySegmentStats stats;
+  *atomic_cost = RunThreads(thread_count, [&stats](uint32_t begin,
+                                                   uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      stats.doc_count.fetch_add(1U, std::memory_order_relaxed);
+      index::MemorySegmentStats::UpdateMax(&stats.max_doc_id, i);
+      index::MemorySegmentStats::UpdateMin(&stats.min_primary_key, i);
+      index::MemorySegmentStats::UpdateMax(&stats.max_primary_key, i);
+      index::MemorySegmentStats::UpdateMin(&stats.min_lsn, i);
+      index::MemorySegmentStats::UpdateMax(&stats.max_lsn, i);
+    }
+  });
+
+  std::mutex mutex;
+  index::SegmentMeta meta;
+  *mutex_cost = RunThreads(thread_count, [&mutex, &meta](uint32_t begin,
+                                                         uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      std::lock_guard<std::mutex> lock(mutex);
+      meta.doc_count++;
+      meta.max_doc_id = std::max<uint64_t>(meta.max_doc_id, i);
+      meta.min_primary_key = std::min<uint64_t>(meta.min_primary_key, i);
+      meta.max_primary_key = std::max<uint64_t>(meta.max_primary_key, i);
+      meta.min_lsn = std::min<uint64_t>(meta.min_lsn, i);
+      meta.max_lsn = std::max<uint64_t>(meta.max_lsn, i);
+    }
+  });
+}
+
+int main(int argc, char **argv) {
+  // Parse arguments
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (!strcmp(arg, "-help") || !strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+      PrintUsage();
+      exit(0);
+    } else if (!strcmp(arg, "-version") || !strcmp(arg, "--version") ||
+               !strcmp(arg, "-v")) {
+      std::cout << proxima::be::Version::Details() << std::endl;
+      exit(0);
+    }
+  }
+  gflags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+
+  // Adjust log level to prevent print too many logs
+  aitheta2::IndexLoggerBroker::SetLevel(aitheta2::IndexLogger::LEVEL_WARN);
+
+  index::FileHelper::RemoveDirectory(FLAGS_output);
+  index::FileHelper::CreateDirectory(FLAGS_output);
+
+  auto schema = std::make_shared<meta::CollectionMeta>();
+  schema->set_name("insert_bench");
+  for (uint32_t threads = 1U; threads <= FLAGS_max_threads; threads *= 2U) {
+    uint64_t insert_cost = 0U;
+    if (!RunSegmentInserts(schema, threads, &insert_cost)) {
+      LOG_ERROR("Run segment inserts failed. threads[%u]", threads);
+      exit(1);
+    }
+
+    uint64_t atomic_cost = 0U;
+    uint64_t mutex_cost = 0U;
+    RunStatsUpdates(threads, &atomic_cost, &mutex_cost);
+    std::cout << "threads[" << threads << "] insert_qps["
+              << FLAGS_count * 1000UL / std::max<uint64_t>(insert_cost, 1U)
+              << "] stats_atomic[" << atomic_cost << "ms] stats_mutex["
+              << mutex_cost << "ms]" << std::endl;
+  }
+  return 0;
+}